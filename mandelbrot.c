@@ -3,8 +3,23 @@
  * 
  * contains the main () entry point for the mandelbrot binary
  * 
- * creates window and mandelbrot objects, before setting up all the input callbacks, before entering an event-draw loop
+ * creates window and mandelbrot objects, before setting up all the input callbacks, before starting a render thread and entering an event loop
  * cleans up after being closed or ESC is pressed
+ *
+ * mandelbrot --record <log> does the same, recording every input callback, with when it occured, to a binary input log
+ * mandelbrot --replay <log> [max] opens a window and drives the same callbacks from an input log, at the speed they were recorded,
+ * or with max, each as soon as the view published by the last has been rendered, then reports the frame times of the render thread
+ * mandelbrot --headless <width> <height> <output.ppm|png|tif> instead renders the default view without a display, and writes it to a file
+ * mandelbrot --png-bench <width> <height> <output.png> compares the parallel PNG encoder against a single deflate stream
+ * mandelbrot --bench [<width> <height> <runs>] renders a fixed set of scenes at several maximum iterations, and writes their timings to stdout as JSON
+ * mandelbrot --export <width> <height> <output.ppm|png|tif|mbraw> [<re_centre> <im_centre> <min_range> <max_it>] renders a view of any size tile by tile, streaming it to a file
+ * .mbraw files are raw dumps of the iterations of each pixel rather than its colour, which can be recoloured without iterating again
+ * mandelbrot --video <width> <height> <frames> <re_start> <im_start> <range_start> <re_end> <im_end> <range_end> [y4m|rgb] renders a zoom
+ * from one view to another, streaming the frames to stdout, such as into ffmpeg -i - for Y4M or ffmpeg -f rawvideo -pix_fmt rgb24 for rgb
+ * mandelbrot --expmap-video <width> <height> <frames> <re_centre> <im_centre> <range_start> <range_end> [y4m|rgb] renders a zoom into a point
+ * in the same way, but resamples the frames from a single log-polar strip of the whole zoom, which is far faster for long and deep zooms
+ * mandelbrot --trace <trace.json> followed by any of the above traces where time goes on each thread, dumping the trace as Chrome trace-event JSON
+ * when the process exits, or when T is pressed in the window
  * 
  */
 
@@ -15,10 +30,19 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <math.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/stat.h>
 
 /* include mb_handler */
 #include <mb_handler/mb_handler.h>
 
+/* include mb_export */
+#include <mb_export/mb_export.h>
+
+/* include mb_input */
+#include <mb_input/mb_input.h>
+
 
 
 /* MACROS AND GLOBAL DEFINITIONS */
@@ -47,87 +71,128 @@
  */
 #define MANDELBROT_MOVE_STEP 0.075
 
-/* volatile size_t mb_set_ptr
+/* MANDELBROT_SWAP_INTERVAL
  *
- * int-casted pointer to the mandelbrot set currently being rendered
+ * defines the number of display refreshes to wait for before swapping buffers
+ * 1 paces rendering to the display refresh rate, 0 disables waiting
+ * can be set during compilation using -DMANDELBROT_SWAP_INTERVAL=interval
  */
-volatile size_t mb_set_ptr = 0;
+#ifndef MANDELBROT_SWAP_INTERVAL
+#define MANDELBROT_SWAP_INTERVAL 1
+#endif
 
-/* volatile double scroll_track
+/* MANDELBROT_REPLAY_FRAME_TIMES
  *
- * keeps a track of how zoomed in the mandelbrot set is, through summing the yoffsets in the scroll callback
+ * defines the most frame times recorded while replaying an input log, after which no more are recorded
+ * can be set during compilation using -DMANDELBROT_REPLAY_FRAME_TIMES=frames
  */
-volatile double scroll_track = 0.0;
+#ifndef MANDELBROT_REPLAY_FRAME_TIMES
+#define MANDELBROT_REPLAY_FRAME_TIMES 65536
+#endif
 
+/* MANDELBROT_BENCH_WIDTH/HEIGHT/RUNS
+ *
+ * defines the default size of the frames rendered by the benchmark, and the number of timed renders of each scene
+ * small enough by default for the benchmark to finish in a few minutes on Mesa's software rasterisers
+ * can be set during compilation using -DMANDELBROT_BENCH_WIDTH/HEIGHT/RUNS=value
+ */
+#ifndef MANDELBROT_BENCH_WIDTH
+#define MANDELBROT_BENCH_WIDTH 320
+#endif
+#ifndef MANDELBROT_BENCH_HEIGHT
+#define MANDELBROT_BENCH_HEIGHT 240
+#endif
+#ifndef MANDELBROT_BENCH_RUNS
+#define MANDELBROT_BENCH_RUNS 5
+#endif
 
+/* MANDELBROT_BENCH_WARMUP
+ *
+ * defines the number of untimed renders of each scene before it is timed, which compile the shader paths and fill the caches
+ * can be set during compilation using -DMANDELBROT_BENCH_WARMUP=renders
+ */
+#ifndef MANDELBROT_BENCH_WARMUP
+#define MANDELBROT_BENCH_WARMUP 1
+#endif
 
-/* CALLBACK FUNCTIONS */
 
-/* mandelbrot_drag_callback
+
+/* STRUCTURES */
+
+/* struct mandelbrot_window_t
  *
- * callback when dragging occurs
- * 
- * window: the window the drag is being applied to
- * x,ydrag: the change in x and y
+ * the set shown in a window, along with the window's input which is yet to be applied to it
+ * set as the window's user pointer, so that each window has its own view
  */
-void mandelbrot_drag_callback ( glh_window_t window, const double xdrag, const double ydrag )
+typedef struct
 {
-    /* get the mandelbrot set */
-    mb_set_t mb_set = ( mb_set_t ) mb_set_ptr;   
+    /* the mandelbrot set shown in the window */
+    mb_set_t mb_set;
 
-    /* get viewport size */
-    int viewport_size [ 4 ];
-    glh_get_viewport_size ( window, viewport_size );
+    /* keeps a track of how zoomed in the set is, through summing the yoffsets in the scroll callback */
+    double scroll_track;
 
-    /* find change as fraction of viewport */
-    const double xfrac = xdrag / viewport_size [ 2 ];
-    const double yfrac = ydrag / viewport_size [ 3 ];
+    /* the sums of the drags which have occured since input was last applied to the set */
+    double pending_xdrag;
+    double pending_ydrag;
 
-    /* add change to centre of mandelbrot by a fraction of what is currently visible on thr real and imaginary axis */
-    mb_set->re_centre -= mb_set->re_range * xfrac;
-    mb_set->im_centre += mb_set->im_range * yfrac;
-}
+    /* the sum of the scroll yoffsets which have occured since input was last applied to the set */
+    double pending_yscroll;
 
-/* mandelbrot_scroll_callback
+    /* the position of the cursor at the most recent scroll, which the pending zoom is centred on */
+    double pending_scroll_xpos;
+    double pending_scroll_ypos;
+
+    /* the input log the window's input is being recorded to, or NULL if not recording */
+    mb_input_log_t * record_log;
+
+    /* 1 while replaying an input log, along with the position of the cursor when the event being replayed was recorded,
+     * which is used in place of the position of the real cursor
+     */
+    int replaying;
+    double replay_xpos;
+    double replay_ypos;
+
+} mandelbrot_window_t;
+
+/* struct mandelbrot_bench_scene_t
  *
- * callback when scrolling occurs
- * 
- * window: window the scrolling is being applied to
- * x,yoffset: the change in x and y
+ * a view of the set rendered by the benchmark
  */
-void mandelbrot_scroll_callback ( glh_window_t window, const double xoffset, const double yoffset )
+typedef struct
 {
-    /* get the mandelbrot set */
-    mb_set_t mb_set = ( mb_set_t ) mb_set_ptr; 
+    /* the name of the scene */
+    const char * name;
 
-    /* add the offset to scroll track */
-    scroll_track += yoffset;
+    /* centre of the screen, and the minimum range visible on both axes */
+    float re_centre;
+    float im_centre;
+    float min_range;
 
-    /* get mouse position */
-    double xpos, ypos;
-    glh_get_cursor_pos ( window, &xpos, &ypos );
+    /* power, and rotation (in radians) */
+    int power;
+    float rotation;
 
-    /* get viewport size */
-    int viewport_size [ 4 ];
-    glh_get_viewport_size ( window, viewport_size );
+} mandelbrot_bench_scene_t;
 
-    /* find mouse position in terms of fractions of the viewport centre */
-    const double xcfrac = ( xpos / viewport_size [ 2 ] ) - 0.5;
-    const double ycfrac = ( ypos / viewport_size [ 3 ] ) - 0.5;
 
+
+/* ZOOM */
+
+/* mandelbrot_zoom_set
+ *
+ * sets the minimum ranges and maximum iterations of the set to those after zooming a number of steps in from the default view
+ * each step multiplies the minimum ranges by MANDELBROT_RANGE_COEFICIENT and the maximum iterations by MANDELBROT_IT_COEFICIENT
+ * 
+ * mb_set: the set to zoom
+ * scroll_track: the number of steps zoomed in from the default view, which need not be whole
+ */
+void mandelbrot_zoom_set ( mb_set_t mb_set, const double scroll_track )
+{
     /* find the scaling multiples */
     const double range_from_def_multiple = pow ( MANDELBROT_RANGE_COEFICIENT, scroll_track );
-    const double range_from_curr_multiple = pow ( MANDELBROT_RANGE_COEFICIENT, yoffset );
     const double it_from_def_multiple = pow ( MANDELBROT_IT_COEFICIENT, scroll_track );
 
-    /* find the change in real and imaginary ranges */
-    const double re_range_change = ( mb_set->re_range * range_from_curr_multiple ) - mb_set->re_range;
-    const double im_range_change = ( mb_set->im_range * range_from_curr_multiple ) - mb_set->im_range;
-
-    /* find the new centre */
-    mb_set->re_centre -= re_range_change * xcfrac;
-    mb_set->im_centre += im_range_change * ycfrac;
-
     /* find the new real and imaginary min ranges */
     mb_set->re_min_range = MBDEF_RE_MIN_RANGE * range_from_def_multiple;
     mb_set->im_min_range = MBDEF_IM_MIN_RANGE * range_from_def_multiple;
@@ -136,6 +201,69 @@ void mandelbrot_scroll_callback ( glh_window_t window, const double xoffset, con
     mb_set->max_it = MBDEF_MAX_IT * it_from_def_multiple;
 }
 
+/* mandelbrot_scroll_track
+ *
+ * finds the number of steps zoomed in from the default view at which the minimum range is reached, the inverse of mandelbrot_zoom_set
+ * 
+ * min_range: the minimum range
+ *
+ * return: the number of steps, which need not be whole
+ */
+double mandelbrot_scroll_track ( const double min_range )
+{
+    /* find the steps */
+    return log ( min_range / MBDEF_RE_MIN_RANGE ) / log ( MANDELBROT_RANGE_COEFICIENT );
+}
+
+
+
+/* CALLBACK FUNCTIONS */
+
+/* mandelbrot_drag_callback
+ *
+ * callback when dragging occurs
+ * the drag is accumulated, and applied to the set by mandelbrot_apply_input
+ * 
+ * window: the window the drag is being applied to
+ * x,ydrag: the change in x and y
+ */
+void mandelbrot_drag_callback ( glh_window_t window, const double xdrag, const double ydrag )
+{
+    /* get the window's view */
+    mandelbrot_window_t * mb_window = glh_get_window_user_pointer ( window );
+    MB_TRACE_INSTANT ( "drag" );
+
+    /* add the drag to the pending drag */
+    mb_window->pending_xdrag += xdrag;
+    mb_window->pending_ydrag += ydrag;
+}
+
+/* mandelbrot_scroll_callback
+ *
+ * callback when scrolling occurs
+ * the scroll is accumulated, and applied to the set by mandelbrot_apply_input
+ * 
+ * window: window the scrolling is being applied to
+ * x,yoffset: the change in x and y
+ */
+void mandelbrot_scroll_callback ( glh_window_t window, const double xoffset, const double yoffset )
+{
+    /* get the window's view */
+    mandelbrot_window_t * mb_window = glh_get_window_user_pointer ( window );
+    MB_TRACE_INSTANT ( "scroll" );
+
+    /* add the offset to the pending scroll */
+    mb_window->pending_yscroll += yoffset;
+
+    /* get mouse position, which the zoom will be centred on, or if replaying, where it was when the scroll was recorded */
+    if ( mb_window->replaying )
+    {
+        mb_window->pending_scroll_xpos = mb_window->replay_xpos;
+        mb_window->pending_scroll_ypos = mb_window->replay_ypos;
+    }
+    else glh_get_cursor_pos ( window, &mb_window->pending_scroll_xpos, &mb_window->pending_scroll_ypos );
+}
+
 /* mandelbrot_key_callback
  *
  * callback for when a key is pressed
@@ -148,84 +276,1149 @@ void mandelbrot_scroll_callback ( glh_window_t window, const double xoffset, con
  */
 void mandelbrot_key_callback ( glh_window_t window, const int key, const int scancode, const int action, const int mods )
 {
-    /* get the mandelbrot set */
-    mb_set_t mb_set = ( mb_set_t ) mb_set_ptr;
+    /* get the window's view and its set */
+    mandelbrot_window_t * mb_window = glh_get_window_user_pointer ( window );
+    mb_set_t mb_set = mb_window->mb_set;
+
+    /* key releases do not change anything */
+    if ( action == GLFW_RELEASE ) return;
+    MB_TRACE_INSTANT ( "key" );
+
+    switch ( key )
+    {
+        /* if escape, set window should close */
+        case GLFW_KEY_ESCAPE: glh_set_window_should_close ( window ); return;
+
+        /* if T, dump the trace so far, if tracing */
+        case GLFW_KEY_T: mb_trace_dump (); return;
+
+        /* if H, show or hide the overlay of performance statistics, counting the iterations of each frame started for it while it is shown,
+         * both from a single read of whether it is shown, as the render thread hides it if it cannot be created
+         */
+        case GLFW_KEY_H:
+        {
+            const int shown = !__atomic_load_n ( &mb_set->hud_enabled, __ATOMIC_ACQUIRE );
+            mb_set_frame_stats ( mb_set, shown );
+            mb_set_hud ( mb_set, shown );
+            return;
+        }
+
+        /* if W/Q, increase/decrease the power */
+        case GLFW_KEY_W: mb_set->power += 1; break;
+        case GLFW_KEY_Q: mb_set->power -= 1; break;
+
+        /* if A/S, rotate the set */
+        case GLFW_KEY_A: mb_set->rotation += MANDELBROT_ROTATION_STEP; break;
+        case GLFW_KEY_S: mb_set->rotation -= MANDELBROT_ROTATION_STEP; break;
+
+        /* if +/-, zoom in and out */
+        case GLFW_KEY_EQUAL: mandelbrot_scroll_callback ( window, 0, 1 ); return;
+        case GLFW_KEY_MINUS: mandelbrot_scroll_callback ( window, 0, -1 ); return;
+
+        /* arrow keys to move */
+        case GLFW_KEY_LEFT: mb_set->re_centre -= mb_set->re_range * MANDELBROT_MOVE_STEP; break;
+        case GLFW_KEY_UP: mb_set->im_centre += mb_set->im_range * MANDELBROT_MOVE_STEP; break;
+        case GLFW_KEY_RIGHT: mb_set->re_centre += mb_set->re_range * MANDELBROT_MOVE_STEP; break;
+        case GLFW_KEY_DOWN: mb_set->im_centre -= mb_set->im_range * MANDELBROT_MOVE_STEP; break;
+
+        /* if R, reset to defaults */
+        case GLFW_KEY_R:
+            mb_set->re_min_range = MBDEF_RE_MIN_RANGE;
+            mb_set->im_min_range = MBDEF_IM_MIN_RANGE;
+            mb_set->re_centre = MBDEF_RE_CENTRE;
+            mb_set->im_centre = MBDEF_IM_CENTRE;
+            mb_set->breakout = MBDEF_BREAKOUT;
+            mb_set->max_it = MBDEF_MAX_IT;
+            mb_set->power = MBDEF_POWER;
+            mb_set->rotation = MBDEF_ROTATION;
+            mb_window->scroll_track = 0.0;
+            break;
+
+        /* any other key does not change anything */
+        default: return;
+    }
+
+    /* the set has changed, so publish the new view */
+    mb_publish_view ( mb_set );
+}
+
+/* mandelbrot_apply_input
+ *
+ * applies the drags and scrolls accumulated since the last call to the set
+ * all of the drags are applied as a single move, and all of the scrolls as a single zoom
+ * 
+ * window: the window the input occured on
+ */
+void mandelbrot_apply_input ( glh_window_t window )
+{
+    /* get the window's view and its set */
+    mandelbrot_window_t * mb_window = glh_get_window_user_pointer ( window );
+    mb_set_t mb_set = mb_window->mb_set;
+
+    /* if there is no pending input, return */
+    if ( mb_window->pending_xdrag == 0.0 && mb_window->pending_ydrag == 0.0 && mb_window->pending_yscroll == 0.0 ) return;
+    MB_TRACE_BEGIN ( "apply input" );
+
+    /* if there is a pending drag, apply it */
+    if ( mb_window->pending_xdrag != 0.0 || mb_window->pending_ydrag != 0.0 )
+    {
+        /* find change as fraction of viewport */
+        const double xfrac = mb_window->pending_xdrag / mb_set->width;
+        const double yfrac = mb_window->pending_ydrag / mb_set->height;
+
+        /* add change to centre of mandelbrot by a fraction of what is currently visible on thr real and imaginary axis */
+        mb_set->re_centre -= mb_set->re_range * xfrac;
+        mb_set->im_centre += mb_set->im_range * yfrac;
+    }
+
+    /* if there is a pending scroll, apply it */
+    if ( mb_window->pending_yscroll != 0.0 )
+    {
+        /* add the offset to scroll track */
+        mb_window->scroll_track += mb_window->pending_yscroll;
+
+        /* find mouse position in terms of fractions of the viewport centre */
+        const double xcfrac = ( mb_window->pending_scroll_xpos / mb_set->width ) - 0.5;
+        const double ycfrac = ( mb_window->pending_scroll_ypos / mb_set->height ) - 0.5;
+
+        /* find the scaling multiple from the current ranges */
+        const double range_from_curr_multiple = pow ( MANDELBROT_RANGE_COEFICIENT, mb_window->pending_yscroll );
+
+        /* find the change in real and imaginary ranges */
+        const double re_range_change = ( mb_set->re_range * range_from_curr_multiple ) - mb_set->re_range;
+        const double im_range_change = ( mb_set->im_range * range_from_curr_multiple ) - mb_set->im_range;
+
+        /* find the new centre */
+        mb_set->re_centre -= re_range_change * xcfrac;
+        mb_set->im_centre += im_range_change * ycfrac;
+
+        /* find the new min ranges and maximum iterations */
+        mandelbrot_zoom_set ( mb_set, mb_window->scroll_track );
+    }
+
+    /* reset the pending input */
+    mb_window->pending_xdrag = 0.0;
+    mb_window->pending_ydrag = 0.0;
+    mb_window->pending_yscroll = 0.0;
+
+    /* the set has changed, so publish the new view */
+    mb_publish_view ( mb_set );
+    MB_TRACE_END ( "apply input" );
+}
+
+/* mandelbrot_refresh_callback
+ *
+ * callback for when the contents of the window are damaged
+ * 
+ * window: the window which was damaged
+ */
+void mandelbrot_refresh_callback ( glh_window_t window )
+{
+    /* get the window's view and its set */
+    mandelbrot_window_t * mb_window = glh_get_window_user_pointer ( window );
+    mb_set_t mb_set = mb_window->mb_set;
+    MB_TRACE_INSTANT ( "refresh" );
+
+    /* if the set has been created, mark the window as damaged so the frame is presented again */
+    if ( mb_set ) mb_mark_damaged ( mb_set );
+}
+
+/* mandelbrot_viewport_size_callback
+ *
+ * callback for when the size of the window's framebuffer changes
+ * 
+ * window: the window which was resized
+ * width/height: the new size of the framebuffer
+ */
+void mandelbrot_viewport_size_callback ( glh_window_t window, const int width, const int height )
+{
+    /* get the window's view and its set */
+    mandelbrot_window_t * mb_window = glh_get_window_user_pointer ( window );
+    mb_set_t mb_set = mb_window->mb_set;
+    MB_TRACE_INSTANT ( "resize" );
+
+    /* if the set has been created, set the new size and publish the new view */
+    if ( mb_set )
+    {
+        mb_set->width = width;
+        mb_set->height = height;
+        mb_publish_view ( mb_set );
+    }
+}
+
+
+
+/* INPUT RECORDING AND REPLAY */
+
+/* mandelbrot_record_event
+ *
+ * record an event to the window's input log, if it is being recorded, along with the position of the cursor
+ * if recording fails, recording is stopped, but the window carries on
+ *
+ * window: the window the event occured on
+ * event: the event, whose time and cursor position will be set
+ */
+void mandelbrot_record_event ( glh_window_t window, mb_input_event_t * event )
+{
+    /* get the window's view, and if not recording, return */
+    mandelbrot_window_t * mb_window = glh_get_window_user_pointer ( window );
+    if ( !mb_window->record_log ) return;
+
+    /* find the position of the cursor */
+    double xpos, ypos;
+    glh_get_cursor_pos ( window, &xpos, &ypos );
+    event->cursor_x = xpos;
+    event->cursor_y = ypos;
+
+    /* record the event, stopping recording if it fails */
+    if ( mb_input_record ( mb_window->record_log, event ) != 0 )
+    {
+        fprintf ( stderr, "MANDELBROT ERROR: failed to record input, recording stopped\n" );
+        mb_input_close ( mb_window->record_log );
+        mb_window->record_log = NULL;
+    }
+}
+
+/* mandelbrot_record_key/drag/scroll/refresh/viewport_size_callback
+ *
+ * callbacks set in place of mandelbrot_key/drag/scroll/refresh/viewport_size_callback while recording
+ * each records the event, then passes it on to the callback it replaces
+ *
+ * window: the window the event occured on
+ * ...: the arguments of the callback replaced
+ */
+void mandelbrot_record_key_callback ( glh_window_t window, const int key, const int scancode, const int action, const int mods )
+{
+    mb_input_event_t event = { .type = MB_INPUT_KEY, .key = key, .scancode = scancode, .action = action, .mods = mods };
+    mandelbrot_record_event ( window, &event );
+    mandelbrot_key_callback ( window, key, scancode, action, mods );
+}
+void mandelbrot_record_drag_callback ( glh_window_t window, const double xdrag, const double ydrag )
+{
+    mb_input_event_t event = { .type = MB_INPUT_DRAG, .x = xdrag, .y = ydrag };
+    mandelbrot_record_event ( window, &event );
+    mandelbrot_drag_callback ( window, xdrag, ydrag );
+}
+void mandelbrot_record_scroll_callback ( glh_window_t window, const double xoffset, const double yoffset )
+{
+    mb_input_event_t event = { .type = MB_INPUT_SCROLL, .x = xoffset, .y = yoffset };
+    mandelbrot_record_event ( window, &event );
+    mandelbrot_scroll_callback ( window, xoffset, yoffset );
+}
+void mandelbrot_record_refresh_callback ( glh_window_t window )
+{
+    mb_input_event_t event = { .type = MB_INPUT_REFRESH };
+    mandelbrot_record_event ( window, &event );
+    mandelbrot_refresh_callback ( window );
+}
+void mandelbrot_record_viewport_size_callback ( glh_window_t window, const int width, const int height )
+{
+    mb_input_event_t event = { .type = MB_INPUT_RESIZE, .x = width, .y = height };
+    mandelbrot_record_event ( window, &event );
+    mandelbrot_viewport_size_callback ( window, width, height );
+}
 
-    /* if escape, set window should close */
-    if ( glh_get_key ( window, GLFW_KEY_ESCAPE ) == GLFW_PRESS ) glh_set_window_should_close ( window );
-    
-    /* if W/Q, increase/decrease the power */
-    if ( glh_get_key ( window, GLFW_KEY_W ) == GLFW_PRESS ) mb_set->power += 1;
-    if ( glh_get_key ( window, GLFW_KEY_Q ) == GLFW_PRESS ) mb_set->power -= 1;
+/* mandelbrot_record_apply_input
+ *
+ * applies the accumulated input to the set as mandelbrot_apply_input does, recording that it was applied if there was any
+ * so that a replay applies the same input together, and publishes the same views
+ *
+ * window: the window the input occured on
+ */
+void mandelbrot_record_apply_input ( glh_window_t window )
+{
+    /* get the window's view */
+    mandelbrot_window_t * mb_window = glh_get_window_user_pointer ( window );
 
-    /* if A/S, rotate the set */
-    if ( glh_get_key ( window, GLFW_KEY_A ) == GLFW_PRESS ) mb_set->rotation += MANDELBROT_ROTATION_STEP;
-    if ( glh_get_key ( window, GLFW_KEY_S ) == GLFW_PRESS ) mb_set->rotation -= MANDELBROT_ROTATION_STEP;
+    /* if there is pending input, record that it is applied */
+    if ( mb_window->pending_xdrag != 0.0 || mb_window->pending_ydrag != 0.0 || mb_window->pending_yscroll != 0.0 )
+    {
+        mb_input_event_t event = { .type = MB_INPUT_APPLY };
+        mandelbrot_record_event ( window, &event );
+    }
 
-    /* if +/-, zoom in and out */
-    if ( glh_get_key ( window, GLFW_KEY_EQUAL ) == GLFW_PRESS ) mandelbrot_scroll_callback ( window, 0, 1 );
-    if ( glh_get_key ( window, GLFW_KEY_MINUS ) == GLFW_PRESS ) mandelbrot_scroll_callback ( window, 0, -1 );
+    /* apply the input */
+    mandelbrot_apply_input ( window );
+}
 
-    /* arrow keys to move */
-    if ( glh_get_key ( window, GLFW_KEY_LEFT ) == GLFW_PRESS ) mb_set->re_centre -= mb_set->re_range * MANDELBROT_MOVE_STEP;
-    if ( glh_get_key ( window, GLFW_KEY_UP ) == GLFW_PRESS ) mb_set->im_centre += mb_set->im_range * MANDELBROT_MOVE_STEP;
-    if ( glh_get_key ( window, GLFW_KEY_RIGHT ) == GLFW_PRESS ) mb_set->re_centre += mb_set->re_range * MANDELBROT_MOVE_STEP;
-    if ( glh_get_key ( window, GLFW_KEY_DOWN ) == GLFW_PRESS ) mb_set->im_centre -= mb_set->im_range * MANDELBROT_MOVE_STEP;
+/* mandelbrot_replay_event
+ *
+ * replay an event from an input log, calling the callback it was recorded from with the same arguments
+ *
+ * window: the window to replay the event on
+ * event: the event to replay
+ */
+void mandelbrot_replay_event ( glh_window_t window, const mb_input_event_t * event )
+{
+    /* get the window's view, and put the cursor where it was when the event was recorded */
+    mandelbrot_window_t * mb_window = glh_get_window_user_pointer ( window );
+    mb_window->replay_xpos = event->cursor_x;
+    mb_window->replay_ypos = event->cursor_y;
 
-    /* if R, reset to defaults */
-    if ( glh_get_key ( window, GLFW_KEY_R ) == GLFW_PRESS )
+    /* call the callback for the event */
+    switch ( event->type )
     {
-        mb_set->re_min_range = MBDEF_RE_MIN_RANGE;
-        mb_set->im_min_range = MBDEF_IM_MIN_RANGE;
-        mb_set->re_centre = MBDEF_RE_CENTRE;
-        mb_set->im_centre = MBDEF_IM_CENTRE;
-        mb_set->breakout = MBDEF_BREAKOUT;
-        mb_set->max_it = MBDEF_MAX_IT;
-        mb_set->power = MBDEF_POWER;
-        mb_set->rotation = MBDEF_ROTATION;
-        scroll_track = 0.0;
+        case MB_INPUT_KEY: mandelbrot_key_callback ( window, event->key, event->scancode, event->action, event->mods ); break;
+        case MB_INPUT_DRAG: mandelbrot_drag_callback ( window, event->x, event->y ); break;
+        case MB_INPUT_SCROLL: mandelbrot_scroll_callback ( window, event->x, event->y ); break;
+        case MB_INPUT_RESIZE: mandelbrot_viewport_size_callback ( window, ( int ) event->x, ( int ) event->y ); break;
+        case MB_INPUT_REFRESH: mandelbrot_refresh_callback ( window ); break;
+        case MB_INPUT_APPLY: mandelbrot_apply_input ( window ); break;
+        default: break;
     }
 }
 
+/* mandelbrot_replay_viewport_size_callback
+ *
+ * callback for when the size of a replay window's framebuffer changes
+ * the set is rendered at the size given by the log, so the new size is ignored, and the window is only marked as damaged
+ * so the frame is presented again, leaving the context to the render thread which owns it
+ *
+ * window: the window which was resized
+ * width/height: the new size of the framebuffer
+ */
+void mandelbrot_replay_viewport_size_callback ( glh_window_t window, const int width, const int height )
+{
+    /* ignore the new size, and mark the window as damaged */
+    ( void ) width;
+    ( void ) height;
+    mandelbrot_refresh_callback ( window );
+}
+
+/* mandelbrot_compare_times
+ *
+ * compare two times for qsort
+ *
+ * a/b: pointers to the doubles to compare
+ *
+ * return: less than, equal to or greater than 0 as a is less than, equal to or greater than b
+ */
+int mandelbrot_compare_times ( const void * a, const void * b )
+{
+    /* compare the times */
+    const double time_a = * ( const double * ) a;
+    const double time_b = * ( const double * ) b;
+    return ( time_a > time_b ) - ( time_a < time_b );
+}
+
+/* mandelbrot_replay
+ *
+ * open a window and replay an input log onto it, then report the frame times of the render thread on stdout
+ * at the speed it was recorded, each event is replayed when it originally occured, so interaction is reproduced as the user saw it
+ * at maximum speed, each event is replayed as soon as the view published by the last has been rendered, so the replay is a benchmark
+ * of rendering the same views
+ * the set is rendered at the size of the framebuffer when the log was recorded, whatever the size of the window
+ *
+ * path: the input log to replay
+ * max_speed: 1 to replay at maximum speed, 0 to replay at the speed the log was recorded
+ *
+ * return: 0 for success, 1 for failure
+ */
+int mandelbrot_replay ( const char * path, const int max_speed )
+{
+    /* open the log */
+    mb_input_log_t * log = mb_input_open_replay ( path );
+    if ( !log ) return 1;
+
+    /* init glfw and create a window of the size recorded, whose view is being replayed */
+    glh_init_glfw ();
+    glh_window_t window = glh_create_window ( "Replay", log->header.width, log->header.height );
+    if ( !window )
+    {
+        /* failed to create the window, so close the log and return failure */
+        fprintf ( stderr, "MANDELBROT ERROR: failed to create a window to replay %s\n", path );
+        mb_input_close ( log );
+        glh_terminate_glfw ();
+        return 1;
+    }
+    mandelbrot_window_t mb_window = { 0 };
+    mb_window.replaying = 1;
+    glh_set_window_user_pointer ( window, &mb_window );
+
+    /* only damage to the window is handled, as all other input comes from the log, including the size the set is rendered at,
+     * and glhelper's own resize callback is replaced, as it would make the context current on this thread while the render thread owns it
+     */
+    glh_set_window_refresh_callback ( window, mandelbrot_refresh_callback );
+    glh_set_viewport_size_callback ( window, mandelbrot_replay_viewport_size_callback );
+    glh_set_swap_interval ( window, MANDELBROT_SWAP_INTERVAL );
+
+    /* construct mandelbrot set from defaults, at the size recorded, recording its frame times */
+    mb_set_t mb_set = mb_create_set ( MBDEF_RE_MIN_RANGE, MBDEF_IM_MIN_RANGE, MBDEF_RE_CENTRE, MBDEF_IM_CENTRE, MBDEF_BREAKOUT, MBDEF_MAX_IT );
+    mb_window.mb_set = mb_set;
+    int status = 1;
+    if ( mb_set && mb_record_frame_times ( mb_set, MANDELBROT_REPLAY_FRAME_TIMES ) == 0 )
+    {
+        /* publish the initial view and start the render thread */
+        mb_set->width = log->header.width;
+        mb_set->height = log->header.height;
+        mb_publish_view ( mb_set );
+        if ( mb_start_render_thread ( mb_set, window ) == 0 )
+        {
+            /* replay each event until the log ends or the window is closed */
+            const double start_time = glh_get_time ();
+            mb_input_event_t event;
+            int read = 0, events = 0;
+            double log_seconds = 0.0;
+            while ( !glh_should_window_close ( window ) && ( read = mb_input_read ( log, &event ) ) == 1 )
+            {
+                /* at the speed recorded, wait until the event is due, handling any damage to the window meanwhile */
+                double wait;
+                while ( !max_speed && ( wait = start_time + event.time - glh_get_time () ) > 0.0 ) glh_wait_events ( wait );
+                glh_poll_events ();
+
+                /* replay the event, and at maximum speed, wait for the view it published to be rendered */
+                mandelbrot_replay_event ( window, &event );
+                if ( max_speed && mb_wait_frame ( mb_set ) < 0 ) break;
+                log_seconds = event.time;
+                ++events;
+            }
+
+            /* wait for the last view to be rendered, then stop the render thread so its frame times can be read */
+            const int failed = ( mb_wait_frame ( mb_set ) < 0 );
+            const double seconds = glh_get_time () - start_time;
+            mb_stop_render_thread ( mb_set );
+            status = ( read < 0 || failed ? 1 : 0 );
+
+            /* sort the frame times, and report their distribution */
+            const int frames = mb_set->frame_time_count;
+            double * times = mb_set->frame_times;
+            qsort ( times, frames, sizeof ( double ), mandelbrot_compare_times );
+            double mean = 0.0;
+            for ( int frame = 0; frame < frames; ++frame ) mean += times [ frame ] / frames;
+            if ( status == 0 && frames > 0 )
+            {
+                printf ( "replayed %d events recorded over %.2fs in %.2fs at %s speed: %d frames, frame time mean %.2fms, p50 %.2fms, p95 %.2fms, p99 %.2fms, max %.2fms\n",
+                         events, log_seconds, seconds, ( max_speed ? "maximum" : "recorded" ), frames, mean * 1.0e3, times [ frames / 2 ] * 1.0e3,
+                         times [ ( int ) ( frames * 0.95 ) ] * 1.0e3, times [ ( int ) ( frames * 0.99 ) ] * 1.0e3, times [ frames - 1 ] * 1.0e3 );
+            }
+
+            /* report the mean gpu and cpu time of each phase of the draws timed on the gpu */
+            mb_stats_t stats;
+            if ( status == 0 && mb_get_stats ( mb_set, &stats ) == 0 && stats.draws > 0 )
+            {
+                printf ( "%lu draws timed, gpu mean prepare %.3fms, iterate %.3fms, present %.3fms, span %.3fms, cpu mean prepare %.3fms, iterate %.3fms, present %.3fms\n",
+                         stats.draws, stats.total_gpu_times [ MANDELBROT_PHASE_PREPARE ] * 1.0e3 / stats.draws, stats.total_gpu_times [ MANDELBROT_PHASE_ITERATE ] * 1.0e3 / stats.draws,
+                         stats.total_gpu_times [ MANDELBROT_PHASE_PRESENT ] * 1.0e3 / stats.draws, stats.total_gpu_span * 1.0e3 / stats.draws,
+                         stats.total_cpu_times [ MANDELBROT_PHASE_PREPARE ] * 1.0e3 / stats.draws, stats.total_cpu_times [ MANDELBROT_PHASE_ITERATE ] * 1.0e3 / stats.draws,
+                         stats.total_cpu_times [ MANDELBROT_PHASE_PRESENT ] * 1.0e3 / stats.draws );
+            }
+        }
+    }
+    if ( status != 0 ) fprintf ( stderr, "MANDELBROT ERROR: failed to replay %s\n", path );
+
+    /* clean up */
+    if ( mb_set ) mb_destroy_set ( mb_set );
+    mb_input_close ( log );
+    glh_destroy_window ( window );
+    glh_terminate_glfw ();
+
+    /* return the status */
+    return status;
+}
+
+
+
+/* HEADLESS RENDERING */
+
+/* mandelbrot_render_rows
+ *
+ * render the default view of the set with a headless context, and read it back
+ *
+ * width/height: the size of the image in pixels
+ *
+ * return: the rows of the image as 8 bit RGB, top row first, to be freed by the caller, or NULL on failure
+ */
+unsigned char * mandelbrot_render_rows ( const int width, const int height )
+{
+    /* create headless context */
+    glh_headless_context_t * context = glh_create_headless_context ();
+    if ( !context ) return NULL;
+
+    /* construct mandelbrot set from defaults, at the size of the image */
+    mb_set_t mb_set = mb_create_set ( MBDEF_RE_MIN_RANGE, MBDEF_IM_MIN_RANGE,
+                                      MBDEF_RE_CENTRE,    MBDEF_IM_CENTRE,
+                                      MBDEF_BREAKOUT,     MBDEF_MAX_IT );
+    unsigned char * rows = malloc ( ( size_t ) width * height * 3 );
+    int status = 1;
+    if ( mb_set && rows )
+    {
+        /* render the view and read it back through the readback ring */
+        mb_set->width = width;
+        mb_set->height = height;
+        mb_publish_view ( mb_set );
+        const unsigned char * pixels;
+        int frame_width, frame_height;
+        unsigned long tag;
+        if ( mb_render_frame ( mb_set ) == 0 && mb_queue_readback ( mb_set, 0 ) == 0 && mb_map_readback ( mb_set, 1, &pixels, &frame_width, &frame_height, &tag ) == 0 )
+        {
+            /* copy the image, top row first, dropping the alpha channel */
+            __mb_export_copy_tile ( pixels, frame_width, frame_height, rows, width, 0, width, height );
+            status = ( mb_unmap_readback ( mb_set ) == 0 ? 0 : 1 );
+        }
+    }
+
+    /* clean up */
+    if ( mb_set ) mb_destroy_set ( mb_set );
+    glh_destroy_headless_context ( context );
+
+    /* return the rows, or NULL on failure */
+    if ( status != 0 ) free ( rows );
+    return ( status == 0 ? rows : NULL );
+}
+
+/* mandelbrot_headless
+ *
+ * render the default view of the set with a headless context, and write it to a binary PPM, PNG or tiled TIFF file
+ * needs no display, so runs on render servers and in CI using Mesa's software rasterisers
+ *
+ * width/height: the size of the image in pixels
+ * path: the file to write the image to
+ *
+ * return: 0 for success, 1 for failure
+ */
+int mandelbrot_headless ( const int width, const int height, const char * path )
+{
+    /* render the image */
+    unsigned char * rows = mandelbrot_render_rows ( width, height );
+    if ( !rows ) return 1;
+
+    /* write the image */
+    mb_export_writer_t * writer = mb_export_open_writer ( path, width, height, NULL, 0 );
+    int status = ( writer && mb_export_write_rows ( writer, rows, 0, height ) == 0 ? 0 : 1 );
+    if ( writer && mb_export_close_writer ( writer ) != 0 ) status = 1;
+    if ( status != 0 ) fprintf ( stderr, "MANDELBROT ERROR: failed to write %s\n", path );
+
+    /* free the rows and return the status */
+    free ( rows );
+    return status;
+}
+
+/* mandelbrot_png_bench
+ *
+ * render the default view of the set with a headless context, and compare encoding it as a PNG with the parallel encoder
+ * against a single deflate stream at the same level on one thread, as plain zlib would produce
+ *
+ * width/height: the size of the image in pixels
+ * path: the file to write the images to, which is left holding the output of the parallel encoder
+ *
+ * return: 0 for success, 1 for failure
+ */
+int mandelbrot_png_bench ( const int width, const int height, const char * path )
+{
+    /* render the image */
+    unsigned char * rows = mandelbrot_render_rows ( width, height );
+    if ( !rows ) return 1;
+
+    /* encode the image as a single stream on one thread, then in rows of tiles as the export does, on as many threads as are available */
+    int status = 0;
+    for ( int parallel = 0; parallel <= 1 && status == 0; ++parallel )
+    {
+        const double start_time = __mb_export_time ();
+        mb_export_png_t * png = mb_export_open_png ( path, width, height, MB_EXPORT_PNG_LEVEL, ( parallel ? MB_EXPORT_PNG_THREADS : 1 ) );
+        if ( !png ) { status = 1; break; }
+        const int threads = png->threads;
+        const int step = ( parallel ? MB_EXPORT_TILE_SIZE : height );
+        for ( int y = 0; y < height && status == 0; y += step ) if ( mb_export_write_png_rows ( png, rows + ( size_t ) y * width * 3, ( height - y < step ? height - y : step ) ) != 0 ) status = 1;
+        if ( mb_export_close_png ( png ) != 0 ) status = 1;
+        const double seconds = __mb_export_time () - start_time;
+
+        /* report the time and size */
+        struct stat file_stat;
+        if ( status == 0 && stat ( path, &file_stat ) == 0 )
+        {
+            printf ( "%s, %d thread%s: %.3fs, %.2f Mpixel/s, %lld bytes\n", ( parallel ? "parallel bands" : "single stream" ), threads, ( threads == 1 ? "" : "s" ),
+                     seconds, ( double ) width * height * 1.0e-6 / seconds, ( long long ) file_stat.st_size );
+        }
+    }
+    if ( status != 0 ) fprintf ( stderr, "MANDELBROT ERROR: failed to write %s\n", path );
+
+    /* free the rows and return the status */
+    free ( rows );
+    return status;
+}
+
+/* mandelbrot_bench
+ *
+ * render a fixed set of scenes with a headless context, each at several maximum iterations, and write their timings to stdout as JSON
+ * every scene is rendered MANDELBROT_BENCH_WARMUP times untimed, then timed over a number of runs, each run rendering the whole frame with
+ * mb_render_frame, whose tiles are the same as mb_draw renders, and reading it back, so that the time includes waiting for the gpu
+ * the iterations of each scene are counted from one further render, reduced to frame statistics on the gpu, so that the iteration rate can be found
+ * the scenes and their order never change, so that the results of any two builds can be compared
+ *
+ * width/height: the size of the frames in pixels
+ * runs: the number of timed renders of each scene
+ *
+ * return: 0 for success, 1 for failure
+ */
+int mandelbrot_bench ( const int width, const int height, const int runs )
+{
+    /* the scenes: the default view, the boundary in seahorse valley, a view mostly inside the main cardioid,
+     * multibrots of powers 3, 5 and -2, and a rotated view of the boundary, each rendered at every maximum iterations
+     */
+    static const mandelbrot_bench_scene_t scenes [] =
+    {
+        { "default", MBDEF_RE_CENTRE, MBDEF_IM_CENTRE, MBDEF_RE_MIN_RANGE, 2, 0.0 },
+        { "seahorse_valley", -0.7453, 0.1127, 0.01, 2, 0.0 },
+        { "interior", -0.15, 0.0, 0.6, 2, 0.0 },
+        { "multibrot_3", 0.0, 0.0, 3.0, 3, 0.0 },
+        { "multibrot_5", 0.0, 0.0, 3.0, 5, 0.0 },
+        { "multibrot_-2", 0.0, 0.0, 5.0, -2, 0.0 },
+        { "rotated", -0.75, 0.1, 0.5, 2, 0.7853981633974483 }
+    };
+    static const int max_its [] = { 64, 256, 1024 };
+    const int scene_count = sizeof ( scenes ) / sizeof ( scenes [ 0 ] );
+    const int max_it_count = sizeof ( max_its ) / sizeof ( max_its [ 0 ] );
+
+    /* create headless context */
+    glh_headless_context_t * context = glh_create_headless_context ();
+    if ( !context ) return 1;
+
+    /* construct mandelbrot set, and allocate a frame to read each run back into and the times of each run */
+    mb_set_t mb_set = mb_create_set ( MBDEF_RE_MIN_RANGE, MBDEF_IM_MIN_RANGE, MBDEF_RE_CENTRE, MBDEF_IM_CENTRE, MBDEF_BREAKOUT, MBDEF_MAX_IT );
+    unsigned char * pixels = malloc ( ( size_t ) width * height * 4 );
+    double * times = malloc ( ( size_t ) runs * sizeof ( double ) );
+    int status = ( mb_set && pixels && times ? 0 : 1 );
+
+    /* write the renderer and settings, dropping any quotes or backslashes from the renderer so that the JSON needs no escaping */
+    const char * renderer = ( status == 0 ? glh_get_renderer () : NULL );
+    if ( status == 0 )
+    {
+        printf ( "{\n  \"renderer\": \"" );
+        for ( const char * c = ( renderer ? renderer : "unknown" ); *c; ++c ) if ( *c != '"' && *c != '\\' ) putchar ( *c );
+        printf ( "\",\n  \"width\": %d,\n  \"height\": %d,\n  \"warmup\": %d,\n  \"runs\": %d,\n  \"scenes\":\n  [\n", width, height, MANDELBROT_BENCH_WARMUP, runs );
+    }
+
+    /* benchmark each scene at each maximum iterations */
+    for ( int i = 0; i < scene_count * max_it_count && status == 0; ++i )
+    {
+        /* set up the view */
+        const mandelbrot_bench_scene_t * scene = &scenes [ i / max_it_count ];
+        const int max_it = max_its [ i % max_it_count ];
+        mb_set->re_min_range = scene->min_range;
+        mb_set->im_min_range = scene->min_range;
+        mb_set->re_centre = scene->re_centre;
+        mb_set->im_centre = scene->im_centre;
+        mb_set->power = scene->power;
+        mb_set->rotation = scene->rotation;
+        mb_set->max_it = max_it;
+        mb_set->width = width;
+        mb_set->height = height;
+
+        /* count the iterations of the view from a render reduced to statistics on the gpu, which is the only frame of each scene reduced,
+         * then disable statistics again so that the timed runs are unaffected
+         */
+        mb_frame_stats_t frame_stats;
+        if ( mb_set_frame_stats ( mb_set, 1 ) != 0 || mb_publish_view ( mb_set ) != 0 || mb_render_frame ( mb_set ) != 0 ||
+             mb_get_frame_stats ( mb_set, &frame_stats, 1 ) != 0 || mb_set_frame_stats ( mb_set, 0 ) != 0 ||
+             frame_stats.frames != ( unsigned long ) i + 1 ) { status = 1; break; }
+        const double iterations = frame_stats.iterations;
+
+        /* warm up, then time each run, republishing the view so that the whole frame is rendered again
+         * the gpu timings are taken from before the first run, once the warm up has been read back
+         */
+        mb_stats_t stats_before, stats_after;
+        for ( int run = -MANDELBROT_BENCH_WARMUP; run < runs && status == 0; ++run )
+        {
+            if ( run == 0 ) mb_get_stats ( mb_set, &stats_before );
+            const double start_time = __mb_export_time ();
+            if ( mb_publish_view ( mb_set ) != 0 || mb_render_frame ( mb_set ) != 0 || mb_read_frame ( mb_set, pixels ) != 0 ) status = 1;
+            if ( run >= 0 ) times [ run ] = ( __mb_export_time () - start_time ) * 1.0e3;
+        }
+        if ( status != 0 ) break;
+        mb_get_stats ( mb_set, &stats_after );
+
+        /* find the gpu time per frame from the batches of tiles timed on the gpu, scaling by the pixels they covered,
+         * as batches go untimed whenever every timer query is in flight
+         */
+        const double timed_pixels = stats_after.total_pixels - stats_before.total_pixels;
+        const double gpu_time = stats_after.total_gpu_times [ MANDELBROT_PHASE_ITERATE ] - stats_before.total_gpu_times [ MANDELBROT_PHASE_ITERATE ];
+        const double gpu_ms = ( timed_pixels > 0.0 ? gpu_time * 1.0e3 * width * height / timed_pixels : 0.0 );
+
+        /* find the mean, variance and minimum of the times */
+        double mean = 0.0, variance = 0.0, minimum = times [ 0 ];
+        for ( int run = 0; run < runs; ++run ) { mean += times [ run ] / runs; minimum = fmin ( minimum, times [ run ] ); }
+        for ( int run = 0; run < runs; ++run ) variance += ( times [ run ] - mean ) * ( times [ run ] - mean ) / runs;
+
+        /* write the results of the scene */
+        printf ( "    { \"scene\": \"%s\", \"power\": %d, \"max_it\": %d, \"ms_per_frame\": %.3f, \"ms_min\": %.3f, \"ms_variance\": %.4f, "
+                 "\"gpu_ms_per_frame\": %.3f, \"mpixel_per_s\": %.3f, \"miter_per_s\": %.3f, \"iterations\": %.0f, \"escaped\": %.0f, \"bound\": %.0f }%s\n",
+                 scene->name, scene->power, max_it, mean, minimum, variance, gpu_ms, ( double ) width * height * 1.0e-3 / mean, iterations * 1.0e-3 / mean, iterations,
+                 frame_stats.escaped, frame_stats.bound,
+                 ( i + 1 < scene_count * max_it_count ? "," : "" ) );
+        fflush ( stdout );
+    }
+
+    /* close the JSON */
+    if ( status == 0 ) printf ( "  ]\n}\n" );
+    else fprintf ( stderr, "MANDELBROT ERROR: failed to run benchmark\n" );
+
+    /* clean up */
+    free ( pixels );
+    free ( times );
+    if ( mb_set ) mb_destroy_set ( mb_set );
+    glh_destroy_headless_context ( context );
+
+    /* return the status */
+    return status;
+}
+
+/* mandelbrot_export
+ *
+ * render a view of the set of any size with a headless context, streaming it to a binary PPM, PNG, tiled TIFF or raw dump file tile by tile
+ * reports the throughput and peak memory usage of the export, as posters are rendered routinely
+ * if a previous run of the same export died, it is resumed from its checkpoint
+ * the reference orbit is iterated once, at the centre, and every tile perturbs around it, so views far deeper than a float can place are exported
+ *
+ * width/height: the size of the image in pixels
+ * path: the file to write the image to
+ * re/im_centre: the point at the centre of the image
+ * min_range: the minimum range visible on both axes
+ * max_it: the maximum number of iterations
+ *
+ * return: 0 for success, 1 for failure
+ */
+int mandelbrot_export ( const int width, const int height, const char * path, const long double re_centre, const long double im_centre, const float min_range, const float max_it )
+{
+    /* create headless context */
+    glh_headless_context_t * context = glh_create_headless_context ();
+    if ( !context ) return 1;
+
+    /* construct mandelbrot set for the view, at the size of the image, with its centre an offset of 0 from the reference */
+    mb_set_t mb_set = mb_create_set ( min_range, min_range, 0.0, 0.0, MBDEF_BREAKOUT, max_it );
+    int status = 1;
+    if ( mb_set && mb_set_reference ( mb_set, re_centre, im_centre, ( int ) max_it ) == 0 )
+    {
+        /* publish the view, which records the reference, and export it */
+        mb_set->width = width;
+        mb_set->height = height;
+        mb_publish_view ( mb_set );
+        mb_export_stats_t stats;
+        if ( mb_export ( mb_set, width, height, path, &stats ) == 0 )
+        {
+            /* report the statistics */
+            printf ( "exported %dx%d to %s in %.2fs: %.2f Mpixel/s, peak rss %ld KiB", width, height, path, stats.seconds, stats.mpixels_per_second, stats.peak_rss_kb );
+            if ( stats.pixels_resumed > 0.0 ) printf ( ", resumed with %.1f%% already exported", 100.0 * stats.pixels_resumed / stats.pixels );
+            printf ( "\n" );
+            status = 0;
+        }
+    }
+
+    /* clean up */
+    if ( mb_set ) mb_destroy_set ( mb_set );
+    glh_destroy_headless_context ( context );
+
+    /* return the status */
+    return status;
+}
+
+/* mandelbrot_video_write_oldest
+ *
+ * map the oldest frame in the set's readback ring, waiting for it if necessary, and queue it to be written to a video
+ *
+ * mb_set: the mandelbrot set being read back
+ * video: the video to write to
+ *
+ * return: 0 for success, 1 for failure
+ */
+int mandelbrot_video_write_oldest ( mb_set_t mb_set, mb_export_video_t * video )
+{
+    /* map the frame, queue it to be written, which copies it, then unmap it */
+    const unsigned char * pixels;
+    int frame_width, frame_height;
+    unsigned long tag;
+    if ( mb_map_readback ( mb_set, 1, &pixels, &frame_width, &frame_height, &tag ) != 0 ) return 1;
+    const int status = ( mb_export_write_video_frame ( video, pixels ) == 0 ? 0 : 1 );
+    if ( mb_unmap_readback ( mb_set ) != 0 ) return 1;
+
+    /* return the status */
+    return status;
+}
+
+/* mandelbrot_video
+ *
+ * render a zoom from one view of the set to another with a headless context, streaming the frames to stdout for an external encoder
+ * the zoom is exponential, as scrolling is, so the minimum range shrinks by the same factor each frame, and the maximum iterations grow
+ * as they do when scrolling, with the centre moving in proportion to the change in range so that the end view is zoomed towards
+ * rendering, reading back and writing are pipelined: frames are read back through the readback ring while later frames render,
+ * and are converted and written by a thread of their own, so throughput is bounded by the slowest stage rather than their sum
+ * the reference orbit is iterated once, at the centre of the deeper end of the zoom with the iterations of the deepest frame, and every
+ * frame perturbs around it, so only the pixels of each frame are iterated, and frames far deeper than a float can place are rendered
+ *
+ * width/height: the size of the frames in pixels
+ * frames: the number of frames
+ * re/im_start, range_start: the centre and minimum range of the first frame
+ * re/im_end, range_end: the centre and minimum range of the last frame
+ * format: the format to stream the frames in (MB_EXPORT_VIDEO_X)
+ *
+ * return: 0 for success, 1 for failure
+ */
+int mandelbrot_video ( const int width, const int height, const int frames, const long double re_start, const long double im_start, const double range_start,
+                       const long double re_end, const long double im_end, const double range_end, const int format )
+{
+    /* refuse to write the video to a terminal */
+    if ( isatty ( STDOUT_FILENO ) )
+    {
+        fprintf ( stderr, "MANDELBROT ERROR: refusing to write video to a terminal, pipe it into an encoder\n" );
+        return 1;
+    }
+
+    /* ignore broken pipes, so that an encoder exiting early fails the write rather than killing the process */
+    signal ( SIGPIPE, SIG_IGN );
+
+    /* create headless context */
+    glh_headless_context_t * context = glh_create_headless_context ();
+    if ( !context ) return 1;
+
+    /* construct mandelbrot set at the start of the zoom, at the size of the frames, and start the video */
+    mb_set_t mb_set = mb_create_set ( range_start, range_start, 0.0, 0.0, MBDEF_BREAKOUT, MBDEF_MAX_IT );
+    mb_export_video_t * video = ( mb_set ? mb_export_open_video ( STDOUT_FILENO, width, height, format ) : NULL );
+    int status = ( video ? 0 : 1 );
+    const double start_time = __mb_export_time ();
+    if ( video )
+    {
+        /* find how far the start and end are zoomed in from the default view, and the maximum iterations of the deepest frame */
+        const double track_start = mandelbrot_scroll_track ( range_start );
+        const double track_end = mandelbrot_scroll_track ( range_end );
+        mandelbrot_zoom_set ( mb_set, track_start );
+        const float max_it_start = mb_set->max_it;
+        mandelbrot_zoom_set ( mb_set, track_end );
+        const float max_it_end = mb_set->max_it;
+
+        /* iterate the reference orbit once, at the centre of the deeper end, which every frame is then an offset from */
+        const long double re_reference = ( range_end <= range_start ? re_end : re_start );
+        const long double im_reference = ( range_end <= range_start ? im_end : im_start );
+        if ( mb_set_reference ( mb_set, re_reference, im_reference, ( int ) fmax ( max_it_start, max_it_end ) ) != 0 ) status = 1;
+
+        /* render each frame */
+        mb_set->width = width;
+        mb_set->height = height;
+        for ( int frame = 0; frame < frames && status == 0; ++frame )
+        {
+            /* zoom to the frame, moving the centre by the fraction of the change in range made so far, as an offset from the reference */
+            const double progress = ( frames > 1 ? ( double ) frame / ( frames - 1 ) : 0.0 );
+            mandelbrot_zoom_set ( mb_set, track_start + ( track_end - track_start ) * progress );
+            const double fraction = ( range_start != range_end ? ( range_start - mb_set->re_min_range ) / ( range_start - range_end ) : progress );
+            mb_set->re_centre = re_start + ( re_end - re_start ) * fraction - re_reference;
+            mb_set->im_centre = im_start + ( im_end - im_start ) * fraction - im_reference;
+
+            /* publish and render the view */
+            mb_publish_view ( mb_set );
+            if ( mb_render_frame ( mb_set ) != 0 ) { status = 1; break; }
+
+            /* begin reading the frame back, first writing the oldest frame if the ring is full */
+            int queued;
+            while ( ( queued = mb_queue_readback ( mb_set, frame ) ) == 1 ) if ( mandelbrot_video_write_oldest ( mb_set, video ) != 0 ) break;
+            if ( queued != 0 ) status = 1;
+        }
+
+        /* write the frames left in the ring */
+        while ( status == 0 && mb_set->readback_pending > 0 ) status = mandelbrot_video_write_oldest ( mb_set, video );
+
+        /* wait for the frames to be written, and report the throughput on stderr, as stdout holds the video */
+        double write_seconds = 0.0;
+        if ( mb_export_close_video ( video, &write_seconds ) != 0 ) status = 1;
+        const double seconds = __mb_export_time () - start_time;
+        if ( status == 0 ) fprintf ( stderr, "streamed %d frames of %dx%d in %.2fs: %.2f frames/s, writing busy for %.2fs\n", frames, width, height, seconds, frames / seconds, write_seconds );
+    }
+    if ( status != 0 ) fprintf ( stderr, "MANDELBROT ERROR: failed to stream video\n" );
+
+    /* clean up */
+    if ( mb_set ) mb_destroy_set ( mb_set );
+    glh_destroy_headless_context ( context );
+
+    /* return the status */
+    return status;
+}
+
+/* mandelbrot_expmap_video
+ *
+ * render a zoom into a point of the set with a headless context from a log-polar strip, streaming the frames to stdout for an external encoder
+ * the strip holds the whole zoom and is rendered once, then each frame is resampled from it, apart from a small patch at its centre,
+ * which is rendered for every frame, so far fewer pixels are iterated than rendering every frame from scratch
+ * the zoom is exponential, as with mandelbrot_video, but every frame uses the maximum iterations of the last, so the strip and the patches match
+ * the reference orbit is iterated once, at the point, and the strip and every patch perturb around it
+ *
+ * width/height: the size of the frames in pixels
+ * frames: the number of frames
+ * re/im_centre: the point zoomed into
+ * range_start/end: the minimum range of the first and last frame
+ * format: the format to stream the frames in (MB_EXPORT_VIDEO_X)
+ *
+ * return: 0 for success, 1 for failure
+ */
+int mandelbrot_expmap_video ( const int width, const int height, const int frames, const long double re_centre, const long double im_centre,
+                              const double range_start, const double range_end, const int format )
+{
+    /* refuse to write the video to a terminal */
+    if ( isatty ( STDOUT_FILENO ) )
+    {
+        fprintf ( stderr, "MANDELBROT ERROR: refusing to write video to a terminal, pipe it into an encoder\n" );
+        return 1;
+    }
+
+    /* ignore broken pipes, so that an encoder exiting early fails the write rather than killing the process */
+    signal ( SIGPIPE, SIG_IGN );
+
+    /* create headless context */
+    glh_headless_context_t * context = glh_create_headless_context ();
+    if ( !context ) return 1;
+
+    /* construct mandelbrot set centred on the point, which is the reference, at the size of the frames, and allocate the patch and a frame to reconstruct into */
+    mb_set_t mb_set = mb_create_set ( range_start, range_start, 0.0, 0.0, MBDEF_BREAKOUT, MBDEF_MAX_IT );
+    unsigned char * patch = malloc ( ( size_t ) MB_EXPORT_EXPMAP_PATCH * MB_EXPORT_EXPMAP_PATCH * 4 );
+    unsigned char * pixels = malloc ( ( size_t ) width * height * 4 );
+    mb_export_expmap_t * expmap = NULL;
+    mb_export_video_t * video = NULL;
+    int status = ( mb_set && patch && pixels ? 0 : 1 );
+    const double start_time = __mb_export_time ();
+    if ( status == 0 )
+    {
+        /* find the stretch of the first and last frames, and the maximum iterations of the last, which every frame uses */
+        const double track_start = mandelbrot_scroll_track ( range_start );
+        const double track_end = mandelbrot_scroll_track ( range_end );
+        mb_view_t view;
+        mb_set->width = width;
+        mb_set->height = height;
+        mandelbrot_zoom_set ( mb_set, track_start );
+        mb_publish_view ( mb_set );
+        __mb_read_view ( mb_set, &view );
+        const double stretch_start = __mb_view_stretch ( &view );
+        mandelbrot_zoom_set ( mb_set, track_end );
+        mb_publish_view ( mb_set );
+        __mb_read_view ( mb_set, &view );
+        const double stretch_end = __mb_view_stretch ( &view );
+        const float max_it = mb_set->max_it;
+
+        /* iterate the reference orbit once, at the point, then render the strip and start the video */
+        if ( mb_set_reference ( mb_set, re_centre, im_centre, ( int ) max_it ) != 0 ) status = 1;
+        if ( status == 0 ) expmap = mb_export_render_expmap ( mb_set, width, height, MB_EXPORT_EXPMAP_PATCH, fmax ( stretch_start, stretch_end ), fmin ( stretch_start, stretch_end ) );
+        const double strip_seconds = __mb_export_time () - start_time;
+        if ( !expmap || !( video = mb_export_open_video ( STDOUT_FILENO, width, height, format ) ) ) status = 1;
+
+        /* reconstruct each frame */
+        for ( int frame = 0; frame < frames && status == 0; ++frame )
+        {
+            /* zoom to the frame, keeping the maximum iterations of the last */
+            const double progress = ( frames > 1 ? ( double ) frame / ( frames - 1 ) : 0.0 );
+            mandelbrot_zoom_set ( mb_set, track_start + ( track_end - track_start ) * progress );
+            mb_set->max_it = max_it;
+            mb_publish_view ( mb_set );
+            __mb_read_view ( mb_set, &view );
+
+            /* render and read back the patch, then resample the rest of the frame from the strip, and queue it to be written */
+            if ( mb_render_region ( mb_set, width, height, expmap->patch_x, expmap->patch_y, MB_EXPORT_EXPMAP_PATCH, MB_EXPORT_EXPMAP_PATCH ) != 0 ||
+                 mb_read_frame ( mb_set, patch ) != 0 || mb_export_expmap_frame ( expmap, __mb_view_stretch ( &view ), patch, pixels ) != 0 ||
+                 mb_export_write_video_frame ( video, pixels ) != 0 ) status = 1;
+        }
+
+        /* wait for the frames to be written, and report the throughput and the pixels iterated against rendering every frame on stderr */
+        if ( video && mb_export_close_video ( video, NULL ) != 0 ) status = 1;
+        const double seconds = __mb_export_time () - start_time;
+        if ( status == 0 )
+        {
+            const double iterated = ( double ) expmap->width * expmap->height + ( double ) frames * MB_EXPORT_EXPMAP_PATCH * MB_EXPORT_EXPMAP_PATCH;
+            fprintf ( stderr, "streamed %d frames of %dx%d in %.2fs: %.2f frames/s, %dx%d strip in %.2fs, %.1f Mpixel iterated instead of %.1f\n",
+                      frames, width, height, seconds, frames / seconds, expmap->width, expmap->height, strip_seconds, iterated * 1.0e-6, ( double ) frames * width * height * 1.0e-6 );
+        }
+    }
+    if ( status != 0 ) fprintf ( stderr, "MANDELBROT ERROR: failed to stream video\n" );
+
+    /* clean up */
+    if ( expmap ) mb_export_destroy_expmap ( expmap );
+    free ( patch );
+    free ( pixels );
+    if ( mb_set ) mb_destroy_set ( mb_set );
+    glh_destroy_headless_context ( context );
+
+    /* return the status */
+    return status;
+}
+
 
 
 /* MAIN */
 
-int main ()
+int main ( int argc, char ** argv )
 {
+    /* if asked, trace whichever mode follows, dumping the trace on exit, then carry on as if the option was not given */
+    if ( argc > 1 && strcmp ( argv [ 1 ], "--trace" ) == 0 )
+    {
+        if ( argc < 3 || mb_trace_enable ( argv [ 2 ] ) != 0 )
+        {
+            fprintf ( stderr, "usage: %s --trace <trace.json> [mode...]\n", argv [ 0 ] );
+            return 1;
+        }
+        mb_trace_name_thread ( "main" );
+        argv [ 2 ] = argv [ 0 ];
+        argv += 2;
+        argc -= 2;
+    }
+
+    /* if asked, render headless instead of opening a window */
+    if ( argc > 1 && strcmp ( argv [ 1 ], "--headless" ) == 0 )
+    {
+        if ( argc != 5 || atoi ( argv [ 2 ] ) <= 0 || atoi ( argv [ 3 ] ) <= 0 )
+        {
+            fprintf ( stderr, "usage: %s --headless <width> <height> <output.ppm|png|tif>\n", argv [ 0 ] );
+            return 1;
+        }
+        return mandelbrot_headless ( atoi ( argv [ 2 ] ), atoi ( argv [ 3 ] ), argv [ 4 ] );
+    }
+
+    /* if asked, benchmark the png encoder */
+    if ( argc > 1 && strcmp ( argv [ 1 ], "--png-bench" ) == 0 )
+    {
+        if ( argc != 5 || atoi ( argv [ 2 ] ) <= 0 || atoi ( argv [ 3 ] ) <= 0 )
+        {
+            fprintf ( stderr, "usage: %s --png-bench <width> <height> <output.png>\n", argv [ 0 ] );
+            return 1;
+        }
+        return mandelbrot_png_bench ( atoi ( argv [ 2 ] ), atoi ( argv [ 3 ] ), argv [ 4 ] );
+    }
+
+    /* if asked, run the benchmark */
+    if ( argc > 1 && strcmp ( argv [ 1 ], "--bench" ) == 0 )
+    {
+        if ( ( argc != 2 && argc != 5 ) || ( argc == 5 && ( atoi ( argv [ 2 ] ) <= 0 || atoi ( argv [ 3 ] ) <= 0 || atoi ( argv [ 4 ] ) <= 0 ) ) )
+        {
+            fprintf ( stderr, "usage: %s --bench [<width> <height> <runs>]\n", argv [ 0 ] );
+            return 1;
+        }
+        if ( argc == 2 ) return mandelbrot_bench ( MANDELBROT_BENCH_WIDTH, MANDELBROT_BENCH_HEIGHT, MANDELBROT_BENCH_RUNS );
+        return mandelbrot_bench ( atoi ( argv [ 2 ] ), atoi ( argv [ 3 ] ), atoi ( argv [ 4 ] ) );
+    }
+
+    /* if asked, export a view of any size */
+    if ( argc > 1 && strcmp ( argv [ 1 ], "--export" ) == 0 )
+    {
+        if ( ( argc != 5 && argc != 9 ) || atoi ( argv [ 2 ] ) <= 0 || atoi ( argv [ 3 ] ) <= 0 )
+        {
+            fprintf ( stderr, "usage: %s --export <width> <height> <output.ppm|png|tif|mbraw> [<re_centre> <im_centre> <min_range> <max_it>]\n", argv [ 0 ] );
+            return 1;
+        }
+        if ( argc == 5 ) return mandelbrot_export ( atoi ( argv [ 2 ] ), atoi ( argv [ 3 ] ), argv [ 4 ], MBDEF_RE_CENTRE, MBDEF_IM_CENTRE, MBDEF_RE_MIN_RANGE, MBDEF_MAX_IT );
+        return mandelbrot_export ( atoi ( argv [ 2 ] ), atoi ( argv [ 3 ] ), argv [ 4 ], strtold ( argv [ 5 ], NULL ), strtold ( argv [ 6 ], NULL ), atof ( argv [ 7 ] ), atof ( argv [ 8 ] ) );
+    }
+
+    /* if asked, stream a zoom video to stdout */
+    if ( argc > 1 && strcmp ( argv [ 1 ], "--video" ) == 0 )
+    {
+        const int format = ( argc == 12 && strcmp ( argv [ 11 ], "rgb" ) == 0 ? MB_EXPORT_VIDEO_RGB : MB_EXPORT_VIDEO_Y4M );
+        if ( ( argc != 11 && argc != 12 ) || ( argc == 12 && strcmp ( argv [ 11 ], "y4m" ) != 0 && strcmp ( argv [ 11 ], "rgb" ) != 0 ) ||
+             atoi ( argv [ 2 ] ) <= 0 || atoi ( argv [ 3 ] ) <= 0 || atoi ( argv [ 4 ] ) <= 0 || atof ( argv [ 7 ] ) <= 0.0 || atof ( argv [ 10 ] ) <= 0.0 )
+        {
+            fprintf ( stderr, "usage: %s --video <width> <height> <frames> <re_start> <im_start> <range_start> <re_end> <im_end> <range_end> [y4m|rgb]\n", argv [ 0 ] );
+            return 1;
+        }
+        return mandelbrot_video ( atoi ( argv [ 2 ] ), atoi ( argv [ 3 ] ), atoi ( argv [ 4 ] ), strtold ( argv [ 5 ], NULL ), strtold ( argv [ 6 ], NULL ), atof ( argv [ 7 ] ),
+                                  strtold ( argv [ 8 ], NULL ), strtold ( argv [ 9 ], NULL ), atof ( argv [ 10 ] ), format );
+    }
+
+    /* if asked, stream a zoom video resampled from a log-polar strip to stdout */
+    if ( argc > 1 && strcmp ( argv [ 1 ], "--expmap-video" ) == 0 )
+    {
+        const int format = ( argc == 10 && strcmp ( argv [ 9 ], "rgb" ) == 0 ? MB_EXPORT_VIDEO_RGB : MB_EXPORT_VIDEO_Y4M );
+        if ( ( argc != 9 && argc != 10 ) || ( argc == 10 && strcmp ( argv [ 9 ], "y4m" ) != 0 && strcmp ( argv [ 9 ], "rgb" ) != 0 ) ||
+             atoi ( argv [ 2 ] ) < MB_EXPORT_EXPMAP_PATCH || atoi ( argv [ 3 ] ) < MB_EXPORT_EXPMAP_PATCH || atoi ( argv [ 4 ] ) <= 0 || atof ( argv [ 7 ] ) <= 0.0 || atof ( argv [ 8 ] ) <= 0.0 )
+        {
+            fprintf ( stderr, "usage: %s --expmap-video <width> <height> <frames> <re_centre> <im_centre> <range_start> <range_end> [y4m|rgb]\n", argv [ 0 ] );
+            return 1;
+        }
+        return mandelbrot_expmap_video ( atoi ( argv [ 2 ] ), atoi ( argv [ 3 ] ), atoi ( argv [ 4 ] ), strtold ( argv [ 5 ], NULL ), strtold ( argv [ 6 ], NULL ), atof ( argv [ 7 ] ), atof ( argv [ 8 ] ), format );
+    }
+
+    /* if asked, replay an input log */
+    if ( argc > 1 && strcmp ( argv [ 1 ], "--replay" ) == 0 )
+    {
+        if ( ( argc != 3 && argc != 4 ) || ( argc == 4 && strcmp ( argv [ 3 ], "max" ) != 0 ) )
+        {
+            fprintf ( stderr, "usage: %s --replay <log> [max]\n", argv [ 0 ] );
+            return 1;
+        }
+        return mandelbrot_replay ( argv [ 2 ], argc == 4 );
+    }
+
+    /* if asked, record the input given to the window to an input log */
+    const char * record_path = NULL;
+    if ( argc > 1 && strcmp ( argv [ 1 ], "--record" ) == 0 )
+    {
+        if ( argc != 3 )
+        {
+            fprintf ( stderr, "usage: %s --record <log>\n", argv [ 0 ] );
+            return 1;
+        }
+        record_path = argv [ 2 ];
+    }
+
     /* init glfw and create window */
     glh_init_glfw ();
     glh_window_t window = glh_create_window ( "Test Window", 800, 600 );
 
-    /* set key callback */
-    glh_set_key_callback ( window, mandelbrot_key_callback );
+    /* create the window's view, which the callbacks find through the window's user pointer */
+    mandelbrot_window_t mb_window = { 0 };
+    glh_set_window_user_pointer ( window, &mb_window );
+
+    /* set key callback, recording it first if recording */
+    glh_set_key_callback ( window, ( record_path ? mandelbrot_record_key_callback : mandelbrot_key_callback ) );
 
     /* set drag and scroll callbacks */
     glh_cursor_t drag_cursor = glh_create_standard_cursor ( GLFW_HAND_CURSOR );
-    glh_set_mouse_drag_calback ( window, drag_cursor, mandelbrot_drag_callback );
-    glh_set_scroll_callback ( window, mandelbrot_scroll_callback );
+    glh_set_mouse_drag_calback ( window, drag_cursor, ( record_path ? mandelbrot_record_drag_callback : mandelbrot_drag_callback ) );
+    glh_set_scroll_callback ( window, ( record_path ? mandelbrot_record_scroll_callback : mandelbrot_scroll_callback ) );
+
+    /* set refresh callback */
+    glh_set_window_refresh_callback ( window, ( record_path ? mandelbrot_record_refresh_callback : mandelbrot_refresh_callback ) );
+
+    /* set the swap interval, so that frames are paced by the display refresh */
+    glh_set_swap_interval ( window, MANDELBROT_SWAP_INTERVAL );
 
     /* construct mandelbrot set from defaults */
     mb_set_t mb_set = mb_create_set ( MBDEF_RE_MIN_RANGE, MBDEF_IM_MIN_RANGE,
                                       MBDEF_RE_CENTRE,    MBDEF_IM_CENTRE,
                                       MBDEF_BREAKOUT,     MBDEF_MAX_IT );
 
-    /* set the global variable to the pointer to the set */
-    mb_set_ptr = ( size_t ) mb_set;
+    /* show the set in the window */
+    mb_window.mb_set = mb_set;
 
     /* if successfully created set */                                
     if ( mb_set )
     {
-        /* while window should not close, draw set */
-        while ( !glh_should_window_close ( window ) ) 
+        /* set the size of the set to the size of the framebuffer, publish the initial view, and keep the size updated
+         * this replaces the default viewport size callback, as the viewport is set by the render thread
+         */
+        glh_get_framebuffer_size ( window, &mb_set->width, &mb_set->height );
+        mb_publish_view ( mb_set );
+        glh_set_viewport_size_callback ( window, ( record_path ? mandelbrot_record_viewport_size_callback : mandelbrot_viewport_size_callback ) );
+
+        /* if recording, start the input log at the size of the framebuffer */
+        if ( record_path ) mb_window.record_log = mb_input_open_record ( record_path, mb_set->width, mb_set->height );
+
+        /* start the render thread, which takes ownership of the window's context, unless the input log could not be started */
+        if ( ( !record_path || mb_window.record_log ) && mb_start_render_thread ( mb_set, window ) == 0 )
         {
-            /* draw set */
-            mb_draw ( mb_set, window );
-        
-            /* wait infinitely for events */
-            glh_wait_events ( 0.0f );
+            /* while window should not close, handle events */
+            while ( !glh_should_window_close ( window ) ) 
+            {
+                /* wait infinitely for events, then drain any which arrived while waiting */
+                MB_TRACE_BEGIN ( "wait events" );
+                glh_wait_events ( 0.0f );
+                glh_poll_events ();
+                MB_TRACE_END ( "wait events" );
+
+                /* apply all of the input accumulated since the last view was published, publishing a new view
+                 * this never blocks on rendering, and the render thread always picks up the newest view
+                 */
+                if ( record_path ) mandelbrot_record_apply_input ( window );
+                else mandelbrot_apply_input ( window );
+            }
+
+            /* stop the render thread, taking back the window's context */
+            mb_stop_render_thread ( mb_set );
         }
 
+        /* if recording, finish the input log */
+        if ( mb_window.record_log && mb_input_close ( mb_window.record_log ) == 0 ) printf ( "recorded input to %s\n", record_path );
+
         /* destroy set */
         mb_destroy_set ( mb_set );
     }
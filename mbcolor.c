@@ -0,0 +1,131 @@
+/*
+ * mbcolor.c
+ *
+ * contains the main () entry point for the mbcolor binary
+ *
+ * recolours a raw dump written by mandelbrot --export, writing it as an image without iterating again
+ *
+ * mbcolor [--palette grey|fire|ocean|heat] [--smooth] [--equalise] <input.mbraw> <output.ppm|png|tif>
+ * --palette chooses the colours outside of the set, --smooth colours by smooth iteration counts rather than whole iterations,
+ * and --equalise spreads the palette evenly over the pixels rather than the iterations
+ * --palette heat instead shows what each pixel cost to iterate, to find where max_it is spent, with a legend added below the image,
+ * and ignores --smooth and --equalise
+ *
+ */
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+
+/* include mb_export_writer */
+#include <mb_export/mb_export_writer.h>
+
+/* include mb_color */
+#include <mb_color/mb_color.h>
+
+
+
+/* RECOLOURING */
+
+/* mbcolor_recolor
+ *
+ * recolour a raw dump, streaming it through a run of rows of tiles at a time, and write it to a binary PPM, PNG or tiled TIFF file
+ * reports the throughput of each pass, so recolouring can be compared with rendering
+ *
+ * input: the raw dump
+ * output: the file to write the image to
+ * palette: the palette to colour with (MB_COLOR_PALETTE_X)
+ * smooth: 1 to colour by smooth iteration counts
+ * equalise: 1 to equalise the palette over the pixels
+ *
+ * return: 0 for success, 1 for failure
+ */
+int mbcolor_recolor ( const char * input, const char * output, const int palette, const int smooth, const int equalise )
+{
+    /* open the dump and create the colouring */
+    mb_color_dump_t * dump = mb_color_open_dump ( input );
+    if ( !dump ) return 1;
+    mb_color_t * color = mb_color_create ( dump, palette, smooth, MB_COLOR_THREADS );
+    if ( !color )
+    {
+        mb_color_close_dump ( dump );
+        return 1;
+    }
+    const int width = dump->header.width;
+    const int height = color->height;
+    const double pixels = ( double ) width * height;
+
+    /* if showing the heat view, report the scale of its legend, which is added below the image */
+    if ( color->heat ) printf ( "heat: legend in the bottom %d rows, ticks at each %d iterations, white reached max_it %d, magenta hatching glitched\n", MB_COLOR_LEGEND_HEIGHT, color->max_it / 4, color->max_it );
+
+    /* if equalising, count the iterations of the whole dump first */
+    int status = 0;
+    double start_time = __mb_export_time ();
+    if ( equalise && !color->heat )
+    {
+        if ( mb_color_equalise ( color, dump ) == 0 ) printf ( "counted %dx%d in %.2fs: %.2f Mpixel/s\n", width, height, __mb_export_time () - start_time, pixels * 1.0e-6 / ( __mb_export_time () - start_time ) );
+        else status = 1;
+    }
+
+    /* open the image, and allocate the rows of a tile of it, which are coloured then written at once */
+    start_time = __mb_export_time ();
+    mb_export_writer_t * writer = ( status == 0 ? mb_export_open_writer ( output, width, height, &dump->header.view, 0 ) : NULL );
+    unsigned char * rows = malloc ( ( size_t ) width * MB_EXPORT_TILE_SIZE * 3 );
+    if ( !writer || !rows ) status = 1;
+
+    /* colour and write the rows a tile at a time */
+    for ( int top = 0; top < height && status == 0; top += MB_EXPORT_TILE_SIZE )
+    {
+        const int count = ( height - top < MB_EXPORT_TILE_SIZE ? height - top : MB_EXPORT_TILE_SIZE );
+        if ( mb_color_rows ( color, dump, top, count, rows ) != 0 || mb_export_write_rows ( writer, rows, top, count ) != 0 ) status = 1;
+    }
+
+    /* close the image, and report the throughput */
+    if ( writer && mb_export_close_writer ( writer ) != 0 ) status = 1;
+    if ( status == 0 ) printf ( "coloured %dx%d to %s in %.2fs: %.2f Mpixel/s\n", width, height, output, __mb_export_time () - start_time, pixels * 1.0e-6 / ( __mb_export_time () - start_time ) );
+    else fprintf ( stderr, "MBCOLOR ERROR: failed to recolour %s to %s\n", input, output );
+
+    /* clean up and return the status */
+    free ( rows );
+    mb_color_destroy ( color );
+    mb_color_close_dump ( dump );
+    return status;
+}
+
+
+
+/* MAIN */
+
+int main ( int argc, char ** argv )
+{
+    /* read the options, which come before the files */
+    int palette = MB_COLOR_PALETTE_GREY, smooth = 0, equalise = 0, arg = 1;
+    for ( ; arg < argc && strncmp ( argv [ arg ], "--", 2 ) == 0; ++arg )
+    {
+        if ( strcmp ( argv [ arg ], "--smooth" ) == 0 ) smooth = 1; else
+        if ( strcmp ( argv [ arg ], "--equalise" ) == 0 ) equalise = 1; else
+        if ( strcmp ( argv [ arg ], "--palette" ) == 0 && arg + 1 < argc )
+        {
+            ++arg;
+            if ( strcmp ( argv [ arg ], "grey" ) == 0 ) palette = MB_COLOR_PALETTE_GREY; else
+            if ( strcmp ( argv [ arg ], "fire" ) == 0 ) palette = MB_COLOR_PALETTE_FIRE; else
+            if ( strcmp ( argv [ arg ], "ocean" ) == 0 ) palette = MB_COLOR_PALETTE_OCEAN; else
+            if ( strcmp ( argv [ arg ], "heat" ) == 0 ) palette = MB_COLOR_PALETTE_HEAT; else
+            break;
+        } else break;
+    }
+
+    /* check the files follow the options */
+    if ( argc - arg != 2 )
+    {
+        fprintf ( stderr, "usage: %s [--palette grey|fire|ocean|heat] [--smooth] [--equalise] <input.mbraw> <output.ppm|png|tif>\n", argv [ 0 ] );
+        return 1;
+    }
+
+    /* recolour the dump */
+    return mbcolor_recolor ( argv [ arg ], argv [ arg + 1 ], palette, smooth, equalise );
+}
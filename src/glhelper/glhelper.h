@@ -13,15 +13,30 @@
 /* include glhelper_glad.h /*
 #include "glhelper_glad.h"
 
+/* include glhelper_state.h */
+#include "glhelper_state.h"
+
 /* include glhelper_glfw.h */
 #include "glhelper_glfw.h"
 
+/* include glhelper_egl.h */
+#include "glhelper_egl.h"
+
 /* include glhelper_glsl.h */
 #include "glhelper_glsl.h"
 
 /* include glhelper_buff.h */
 #include "glhelper_buff.h"
 
+/* include glhelper_fbo.h */
+#include "glhelper_fbo.h"
+
+/* include glhelper_query.h */
+#include "glhelper_query.h"
+
+/* include glhelper_sync.h */
+#include "glhelper_sync.h"
+
 /* include glhelper_draw.h */
 #include "glhelper_draw.h"
 
@@ -47,7 +47,8 @@ int glh_delete_vertex_array_object( const glh_object_t vao )
     /* check glad is initialised */
     __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before deleting a vertex array object\n" );
 
-    /* delete the array object */
+    /* forget then delete the array object */
+    __glh_state_forget_object ( vao, GLH_STATE_OBJECT_VERTEX_ARRAY );
     glDeleteVertexArrays ( 1, &vao );
 
     /* return 0 for success */
@@ -74,13 +75,10 @@ glh_object_t glh_create_vertex_buffer_object ( const void * vertices, const size
     glGenBuffers ( 1, &vbo );
     
     /* bind the object to GL_ARRAY_BUFFER */
-    glBindBuffer ( GL_ARRAY_BUFFER, vbo );
+    __glh_state_bind_buffer ( GL_ARRAY_BUFFER, vbo );
     
     /* send the data to the buffer */
     glBufferData ( GL_ARRAY_BUFFER, v_size, vertices, buff_type );
-
-    /* unbind vbo */
-    glBindBuffer ( GL_ARRAY_BUFFER, 0 );
     
     /* return the buffer */
     return vbo;
@@ -99,17 +97,44 @@ int glh_delete_vertex_buffer_object ( const glh_object_t vbo )
     /* check glad is initialised */
     __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before deleting a vertex buffer object\n" );
     
-    /* delete the buffer */
+    /* forget then delete the buffer */
+    __glh_state_forget_object ( vbo, GLH_STATE_OBJECT_BUFFER );
     glDeleteBuffers ( 1, &vbo );
 
     /* return 0 for success */
     return 0;
 }
 
+/* glh_update_vertex_buffer_object
+ *
+ * replaces part of the data in a vertex buffer object
+ * 
+ * vbo: the vertex buffer object to update
+ * offset: the offset (in bytes) of the data to replace
+ * data: the new data
+ * d_size: size of the new data (in bytes)
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_update_vertex_buffer_object ( const glh_object_t vbo, const size_t offset, const void * data, const size_t d_size )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before updating a vertex buffer object\n" );
+
+    /* bind the vbo */
+    __glh_state_bind_buffer ( GL_ARRAY_BUFFER, vbo );
+
+    /* replace the data */
+    glBufferSubData ( GL_ARRAY_BUFFER, offset, d_size, data );
+
+    /* return 0 for success */
+    return 0;
+}
+
 /* glh_create_element_buffer_object
  * 
  * creates an element buffer object containing the given data
- * the new buffer will be bound to GL_ELEMENT_ARRAY_BUFFER on return
+ * the data is sent through GL_COPY_WRITE_BUFFER, so that the buffer is not bound to whichever vao is bound
  * 
  * elements: array of elements
  * e_size: size of array (in bytes)
@@ -126,14 +151,11 @@ glh_object_t glh_create_element_buffer_object ( const void * elements, const siz
     glh_object_t ebo;
     glGenBuffers ( 1, &ebo );
 
-    /* bind the object to GL_ELEMENT_ARRAY_BUFFER */
-    glBindBuffer ( GL_ELEMENT_ARRAY_BUFFER, ebo );
+    /* bind the object to GL_COPY_WRITE_BUFFER */
+    __glh_state_bind_buffer ( GL_COPY_WRITE_BUFFER, ebo );
 
     /* send the data to the buffer */
-    glBufferData ( GL_ELEMENT_ARRAY_BUFFER, e_size, elements, buff_type );
-
-    /* unbind ebo */
-    glBindBuffer ( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    glBufferData ( GL_COPY_WRITE_BUFFER, e_size, elements, buff_type );
 
     /* return the buffer */
     return ebo;
@@ -152,7 +174,8 @@ int glh_delete_element_buffer_object ( const glh_object_t ebo )
     /* check glad is initialised */
     __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before deleting an element buffer object\n" );
     
-    /* delete the buffer */
+    /* forget then delete the buffer */
+    __glh_state_forget_object ( ebo, GLH_STATE_OBJECT_BUFFER );
     glDeleteBuffers ( 1, &ebo );
 
     /* return 0 for success */
@@ -160,6 +183,218 @@ int glh_delete_element_buffer_object ( const glh_object_t ebo )
 }
 
 
+/* glh_create_uniform_buffer_object
+ *
+ * creates a uniform buffer object containing the given data
+ * 
+ * data: array of data laid out to match the uniform block (usually std140), or NULL to leave uninitialised
+ * d_size: size of array (in bytes)
+ * buff_type: the buffer type from GLH_BUFF_STREAM/STATIC/DYNAMIC_DRAW
+ *
+ * return: buffer ID >= 0 for success, -1 for failure
+ */
+glh_object_t glh_create_uniform_buffer_object ( const void * data, const size_t d_size, const glh_type_t buff_type )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before creating a uniform buffer object\n" );
+
+    /* create object */
+    glh_object_t ubo;
+    glGenBuffers ( 1, &ubo );
+
+    /* bind the object to GL_UNIFORM_BUFFER */
+    __glh_state_bind_buffer ( GL_UNIFORM_BUFFER, ubo );
+
+    /* send the data to the buffer */
+    glBufferData ( GL_UNIFORM_BUFFER, d_size, data, buff_type );
+
+    /* return the buffer */
+    return ubo;
+}
+
+/* glh_delete_uniform_buffer_object
+ *
+ * deletes a uniform buffer object
+ * 
+ * ubo: uniform buffer object to delete
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_delete_uniform_buffer_object ( const glh_object_t ubo )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before deleting a uniform buffer object\n" );
+    
+    /* forget then delete the buffer */
+    __glh_state_forget_object ( ubo, GLH_STATE_OBJECT_BUFFER );
+    glDeleteBuffers ( 1, &ubo );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_update_uniform_buffer_object
+ *
+ * replaces part of the data in a uniform buffer object
+ * 
+ * ubo: the uniform buffer object to update
+ * offset: the offset (in bytes) of the data to replace
+ * data: the new data
+ * d_size: size of the new data (in bytes)
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_update_uniform_buffer_object ( const glh_object_t ubo, const size_t offset, const void * data, const size_t d_size )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before updating a uniform buffer object\n" );
+
+    /* bind the ubo */
+    __glh_state_bind_buffer ( GL_UNIFORM_BUFFER, ubo );
+
+    /* replace the data */
+    glBufferSubData ( GL_UNIFORM_BUFFER, offset, d_size, data );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_bind_uniform_buffer_object
+ *
+ * bind a uniform buffer object to a uniform block binding point
+ * any uniform block assigned to the binding point in any shader program will read from the buffer
+ * 
+ * ubo: the uniform buffer object to bind
+ * binding: the binding point
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_bind_uniform_buffer_object ( const glh_object_t ubo, const int binding )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before binding a uniform buffer object\n" );
+
+    /* bind the ubo to the binding point */
+    __glh_state_bind_uniform_buffer_base ( binding, ubo );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_create_pixel_pack_buffer_object
+ *
+ * creates a pixel pack buffer object, which pixels can be read into without waiting for rendering to finish
+ * 
+ * d_size: size of the buffer (in bytes)
+ *
+ * return: buffer ID >= 0 for success, -1 for failure
+ */
+glh_object_t glh_create_pixel_pack_buffer_object ( const size_t d_size )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before creating a pixel pack buffer object\n" );
+
+    /* create object */
+    glh_object_t pbo;
+    glGenBuffers ( 1, &pbo );
+
+    /* bind the object to GL_PIXEL_PACK_BUFFER */
+    __glh_state_bind_buffer ( GL_PIXEL_PACK_BUFFER, pbo );
+
+    /* allocate the buffer */
+    glBufferData ( GL_PIXEL_PACK_BUFFER, d_size, NULL, GLH_BUFF_STREAM_READ );
+
+    /* return the buffer */
+    return pbo;
+}
+
+/* glh_delete_pixel_pack_buffer_object
+ *
+ * deletes a pixel pack buffer object
+ * 
+ * pbo: pixel pack buffer object to delete
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_delete_pixel_pack_buffer_object ( const glh_object_t pbo )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before deleting a pixel pack buffer object\n" );
+    
+    /* forget then delete the buffer */
+    __glh_state_forget_object ( pbo, GLH_STATE_OBJECT_BUFFER );
+    glDeleteBuffers ( 1, &pbo );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_resize_pixel_pack_buffer_object
+ *
+ * reallocates a pixel pack buffer object at a new size, discarding its contents
+ * 
+ * pbo: pixel pack buffer object to resize
+ * d_size: new size of the buffer (in bytes)
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_resize_pixel_pack_buffer_object ( const glh_object_t pbo, const size_t d_size )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before resizing a pixel pack buffer object\n" );
+
+    /* bind the pbo and reallocate it */
+    __glh_state_bind_buffer ( GL_PIXEL_PACK_BUFFER, pbo );
+    glBufferData ( GL_PIXEL_PACK_BUFFER, d_size, NULL, GLH_BUFF_STREAM_READ );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_map_pixel_pack_buffer_object
+ *
+ * map the contents of a pixel pack buffer object into memory for reading
+ * stalls until any reads into the buffer have completed, so wait on a fence first to avoid stalling
+ * 
+ * pbo: pixel pack buffer object to map
+ * d_size: size of the data to map (in bytes), from the start of the buffer
+ * 
+ * return: pointer to the contents for success, NULL for failure
+ */
+const void * glh_map_pixel_pack_buffer_object ( const glh_object_t pbo, const size_t d_size )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, NULL, "GLH ERROR: glad must be initialised before mapping a pixel pack buffer object\n" );
+
+    /* bind the pbo and map it for reading */
+    __glh_state_bind_buffer ( GL_PIXEL_PACK_BUFFER, pbo );
+    const void * data = glMapBufferRange ( GL_PIXEL_PACK_BUFFER, 0, d_size, GL_MAP_READ_BIT );
+
+    /* check success */
+    if ( !data ) fprintf ( stderr, "GLH ERROR: failed to map pixel pack buffer object\n" );
+
+    /* return the contents */
+    return data;
+}
+
+/* glh_unmap_pixel_pack_buffer_object
+ *
+ * unmap a pixel pack buffer object mapped by glh_map_pixel_pack_buffer_object
+ * 
+ * pbo: pixel pack buffer object to unmap
+ * 
+ * return: 0 for success, -1 for failure (including the contents having been lost while mapped)
+ */
+int glh_unmap_pixel_pack_buffer_object ( const glh_object_t pbo )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before unmapping a pixel pack buffer object\n" );
+
+    /* bind the pbo and unmap it */
+    __glh_state_bind_buffer ( GL_PIXEL_PACK_BUFFER, pbo );
+    return ( glUnmapBuffer ( GL_PIXEL_PACK_BUFFER ) == GL_TRUE ? 0 : -1 );
+}
+
 /* glh_bind_vertex_buffer_object
  *
  * how to handle attributes of vertex data
@@ -188,16 +423,12 @@ int glh_bind_vertex_buffer_object ( const glh_object_t vao,
     __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before configuring a vertex attribute\n" );
 
     /* bind the vao and vbo */
-    glBindVertexArray ( vao );
-    glBindBuffer ( GL_ARRAY_BUFFER, vbo );
+    __glh_state_bind_vertex_array ( vao );
+    __glh_state_bind_buffer ( GL_ARRAY_BUFFER, vbo );
 
     /* configure attribute pointer */
     glVertexAttribPointer ( index, size, type, GL_FALSE, stride, offset );
 
-    /* unbind vao and vbo */
-    glBindVertexArray ( 0 );
-    glBindBuffer ( GL_ARRAY_BUFFER, 0 );
-
     /* return 0 for success */
     return 0;
 }
@@ -217,12 +448,8 @@ int glh_bind_element_buffer_object ( const glh_object_t vao, const glh_object_t
     __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before bind an ebo to a vao\n" );
 
     /* bind the vao then the ebo */
-    glBindVertexArray ( vao );
-    glBindBuffer ( GL_ELEMENT_ARRAY_BUFFER, ebo );
-
-    /* unbind the vao then the ebo */
-    glBindVertexArray ( 0 );
-    glBindBuffer ( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    __glh_state_bind_vertex_array ( vao );
+    __glh_state_bind_buffer ( GL_ELEMENT_ARRAY_BUFFER, ebo );
 
     /* return 0 for success */
     return 0;
@@ -243,14 +470,11 @@ int glh_enable_vertex_attribute ( const glh_object_t vao, const int index )
     __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before enabling a vertex attribute\n" );
 
     /* bind the vao */
-    glBindVertexArray ( vao );
+    __glh_state_bind_vertex_array ( vao );
 
     /* enable the attribute */
     glEnableVertexAttribArray ( index );
 
-    /* unbind vao */
-    glBindVertexArray ( 0 );
-
     /* return 0 for success */
     return 0;
 }
@@ -270,13 +494,35 @@ int glh_disable_vertex_attribute ( const glh_object_t vao, const int index )
     __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before disabling a vertex attribute\n" );
 
     /* bind the vao */
-    glBindVertexArray ( vao );
+    __glh_state_bind_vertex_array ( vao );
 
     /* disable the attribute */
     glDisableVertexAttribArray ( index );
 
-    /* unbind vao */
-    glBindVertexArray ( 0 );
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_set_vertex_attribute_divisor
+ *
+ * sets how often a vertex attribute advances when drawing instances
+ * 
+ * vao: vertex array object to configure
+ * index: the index of the attribute
+ * divisor: 0 to advance every vertex, or n to advance every n instances
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_set_vertex_attribute_divisor ( const glh_object_t vao, const int index, const int divisor )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before setting a vertex attribute divisor\n" );
+
+    /* bind the vao */
+    __glh_state_bind_vertex_array ( vao );
+
+    /* set the divisor */
+    glVertexAttribDivisor ( index, divisor );
 
     /* return 0 for success */
     return 0;
@@ -300,6 +546,37 @@ glh_object_t glh_get_uniform_location ( const glh_object_t shader_program, const
     return glGetUniformLocation ( shader_program, uniform_name );
 }
 
+/* glh_set_uniform_block_binding
+ *
+ * assigns a uniform block within a shader program to a binding point
+ * 
+ * shader_program: the shader program containing the uniform block
+ * block_name: the name of the uniform block (string)
+ * binding: the binding point to read the block from (see glh_bind_uniform_buffer_object)
+ * 
+ * return: 0 for success, -1 for failure (including uniform block not found)
+ */
+int glh_set_uniform_block_binding ( const glh_object_t shader_program, const char * block_name, const int binding )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before setting a uniform block's binding\n" );
+
+    /* get the index of the block */
+    const GLuint block_index = glGetUniformBlockIndex ( shader_program, block_name );
+    if ( block_index == GL_INVALID_INDEX )
+    {
+        /* block not found, so produce error */
+        fprintf ( stderr, "GLH ERROR: uniform block '%s' not found\n", block_name );
+        return -1;
+    }
+
+    /* assign the block to the binding point */
+    glUniformBlockBinding ( shader_program, block_index, binding );
+
+    /* return 0 for success */
+    return 0;
+}
+
 /* glh_set_uniform_vec1,2,3,4
  *
  * assigns a vector uniform to values
@@ -27,6 +27,9 @@
 /* include glhelper_glad.h */
 #include "glhelper_glad.h"
 
+/* include glhelper_state.h */
+#include "glhelper_state.h"
+
 
 
 /* GLOBAL FLAGS AND MACROS */
@@ -43,6 +46,14 @@
 #define GLH_BUFF_STATIC_DRAW GL_STATIC_DRAW
 #define GLH_BUFF_DYNAMIC_DRAW GL_DYNAMIC_DRAW
 
+/* GLH_BUFF_STREAM_READ
+ *
+ * macro for the pixel pack buffer object management scheme
+ * 
+ * stream read: filled by OpenGL once, read back once
+ */
+#define GLH_BUFF_STREAM_READ GL_STREAM_READ
+
 
 
 /* FUNCTIONS */
@@ -88,9 +99,23 @@ glh_object_t glh_create_vertex_buffer_object ( const void * vertices, const size
 
 int glh_delete_vertex_buffer_object ( const glh_object_t vbo );
 
+/* glh_update_vertex_buffer_object
+ *
+ * replaces part of the data in a vertex buffer object
+ * 
+ * vbo: the vertex buffer object to update
+ * offset: the offset (in bytes) of the data to replace
+ * data: the new data
+ * d_size: size of the new data (in bytes)
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_update_vertex_buffer_object ( const glh_object_t vbo, const size_t offset, const void * data, const size_t d_size );
+
 /* glh_create_element_buffer_object
  * 
  * creates an element buffer object containing the given data
+ * the data is sent through GL_COPY_WRITE_BUFFER, so that the buffer is not bound to whichever vao is bound
  * 
  * elements: array of elements
  * e_size: size of array (in bytes)
@@ -110,6 +135,106 @@ glh_object_t glh_create_element_buffer_object ( const void * elements, const siz
  */
 int glh_delete_element_buffer_object ( const glh_object_t ebo );
 
+/* glh_create_uniform_buffer_object
+ *
+ * creates a uniform buffer object containing the given data
+ * 
+ * data: array of data laid out to match the uniform block (usually std140), or NULL to leave uninitialised
+ * d_size: size of array (in bytes)
+ * buff_type: the buffer type from GLH_BUFF_STREAM/STATIC/DYNAMIC_DRAW
+ *
+ * return: buffer ID >= 0 for success, -1 for failure
+ */
+glh_object_t glh_create_uniform_buffer_object ( const void * data, const size_t d_size, const glh_type_t buff_type );
+
+/* glh_delete_uniform_buffer_object
+ *
+ * deletes a uniform buffer object
+ * 
+ * ubo: uniform buffer object to delete
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_delete_uniform_buffer_object ( const glh_object_t ubo );
+
+/* glh_update_uniform_buffer_object
+ *
+ * replaces part of the data in a uniform buffer object
+ * 
+ * ubo: the uniform buffer object to update
+ * offset: the offset (in bytes) of the data to replace
+ * data: the new data
+ * d_size: size of the new data (in bytes)
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_update_uniform_buffer_object ( const glh_object_t ubo, const size_t offset, const void * data, const size_t d_size );
+
+/* glh_bind_uniform_buffer_object
+ *
+ * bind a uniform buffer object to a uniform block binding point
+ * any uniform block assigned to the binding point in any shader program will read from the buffer
+ * 
+ * ubo: the uniform buffer object to bind
+ * binding: the binding point
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_bind_uniform_buffer_object ( const glh_object_t ubo, const int binding );
+
+/* glh_create_pixel_pack_buffer_object
+ *
+ * creates a pixel pack buffer object, which pixels can be read into without waiting for rendering to finish
+ * 
+ * d_size: size of the buffer (in bytes)
+ *
+ * return: buffer ID >= 0 for success, -1 for failure
+ */
+glh_object_t glh_create_pixel_pack_buffer_object ( const size_t d_size );
+
+/* glh_delete_pixel_pack_buffer_object
+ *
+ * deletes a pixel pack buffer object
+ * 
+ * pbo: pixel pack buffer object to delete
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_delete_pixel_pack_buffer_object ( const glh_object_t pbo );
+
+/* glh_resize_pixel_pack_buffer_object
+ *
+ * reallocates a pixel pack buffer object at a new size, discarding its contents
+ * 
+ * pbo: pixel pack buffer object to resize
+ * d_size: new size of the buffer (in bytes)
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_resize_pixel_pack_buffer_object ( const glh_object_t pbo, const size_t d_size );
+
+/* glh_map_pixel_pack_buffer_object
+ *
+ * map the contents of a pixel pack buffer object into memory for reading
+ * stalls until any reads into the buffer have completed, so wait on a fence first to avoid stalling
+ * 
+ * pbo: pixel pack buffer object to map
+ * d_size: size of the data to map (in bytes), from the start of the buffer
+ * 
+ * return: pointer to the contents for success, NULL for failure
+ */
+const void * glh_map_pixel_pack_buffer_object ( const glh_object_t pbo, const size_t d_size );
+
+/* glh_unmap_pixel_pack_buffer_object
+ *
+ * unmap a pixel pack buffer object mapped by glh_map_pixel_pack_buffer_object
+ * 
+ * pbo: pixel pack buffer object to unmap
+ * 
+ * return: 0 for success, -1 for failure (including the contents having been lost while mapped)
+ */
+int glh_unmap_pixel_pack_buffer_object ( const glh_object_t pbo );
+
 /* glh_bind_vertex_buffer_object
  *
  * how to handle attributes of vertex data
@@ -167,6 +292,18 @@ int glh_enable_vertex_attribute ( const glh_object_t vao, const int index );
  */
 int glh_disable_vertex_attribute ( const glh_object_t vao, const int index );
 
+/* glh_set_vertex_attribute_divisor
+ *
+ * sets how often a vertex attribute advances when drawing instances
+ * 
+ * vao: vertex array object to configure
+ * index: the index of the attribute
+ * divisor: 0 to advance every vertex, or n to advance every n instances
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_set_vertex_attribute_divisor ( const glh_object_t vao, const int index, const int divisor );
+
 /* glh_get_uniform_location
  *
  * aquires an object reference for a uniform within a shader program
@@ -178,6 +315,18 @@ int glh_disable_vertex_attribute ( const glh_object_t vao, const int index );
  */
 glh_object_t glh_get_uniform_location ( const glh_object_t shader_program, const char * uniform_name );
 
+/* glh_set_uniform_block_binding
+ *
+ * assigns a uniform block within a shader program to a binding point
+ * 
+ * shader_program: the shader program containing the uniform block
+ * block_name: the name of the uniform block (string)
+ * binding: the binding point to read the block from (see glh_bind_uniform_buffer_object)
+ * 
+ * return: 0 for success, -1 for failure (including uniform block not found)
+ */
+int glh_set_uniform_block_binding ( const glh_object_t shader_program, const char * block_name, const int binding );
+
 /* glh_set_uniform_vec1,2,3,4
  *
  * assigns a vector uniform to values
@@ -70,14 +70,11 @@ int glh_draw_arrays ( const glh_object_t vao, const glh_type_t mode, const int s
     __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before drawing arrays\n" );
 
     /* bind vao */
-    glBindVertexArray ( vao );
+    __glh_state_bind_vertex_array ( vao );
 
     /* draw arrays */
     glDrawArrays ( mode, start_index, count );
 
-    /* unbind vao */
-    glBindVertexArray ( 0 );
-
     /* return 0 for success */
     return 0;
 }
@@ -100,14 +97,157 @@ int glh_draw_elements ( const glh_object_t vao, const glh_type_t mode, const siz
     __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before drawing arrays\n" );
 
     /* bind vao */
-    glBindVertexArray ( vao );
+    __glh_state_bind_vertex_array ( vao );
 
     /* draw elements */
     glDrawElements ( mode, count, type, 0 );
 
-    /* unbind vao */
-    glBindVertexArray ( 0 );
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_draw_arrays_instanced
+ *
+ * draws instances of vertices from a vao
+ * attributes with a divisor set by glh_set_vertex_attribute_divisor advance per instance rather than per vertex
+ * 
+ * vao: the vao to draw from
+ * mode: the primative to render (see macros section)
+ * start_index: index of the array to start on
+ * count: number of vertices to draw in each instance
+ * instances: number of instances to draw
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_draw_arrays_instanced ( const glh_object_t vao, const glh_type_t mode, const int start_index, const size_t count, const size_t instances )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before drawing instances\n" );
+
+    /* bind vao */
+    __glh_state_bind_vertex_array ( vao );
+
+    /* draw the instances */
+    glDrawArraysInstanced ( mode, start_index, count, instances );
 
     /* return 0 for success */
     return 0;
-}
\ No newline at end of file
+}
+
+/* glh_enable_scissor
+ *
+ * restrict drawing and clearing to a rectangle of the framebuffer
+ * 
+ * x/y: the bottom-left corner of the rectangle in pixels
+ * width/height: the size of the rectangle in pixels
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_enable_scissor ( const int x, const int y, const int width, const int height )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before enabling the scissor\n" );
+
+    /* set the scissor rectangle and enable the scissor test */
+    glScissor ( x, y, width, height );
+    glEnable ( GL_SCISSOR_TEST );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_disable_scissor
+ *
+ * remove any restriction set by glh_enable_scissor
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_disable_scissor ()
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before disabling the scissor\n" );
+
+    /* disable the scissor test */
+    glDisable ( GL_SCISSOR_TEST );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_enable_blend
+ *
+ * blend what is drawn over the framebuffer by its alpha
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_enable_blend ()
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before enabling blending\n" );
+
+    /* blend by the alpha of what is drawn */
+    glBlendFunc ( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+    glEnable ( GL_BLEND );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_enable_additive_blend
+ *
+ * add what is drawn to the framebuffer, so that many fragments landing on the same pixel sum, such as to count or total values
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_enable_additive_blend ()
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before enabling blending\n" );
+
+    /* add every component of what is drawn to the framebuffer */
+    glBlendFunc ( GL_ONE, GL_ONE );
+    glEnable ( GL_BLEND );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_disable_blend
+ *
+ * stop blending set by glh_enable_blend or glh_enable_additive_blend, so that what is drawn replaces the framebuffer
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_disable_blend ()
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before disabling blending\n" );
+
+    /* disable blending */
+    glDisable ( GL_BLEND );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_set_viewport
+ *
+ * set the rectangle of the bound framebuffer which is drawn into
+ * unlike glh_set_viewport_size, does not need a window, so can be used with headless contexts
+ *
+ * x/y: the bottom-left corner of the rectangle in pixels
+ * width/height: the size of the rectangle in pixels
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_set_viewport ( const int x, const int y, const int width, const int height )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before setting the viewport\n" );
+
+    /* set the viewport */
+    glViewport ( x, y, width, height );
+
+    /* return 0 for success */
+    return 0;
+}
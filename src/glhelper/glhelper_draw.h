@@ -99,6 +99,76 @@ int glh_draw_arrays ( const glh_object_t vao, const glh_type_t mode, const int s
  */
 int glh_draw_elements ( const glh_object_t vao, const glh_type_t mode, const size_t count, const glh_type_t type );
 
+/* glh_draw_arrays_instanced
+ *
+ * draws instances of vertices from a vao
+ * attributes with a divisor set by glh_set_vertex_attribute_divisor advance per instance rather than per vertex
+ * 
+ * vao: the vao to draw from
+ * mode: the primative to render (see macros section)
+ * start_index: index of the array to start on
+ * count: number of vertices to draw in each instance
+ * instances: number of instances to draw
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_draw_arrays_instanced ( const glh_object_t vao, const glh_type_t mode, const int start_index, const size_t count, const size_t instances );
+
+/* glh_enable_scissor
+ *
+ * restrict drawing and clearing to a rectangle of the framebuffer
+ * 
+ * x/y: the bottom-left corner of the rectangle in pixels
+ * width/height: the size of the rectangle in pixels
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_enable_scissor ( const int x, const int y, const int width, const int height );
+
+/* glh_disable_scissor
+ *
+ * remove any restriction set by glh_enable_scissor
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_disable_scissor ();
+
+/* glh_enable_blend
+ *
+ * blend what is drawn over the framebuffer by its alpha
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_enable_blend ();
+
+/* glh_enable_additive_blend
+ *
+ * add what is drawn to the framebuffer, so that many fragments landing on the same pixel sum, such as to count or total values
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_enable_additive_blend ();
+
+/* glh_disable_blend
+ *
+ * stop blending set by glh_enable_blend or glh_enable_additive_blend, so that what is drawn replaces the framebuffer
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_disable_blend ();
+
+/* glh_set_viewport
+ *
+ * set the rectangle of the bound framebuffer which is drawn into
+ * unlike glh_set_viewport_size, does not need a window, so can be used with headless contexts
+ *
+ * x/y: the bottom-left corner of the rectangle in pixels
+ * width/height: the size of the rectangle in pixels
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_set_viewport ( const int x, const int y, const int width, const int height );
+
 
 
 /* #ifndef GLHELPER_DRAW_H_INCLUDED */
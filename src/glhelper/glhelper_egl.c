@@ -0,0 +1,214 @@
+/*
+ * glhelper_egl.c
+ *
+ * implementation of glhelper_egl.h
+ *
+ */
+
+
+
+/* include glhelper_egl.h */
+#include "glhelper_egl.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* glh_create_headless_context
+ *
+ * create a headless OpenGL 3.3 core context, and make it current
+ * the surfaceless Mesa platform is used if available, otherwise the default display
+ * there is no default framebuffer to draw into, so all rendering should be into framebuffer objects
+ * glad is loaded if it has not already been
+ *
+ * return: the context, or NULL on failure
+ */
+glh_headless_context_t * glh_create_headless_context ()
+{
+    /* allocate the context, with no egl objects yet */
+    glh_headless_context_t * context = malloc ( sizeof ( glh_headless_context_t ) );
+    if ( !context )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "GLH ERROR: failed to allocate memory for headless context\n" );
+        return NULL;
+    }
+    context->display = EGL_NO_DISPLAY;
+    context->context = EGL_NO_CONTEXT;
+    context->surface = EGL_NO_SURFACE;
+    context->state = NULL;
+
+    /* get and initialise the display */
+    if ( ( context->display = __glh_egl_get_display () ) == EGL_NO_DISPLAY || !eglInitialize ( context->display, NULL, NULL ) )
+    {
+        /* failed to initialise display */
+        fprintf ( stderr, "GLH ERROR: failed to initialise egl display\n" );
+        context->display = EGL_NO_DISPLAY;
+        glh_destroy_headless_context ( context );
+        return NULL;
+    }
+
+    /* choose a config supporting desktop OpenGL and pbuffers */
+    const EGLint config_attribs [] =
+    {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint config_count = 0;
+    if ( !eglChooseConfig ( context->display, config_attribs, &config, 1, &config_count ) || config_count < 1 || !eglBindAPI ( EGL_OPENGL_API ) )
+    {
+        /* no suitable config */
+        fprintf ( stderr, "GLH ERROR: failed to find an egl config supporting OpenGL\n" );
+        glh_destroy_headless_context ( context );
+        return NULL;
+    }
+
+    /* create a 3.3 core context, matching the contexts glfw creates */
+    const EGLint context_attribs [] =
+    {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    if ( ( context->context = eglCreateContext ( context->display, config, EGL_NO_CONTEXT, context_attribs ) ) == EGL_NO_CONTEXT )
+    {
+        /* failed to create context */
+        fprintf ( stderr, "GLH ERROR: failed to create egl context\n" );
+        glh_destroy_headless_context ( context );
+        return NULL;
+    }
+
+    /* if the context cannot be made current without a surface, create a 1x1 pbuffer to make current with it */
+    const char * extensions = eglQueryString ( context->display, EGL_EXTENSIONS );
+    if ( !extensions || !strstr ( extensions, "EGL_KHR_surfaceless_context" ) )
+    {
+        const EGLint surface_attribs [] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        if ( ( context->surface = eglCreatePbufferSurface ( context->display, config, surface_attribs ) ) == EGL_NO_SURFACE )
+        {
+            /* failed to create surface */
+            fprintf ( stderr, "GLH ERROR: failed to create egl pbuffer surface\n" );
+            glh_destroy_headless_context ( context );
+            return NULL;
+        }
+    }
+
+    /* create the shadow state, make the context current and load glad if not yet loaded */
+    if ( !( context->state = glh_create_state () ) ||
+         glh_make_headless_context_current ( context ) == -1 ||
+         ( GLH_GLAD_INIT_STATE == 0 && glh_load_glad_from_loader ( ( GLADloadproc ) eglGetProcAddress ) == -1 ) )
+    {
+        /* failed to set up context */
+        fprintf ( stderr, "GLH ERROR: failed to set up headless context\n" );
+        glh_destroy_headless_context ( context );
+        return NULL;
+    }
+
+    /* return the context */
+    return context;
+}
+
+/* glh_destroy_headless_context
+ *
+ * destroy a headless context, releasing it first if current
+ *
+ * context: the context to destroy
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_destroy_headless_context ( glh_headless_context_t * context )
+{
+    /* if there is a display, destroy the egl objects and terminate it */
+    if ( context->display != EGL_NO_DISPLAY )
+    {
+        /* release the context if current */
+        if ( eglGetCurrentContext () == context->context && context->context != EGL_NO_CONTEXT ) glh_release_headless_context ( context );
+
+        /* destroy the surface and context */
+        if ( context->surface != EGL_NO_SURFACE ) eglDestroySurface ( context->display, context->surface );
+        if ( context->context != EGL_NO_CONTEXT ) eglDestroyContext ( context->display, context->context );
+
+        /* terminate the display */
+        eglTerminate ( context->display );
+    }
+
+    /* destroy the shadow state */
+    if ( context->state ) glh_destroy_state ( context->state );
+
+    /* free the context */
+    free ( context );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_make_headless_context_current
+ *
+ * make a headless context current on the calling thread
+ *
+ * context: the context to make current
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_make_headless_context_current ( glh_headless_context_t * context )
+{
+    /* skip if already current on this thread */
+    if ( eglGetCurrentContext () == context->context && glh_get_current_state () == context->state ) return __glh_state_elide ();
+
+    /* make the context current, along with its shadow state */
+    if ( !eglMakeCurrent ( context->display, context->surface, context->surface, context->context ) )
+    {
+        /* failed to make current */
+        fprintf ( stderr, "GLH ERROR: failed to make headless context current\n" );
+        return -1;
+    }
+    glh_set_current_state ( context->state );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_release_headless_context
+ *
+ * release the headless context current on the calling thread
+ *
+ * context: the context to release
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_release_headless_context ( glh_headless_context_t * context )
+{
+    /* release the context, along with its shadow state */
+    eglMakeCurrent ( context->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+    glh_set_current_state ( NULL );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __glh_egl_get_display
+ *
+ * get an egl display, preferring the surfaceless Mesa platform
+ *
+ * return: the display, or EGL_NO_DISPLAY on failure
+ */
+EGLDisplay __glh_egl_get_display ()
+{
+    /* if platform displays are supported, try the surfaceless platform, which needs no window system */
+    const char * extensions = eglQueryString ( EGL_NO_DISPLAY, EGL_EXTENSIONS );
+    if ( extensions && strstr ( extensions, "EGL_MESA_platform_surfaceless" ) )
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display = ( PFNEGLGETPLATFORMDISPLAYEXTPROC ) eglGetProcAddress ( "eglGetPlatformDisplayEXT" );
+        if ( get_platform_display )
+        {
+            EGLDisplay display = get_platform_display ( EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL );
+            if ( display != EGL_NO_DISPLAY ) return display;
+        }
+    }
+
+    /* otherwise fall back to the default display */
+    return eglGetDisplay ( EGL_DEFAULT_DISPLAY );
+}
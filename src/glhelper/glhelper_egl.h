@@ -0,0 +1,118 @@
+/*
+ * glhelper_egl.h
+ *
+ * defines functions to create headless OpenGL contexts with EGL, which need no display or window system
+ * on machines without a gpu, these run on Mesa's software rasterisers such as llvmpipe
+ *
+ */
+
+
+
+/* pragma one */
+#ifndef GLHELPER_EGL_H_INCLUDED
+#define GLHELPER_EGL_H_INCLUDED
+
+
+
+/* INCLUDES */
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+
+/* include egl headers, without the X11 headers which are not needed headless */
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+/* include glhelper_core.h */
+#include "glhelper_core.h"
+
+/* include glhelper_glad.h */
+#include "glhelper_glad.h"
+
+/* include glhelper_state.h */
+#include "glhelper_state.h"
+
+
+
+/* STRUCTURES */
+
+/* struct glh_headless_context_t
+ *
+ * a headless OpenGL context, along with the egl objects it depends on
+ */
+typedef struct
+{
+    /* egl display and context */
+    EGLDisplay display;
+    EGLContext context;
+
+    /* 1x1 pbuffer surface to make current, or EGL_NO_SURFACE if the context can be made current without a surface */
+    EGLSurface surface;
+
+    /* shadow state of the context */
+    glh_state_t * state;
+
+} glh_headless_context_t;
+
+
+
+/* FUNCTIONS */
+
+/* glh_create_headless_context
+ *
+ * create a headless OpenGL 3.3 core context, and make it current
+ * the surfaceless Mesa platform is used if available, otherwise the default display
+ * there is no default framebuffer to draw into, so all rendering should be into framebuffer objects
+ * glad is loaded if it has not already been
+ *
+ * return: the context, or NULL on failure
+ */
+glh_headless_context_t * glh_create_headless_context ();
+
+/* glh_destroy_headless_context
+ *
+ * destroy a headless context, releasing it first if current
+ *
+ * context: the context to destroy
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_destroy_headless_context ( glh_headless_context_t * context );
+
+/* glh_make_headless_context_current
+ *
+ * make a headless context current on the calling thread
+ *
+ * context: the context to make current
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_make_headless_context_current ( glh_headless_context_t * context );
+
+/* glh_release_headless_context
+ *
+ * release the headless context current on the calling thread
+ *
+ * context: the context to release
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_release_headless_context ( glh_headless_context_t * context );
+
+/* __glh_egl_get_display
+ *
+ * get an egl display, preferring the surfaceless Mesa platform
+ *
+ * return: the display, or EGL_NO_DISPLAY on failure
+ */
+EGLDisplay __glh_egl_get_display ();
+
+
+
+/* #ifndef GLHELPER_EGL_H_INCLUDED */
+#endif
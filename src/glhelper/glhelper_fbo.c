@@ -0,0 +1,341 @@
+/*
+ * glhelper_fbo.c
+ *
+ * implementation of glhelper_fbo.h
+ *
+ */
+
+
+
+/* include glhelper_fbo.h */
+#include "glhelper_fbo.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* glh_create_texture_2d
+ *
+ * creates an empty 2d texture
+ *
+ * width/height: the size of the texture in pixels
+ * internal_format: the format the texture is stored in (GLH_TEX_R8/R32F/RGBA8/RGBA32F)
+ * format: the format of pixel data (GLH_TEX_FORMAT_RED/RGBA)
+ * type: the type of each component of pixel data, e.g.:
+ *       GLH_TYPE_UNSIGNED_BYTE
+ * filter: the filter to use when sampling the texture (GLH_TEX_FILTER_NEAREST/LINEAR)
+ *
+ * return: texture ID >= 0 for success, -1 for failure
+ */
+glh_object_t glh_create_texture_2d ( const int width, const int height, const glh_type_t internal_format, const glh_type_t format, const glh_type_t type, const glh_type_t filter )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before creating a texture\n" );
+
+    /* create object */
+    glh_object_t texture;
+    glGenTextures ( 1, &texture );
+
+    /* bind the texture */
+    __glh_state_bind_texture_2d ( texture );
+
+    /* allocate the storage for the texture */
+    glTexImage2D ( GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, NULL );
+
+    /* set the filtering and wrapping */
+    glTexParameteri ( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter );
+    glTexParameteri ( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter );
+    glTexParameteri ( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    glTexParameteri ( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+
+    /* return the texture */
+    return texture;
+}
+
+/* glh_delete_texture
+ *
+ * deletes a texture
+ *
+ * texture: the texture to delete
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_delete_texture ( const glh_object_t texture )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before deleting a texture\n" );
+
+    /* forget then delete the texture */
+    __glh_state_forget_object ( texture, GLH_STATE_OBJECT_TEXTURE );
+    glDeleteTextures ( 1, &texture );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_update_texture_2d
+ *
+ * replaces the pixels of a region of a 2d texture
+ *
+ * texture: the texture to update
+ * x/y: the bottom left pixel of the region
+ * width/height: the size of the region in pixels
+ * format: the format of pixel data (GLH_TEX_FORMAT_RED/RGBA)
+ * type: the type of each component of pixel data (e.g. GLH_TYPE_FLOAT)
+ * pixels: the pixel data, bottom row first
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_update_texture_2d ( const glh_object_t texture, const int x, const int y, const int width, const int height, const glh_type_t format, const glh_type_t type, const void * pixels )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before updating a texture\n" );
+
+    /* bind the texture and replace the region */
+    __glh_state_bind_texture_2d ( texture );
+    glTexSubImage2D ( GL_TEXTURE_2D, 0, x, y, width, height, format, type, pixels );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_bind_texture_2d_to_unit
+ *
+ * bind a 2d texture to a texture unit other than the first, for shaders to sample
+ * the first texture unit is left active, so textures bound by the other functions are unaffected
+ *
+ * texture: the texture to bind
+ * unit: the texture unit to bind it to, at least 1
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_bind_texture_2d_to_unit ( const glh_object_t texture, const int unit )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before binding a texture\n" );
+
+    /* the first unit is tracked by the state, so may not be bound to here */
+    if ( unit < 1 )
+    {
+        fprintf ( stderr, "GLH ERROR: textures may only be bound to units other than the first\n" );
+        return -1;
+    }
+
+    /* make the unit active, bind the texture, then make the first unit active again */
+    glActiveTexture ( GL_TEXTURE0 + unit );
+    glBindTexture ( GL_TEXTURE_2D, texture );
+    glActiveTexture ( GL_TEXTURE0 );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_create_framebuffer_object
+ *
+ * creates a framebuffer object rendering into a texture
+ *
+ * texture: the texture to attach as the colour buffer
+ *
+ * return: fbo ID >= 0 for success, -1 for failure (including an incomplete framebuffer)
+ */
+glh_object_t glh_create_framebuffer_object ( const glh_object_t texture )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before creating a framebuffer object\n" );
+
+    /* create object */
+    glh_object_t fbo;
+    glGenFramebuffers ( 1, &fbo );
+
+    /* bind the fbo and attach the texture */
+    __glh_state_bind_framebuffer ( GL_FRAMEBUFFER, fbo );
+    glFramebufferTexture2D ( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0 );
+
+    /* check the framebuffer is complete */
+    if ( glCheckFramebufferStatus ( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE )
+    {
+        /* incomplete, so delete and produce error */
+        __glh_state_forget_object ( fbo, GLH_STATE_OBJECT_FRAMEBUFFER );
+        glDeleteFramebuffers ( 1, &fbo );
+        fprintf ( stderr, "GLH ERROR: framebuffer object is incomplete\n" );
+        return -1;
+    }
+
+    /* return the fbo */
+    return fbo;
+}
+
+/* glh_attach_texture_to_framebuffer_object
+ *
+ * attach a further texture to a framebuffer object as another colour buffer, which fragment shader output index is written to
+ * every colour buffer up to and including index is then drawn into, so lower indices must already be attached
+ *
+ * fbo: the framebuffer object to attach to
+ * texture: the texture to attach
+ * index: the index of the colour buffer, at least 1, as 0 is attached by glh_create_framebuffer_object
+ *
+ * return: 0 for success, -1 for failure (including an incomplete framebuffer)
+ */
+int glh_attach_texture_to_framebuffer_object ( const glh_object_t fbo, const glh_object_t texture, const int index )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before attaching a texture to a framebuffer object\n" );
+
+    /* check the index is within the colour buffers every context supports */
+    if ( index < 1 || index >= 8 )
+    {
+        fprintf ( stderr, "GLH ERROR: colour buffer index %d is out of range\n", index );
+        return -1;
+    }
+
+    /* bind the fbo and attach the texture */
+    __glh_state_bind_framebuffer ( GL_FRAMEBUFFER, fbo );
+    glFramebufferTexture2D ( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + index, GL_TEXTURE_2D, texture, 0 );
+
+    /* draw into every colour buffer up to the new one */
+    GLenum draw_buffers [ 8 ];
+    for ( int i = 0; i <= index; ++i ) draw_buffers [ i ] = GL_COLOR_ATTACHMENT0 + i;
+    glDrawBuffers ( index + 1, draw_buffers );
+
+    /* check the framebuffer is still complete */
+    if ( glCheckFramebufferStatus ( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE )
+    {
+        /* incomplete, so produce error */
+        fprintf ( stderr, "GLH ERROR: framebuffer object is incomplete\n" );
+        return -1;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_delete_framebuffer_object
+ *
+ * deletes a framebuffer object
+ * the attached texture is not deleted
+ *
+ * fbo: the framebuffer object to delete
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_delete_framebuffer_object ( const glh_object_t fbo )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before deleting a framebuffer object\n" );
+
+    /* forget then delete the fbo */
+    __glh_state_forget_object ( fbo, GLH_STATE_OBJECT_FRAMEBUFFER );
+    glDeleteFramebuffers ( 1, &fbo );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_bind_framebuffer_object
+ *
+ * bind a framebuffer object to be drawn into
+ *
+ * fbo: the framebuffer object to bind, or 0 for the window's framebuffer
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_bind_framebuffer_object ( const glh_object_t fbo )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before binding a framebuffer object\n" );
+
+    /* bind the fbo */
+    __glh_state_bind_framebuffer ( GL_FRAMEBUFFER, fbo );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_blit_framebuffer_object
+ *
+ * copy the contents of one framebuffer to another
+ *
+ * read_fbo: the framebuffer to copy from, or 0 for the window's framebuffer
+ * draw_fbo: the framebuffer to copy to, or 0 for the window's framebuffer
+ * width/height: the size of the region to copy, from the bottom-left corner
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_blit_framebuffer_object ( const glh_object_t read_fbo, const glh_object_t draw_fbo, const int width, const int height )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before blitting a framebuffer object\n" );
+
+    /* bind the read and draw framebuffers */
+    __glh_state_bind_framebuffer ( GL_READ_FRAMEBUFFER, read_fbo );
+    __glh_state_bind_framebuffer ( GL_DRAW_FRAMEBUFFER, draw_fbo );
+
+    /* copy the colour buffer */
+    glBlitFramebuffer ( 0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_read_framebuffer_object
+ *
+ * read pixels from a framebuffer into memory
+ * rows are tightly packed, and the first row read is the bottom row of the region
+ *
+ * fbo: the framebuffer to read from, or 0 for the window's framebuffer
+ * x/y: the bottom-left corner of the region to read
+ * width/height: the size of the region to read
+ * format: the format of the pixel data (e.g. GLH_TEX_FORMAT_RGBA)
+ * type: the type of each component of the pixel data (e.g. GLH_TYPE_UNSIGNED_BYTE)
+ * pixels: the memory to read into
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_read_framebuffer_object ( const glh_object_t fbo, const int x, const int y, const int width, const int height, const glh_type_t format, const glh_type_t type, void * pixels )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before reading a framebuffer object\n" );
+
+    /* bind the framebuffer to read from, and unbind any pixel pack buffer so that pixels is treated as a pointer */
+    __glh_state_bind_framebuffer ( GL_READ_FRAMEBUFFER, fbo );
+    __glh_state_bind_buffer ( GL_PIXEL_PACK_BUFFER, 0 );
+
+    /* read the pixels, with rows tightly packed */
+    glPixelStorei ( GL_PACK_ALIGNMENT, 1 );
+    glReadPixels ( x, y, width, height, format, type, pixels );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_read_framebuffer_object_to_buffer
+ *
+ * begin reading pixels from a framebuffer into a pixel pack buffer object, without waiting for rendering to finish
+ * rows are tightly packed, and the first row read is the bottom row of the region
+ * create a fence after this to find when the pixels can be mapped without stalling
+ *
+ * fbo: the framebuffer to read from, or 0 for the window's framebuffer
+ * x/y: the bottom-left corner of the region to read
+ * width/height: the size of the region to read
+ * format: the format of the pixel data (e.g. GLH_TEX_FORMAT_RGBA)
+ * type: the type of each component of the pixel data (e.g. GLH_TYPE_UNSIGNED_BYTE)
+ * pbo: the pixel pack buffer object to read into, which must be large enough to hold the pixels
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_read_framebuffer_object_to_buffer ( const glh_object_t fbo, const int x, const int y, const int width, const int height, const glh_type_t format, const glh_type_t type, const glh_object_t pbo )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before reading a framebuffer object\n" );
+
+    /* bind the framebuffer to read from, and the pixel pack buffer to read into */
+    __glh_state_bind_framebuffer ( GL_READ_FRAMEBUFFER, fbo );
+    __glh_state_bind_buffer ( GL_PIXEL_PACK_BUFFER, pbo );
+
+    /* begin reading the pixels to the start of the buffer, with rows tightly packed */
+    glPixelStorei ( GL_PACK_ALIGNMENT, 1 );
+    glReadPixels ( x, y, width, height, format, type, ( void * ) 0 );
+
+    /* return 0 for success */
+    return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * glhelper_fbo.h
+ *
+ * defines structures and functions to handle OpenGL textures and framebuffer objects
+ *
+ */
+
+
+
+/* pragma one */
+#ifndef GLHELPER_FBO_H_INCLUDED
+#define GLHELPER_FBO_H_INCLUDED
+
+
+
+/* INCLUDES */
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* include glhelper_core.h */
+#include "glhelper_core.h"
+
+/* include glhelper_glad.h */
+#include "glhelper_glad.h"
+
+/* include glhelper_state.h */
+#include "glhelper_state.h"
+
+
+
+/* GLOBAL FLAGS AND MACROS */
+
+/* GLH_TEX_R8/R32F/RGBA8/RGBA32F
+ *
+ * macros for texture internal formats
+ */
+#define GLH_TEX_R8 GL_R8
+#define GLH_TEX_R32F GL_R32F
+#define GLH_TEX_RGBA8 GL_RGBA8
+#define GLH_TEX_RGBA32F GL_RGBA32F
+
+/* GLH_TEX_FORMAT_RED/RGBA
+ *
+ * macros for the format of texture pixel data
+ */
+#define GLH_TEX_FORMAT_RED GL_RED
+#define GLH_TEX_FORMAT_RGBA GL_RGBA
+
+/* GLH_TEX_FILTER_NEAREST/LINEAR
+ *
+ * macros for texture sampling filters
+ */
+#define GLH_TEX_FILTER_NEAREST GL_NEAREST
+#define GLH_TEX_FILTER_LINEAR GL_LINEAR
+
+
+
+/* FUNCTIONS */
+
+/* glh_create_texture_2d
+ *
+ * creates an empty 2d texture
+ *
+ * width/height: the size of the texture in pixels
+ * internal_format: the format the texture is stored in (GLH_TEX_R8/R32F/RGBA8/RGBA32F)
+ * format: the format of pixel data (GLH_TEX_FORMAT_RED/RGBA)
+ * type: the type of each component of pixel data, e.g.:
+ *       GLH_TYPE_UNSIGNED_BYTE
+ * filter: the filter to use when sampling the texture (GLH_TEX_FILTER_NEAREST/LINEAR)
+ *
+ * return: texture ID >= 0 for success, -1 for failure
+ */
+glh_object_t glh_create_texture_2d ( const int width, const int height, const glh_type_t internal_format, const glh_type_t format, const glh_type_t type, const glh_type_t filter );
+
+/* glh_delete_texture
+ *
+ * deletes a texture
+ *
+ * texture: the texture to delete
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_delete_texture ( const glh_object_t texture );
+
+/* glh_update_texture_2d
+ *
+ * replaces the pixels of a region of a 2d texture
+ *
+ * texture: the texture to update
+ * x/y: the bottom left pixel of the region
+ * width/height: the size of the region in pixels
+ * format: the format of pixel data (GLH_TEX_FORMAT_RED/RGBA)
+ * type: the type of each component of pixel data (e.g. GLH_TYPE_FLOAT)
+ * pixels: the pixel data, bottom row first
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_update_texture_2d ( const glh_object_t texture, const int x, const int y, const int width, const int height, const glh_type_t format, const glh_type_t type, const void * pixels );
+
+/* glh_bind_texture_2d_to_unit
+ *
+ * bind a 2d texture to a texture unit other than the first, for shaders to sample
+ * the first texture unit is left active, so textures bound by the other functions are unaffected
+ *
+ * texture: the texture to bind
+ * unit: the texture unit to bind it to, at least 1
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_bind_texture_2d_to_unit ( const glh_object_t texture, const int unit );
+
+/* glh_create_framebuffer_object
+ *
+ * creates a framebuffer object rendering into a texture
+ *
+ * texture: the texture to attach as the colour buffer
+ *
+ * return: fbo ID >= 0 for success, -1 for failure (including an incomplete framebuffer)
+ */
+glh_object_t glh_create_framebuffer_object ( const glh_object_t texture );
+
+/* glh_attach_texture_to_framebuffer_object
+ *
+ * attach a further texture to a framebuffer object as another colour buffer, which fragment shader output index is written to
+ * every colour buffer up to and including index is then drawn into, so lower indices must already be attached
+ *
+ * fbo: the framebuffer object to attach to
+ * texture: the texture to attach
+ * index: the index of the colour buffer, at least 1, as 0 is attached by glh_create_framebuffer_object
+ *
+ * return: 0 for success, -1 for failure (including an incomplete framebuffer)
+ */
+int glh_attach_texture_to_framebuffer_object ( const glh_object_t fbo, const glh_object_t texture, const int index );
+
+/* glh_delete_framebuffer_object
+ *
+ * deletes a framebuffer object
+ * the attached texture is not deleted
+ *
+ * fbo: the framebuffer object to delete
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_delete_framebuffer_object ( const glh_object_t fbo );
+
+/* glh_bind_framebuffer_object
+ *
+ * bind a framebuffer object to be drawn into
+ *
+ * fbo: the framebuffer object to bind, or 0 for the window's framebuffer
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_bind_framebuffer_object ( const glh_object_t fbo );
+
+/* glh_blit_framebuffer_object
+ *
+ * copy the contents of one framebuffer to another
+ *
+ * read_fbo: the framebuffer to copy from, or 0 for the window's framebuffer
+ * draw_fbo: the framebuffer to copy to, or 0 for the window's framebuffer
+ * width/height: the size of the region to copy, from the bottom-left corner
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_blit_framebuffer_object ( const glh_object_t read_fbo, const glh_object_t draw_fbo, const int width, const int height );
+
+/* glh_read_framebuffer_object
+ *
+ * read pixels from a framebuffer into memory
+ * rows are tightly packed, and the first row read is the bottom row of the region
+ *
+ * fbo: the framebuffer to read from, or 0 for the window's framebuffer
+ * x/y: the bottom-left corner of the region to read
+ * width/height: the size of the region to read
+ * format: the format of the pixel data (e.g. GLH_TEX_FORMAT_RGBA)
+ * type: the type of each component of the pixel data (e.g. GLH_TYPE_UNSIGNED_BYTE)
+ * pixels: the memory to read into
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_read_framebuffer_object ( const glh_object_t fbo, const int x, const int y, const int width, const int height, const glh_type_t format, const glh_type_t type, void * pixels );
+
+/* glh_read_framebuffer_object_to_buffer
+ *
+ * begin reading pixels from a framebuffer into a pixel pack buffer object, without waiting for rendering to finish
+ * rows are tightly packed, and the first row read is the bottom row of the region
+ * create a fence after this to find when the pixels can be mapped without stalling
+ *
+ * fbo: the framebuffer to read from, or 0 for the window's framebuffer
+ * x/y: the bottom-left corner of the region to read
+ * width/height: the size of the region to read
+ * format: the format of the pixel data (e.g. GLH_TEX_FORMAT_RGBA)
+ * type: the type of each component of the pixel data (e.g. GLH_TYPE_UNSIGNED_BYTE)
+ * pbo: the pixel pack buffer object to read into, which must be large enough to hold the pixels
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_read_framebuffer_object_to_buffer ( const glh_object_t fbo, const int x, const int y, const int width, const int height, const glh_type_t format, const glh_type_t type, const glh_object_t pbo );
+
+
+
+/* #ifndef GLHELPER_FBO_H_INCLUDED */
+#endif
@@ -37,8 +37,23 @@ int glh_load_glad ()
     /* check glfw is initialised */
     /* __GLH_GLFW_INIT_CHECK__ ( 1, -1, "GLH ERROR: glfw must be initialised before loading glad to a context\n" ); */
 
+    /* load glad using glfw's loader */
+    return glh_load_glad_from_loader ( ( GLADloadproc ) glfwGetProcAddress );
+}
+
+/* glh_load_glad_from_loader
+ *
+ * load glad to current context, using a function other than glfw's to find OpenGL functions
+ * used for contexts not created by glfw, such as headless contexts
+ *
+ * loader: function returning the address of an OpenGL function given its name
+ *
+ * return: 0 on success, and -1 on failure
+ */
+int glh_load_glad_from_loader ( GLADloadproc loader )
+{
     /* initialise glad */
-    if ( !gladLoadGLLoader ( ( GLADloadproc ) glfwGetProcAddress ) )
+    if ( !gladLoadGLLoader ( loader ) )
     {
         /* initialisation failed, so produce error */
         fprintf ( stderr, "GLH ERROR: glad failed to initialise\n" );
@@ -50,4 +65,19 @@ int glh_load_glad ()
 
     /* return 0 for success */
     return 0;
+}
+
+/* glh_get_renderer
+ *
+ * get the name of the renderer of the current context, such as the gpu or software rasteriser in use
+ *
+ * return: the name of the renderer, or NULL on failure
+ */
+const char * glh_get_renderer ()
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, NULL, "GLH ERROR: glad must be initialised before getting the renderer\n" );
+
+    /* return the renderer string */
+    return ( const char * ) glGetString ( GL_RENDERER );
 }
\ No newline at end of file
@@ -59,6 +59,25 @@ extern volatile int GLH_GLAD_INIT_STATE;
  */
 int glh_load_glad ();
 
+/* glh_load_glad_from_loader
+ *
+ * load glad to current context, using a function other than glfw's to find OpenGL functions
+ * used for contexts not created by glfw, such as headless contexts
+ *
+ * loader: function returning the address of an OpenGL function given its name
+ *
+ * return: 0 on success, and -1 on failure
+ */
+int glh_load_glad_from_loader ( GLADloadproc loader );
+
+/* glh_get_renderer
+ *
+ * get the name of the renderer of the current context, such as the gpu or software rasteriser in use
+ *
+ * return: the name of the renderer, or NULL on failure
+ */
+const char * glh_get_renderer ();
+
 
 
 /* #ifndef GLHELPER_GLAD_H_INCLUDED */
@@ -20,12 +20,6 @@
  */
 volatile int GLH_GLFW_INIT_STATE = 0;
 
-/* volatile size_t GLH_GLFW_CURRENT
- *
- * stores a casted pointer of the window currently loaded into glad, or 0 for not loaded
- */
-volatile size_t GLH_GLFW_CURRENT = 0;
-
 
 
 /* FUNCTION IMPLEMENTATIONS */
@@ -106,6 +100,19 @@ glh_window_t glh_create_window ( const char * title, const int width, const int
         return window;
     }
 
+    /* create the window's state, including the shadow state of its context, and store it in the window */
+    glh_window_data_t * data = calloc ( 1, sizeof ( glh_window_data_t ) );
+    if ( !data || !( data->state = glh_create_state () ) )
+    {
+        /* failed, so close window and return error window */
+        fprintf ( stderr, "GLH ERROR: failed to allocate memory for window state\n" );
+        free ( data );
+        glfwDestroyWindow ( window );
+        window = NULL;
+        return window;
+    }
+    glfwSetWindowUserPointer ( window, data );
+
     /* make window current */
     if ( glh_make_window_current ( window ) < 0 )
     {
@@ -144,14 +151,22 @@ glh_window_t glh_create_window ( const char * title, const int width, const int
     /* check glfw is initialised */
     __GLH_GLFW_INIT_CHECK__ ( 1, -1, "GLH ERROR: glfw must be initialised before destroying a window\n" );
 
+    /* destroy the window's state */
+    glh_window_data_t * data = glh_get_window_data ( window );
+    if ( data ) glh_destroy_state ( data->state );
+    free ( data );
+
      /* destroy window */
      glfwDestroyWindow ( window );
+
+    /* return 0 for success */
+    return 0;
  }
 
   /* glh_make_window_current
   *
   * make a window the current window for OpenGL
-  * quite expensive so don't over-use
+  * does nothing if the window is already current on the calling thread
   * 
   * window: the window to set as the curren t OpenGL context
   *
@@ -162,30 +177,114 @@ int glh_make_window_current ( glh_window_t window )
     /* check glfw is initialised */
     __GLH_GLFW_INIT_CHECK__ ( 1, -1, "GLH ERROR: glfw must be initialised before making a window current\n" );
 
-    /* make context current */
+    /* check the window exists */
+    if ( !window )
+    {
+        fprintf ( stderr, "GLH ERROR: cannot make a NULL window current\n" );
+        return -1;
+    }
+
+    /* skip if already current on this thread */
+    glh_state_t * state = glh_get_window_data ( window )->state;
+    if ( glfwGetCurrentContext () == window && glh_get_current_state () == state ) return __glh_state_elide ();
+
+    /* make context current, along with its shadow state */
     glfwMakeContextCurrent ( window );
+    glh_set_current_state ( state );
 
-    /* reload glad, if necessary */
-    if ( GLH_GLFW_CURRENT != ( size_t ) window )
+    /* load glad, if not yet loaded
+     * every context is created by glfw with the same hints, so the function pointers loaded for the first are valid for all
+     */
+    if ( GLH_GLAD_INIT_STATE == 0 )
     {
         if ( glh_load_glad () < 0 )
         {
             /* failed, so return failure */
             return -1;
         }
-    } else
-    {
-        /* print info that didn't reload glad */
-        //fprintf ( stderr, "GLH INFO: did not reload glad for already current window\n" );
     }
 
-    /* set GLH_GLFW_CURRENT flag */
-    GLH_GLFW_CURRENT = ( size_t ) window;
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_release_window_current
+ *
+ * release the current window's OpenGL context from the calling thread
+ * this allows another thread to make the window current
+ *
+ * return: 0 on success, -1 on failure
+ */
+int glh_release_window_current ()
+{
+    /* check glfw is initialised */
+    __GLH_GLFW_INIT_CHECK__ ( 1, -1, "GLH ERROR: glfw must be initialised before releasing the current window\n" );
+
+    /* release the context, along with its shadow state */
+    glfwMakeContextCurrent ( NULL );
+    glh_set_current_state ( NULL );
 
     /* return 0 for success */
     return 0;
 }
 
+/* glh_get_window_data
+ *
+ * get the state kept for a window
+ *
+ * window: the window to get the state of
+ *
+ * return: the window's state, or NULL on failure
+ */
+glh_window_data_t * glh_get_window_data ( glh_window_t window )
+{
+    /* check glfw is initialised */
+    __GLH_GLFW_INIT_CHECK__ ( 1, NULL, "GLH ERROR: glfw must be initialised before getting the state of a window\n" );
+
+    /* return the glfw user pointer */
+    return ( glh_window_data_t * ) glfwGetWindowUserPointer ( window );
+}
+
+/* glh_set_window_user_pointer
+ *
+ * set a pointer for the application to associate with a window
+ * the glfw user pointer is used by glhelper, so should not be set directly
+ *
+ * window: the window to set the pointer of
+ * pointer: the pointer
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_set_window_user_pointer ( glh_window_t window, void * pointer )
+{
+    /* get the window's state */
+    glh_window_data_t * data = glh_get_window_data ( window );
+    if ( !data ) return -1;
+
+    /* set the pointer */
+    data->user_pointer = pointer;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_get_window_user_pointer
+ *
+ * get the pointer set with glh_set_window_user_pointer
+ *
+ * window: the window to get the pointer of
+ *
+ * return: the pointer, or NULL if it has not been set
+ */
+void * glh_get_window_user_pointer ( glh_window_t window )
+{
+    /* get the window's state */
+    glh_window_data_t * data = glh_get_window_data ( window );
+
+    /* return the pointer, if there is one */
+    return ( data ? data->user_pointer : NULL );
+}
+
 /* glh_set_window_size
  *
  * function to alter size of window
@@ -285,6 +384,50 @@ int glh_get_viewport_size ( glh_window_t window, int * viewport_size )
     return 0;
 }
 
+/* glh_set_window_refresh_callback
+ *
+ * function to set the callback for when the contents of the window have been damaged and need to be redrawn
+ * 
+ * window: the window to set the callback for
+ * callback: function pointer to the callback (may be NULL to remove the callback)
+ *           void ( glh_window_t window )
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_set_window_refresh_callback ( glh_window_t window, glh_window_refresh_callback_t callback )
+{
+    /* check glfw is initialised */
+    __GLH_GLFW_INIT_CHECK__ ( 1, -1, "GLH ERROR: glfw must be initialised before setting window refresh callback\n" );
+
+    /* set the callback */
+    glfwSetWindowRefreshCallback ( window, callback );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_get_framebuffer_size
+ *
+ * function to get the size of a window's framebuffer in pixels
+ * unlike glh_get_viewport_size, does not use OpenGL, so does not require the window to be current
+ * 
+ * window: window to get the framebuffer size of
+ * width/height: will be set to the width and height of the framebuffer
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_get_framebuffer_size ( glh_window_t window, int * width, int * height )
+{
+    /* check glfw is initialised */
+    __GLH_GLFW_INIT_CHECK__ ( 1, -1, "GLH ERROR: glfw must be initialised to get framebuffer size\n" );
+
+    /* get framebuffer size */
+    glfwGetFramebufferSize ( window, width, height );
+
+    /* return 0 for success */
+    return 0;
+}
+
 /* glh_should_window_close
  *
  * function to determine if window should close
@@ -322,6 +465,31 @@ int glh_set_window_should_close ( glh_window_t window )
     return 0;
 }
 
+/* glh_set_swap_interval
+ *
+ * set the number of display refreshes to wait for before swapping the buffers of a window
+ * the window supplied will be set as the current context
+ * 
+ * window: the window to set the swap interval for
+ * interval: the number of refreshes, 1 for vsync, 0 for no waiting
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_set_swap_interval ( glh_window_t window, const int interval )
+{
+    /* check glfw is initialised */
+    __GLH_GLFW_INIT_CHECK__ ( 1, -1, "GLH ERROR: glfw must be initialised before setting the swap interval\n" );
+
+    /* the swap interval applies to the current context, so make the window current */
+    if ( glh_make_window_current ( window ) < 0 ) return -1;
+
+    /* set the swap interval */
+    glfwSwapInterval ( interval );
+
+    /* return 0 for success */
+    return 0;
+}
+
 /* glh_swap_buffers
  *
  * swap the buffers for a window
@@ -340,4 +508,20 @@ int glh_swap_buffers ( glh_window_t window )
 
     /* return 0 for success */
     return 0;
+}
+
+/* glh_get_time
+ *
+ * get the time since glfw was initialised
+ * may be called from any thread
+ *
+ * return: the time in seconds, or 0 on failure
+ */
+double glh_get_time ()
+{
+    /* check glfw is initialised */
+    __GLH_GLFW_INIT_CHECK__ ( 1, 0.0, "GLH ERROR: glfw must be initialised before getting the time\n" );
+
+    /* return the time */
+    return glfwGetTime ();
 }
\ No newline at end of file
@@ -26,6 +26,9 @@
 /* include glhelper_glad.h */
 #include "glhelper_glad.h"
 
+/* include glhelper_state.h */
+#include "glhelper_state.h"
+
 
 
 /* GLOBAL FLAGS AND MACROS */
@@ -36,12 +39,6 @@
  */
 extern volatile int GLH_GLFW_INIT_STATE;
 
-/* volatile size_t GLH_GLFW_CURRENT
- *
- * stores a casted pointer of the window currently loaded into glad, or 0 for not loaded
- */
-extern volatile size_t GLH_GLFW_CURRENT;
-
 /* __GLH_GLFW_INIT_CHECK__
  * 
  * substitiution macro to check if glfw/glad is initiated
@@ -64,6 +61,37 @@ typedef GLFWwindow * glh_window_t;
 /* typedef glh_viewport_size_callback_t -> GLFWframebuffersizefun */
 typedef GLFWframebuffersizefun glh_viewport_size_callback_t;
 
+/* typedef glh_window_refresh_callback_t -> GLFWwindowrefreshfun */
+typedef GLFWwindowrefreshfun glh_window_refresh_callback_t;
+
+
+
+/* STRUCTURES */
+
+/* struct glh_window_data_t
+ *
+ * state kept for each window, stored as the glfw window user pointer
+ */
+typedef struct
+{
+    /* shadow state of the window's context */
+    glh_state_t * state;
+
+    /* whether a drag is in progress, the cursor to show while dragging, and the drag callback */
+    int drag_active;
+    GLFWcursor * drag_style;
+    void ( * drag_callback ) ( glh_window_t, double, double );
+
+    /* the cursor position at the previous drag event */
+    double drag_prev_xpos;
+    double drag_prev_ypos;
+
+    /* pointer set by the application with glh_set_window_user_pointer */
+    void * user_pointer;
+
+} glh_window_data_t;
+
+
 
 /* FUNCTIONS */
 
@@ -108,7 +136,7 @@ glh_window_t glh_create_window ( const char * title, const int width, const int
  /* glh_make_window_current
   *
   * make a window the current window for OpenGL
-  * quite expensive so don't over-use
+  * does nothing if the window is already current on the calling thread
   * 
   * window: the window to set as the curren t OpenGL context
   *
@@ -116,6 +144,47 @@ glh_window_t glh_create_window ( const char * title, const int width, const int
   */
 int glh_make_window_current ( glh_window_t window );
 
+/* glh_release_window_current
+ *
+ * release the current window's OpenGL context from the calling thread
+ * this allows another thread to make the window current
+ *
+ * return: 0 on success, -1 on failure
+ */
+int glh_release_window_current ();
+
+/* glh_get_window_data
+ *
+ * get the state kept for a window
+ *
+ * window: the window to get the state of
+ *
+ * return: the window's state, or NULL on failure
+ */
+glh_window_data_t * glh_get_window_data ( glh_window_t window );
+
+/* glh_set_window_user_pointer
+ *
+ * set a pointer for the application to associate with a window
+ * the glfw user pointer is used by glhelper, so should not be set directly
+ *
+ * window: the window to set the pointer of
+ * pointer: the pointer
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_set_window_user_pointer ( glh_window_t window, void * pointer );
+
+/* glh_get_window_user_pointer
+ *
+ * get the pointer set with glh_set_window_user_pointer
+ *
+ * window: the window to get the pointer of
+ *
+ * return: the pointer, or NULL if it has not been set
+ */
+void * glh_get_window_user_pointer ( glh_window_t window );
+
 /* glh_set_window_size
  *
  * function to alter size of window
@@ -162,6 +231,30 @@ void __glh_set_viewport_size ( glh_window_t window, const int xscale, const int
  */
 int glh_get_viewport_size ( glh_window_t window, int * viewport_size ); 
 
+/* glh_set_window_refresh_callback
+ *
+ * function to set the callback for when the contents of the window have been damaged and need to be redrawn
+ * 
+ * window: the window to set the callback for
+ * callback: function pointer to the callback (may be NULL to remove the callback)
+ *           void ( glh_window_t window )
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_set_window_refresh_callback ( glh_window_t window, glh_window_refresh_callback_t callback );
+
+/* glh_get_framebuffer_size
+ *
+ * function to get the size of a window's framebuffer in pixels
+ * unlike glh_get_viewport_size, does not use OpenGL, so does not require the window to be current
+ * 
+ * window: window to get the framebuffer size of
+ * width/height: will be set to the width and height of the framebuffer
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_get_framebuffer_size ( glh_window_t window, int * width, int * height );
+
 /* glh_should_window_close
  *
  * function to determine if window should close
@@ -182,6 +275,18 @@ int glh_should_window_close ( glh_window_t window );
  */
 int glh_set_window_should_close ( glh_window_t window );
 
+/* glh_set_swap_interval
+ *
+ * set the number of display refreshes to wait for before swapping the buffers of a window
+ * the window supplied will be set as the current context
+ * 
+ * window: the window to set the swap interval for
+ * interval: the number of refreshes, 1 for vsync, 0 for no waiting
+ * 
+ * return: 0 for success, -1 for failure
+ */
+int glh_set_swap_interval ( glh_window_t window, const int interval );
+
 /* glh_swap_buffers
  *
  * swap the buffers for a window
@@ -192,6 +297,15 @@ int glh_set_window_should_close ( glh_window_t window );
  */
 int glh_swap_buffers ( glh_window_t window );
 
+/* glh_get_time
+ *
+ * get the time since glfw was initialised
+ * may be called from any thread
+ *
+ * return: the time in seconds, or 0 on failure
+ */
+double glh_get_time ();
+
 
 
 /* ifndef GLHELPER_H_INCLUDED */
@@ -208,7 +208,8 @@ int glh_delete_shader_program ( const glh_object_t shader_program )
     /* check glad has been initialised */
     __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised in order to delete a shader program\n" );
 
-    /* delete shader program */
+    /* forget then delete shader program */
+    __glh_state_forget_object ( shader_program, GLH_STATE_OBJECT_PROGRAM );
     glDeleteProgram ( shader_program );
 
     /* return 0 for success */
@@ -228,8 +229,8 @@ int glh_use_shader_program ( const glh_object_t shader_program )
     /* check glad has been initialised */
    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised in order to delete a shader program\n" );
 
-    /* set shader program as the one to be used */
-    glUseProgram ( shader_program );
+    /* set shader program as the one to be used, unless it already is */
+    __glh_state_use_program ( shader_program );
 
     /* return 0 for success */
     return 0;
@@ -30,6 +30,9 @@
 /* include glhelper_glad.h */
 #include "glhelper_glad.h"
 
+/* include glhelper_state.h */
+#include "glhelper_state.h"
+
 
 
 /* GLOBAL FLAGS AND MACROS */
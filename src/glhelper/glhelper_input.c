@@ -12,29 +12,6 @@
 
 
 
-/* GLOBAL FLAGS AND MACROS */
-
-/* volatile int GLH_DRAG_ACTIVE
- * 
- * will be zero or one to define if drag mode is active
- * is used by glh_set_mouse_drag_callback to determine when a drag event is occuring
- */
-volatile int GLH_DRAG_ACTIVE = 0;
-
-/* volatile size_t GLH_DRAG_STYLE
- *
- * stores a pointer to a cursor object to change the cursor to when dragging is occuring
- */
-volatile size_t GLH_DRAG_STYLE = 0;
-
-/* volatile size_t GLH_DRAG_CALLBACK
- *
- * stores a pointer to the current drag callback
- */
-volatile size_t GLH_DRAG_CALLBACK = 0;
-
-
-
 /* FUNCTION IMPLEMENTATIONS */
 
 /* glh_poll_events
@@ -158,13 +135,17 @@ int glh_set_mouse_drag_calback ( glh_window_t window, glh_cursor_t cursor_style,
     /* check glfw is initialised */
     __GLH_GLFW_INIT_CHECK__ ( 1, -1, "GLH ERROR: glfw must be initialised before setting a mouse drag callback function\n" );
 
+    /* get the window's state, where the drag state is kept */
+    glh_window_data_t * data = glh_get_window_data ( window );
+    if ( !data ) return -1;
+
     /* if callback is not NULL */
     if ( callback )
     {
-        /* set globals */
-        GLH_DRAG_ACTIVE = 0;
-        GLH_DRAG_STYLE = ( size_t ) cursor_style;
-        GLH_DRAG_CALLBACK = ( size_t ) callback;
+        /* set drag state */
+        data->drag_active = 0;
+        data->drag_style = cursor_style;
+        data->drag_callback = callback;
     
         /* set other callbacks */
         glh_set_mouse_move_callback ( window, __glh_mouse_drag_move_callback );
@@ -172,10 +153,10 @@ int glh_set_mouse_drag_calback ( glh_window_t window, glh_cursor_t cursor_style,
     } else
     /* else */
     {
-        /* unset globals */
-        GLH_DRAG_ACTIVE = 0;
-        GLH_DRAG_STYLE = 0;
-        GLH_DRAG_CALLBACK = 0;
+        /* unset drag state */
+        data->drag_active = 0;
+        data->drag_style = NULL;
+        data->drag_callback = NULL;
 
         /* unset other callbacks */
         glh_set_mouse_move_callback ( window, NULL );
@@ -191,32 +172,36 @@ int glh_set_mouse_drag_calback ( glh_window_t window, glh_cursor_t cursor_style,
 
 void __glh_mouse_drag_move_callback ( glh_window_t window, const double xpos, const double ypos )
 {
-    /* static variables for previous positions */
-    static double prev_xpos = 0;
-    static double prev_ypos = 0;
+    /* get the window's state, where the drag state is kept */
+    glh_window_data_t * data = glh_get_window_data ( window );
+    if ( !data ) return;
 
     /* if drag not active, set the previous positions and return */
-    if ( GLH_DRAG_ACTIVE == 0 )
+    if ( data->drag_active == 0 )
     {
-        prev_xpos = xpos;
-        prev_ypos = ypos;
+        data->drag_prev_xpos = xpos;
+        data->drag_prev_ypos = ypos;
         return;
     }
 
     /* else calculate the xdrag and ydrag */
-    const double xdrag = xpos - prev_xpos;
-    const double ydrag = ypos - prev_ypos;
+    const double xdrag = xpos - data->drag_prev_xpos;
+    const double ydrag = ypos - data->drag_prev_ypos;
 
     /* set the previous positions */
-    prev_xpos = xpos;
-    prev_ypos = ypos;
+    data->drag_prev_xpos = xpos;
+    data->drag_prev_ypos = ypos;
 
     /* call drag callback, if not NULL */
-    if ( GLH_DRAG_CALLBACK > 0 ) ( * ( glh_mouse_drag_callback_t ) GLH_DRAG_CALLBACK ) ( window, xdrag, ydrag );
+    if ( data->drag_callback ) data->drag_callback ( window, xdrag, ydrag );
 }
 
 void __glh_mouse_drag_button_callback ( glh_window_t window, const int button, const int action, const int mods )
 {
+    /* get the window's state, where the drag state is kept */
+    glh_window_data_t * data = glh_get_window_data ( window );
+    if ( !data ) return;
+
     /* check for left mouse button */
     if ( button == GLFW_MOUSE_BUTTON_LEFT )
     {
@@ -224,15 +209,15 @@ void __glh_mouse_drag_button_callback ( glh_window_t window, const int button, c
         if ( action == GLFW_PRESS )
         {
             /* set drag to on */
-            GLH_DRAG_ACTIVE = 1;
+            data->drag_active = 1;
 
             /* change cursor to drag cursor */
-            glh_set_cursor ( window, ( glh_cursor_t ) GLH_DRAG_STYLE );
+            glh_set_cursor ( window, data->drag_style );
         } else
         /* else */
         {
             /* set drag to off */
-            GLH_DRAG_ACTIVE = 0;
+            data->drag_active = 0;
 
             /* change cursor to default */
             glh_set_cursor ( window, NULL );
@@ -0,0 +1,379 @@
+/*
+ * glhelper_query.c
+ *
+ * implementation of glhelper_query.h
+ *
+ */
+
+
+
+/* include glhelper_query.h */
+#include "glhelper_query.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* glh_create_query
+ *
+ * creates a query object
+ *
+ * return: query ID >= 0 for success, -1 for failure
+ */
+glh_object_t glh_create_query ()
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before creating a query\n" );
+
+    /* create object */
+    glh_object_t query;
+    glGenQueries ( 1, &query );
+
+    /* return the query */
+    return query;
+}
+
+/* glh_delete_query
+ *
+ * deletes a query object
+ *
+ * query: the query to delete
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_delete_query ( const glh_object_t query )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before deleting a query\n" );
+
+    /* delete the query */
+    glDeleteQueries ( 1, &query );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_begin_query
+ *
+ * begin a query
+ * only one query per target may be active at once
+ *
+ * query: the query to begin
+ * target: the target of the query (GLH_QUERY_TIME_ELAPSED)
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_begin_query ( const glh_object_t query, const glh_type_t target )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before beginning a query\n" );
+
+    /* begin the query */
+    glBeginQuery ( target, query );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_end_query
+ *
+ * end the active query for a target
+ *
+ * target: the target of the query to end
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_end_query ( const glh_type_t target )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before ending a query\n" );
+
+    /* end the query */
+    glEndQuery ( target );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_query_result_available
+ *
+ * check whether the result of a query can be read without stalling
+ *
+ * query: the query to check
+ *
+ * return: 1 if available, 0 if not, -1 for failure
+ */
+int glh_query_result_available ( const glh_object_t query )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before checking a query\n" );
+
+    /* get the availability */
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv ( query, GL_QUERY_RESULT_AVAILABLE, &available );
+
+    /* return the availability */
+    return ( available == GL_TRUE );
+}
+
+/* glh_get_query_result
+ *
+ * get the result of a query
+ * will stall until the result is available, so check glh_query_result_available first
+ *
+ * query: the query to get the result of
+ * result: will be set to the result of the query
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_get_query_result ( const glh_object_t query, uint64_t * result )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before getting a query result\n" );
+
+    /* get the result */
+    GLuint64 value = 0;
+    glGetQueryObjectui64v ( query, GL_QUERY_RESULT, &value );
+    * result = value;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_query_timestamp
+ *
+ * record the gpu time at which all previous commands have completed into a query
+ *
+ * query: the query to record into
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_query_timestamp ( const glh_object_t query )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before recording a timestamp\n" );
+
+    /* record the timestamp */
+    glQueryCounter ( query, GLH_QUERY_TIMESTAMP );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_create_timer_pool
+ *
+ * create a pool of timer queries
+ *
+ * size: the number of queries in the pool
+ * target: the target of the queries (GLH_QUERY_TIME_ELAPSED or GLH_QUERY_TIMESTAMP)
+ *
+ * return: the pool, or NULL on failure
+ */
+glh_timer_pool_t * glh_create_timer_pool ( const int size, const glh_type_t target )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, NULL, "GLH ERROR: glad must be initialised before creating a timer pool\n" );
+
+    /* allocate the pool and its queries */
+    glh_timer_pool_t * pool = malloc ( sizeof ( glh_timer_pool_t ) );
+    glh_object_t * queries = ( size > 0 ? malloc ( size * sizeof ( glh_object_t ) ) : NULL );
+    if ( !pool || !queries )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "GLH ERROR: failed to allocate timer pool\n" );
+        free ( pool );
+        free ( queries );
+        return NULL;
+    }
+
+    /* create the queries */
+    glGenQueries ( size, ( GLuint * ) queries );
+    pool->queries = queries;
+    pool->size = size;
+    pool->target = target;
+    pool->head = 0;
+    pool->pending = 0;
+    pool->active = -1;
+
+    /* return the pool */
+    return pool;
+}
+
+/* glh_destroy_timer_pool
+ *
+ * destroy a pool of timer queries
+ *
+ * pool: the pool to destroy
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_destroy_timer_pool ( glh_timer_pool_t * pool )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before destroying a timer pool\n" );
+
+    /* delete the queries and free the pool */
+    glDeleteQueries ( pool->size, ( GLuint * ) pool->queries );
+    free ( pool->queries );
+    free ( pool );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_timer_pool_free
+ *
+ * find the number of queries of a pool which are free to be handed out
+ *
+ * pool: the pool
+ *
+ * return: the number of free queries
+ */
+int glh_timer_pool_free ( const glh_timer_pool_t * pool )
+{
+    /* return the queries not handed out */
+    return pool->size - pool->pending;
+}
+
+/* glh_timer_pool_begin
+ *
+ * hand out the next query of a pool of GLH_QUERY_TIME_ELAPSED queries and begin timing the gpu time of the commands which follow it
+ * only one query may be timing at once, so end it before beginning another
+ *
+ * pool: the pool
+ *
+ * return: the slot of the query handed out, or -1 if none are free
+ */
+int glh_timer_pool_begin ( glh_timer_pool_t * pool )
+{
+    /* check the pool times elapsed time */
+    if ( pool->target != GLH_QUERY_TIME_ELAPSED )
+    {
+        /* wrong target */
+        fprintf ( stderr, "GLH ERROR: cannot time elapsed time with a pool of timestamps\n" );
+        return -1;
+    }
+
+    /* check the pool has no query timing already */
+    if ( pool->active != -1 )
+    {
+        /* already timing */
+        fprintf ( stderr, "GLH ERROR: cannot begin timing with a pool whose last query has not been ended\n" );
+        return -1;
+    }
+
+    /* hand out the next query, if one is free */
+    if ( pool->pending >= pool->size ) return -1;
+    const int slot = ( pool->head + pool->pending ) % pool->size;
+    ++pool->pending;
+
+    /* begin timing */
+    if ( glh_begin_query ( pool->queries [ slot ], GLH_QUERY_TIME_ELAPSED ) != 0 ) return -1;
+    pool->active = slot;
+
+    /* return the slot */
+    return slot;
+}
+
+/* glh_timer_pool_end
+ *
+ * end the query begun by glh_timer_pool_begin
+ *
+ * pool: the pool, which must have begun the query
+ *
+ * return: 0 for success, -1 for failure, including if the pool has no query timing
+ */
+int glh_timer_pool_end ( glh_timer_pool_t * pool )
+{
+    /* check the pool began the query */
+    if ( pool->active == -1 )
+    {
+        /* nothing to end */
+        fprintf ( stderr, "GLH ERROR: cannot end timing with a pool which has no query timing\n" );
+        return -1;
+    }
+
+    /* end timing */
+    pool->active = -1;
+    return glh_end_query ( GLH_QUERY_TIME_ELAPSED );
+}
+
+/* glh_timer_pool_timestamp
+ *
+ * hand out the next query of a pool of GLH_QUERY_TIMESTAMP queries and record the gpu time at which all previous commands have completed into it
+ *
+ * pool: the pool
+ *
+ * return: the slot of the query handed out, or -1 if none are free
+ */
+int glh_timer_pool_timestamp ( glh_timer_pool_t * pool )
+{
+    /* check the pool records timestamps */
+    if ( pool->target != GLH_QUERY_TIMESTAMP )
+    {
+        /* wrong target */
+        fprintf ( stderr, "GLH ERROR: cannot record a timestamp with a pool timing elapsed time\n" );
+        return -1;
+    }
+
+    /* hand out the next query, if one is free */
+    if ( pool->pending >= pool->size ) return -1;
+    const int slot = ( pool->head + pool->pending ) % pool->size;
+    ++pool->pending;
+
+    /* record the timestamp */
+    if ( glh_query_timestamp ( pool->queries [ slot ] ) != 0 ) return -1;
+
+    /* return the slot */
+    return slot;
+}
+
+/* glh_timer_pool_read
+ *
+ * read the result of a query handed out by a pool, only if it is available, so never stalls
+ *
+ * pool: the pool
+ * slot: the slot of the query
+ * result: will be set to the result in nanoseconds, if available
+ *
+ * return: 1 if read, 0 if not yet available, -1 for failure
+ */
+int glh_timer_pool_read ( const glh_timer_pool_t * pool, const int slot, uint64_t * result )
+{
+    /* check the result is available */
+    const int available = glh_query_result_available ( pool->queries [ slot ] );
+    if ( available != 1 ) return available;
+
+    /* get the result */
+    if ( glh_get_query_result ( pool->queries [ slot ], result ) != 0 ) return -1;
+
+    /* return 1, as the result was read */
+    return 1;
+}
+
+/* glh_timer_pool_release
+ *
+ * release the oldest queries handed out by a pool, so they can be handed out again
+ *
+ * pool: the pool
+ * count: the number of queries to release
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_timer_pool_release ( glh_timer_pool_t * pool, const int count )
+{
+    /* check that many are handed out */
+    if ( count < 0 || count > pool->pending )
+    {
+        /* too many */
+        fprintf ( stderr, "GLH ERROR: cannot release more timer queries than are handed out\n" );
+        return -1;
+    }
+
+    /* release them */
+    pool->head = ( pool->head + count ) % pool->size;
+    pool->pending -= count;
+
+    /* return 0 for success */
+    return 0;
+}
@@ -0,0 +1,236 @@
+/*
+ * glhelper_query.h
+ *
+ * defines functions to handle OpenGL query objects, such as gpu timers
+ *
+ */
+
+
+
+/* pragma one */
+#ifndef GLHELPER_QUERY_H_INCLUDED
+#define GLHELPER_QUERY_H_INCLUDED
+
+
+
+/* INCLUDES */
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdint.h>
+
+/* include glhelper_core.h */
+#include "glhelper_core.h"
+
+/* include glhelper_glad.h */
+#include "glhelper_glad.h"
+
+
+
+/* GLOBAL FLAGS AND MACROS */
+
+/* GLH_QUERY_TIME_ELAPSED
+ *
+ * query target measuring the gpu time taken by the commands between glh_begin_query and glh_end_query, in nanoseconds
+ */
+#define GLH_QUERY_TIME_ELAPSED GL_TIME_ELAPSED
+
+/* GLH_QUERY_TIMESTAMP
+ *
+ * query target recording the gpu time in nanoseconds at which all previous commands have completed
+ */
+#define GLH_QUERY_TIMESTAMP GL_TIMESTAMP
+
+
+
+/* STRUCTURES */
+
+/* struct glh_timer_pool_t
+ *
+ * a ring of timer queries of a single target, handed out in order and released oldest first
+ * queries are read back only once available, so timing never stalls the pipeline
+ * a query's target is fixed once it is first used, so time elapsed and timestamps need separate pools
+ */
+typedef struct
+{
+    /* the queries, how many there are, and their target (GLH_QUERY_TIME_ELAPSED or GLH_QUERY_TIMESTAMP) */
+    glh_object_t * queries;
+    int size;
+    glh_type_t target;
+
+    /* the oldest query handed out, and the number handed out and not yet released */
+    int head;
+    int pending;
+
+    /* the slot of the query begun by glh_timer_pool_begin and not yet ended, or -1 if none is timing */
+    int active;
+
+} glh_timer_pool_t;
+
+
+
+/* FUNCTIONS */
+
+/* glh_create_query
+ *
+ * creates a query object
+ *
+ * return: query ID >= 0 for success, -1 for failure
+ */
+glh_object_t glh_create_query ();
+
+/* glh_delete_query
+ *
+ * deletes a query object
+ *
+ * query: the query to delete
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_delete_query ( const glh_object_t query );
+
+/* glh_begin_query
+ *
+ * begin a query
+ * only one query per target may be active at once
+ *
+ * query: the query to begin
+ * target: the target of the query (GLH_QUERY_TIME_ELAPSED)
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_begin_query ( const glh_object_t query, const glh_type_t target );
+
+/* glh_end_query
+ *
+ * end the active query for a target
+ *
+ * target: the target of the query to end
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_end_query ( const glh_type_t target );
+
+/* glh_query_result_available
+ *
+ * check whether the result of a query can be read without stalling
+ *
+ * query: the query to check
+ *
+ * return: 1 if available, 0 if not, -1 for failure
+ */
+int glh_query_result_available ( const glh_object_t query );
+
+/* glh_get_query_result
+ *
+ * get the result of a query
+ * will stall until the result is available, so check glh_query_result_available first
+ *
+ * query: the query to get the result of
+ * result: will be set to the result of the query
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_get_query_result ( const glh_object_t query, uint64_t * result );
+
+/* glh_query_timestamp
+ *
+ * record the gpu time at which all previous commands have completed into a query
+ *
+ * query: the query to record into
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_query_timestamp ( const glh_object_t query );
+
+/* glh_create_timer_pool
+ *
+ * create a pool of timer queries
+ *
+ * size: the number of queries in the pool
+ * target: the target of the queries (GLH_QUERY_TIME_ELAPSED or GLH_QUERY_TIMESTAMP)
+ *
+ * return: the pool, or NULL on failure
+ */
+glh_timer_pool_t * glh_create_timer_pool ( const int size, const glh_type_t target );
+
+/* glh_destroy_timer_pool
+ *
+ * destroy a pool of timer queries
+ *
+ * pool: the pool to destroy
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_destroy_timer_pool ( glh_timer_pool_t * pool );
+
+/* glh_timer_pool_free
+ *
+ * find the number of queries of a pool which are free to be handed out
+ *
+ * pool: the pool
+ *
+ * return: the number of free queries
+ */
+int glh_timer_pool_free ( const glh_timer_pool_t * pool );
+
+/* glh_timer_pool_begin
+ *
+ * hand out the next query of a pool of GLH_QUERY_TIME_ELAPSED queries and begin timing the gpu time of the commands which follow it
+ * only one query may be timing at once, so end it before beginning another
+ *
+ * pool: the pool
+ *
+ * return: the slot of the query handed out, or -1 if none are free
+ */
+int glh_timer_pool_begin ( glh_timer_pool_t * pool );
+
+/* glh_timer_pool_end
+ *
+ * end the query begun by glh_timer_pool_begin
+ *
+ * pool: the pool, which must have begun the query
+ *
+ * return: 0 for success, -1 for failure, including if the pool has no query timing
+ */
+int glh_timer_pool_end ( glh_timer_pool_t * pool );
+
+/* glh_timer_pool_timestamp
+ *
+ * hand out the next query of a pool of GLH_QUERY_TIMESTAMP queries and record the gpu time at which all previous commands have completed into it
+ *
+ * pool: the pool
+ *
+ * return: the slot of the query handed out, or -1 if none are free
+ */
+int glh_timer_pool_timestamp ( glh_timer_pool_t * pool );
+
+/* glh_timer_pool_read
+ *
+ * read the result of a query handed out by a pool, only if it is available, so never stalls
+ *
+ * pool: the pool
+ * slot: the slot of the query
+ * result: will be set to the result in nanoseconds, if available
+ *
+ * return: 1 if read, 0 if not yet available, -1 for failure
+ */
+int glh_timer_pool_read ( const glh_timer_pool_t * pool, const int slot, uint64_t * result );
+
+/* glh_timer_pool_release
+ *
+ * release the oldest queries handed out by a pool, so they can be handed out again
+ *
+ * pool: the pool
+ * count: the number of queries to release
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_timer_pool_release ( glh_timer_pool_t * pool, const int count );
+
+
+
+/* #ifndef GLHELPER_QUERY_H_INCLUDED */
+#endif
@@ -0,0 +1,402 @@
+/*
+ * glhelper_state.c
+ *
+ * implementation of glhelper_state.h
+ *
+ */
+
+
+
+/* include glhelper_state.h */
+#include "glhelper_state.h"
+
+
+
+/* GLOBAL FLAGS */
+
+/* glh_state_t * GLH_STATE_CURRENT
+ *
+ * the shadow state of the context current on this thread, or NULL if there is none
+ * thread-local, as each thread has its own current context
+ */
+static __thread glh_state_t * GLH_STATE_CURRENT = NULL;
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* glh_create_state
+ *
+ * create a shadow state with every binding unknown
+ *
+ * return: the new state, or NULL on failure
+ */
+glh_state_t * glh_create_state ()
+{
+    /* allocate the state */
+    glh_state_t * state = malloc ( sizeof ( glh_state_t ) );
+    if ( !state )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "GLH ERROR: failed to allocate memory for state\n" );
+        return NULL;
+    }
+
+    /* set every binding to unknown and the counter to 0 */
+    state->program = GLH_STATE_UNKNOWN;
+    state->vertex_array = GLH_STATE_UNKNOWN;
+    for ( int i = 0; i < GLH_STATE_BUFFER_TARGETS; ++i ) state->buffers [ i ] = GLH_STATE_UNKNOWN;
+    for ( int i = 0; i < GLH_STATE_UNIFORM_BINDINGS; ++i ) state->uniform_bindings [ i ] = GLH_STATE_UNKNOWN;
+    state->read_framebuffer = GLH_STATE_UNKNOWN;
+    state->draw_framebuffer = GLH_STATE_UNKNOWN;
+    state->texture_2d = GLH_STATE_UNKNOWN;
+    state->elided_calls = 0;
+
+    /* return the state */
+    return state;
+}
+
+/* glh_destroy_state
+ *
+ * destroy a shadow state
+ * if it is the calling thread's current state, the thread is left with no current state
+ *
+ * state: the state to destroy
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_destroy_state ( glh_state_t * state )
+{
+    /* if current, leave the thread with no current state */
+    if ( GLH_STATE_CURRENT == state ) GLH_STATE_CURRENT = NULL;
+
+    /* free the state */
+    free ( state );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_set_current_state
+ *
+ * set the shadow state of the context current on the calling thread
+ * if NULL, no calls are skipped
+ *
+ * state: the state to make current, or NULL
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_set_current_state ( glh_state_t * state )
+{
+    /* set the current state */
+    GLH_STATE_CURRENT = state;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_get_current_state
+ *
+ * get the shadow state of the context current on the calling thread
+ *
+ * return: the current state, or NULL if there is none
+ */
+glh_state_t * glh_get_current_state ()
+{
+    /* return the current state */
+    return GLH_STATE_CURRENT;
+}
+
+/* glh_invalidate_state
+ *
+ * mark every binding of the current state as unknown
+ * should be called after changing bindings without going through glhelper
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_invalidate_state ()
+{
+    /* if there is no current state, there is nothing to invalidate */
+    glh_state_t * state = GLH_STATE_CURRENT;
+    if ( !state ) return 0;
+
+    /* set every binding to unknown, keeping the counter */
+    state->program = GLH_STATE_UNKNOWN;
+    state->vertex_array = GLH_STATE_UNKNOWN;
+    for ( int i = 0; i < GLH_STATE_BUFFER_TARGETS; ++i ) state->buffers [ i ] = GLH_STATE_UNKNOWN;
+    for ( int i = 0; i < GLH_STATE_UNIFORM_BINDINGS; ++i ) state->uniform_bindings [ i ] = GLH_STATE_UNKNOWN;
+    state->read_framebuffer = GLH_STATE_UNKNOWN;
+    state->draw_framebuffer = GLH_STATE_UNKNOWN;
+    state->texture_2d = GLH_STATE_UNKNOWN;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_get_elided_calls
+ *
+ * get the number of calls skipped by the current state since it was created
+ *
+ * return: the number of calls skipped, or 0 if there is no current state
+ */
+unsigned long glh_get_elided_calls ()
+{
+    /* return the counter of the current state, if there is one */
+    return ( GLH_STATE_CURRENT ? GLH_STATE_CURRENT->elided_calls : 0 );
+}
+
+/* __glh_state_elide
+ *
+ * count a call skipped as it would not have changed any state
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_elide ()
+{
+    /* increment the counter of the current state, if there is one */
+    if ( GLH_STATE_CURRENT ) ++GLH_STATE_CURRENT->elided_calls;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __glh_state_use_program
+ *
+ * use a shader program, unless already in use
+ *
+ * program: the program to use
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_use_program ( const glh_object_t program )
+{
+    /* get the current state */
+    glh_state_t * state = GLH_STATE_CURRENT;
+
+    /* skip if already in use */
+    if ( state && state->program == program ) return __glh_state_elide ();
+
+    /* use the program and record it */
+    glUseProgram ( program );
+    if ( state ) state->program = program;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __glh_state_bind_vertex_array
+ *
+ * bind a vertex array object, unless already bound
+ * the element array buffer binding is part of the vertex array object, so becomes unknown when a different one is bound
+ *
+ * vao: the vertex array object to bind
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_bind_vertex_array ( const glh_object_t vao )
+{
+    /* get the current state */
+    glh_state_t * state = GLH_STATE_CURRENT;
+
+    /* skip if already bound */
+    if ( state && state->vertex_array == vao ) return __glh_state_elide ();
+
+    /* bind the vertex array and record it, forgetting the element array buffer */
+    glBindVertexArray ( vao );
+    if ( state )
+    {
+        state->vertex_array = vao;
+        state->buffers [ __glh_state_buffer_index ( GL_ELEMENT_ARRAY_BUFFER ) ] = GLH_STATE_UNKNOWN;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __glh_state_buffer_index
+ *
+ * find the index into buffers of the shadow state for a buffer target
+ *
+ * target: the buffer target
+ *
+ * return: the index, or -1 if the target is not tracked
+ */
+int __glh_state_buffer_index ( const glh_type_t target )
+{
+    /* switch on the target */
+    switch ( target )
+    {
+        case GL_ARRAY_BUFFER: return 0;
+        case GL_ELEMENT_ARRAY_BUFFER: return 1;
+        case GL_UNIFORM_BUFFER: return 2;
+        case GL_COPY_WRITE_BUFFER: return 3;
+        case GL_PIXEL_PACK_BUFFER: return 4;
+        default: return -1;
+    }
+}
+
+/* __glh_state_bind_buffer
+ *
+ * bind a buffer to a target, unless already bound
+ *
+ * target: the target to bind to
+ * buffer: the buffer to bind
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_bind_buffer ( const glh_type_t target, const glh_object_t buffer )
+{
+    /* get the current state and the index of the target */
+    glh_state_t * state = GLH_STATE_CURRENT;
+    const int index = __glh_state_buffer_index ( target );
+
+    /* skip if already bound */
+    if ( state && index >= 0 && state->buffers [ index ] == buffer ) return __glh_state_elide ();
+
+    /* bind the buffer and record it */
+    glBindBuffer ( target, buffer );
+    if ( state && index >= 0 ) state->buffers [ index ] = buffer;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __glh_state_bind_uniform_buffer_base
+ *
+ * bind a buffer to an indexed uniform buffer binding point, unless already bound
+ * this also binds the buffer to the generic uniform buffer target
+ *
+ * binding: the binding point
+ * buffer: the buffer to bind
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_bind_uniform_buffer_base ( const int binding, const glh_object_t buffer )
+{
+    /* get the current state, and whether the binding point is tracked */
+    glh_state_t * state = GLH_STATE_CURRENT;
+    const int tracked = ( state && binding >= 0 && binding < GLH_STATE_UNIFORM_BINDINGS );
+
+    /* skip if already bound */
+    if ( tracked && state->uniform_bindings [ binding ] == buffer ) return __glh_state_elide ();
+
+    /* bind the buffer and record it */
+    glBindBufferBase ( GL_UNIFORM_BUFFER, binding, buffer );
+    if ( state ) state->buffers [ __glh_state_buffer_index ( GL_UNIFORM_BUFFER ) ] = buffer;
+    if ( tracked ) state->uniform_bindings [ binding ] = buffer;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __glh_state_bind_framebuffer
+ *
+ * bind a framebuffer, unless already bound
+ *
+ * target: GL_FRAMEBUFFER, GL_READ_FRAMEBUFFER or GL_DRAW_FRAMEBUFFER
+ * fbo: the framebuffer to bind
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_bind_framebuffer ( const glh_type_t target, const glh_object_t fbo )
+{
+    /* get the current state, and which of the read and draw bindings the target covers */
+    glh_state_t * state = GLH_STATE_CURRENT;
+    const int read = ( target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER );
+    const int draw = ( target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER );
+
+    /* skip if already bound */
+    if ( state && ( !read || state->read_framebuffer == fbo ) && ( !draw || state->draw_framebuffer == fbo ) ) return __glh_state_elide ();
+
+    /* bind the framebuffer and record it */
+    glBindFramebuffer ( target, fbo );
+    if ( state && read ) state->read_framebuffer = fbo;
+    if ( state && draw ) state->draw_framebuffer = fbo;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __glh_state_bind_texture_2d
+ *
+ * bind a 2d texture, unless already bound
+ *
+ * texture: the texture to bind
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_bind_texture_2d ( const glh_object_t texture )
+{
+    /* get the current state */
+    glh_state_t * state = GLH_STATE_CURRENT;
+
+    /* skip if already bound */
+    if ( state && state->texture_2d == texture ) return __glh_state_elide ();
+
+    /* bind the texture and record it */
+    glBindTexture ( GL_TEXTURE_2D, texture );
+    if ( state ) state->texture_2d = texture;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __glh_state_forget_object
+ *
+ * update the current state for an object about to be deleted
+ * deleting an object bound in the current context unbinds it, and its name may then be reused
+ *
+ * object: the object being deleted
+ * type: the type of the object (GLH_STATE_OBJECT_X)
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_forget_object ( const glh_object_t object, const int type )
+{
+    /* if there is no current state, there is nothing to forget */
+    glh_state_t * state = GLH_STATE_CURRENT;
+    if ( !state ) return 0;
+
+    /* switch on the type */
+    switch ( type )
+    {
+        /* a program in use is only deleted once no longer in use, so its binding becomes unknown */
+        case GLH_STATE_OBJECT_PROGRAM:
+            if ( state->program == object ) state->program = GLH_STATE_UNKNOWN;
+            break;
+
+        /* a bound vertex array reverts to 0, along with its element array buffer */
+        case GLH_STATE_OBJECT_VERTEX_ARRAY:
+            if ( state->vertex_array == object )
+            {
+                state->vertex_array = 0;
+                state->buffers [ __glh_state_buffer_index ( GL_ELEMENT_ARRAY_BUFFER ) ] = GLH_STATE_UNKNOWN;
+            }
+            break;
+
+        /* a bound buffer reverts to 0 on every target */
+        case GLH_STATE_OBJECT_BUFFER:
+            for ( int i = 0; i < GLH_STATE_BUFFER_TARGETS; ++i ) if ( state->buffers [ i ] == object ) state->buffers [ i ] = 0;
+            for ( int i = 0; i < GLH_STATE_UNIFORM_BINDINGS; ++i ) if ( state->uniform_bindings [ i ] == object ) state->uniform_bindings [ i ] = 0;
+            break;
+
+        /* a bound framebuffer reverts to 0 */
+        case GLH_STATE_OBJECT_FRAMEBUFFER:
+            if ( state->read_framebuffer == object ) state->read_framebuffer = 0;
+            if ( state->draw_framebuffer == object ) state->draw_framebuffer = 0;
+            break;
+
+        /* a bound texture reverts to 0 */
+        case GLH_STATE_OBJECT_TEXTURE:
+            if ( state->texture_2d == object ) state->texture_2d = 0;
+            break;
+
+        /* unknown type */
+        default:
+            fprintf ( stderr, "GLH ERROR: unknown object type to forget\n" );
+            return -1;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
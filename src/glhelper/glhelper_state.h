@@ -0,0 +1,254 @@
+/*
+ * glhelper_state.h
+ *
+ * defines a shadow copy of the OpenGL state of a context
+ * used by glhelper to skip calls which would not change any state
+ *
+ */
+
+
+
+/* pragma one */
+#ifndef GLHELPER_STATE_H_INCLUDED
+#define GLHELPER_STATE_H_INCLUDED
+
+
+
+/* INCLUDES */
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* include glhelper_core.h */
+#include "glhelper_core.h"
+
+/* include glhelper_glad.h */
+#include "glhelper_glad.h"
+
+
+
+/* GLOBAL FLAGS AND MACROS */
+
+/* GLH_STATE_UNKNOWN
+ *
+ * the value of a binding in the shadow state when the real binding is not known
+ */
+#define GLH_STATE_UNKNOWN -1
+
+/* GLH_STATE_BUFFER_TARGETS
+ *
+ * the number of buffer targets whose bindings are tracked
+ */
+#define GLH_STATE_BUFFER_TARGETS 5
+
+/* GLH_STATE_UNIFORM_BINDINGS
+ *
+ * the number of indexed uniform buffer binding points which are tracked
+ */
+#define GLH_STATE_UNIFORM_BINDINGS 16
+
+/* GLH_STATE_OBJECT_X
+ *
+ * the types of object which can be forgotten by __glh_state_forget_object
+ */
+#define GLH_STATE_OBJECT_PROGRAM 0
+#define GLH_STATE_OBJECT_VERTEX_ARRAY 1
+#define GLH_STATE_OBJECT_BUFFER 2
+#define GLH_STATE_OBJECT_FRAMEBUFFER 3
+#define GLH_STATE_OBJECT_TEXTURE 4
+
+
+
+/* STRUCTURES */
+
+/* struct glh_state_t
+ *
+ * shadow copy of the bindings of a single context
+ * each binding is the bound object, or GLH_STATE_UNKNOWN
+ */
+typedef struct
+{
+    /* the program in use */
+    glh_object_t program;
+
+    /* the bound vertex array object */
+    glh_object_t vertex_array;
+
+    /* the bound buffers, indexed by __glh_state_buffer_index */
+    glh_object_t buffers [ GLH_STATE_BUFFER_TARGETS ];
+
+    /* the buffers bound to each indexed uniform buffer binding point */
+    glh_object_t uniform_bindings [ GLH_STATE_UNIFORM_BINDINGS ];
+
+    /* the bound read and draw framebuffers */
+    glh_object_t read_framebuffer;
+    glh_object_t draw_framebuffer;
+
+    /* the bound 2d texture */
+    glh_object_t texture_2d;
+
+    /* the number of calls which were skipped as they would not have changed any state */
+    unsigned long elided_calls;
+
+} glh_state_t;
+
+
+
+/* FUNCTIONS */
+
+/* glh_create_state
+ *
+ * create a shadow state with every binding unknown
+ *
+ * return: the new state, or NULL on failure
+ */
+glh_state_t * glh_create_state ();
+
+/* glh_destroy_state
+ *
+ * destroy a shadow state
+ * if it is the calling thread's current state, the thread is left with no current state
+ *
+ * state: the state to destroy
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_destroy_state ( glh_state_t * state );
+
+/* glh_set_current_state
+ *
+ * set the shadow state of the context current on the calling thread
+ * if NULL, no calls are skipped
+ *
+ * state: the state to make current, or NULL
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_set_current_state ( glh_state_t * state );
+
+/* glh_get_current_state
+ *
+ * get the shadow state of the context current on the calling thread
+ *
+ * return: the current state, or NULL if there is none
+ */
+glh_state_t * glh_get_current_state ();
+
+/* glh_invalidate_state
+ *
+ * mark every binding of the current state as unknown
+ * should be called after changing bindings without going through glhelper
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_invalidate_state ();
+
+/* glh_get_elided_calls
+ *
+ * get the number of calls skipped by the current state since it was created
+ *
+ * return: the number of calls skipped, or 0 if there is no current state
+ */
+unsigned long glh_get_elided_calls ();
+
+/* __glh_state_elide
+ *
+ * count a call skipped as it would not have changed any state
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_elide ();
+
+/* __glh_state_use_program
+ *
+ * use a shader program, unless already in use
+ *
+ * program: the program to use
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_use_program ( const glh_object_t program );
+
+/* __glh_state_bind_vertex_array
+ *
+ * bind a vertex array object, unless already bound
+ * the element array buffer binding is part of the vertex array object, so becomes unknown when a different one is bound
+ *
+ * vao: the vertex array object to bind
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_bind_vertex_array ( const glh_object_t vao );
+
+/* __glh_state_buffer_index
+ *
+ * find the index into buffers of the shadow state for a buffer target
+ *
+ * target: the buffer target
+ *
+ * return: the index, or -1 if the target is not tracked
+ */
+int __glh_state_buffer_index ( const glh_type_t target );
+
+/* __glh_state_bind_buffer
+ *
+ * bind a buffer to a target, unless already bound
+ *
+ * target: the target to bind to
+ * buffer: the buffer to bind
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_bind_buffer ( const glh_type_t target, const glh_object_t buffer );
+
+/* __glh_state_bind_uniform_buffer_base
+ *
+ * bind a buffer to an indexed uniform buffer binding point, unless already bound
+ * this also binds the buffer to the generic uniform buffer target
+ *
+ * binding: the binding point
+ * buffer: the buffer to bind
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_bind_uniform_buffer_base ( const int binding, const glh_object_t buffer );
+
+/* __glh_state_bind_framebuffer
+ *
+ * bind a framebuffer, unless already bound
+ *
+ * target: GL_FRAMEBUFFER, GL_READ_FRAMEBUFFER or GL_DRAW_FRAMEBUFFER
+ * fbo: the framebuffer to bind
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_bind_framebuffer ( const glh_type_t target, const glh_object_t fbo );
+
+/* __glh_state_bind_texture_2d
+ *
+ * bind a 2d texture, unless already bound
+ *
+ * texture: the texture to bind
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_bind_texture_2d ( const glh_object_t texture );
+
+/* __glh_state_forget_object
+ *
+ * update the current state for an object about to be deleted
+ * deleting an object bound in the current context unbinds it, and its name may then be reused
+ *
+ * object: the object being deleted
+ * type: the type of the object (GLH_STATE_OBJECT_X)
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __glh_state_forget_object ( const glh_object_t object, const int type );
+
+
+
+/* #ifndef GLHELPER_STATE_H_INCLUDED */
+#endif
@@ -0,0 +1,89 @@
+/*
+ * glhelper_sync.c
+ *
+ * implementation of glhelper_sync.h
+ *
+ */
+
+
+
+/* include glhelper_sync.h */
+#include "glhelper_sync.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* glh_create_fence
+ *
+ * creates a fence, which is signalled once all commands issued before it have completed
+ * the commands are flushed, so that the fence is eventually signalled
+ *
+ * return: the fence for success, NULL for failure
+ */
+glh_sync_t glh_create_fence ()
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, NULL, "GLH ERROR: glad must be initialised before creating a fence\n" );
+
+    /* create the fence and flush the commands before it */
+    glh_sync_t fence = glFenceSync ( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+    glFlush ();
+
+    /* check success */
+    if ( !fence ) fprintf ( stderr, "GLH ERROR: failed to create fence\n" );
+
+    /* return the fence */
+    return fence;
+}
+
+/* glh_delete_fence
+ *
+ * deletes a fence
+ *
+ * fence: the fence to delete
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_delete_fence ( glh_sync_t fence )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before deleting a fence\n" );
+
+    /* delete the fence */
+    glDeleteSync ( fence );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* glh_wait_fence
+ *
+ * wait for a fence to be signalled
+ *
+ * fence: the fence to wait for
+ * timeout: the maximum time to wait in nanoseconds, or 0 to only check whether it has been signalled
+ *
+ * return: 1 if signalled, 0 if not signalled within the timeout, -1 for failure
+ */
+int glh_wait_fence ( glh_sync_t fence, const uint64_t timeout )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "GLH ERROR: glad must be initialised before waiting for a fence\n" );
+
+    /* wait for the fence */
+    switch ( glClientWaitSync ( fence, 0, timeout ) )
+    {
+        /* signalled */
+        case GL_ALREADY_SIGNALED:
+        case GL_CONDITION_SATISFIED: return 1;
+
+        /* not yet signalled */
+        case GL_TIMEOUT_EXPIRED: return 0;
+
+        /* failed */
+        default:
+            fprintf ( stderr, "GLH ERROR: failed to wait for fence\n" );
+            return -1;
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * glhelper_sync.h
+ *
+ * defines functions to handle OpenGL sync objects, used to find when commands have completed without stalling
+ *
+ */
+
+
+
+/* pragma one */
+#ifndef GLHELPER_SYNC_H_INCLUDED
+#define GLHELPER_SYNC_H_INCLUDED
+
+
+
+/* INCLUDES */
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdint.h>
+
+/* include glhelper_core.h */
+#include "glhelper_core.h"
+
+/* include glhelper_glad.h */
+#include "glhelper_glad.h"
+
+
+
+/* TYPEDEFS */
+
+/* typedef glh_sync_t -> GLsync */
+typedef GLsync glh_sync_t;
+
+
+
+/* FUNCTIONS */
+
+/* glh_create_fence
+ *
+ * creates a fence, which is signalled once all commands issued before it have completed
+ * the commands are flushed, so that the fence is eventually signalled
+ *
+ * return: the fence for success, NULL for failure
+ */
+glh_sync_t glh_create_fence ();
+
+/* glh_delete_fence
+ *
+ * deletes a fence
+ *
+ * fence: the fence to delete
+ *
+ * return: 0 for success, -1 for failure
+ */
+int glh_delete_fence ( glh_sync_t fence );
+
+/* glh_wait_fence
+ *
+ * wait for a fence to be signalled
+ *
+ * fence: the fence to wait for
+ * timeout: the maximum time to wait in nanoseconds, or 0 to only check whether it has been signalled
+ *
+ * return: 1 if signalled, 0 if not signalled within the timeout, -1 for failure
+ */
+int glh_wait_fence ( glh_sync_t fence, const uint64_t timeout );
+
+
+
+/* #ifndef GLHELPER_SYNC_H_INCLUDED */
+#endif
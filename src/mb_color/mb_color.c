@@ -0,0 +1,550 @@
+/*
+ * mb_color.c
+ *
+ * implementation of mb_color.h
+ */
+
+
+
+/* include mb_color.h */
+#include "mb_color.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* mb_color_open_dump
+ *
+ * open a raw dump to read, checking its header
+ *
+ * path: the dump
+ *
+ * return: the dump, or NULL on failure
+ */
+mb_color_dump_t * mb_color_open_dump ( const char * path )
+{
+    /* allocate the dump */
+    mb_color_dump_t * dump = malloc ( sizeof ( mb_color_dump_t ) );
+    if ( !dump )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for raw dump\n" );
+        return NULL;
+    }
+    dump->page_size = sysconf ( _SC_PAGESIZE );
+
+    /* open the file, find its size, and read the header */
+    mb_export_raw_header_t * header = &dump->header;
+    if ( ( dump->fd = open ( path, O_RDONLY ) ) == -1 ||
+         ( dump->size = lseek ( dump->fd, 0, SEEK_END ) ) == -1 ||
+         lseek ( dump->fd, 0, SEEK_SET ) != 0 ||
+         read ( dump->fd, header, sizeof ( mb_export_raw_header_t ) ) != sizeof ( mb_export_raw_header_t ) )
+    {
+        /* failed to open */
+        fprintf ( stderr, "MB ERROR: failed to open raw dump %s\n", path );
+        if ( dump->fd != -1 ) close ( dump->fd );
+        free ( dump );
+        return NULL;
+    }
+
+    /* check the header is of a dump of this layout, holding the iterations and magnitude first, and the file holds every tile */
+    if ( memcmp ( header->magic, MB_EXPORT_RAW_MAGIC, sizeof ( header->magic ) ) != 0 ||
+         header->tile_size == 0 || header->tiles_x == 0 || header->tiles_y == 0 || header->view.max_it < 1 ||
+         ( header->channels & ( MB_EXPORT_RAW_ITERATIONS | MB_EXPORT_RAW_MAGNITUDE ) ) != ( MB_EXPORT_RAW_ITERATIONS | MB_EXPORT_RAW_MAGNITUDE ) ||
+         ( uint64_t ) dump->size < header->data_offset + ( uint64_t ) header->tiles_x * header->tiles_y * mb_export_raw_tile_size ( header ) )
+    {
+        /* not a complete raw dump */
+        fprintf ( stderr, "MB ERROR: %s is not a complete raw dump\n", path );
+        close ( dump->fd );
+        free ( dump );
+        return NULL;
+    }
+
+    /* return the dump */
+    return dump;
+}
+
+/* mb_color_close_dump
+ *
+ * close a raw dump
+ *
+ * dump: the dump to close
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_color_close_dump ( mb_color_dump_t * dump )
+{
+    /* close the file */
+    const int status = close ( dump->fd );
+
+    /* free the dump */
+    free ( dump );
+
+    /* return the status */
+    return status;
+}
+
+/* mb_color_create
+ *
+ * create a colouring for a dump
+ *
+ * dump: the dump to colour
+ * palette: the palette to colour with (MB_COLOR_PALETTE_X)
+ * smooth: 1 to colour by smooth iteration counts, 0 to colour by whole iterations
+ * threads: the maximum number of threads to colour with, or 0 to use one per online processor
+ *
+ * return: the colouring, or NULL on failure
+ */
+mb_color_t * mb_color_create ( const mb_color_dump_t * dump, const int palette, const int smooth, const int threads )
+{
+    /* allocate the colouring */
+    mb_color_t * color = malloc ( sizeof ( mb_color_t ) );
+    if ( !color )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for colouring\n" );
+        return NULL;
+    }
+
+    /* set the parameters the dump was iterated with
+     * smooth iteration counts need a power of at least 2 and a breakout beyond 1, so are not used otherwise
+     */
+    const mb_view_t * view = &dump->header.view;
+    color->max_it = ( int ) view->max_it;
+    color->log_breakout = ( view->breakout > 1.0f ? logf ( view->breakout ) : 0.0f );
+    color->log_power = ( abs ( view->power ) >= 2 ? logf ( abs ( view->power ) ) : 0.0f );
+    color->smooth = ( smooth && color->log_breakout > 0.0f && color->log_power > 0.0f );
+    color->cdf = NULL;
+    color->threads = ( threads > 0 ? threads : ( int ) sysconf ( _SC_NPROCESSORS_ONLN ) );
+    if ( color->threads < 1 ) color->threads = 1;
+
+    /* if showing the heat view, find the glitch flag, which follows whichever of the channels before it the dump holds */
+    const uint32_t channels = dump->header.channels;
+    color->heat = ( palette == MB_COLOR_PALETTE_HEAT );
+    color->height = ( int ) dump->header.height + ( color->heat ? MB_COLOR_LEGEND_HEIGHT : 0 );
+    color->glitch_channel = -1;
+    if ( channels & MB_EXPORT_RAW_GLITCH )
+    {
+        color->glitch_channel = 0;
+        for ( uint32_t channel = 1; channel < MB_EXPORT_RAW_GLITCH; channel <<= 1 ) color->glitch_channel += ( ( channels & channel ) != 0 );
+    }
+
+    /* sample the palette */
+    if ( __mb_color_build_palette ( color, palette ) == -1 )
+    {
+        /* unknown palette */
+        fprintf ( stderr, "MB ERROR: unknown palette\n" );
+        free ( color );
+        return NULL;
+    }
+
+    /* return the colouring */
+    return color;
+}
+
+/* mb_color_destroy
+ *
+ * destroy a colouring
+ *
+ * color: the colouring to destroy
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_color_destroy ( mb_color_t * color )
+{
+    /* free the distribution and colouring */
+    free ( color->cdf );
+    free ( color );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_color_equalise
+ *
+ * count the iterations of every pixel of a dump, so that the palette is spread evenly over the pixels rather than the iterations
+ * streams through the whole dump once, in parallel
+ *
+ * color: the colouring to equalise
+ * dump: the dump
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_color_equalise ( mb_color_t * color, const mb_color_dump_t * dump )
+{
+    /* allocate a histogram for each thread, and the distribution */
+    uint64_t * histograms = calloc ( ( size_t ) color->threads * color->max_it, sizeof ( uint64_t ) );
+    double * cdf = malloc ( ( color->max_it + 1 ) * sizeof ( double ) );
+    if ( !histograms || !cdf )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for histogram\n" );
+        free ( histograms );
+        free ( cdf );
+        return -1;
+    }
+
+    /* count each run of rows of tiles, one at a time, so that only one is mapped at once */
+    const int tile_size = dump->header.tile_size;
+    int status = 0;
+    for ( int top = 0; top < ( int ) dump->header.height && status == 0; top += tile_size )
+    {
+        const int count = ( ( int ) dump->header.height - top < tile_size ? ( int ) dump->header.height - top : tile_size );
+        status = __mb_color_run ( color, dump, top, count, NULL, histograms, __mb_color_count_job );
+    }
+
+    /* sum the histograms of the threads into the first, and accumulate them into the distribution */
+    uint64_t total = 0;
+    for ( int i = 0; i < color->max_it; ++i )
+    {
+        for ( int thread = 1; thread < color->threads; ++thread ) histograms [ i ] += histograms [ ( size_t ) thread * color->max_it + i ];
+        total += histograms [ i ];
+    }
+    cdf [ 0 ] = 0.0;
+    for ( int i = 0; i < color->max_it; ++i ) cdf [ i + 1 ] = cdf [ i ] + ( total > 0 ? ( double ) histograms [ i ] / total : 0.0 );
+    free ( histograms );
+
+    /* replace any previous distribution */
+    if ( status == 0 )
+    {
+        free ( color->cdf );
+        color->cdf = cdf;
+    } else free ( cdf );
+
+    /* return the status */
+    return status;
+}
+
+/* mb_color_rows
+ *
+ * colour rows of a dump, in parallel, and any rows of the legend of the heat view below it
+ *
+ * color: the colouring
+ * dump: the dump
+ * top: the first row, from the top of the image
+ * count: the number of rows, which may run on into the legend, up to the height of the colouring
+ * rows: the 8 bit RGB rows to colour into, top row first
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_color_rows ( const mb_color_t * color, const mb_color_dump_t * dump, const int top, const int count, unsigned char * rows )
+{
+    /* check the rows are in the image */
+    if ( top < 0 || count <= 0 || top + count > color->height )
+    {
+        /* rows outside of the image */
+        fprintf ( stderr, "MB ERROR: attempted to colour rows outside of the raw dump\n" );
+        return -1;
+    }
+
+    /* colour the rows of the dump */
+    const int height = dump->header.height;
+    const int image_count = ( top + count > height ? height - top : count );
+    if ( image_count > 0 && __mb_color_run ( color, dump, top, image_count, rows, NULL, __mb_color_color_job ) != 0 ) return -1;
+
+    /* colour any rows of the legend below it */
+    for ( int y = ( top > height ? top : height ); y < top + count; ++y ) __mb_color_legend_row ( color, dump->header.width, y - height, rows + ( size_t ) ( y - top ) * dump->header.width * 3 );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_color_run
+ *
+ * map the rows of tiles holding some rows of a dump, split the rows between threads, run a function on each, and unmap the rows of tiles
+ *
+ * color: the colouring
+ * dump: the dump
+ * top: the first row, from the top of the image
+ * count: the number of rows
+ * rows: the 8 bit RGB rows to colour into, or NULL if counting
+ * histograms: a histogram of max_it entries for each thread to count into, or NULL if colouring
+ * function: the function to run on each thread
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_color_run ( const mb_color_t * color, const mb_color_dump_t * dump, const int top, const int count, unsigned char * rows, uint64_t * histograms, void * ( * function ) ( void * ) )
+{
+    /* find the rows of tiles holding the rows, which are contiguous in the dump, and map them from the page they start in */
+    const mb_export_raw_header_t * header = &dump->header;
+    const int first_band = top / header->tile_size;
+    const int last_band = ( top + count - 1 ) / header->tile_size;
+    const uint64_t band_size = ( uint64_t ) header->tiles_x * mb_export_raw_tile_size ( header );
+    const uint64_t offset = header->data_offset + first_band * band_size;
+    const uint64_t map_offset = offset - offset % dump->page_size;
+    const size_t map_length = offset - map_offset + ( last_band - first_band + 1 ) * band_size;
+    void * map = mmap ( NULL, map_length, PROT_READ, MAP_SHARED, dump->fd, map_offset );
+    if ( map == MAP_FAILED )
+    {
+        /* failed to map */
+        fprintf ( stderr, "MB ERROR: failed to map raw dump\n" );
+        return -1;
+    }
+
+    /* split the rows between as many threads as there are rows, up to the maximum */
+    const int thread_count = ( count < color->threads ? count : color->threads );
+    mb_color_job_t jobs [ thread_count ];
+    for ( int i = 0; i < thread_count; ++i )
+    {
+        jobs [ i ].color = color;
+        jobs [ i ].dump = dump;
+        jobs [ i ].map = map;
+        jobs [ i ].map_offset = map_offset;
+        jobs [ i ].top = top + ( int ) ( ( long ) count * i / thread_count );
+        jobs [ i ].count = top + ( int ) ( ( long ) count * ( i + 1 ) / thread_count ) - jobs [ i ].top;
+        jobs [ i ].rows = ( rows ? rows + ( size_t ) ( jobs [ i ].top - top ) * header->width * 3 : NULL );
+        jobs [ i ].histogram = ( histograms ? histograms + ( size_t ) i * color->max_it : NULL );
+    }
+
+    /* start a thread for every job but the first, which is run on this thread, running any job whose thread fails to start here too */
+    pthread_t threads [ thread_count ];
+    int started [ thread_count ];
+    for ( int i = 1; i < thread_count; ++i ) started [ i ] = ( pthread_create ( &threads [ i ], NULL, function, &jobs [ i ] ) == 0 );
+    function ( &jobs [ 0 ] );
+    for ( int i = 1; i < thread_count; ++i )
+    {
+        if ( started [ i ] ) pthread_join ( threads [ i ], NULL );
+        else function ( &jobs [ i ] );
+    }
+
+    /* unmap the rows of tiles, letting their pages go */
+    return munmap ( map, map_length );
+}
+
+/* __mb_color_color_job
+ *
+ * colour the rows of a job
+ * each row is coloured in two passes over contiguous arrays, finding the position of each pixel in the palette then looking it up,
+ * which keeps the loops simple enough for the compiler to vectorise
+ *
+ * arg: the job
+ *
+ * return: NULL
+ */
+void * __mb_color_color_job ( void * arg )
+{
+    /* get the job and the layout of the dump */
+    const mb_color_job_t * job = arg;
+    const mb_color_t * color = job->color;
+    const mb_export_raw_header_t * header = &job->dump->header;
+    const int tile_size = header->tile_size;
+    const int channels = header->channel_count;
+    const float max_it = color->max_it;
+
+    /* allocate the positions in the palette of a row of a tile, with -1 for pixels inside the set */
+    float positions [ tile_size ];
+
+    /* colour each row, a tile at a time */
+    for ( int y = job->top; y < job->top + job->count; ++y )
+    {
+        unsigned char * row = job->rows + ( size_t ) ( y - job->top ) * header->width * 3;
+        for ( int left = 0; left < ( int ) header->width; left += tile_size )
+        {
+            /* find the pixels of the row of the tile, which are contiguous, and how many are in the image */
+            const float * pixels = ( const float * ) ( job->map + ( mb_export_raw_offset ( header, left, y ) - job->map_offset ) );
+            const int width = ( ( int ) header->width - left < tile_size ? ( int ) header->width - left : tile_size );
+
+            /* if showing the heat view, colour by cost instead */
+            if ( color->heat )
+            {
+                __mb_color_heat_row ( color, header, pixels, left, y, width, row + ( size_t ) left * 3 );
+                continue;
+            }
+
+            /* find the iteration count of each pixel, smoothed by how far past the breakout it escaped if smoothing
+             * a pixel which escaped after n iterations has n + 1 - log ( log |z| / log breakout ) / log power, which lies in ( n, n + 1 ]
+             */
+            if ( color->smooth )
+            {
+                for ( int i = 0; i < width; ++i )
+                {
+                    const float iterations = pixels [ i * channels ];
+                    const float log_z = 0.5f * logf ( pixels [ i * channels + 1 ] > 1.0f ? pixels [ i * channels + 1 ] : 1.0f );
+                    const float smooth = iterations + 1.0f - logf ( log_z > color->log_breakout ? log_z / color->log_breakout : 1.0f ) / color->log_power;
+                    positions [ i ] = ( iterations >= max_it ? -1.0f : smooth );
+                }
+            } else for ( int i = 0; i < width; ++i ) positions [ i ] = ( pixels [ i * channels ] >= max_it ? -1.0f : pixels [ i * channels ] );
+
+            /* map each iteration count to the palette, through the distribution if equalising */
+            if ( color->cdf )
+            {
+                for ( int i = 0; i < width; ++i )
+                {
+                    const float count = ( positions [ i ] < 0.0f ? 0.0f : positions [ i ] > max_it ? max_it : positions [ i ] );
+                    const int whole = ( count >= max_it ? color->max_it - 1 : ( int ) count );
+                    const double fraction = color->cdf [ whole ] + ( count - whole ) * ( color->cdf [ whole + 1 ] - color->cdf [ whole ] );
+                    positions [ i ] = ( positions [ i ] < 0.0f ? -1.0f : fraction );
+                }
+            } else for ( int i = 0; i < width; ++i ) positions [ i ] = ( positions [ i ] < 0.0f ? -1.0f : positions [ i ] / max_it );
+
+            /* look up each colour, with pixels inside the set black */
+            unsigned char * dst = row + ( size_t ) left * 3;
+            for ( int i = 0; i < width; ++i, dst += 3 )
+            {
+                const float position = ( positions [ i ] > 1.0f ? 1.0f : positions [ i ] );
+                const int index = ( int ) ( position * ( MB_COLOR_PALETTE_SIZE - 1 ) + 0.5f );
+                if ( position < 0.0f ) dst [ 0 ] = dst [ 1 ] = dst [ 2 ] = 0;
+                else memcpy ( dst, color->palette + index * 3, 3 );
+            }
+        }
+    }
+
+    /* return NULL */
+    return NULL;
+}
+
+/* __mb_color_heat_row
+ *
+ * colour the row of a tile of a dump by the heat view
+ *
+ * color: the colouring
+ * header: the header of the dump
+ * pixels: the pixels of the row of the tile
+ * left: the first column of the tile
+ * y: the row, from the top of the image
+ * width: the number of pixels of the row of the tile in the image
+ * dst: the 8 bit RGB pixels to colour into
+ */
+void __mb_color_heat_row ( const mb_color_t * color, const mb_export_raw_header_t * header, const float * pixels, const int left, const int y, const int width, unsigned char * dst )
+{
+    /* get the layout of the dump */
+    const int channels = header->channel_count;
+    const int tile_size = header->tile_size;
+
+    /* colour each pixel by its whole iterations over max_it, which is what it cost, with pixels which reached max_it white */
+    for ( int i = 0; i < width; ++i, dst += 3 )
+    {
+        const float iterations = pixels [ i * channels ];
+        const int index = ( int ) ( ( iterations < 0.0f ? 0.0f : iterations ) / color->max_it * ( MB_COLOR_PALETTE_SIZE - 1 ) + 0.5f );
+        if ( iterations >= color->max_it ) dst [ 0 ] = dst [ 1 ] = dst [ 2 ] = 255;
+        else memcpy ( dst, color->palette + index * 3, 3 );
+
+        /* hatch glitched pixels with magenta, leaving every other pixel showing its cost */
+        if ( color->glitch_channel >= 0 && pixels [ i * channels + color->glitch_channel ] != 0.0f && ( left + i + y ) % 2 == 0 )
+        {
+            dst [ 0 ] = 255;
+            dst [ 1 ] = 0;
+            dst [ 2 ] = 255;
+        }
+
+        /* darken the edges of the tile, so the cost of each tile can be told apart */
+        if ( i == 0 || y % tile_size == 0 )
+        {
+            dst [ 0 ] /= 2;
+            dst [ 1 ] /= 2;
+            dst [ 2 ] /= 2;
+        }
+    }
+}
+
+/* __mb_color_legend_row
+ *
+ * colour a row of the legend of the heat view
+ *
+ * color: the colouring
+ * image_width: the width of the image
+ * y: the row of the legend, from its top
+ * row: the 8 bit RGB row to colour into
+ */
+void __mb_color_legend_row ( const mb_color_t * color, const int image_width, const int y, unsigned char * row )
+{
+    /* find the width of each swatch, and of the palette before them, leaving a gap before each swatch */
+    const int swatch = 2 * MB_COLOR_LEGEND_HEIGHT;
+    const int gap = MB_COLOR_LEGEND_HEIGHT / 4;
+    const int palette_width = image_width - 2 * ( swatch + gap );
+
+    /* start black, which the top row, the gaps and the ticks are left as */
+    memset ( row, 0, ( size_t ) image_width * 3 );
+    if ( y == 0 || palette_width < 4 ) return;
+
+    /* colour the palette from 0 iterations to max_it, with ticks in the bottom half at each quarter */
+    for ( int x = 0; x < palette_width; ++x )
+    {
+        const int index = ( int ) ( ( float ) x / ( palette_width - 1 ) * ( MB_COLOR_PALETTE_SIZE - 1 ) + 0.5f );
+        const int tick = ( y >= MB_COLOR_LEGEND_HEIGHT / 2 && ( x * 4 ) % ( palette_width - 1 ) < 4 );
+        if ( !tick ) memcpy ( row + ( size_t ) x * 3, color->palette + index * 3, 3 );
+    }
+
+    /* colour the swatches of pixels which reached max_it and of glitched pixels */
+    memset ( row + ( size_t ) ( palette_width + gap ) * 3, 255, ( size_t ) swatch * 3 );
+    for ( int x = image_width - swatch; x < image_width; ++x )
+    {
+        row [ x * 3 ] = 255;
+        row [ x * 3 + 2 ] = 255;
+    }
+}
+
+/* __mb_color_count_job
+ *
+ * count the whole iterations of the pixels outside of the set in the rows of a job into its histogram
+ *
+ * arg: the job
+ *
+ * return: NULL
+ */
+void * __mb_color_count_job ( void * arg )
+{
+    /* get the job and the layout of the dump */
+    const mb_color_job_t * job = arg;
+    const mb_export_raw_header_t * header = &job->dump->header;
+    const int tile_size = header->tile_size;
+    const int channels = header->channel_count;
+    const int max_it = job->color->max_it;
+
+    /* count each row, a tile at a time */
+    for ( int y = job->top; y < job->top + job->count; ++y )
+    {
+        for ( int left = 0; left < ( int ) header->width; left += tile_size )
+        {
+            const float * pixels = ( const float * ) ( job->map + ( mb_export_raw_offset ( header, left, y ) - job->map_offset ) );
+            const int width = ( ( int ) header->width - left < tile_size ? ( int ) header->width - left : tile_size );
+            for ( int i = 0; i < width; ++i )
+            {
+                const int iterations = ( int ) pixels [ i * channels ];
+                if ( iterations >= 0 && iterations < max_it ) ++job->histogram [ iterations ];
+            }
+        }
+    }
+
+    /* return NULL */
+    return NULL;
+}
+
+/* __mb_color_build_palette
+ *
+ * sample a palette into a colouring
+ *
+ * color: the colouring
+ * palette: the palette (MB_COLOR_PALETTE_X)
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_color_build_palette ( mb_color_t * color, const int palette )
+{
+    /* the evenly spaced colours of each palette, which are blended between */
+    static const unsigned char grey [] = { 255, 255, 255, 0, 0, 0 };
+    static const unsigned char fire [] = { 0, 0, 0, 128, 0, 0, 255, 64, 0, 255, 192, 0, 255, 255, 255 };
+    static const unsigned char ocean [] = { 0, 8, 48, 0, 64, 160, 0, 192, 224, 160, 255, 255, 255, 255, 255 };
+    static const unsigned char heat [] = { 0, 0, 0, 0, 0, 192, 0, 192, 192, 255, 255, 0, 255, 0, 0 };
+
+    /* find the colours of the palette */
+    const unsigned char * stops;
+    int stop_count;
+    if ( palette == MB_COLOR_PALETTE_GREY ) { stops = grey; stop_count = sizeof ( grey ) / 3; } else
+    if ( palette == MB_COLOR_PALETTE_FIRE ) { stops = fire; stop_count = sizeof ( fire ) / 3; } else
+    if ( palette == MB_COLOR_PALETTE_OCEAN ) { stops = ocean; stop_count = sizeof ( ocean ) / 3; } else
+    if ( palette == MB_COLOR_PALETTE_HEAT ) { stops = heat; stop_count = sizeof ( heat ) / 3; } else
+    return -1;
+
+    /* sample the palette, blending linearly between the two colours either side of each sample */
+    for ( int i = 0; i < MB_COLOR_PALETTE_SIZE; ++i )
+    {
+        const float position = ( float ) i / ( MB_COLOR_PALETTE_SIZE - 1 ) * ( stop_count - 1 );
+        const int stop = ( position >= stop_count - 1 ? stop_count - 2 : ( int ) position );
+        const float blend = position - stop;
+        for ( int channel = 0; channel < 3; ++channel ) color->palette [ i * 3 + channel ] = ( unsigned char ) ( stops [ stop * 3 + channel ] * ( 1.0f - blend ) + stops [ ( stop + 1 ) * 3 + channel ] * blend + 0.5f );
+    }
+
+    /* return 0 for success */
+    return 0;
+}
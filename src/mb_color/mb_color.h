@@ -0,0 +1,310 @@
+/*
+ * mb_color.h
+ *
+ * recolours raw dumps written by mb_export, applying palettes, smooth colouring and histogram equalisation
+ * the dump is mapped into memory a run of rows of tiles at a time and unmapped once coloured, so dumps far larger than memory
+ * are streamed through, and the rows of each run are coloured in parallel
+ */
+
+
+
+/* pragma one */
+#ifndef MB_COLOR_H_INCLUDED
+#define MB_COLOR_H_INCLUDED
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+
+/* include mb_export_writer.h */
+#include <mb_export/mb_export_writer.h>
+
+
+
+/* MACROS */
+
+/* MB_COLOR_THREADS
+ *
+ * defines the maximum number of threads used to colour, or 0 to use one per online processor
+ * can be set during compilation using -DMB_COLOR_THREADS=threads
+ */
+#ifndef MB_COLOR_THREADS
+#define MB_COLOR_THREADS 0
+#endif
+
+/* MB_COLOR_PALETTE_SIZE
+ *
+ * the number of colours palettes are sampled into
+ */
+#define MB_COLOR_PALETTE_SIZE 1024
+
+/* MB_COLOR_PALETTE_X
+ *
+ * the palettes pixels outside of the set can be coloured with, from the fewest iterations to the most
+ * pixels inside the set are always black
+ * GREY fades from white to black, as mandelbrot colours the set
+ * FIRE rises from black through red and yellow to white
+ * OCEAN rises from deep blue through cyan to white
+ * HEAT is a debug view of what each pixel cost to iterate rather than a colouring, rising from black through blue, cyan and yellow to red
+ * by whole iterations over max_it, with pixels which reached max_it white, pixels flagged as glitched hatched with magenta,
+ * the edges of the tiles darkened, and a legend in rows added below the image, ignoring smoothing and equalisation
+ */
+#define MB_COLOR_PALETTE_GREY 0
+#define MB_COLOR_PALETTE_FIRE 1
+#define MB_COLOR_PALETTE_OCEAN 2
+#define MB_COLOR_PALETTE_HEAT 3
+
+/* MB_COLOR_LEGEND_HEIGHT
+ *
+ * defines the height in pixels of the legend the heat view adds below the image, so that none of the image is covered
+ * the legend is the palette from 0 iterations on the left to max_it, with ticks at each quarter, then a swatch of white for pixels
+ * which reached max_it and a swatch of magenta for glitched pixels
+ * can be set during compilation using -DMB_COLOR_LEGEND_HEIGHT=height
+ */
+#ifndef MB_COLOR_LEGEND_HEIGHT
+#define MB_COLOR_LEGEND_HEIGHT 16
+#endif
+
+
+
+/* STRUCTURES */
+
+/* struct mb_color_dump_t
+ *
+ * a raw dump opened for reading
+ */
+typedef struct
+{
+    /* the file being read, and its size */
+    int fd;
+    off_t size;
+
+    /* the header of the dump */
+    mb_export_raw_header_t header;
+
+    /* the size of a page, which mappings must start on */
+    long page_size;
+
+} mb_color_dump_t;
+
+/* struct mb_color_t
+ *
+ * how to colour a dump
+ */
+typedef struct
+{
+    /* the palette sampled into MB_COLOR_PALETTE_SIZE RGB colours */
+    unsigned char palette [ MB_COLOR_PALETTE_SIZE * 3 ];
+
+    /* 1 to colour by smooth iteration counts, found from the final magnitudes, rather than whole iterations */
+    int smooth;
+
+    /* the cumulative distribution of the whole iterations of pixels outside of the set, with max_it + 1 entries from 0 to 1,
+     * or NULL to spread the palette evenly over the iterations rather than equalising it
+     */
+    double * cdf;
+
+    /* the maximum iterations, the log of the breakout and the log of the absolute power the dump was iterated with */
+    int max_it;
+    float log_breakout;
+    float log_power;
+
+    /* the maximum number of threads to colour with */
+    int threads;
+
+    /* the height of the coloured image, which is the height of the dump, with MB_COLOR_LEGEND_HEIGHT more rows for the legend of the heat view */
+    int height;
+
+    /* 1 if showing the heat view (MB_COLOR_PALETTE_HEAT), and the index in each pixel of the glitch flag, or -1 if the dump lacks it */
+    int heat;
+    int glitch_channel;
+
+} mb_color_t;
+
+/* struct mb_color_job_t
+ *
+ * some rows of a mapped run of rows of tiles being coloured or counted by a thread
+ */
+typedef struct
+{
+    /* how to colour, and the dump */
+    const mb_color_t * color;
+    const mb_color_dump_t * dump;
+
+    /* the mapped run, and the offset in the dump of its first byte */
+    const unsigned char * map;
+    uint64_t map_offset;
+
+    /* the rows of the image to colour or count, from the top */
+    int top;
+    int count;
+
+    /* the 8 bit RGB rows to colour into, top row first, or NULL if counting */
+    unsigned char * rows;
+
+    /* the histogram to count the whole iterations of pixels outside of the set into, with max_it entries, or NULL if colouring */
+    uint64_t * histogram;
+
+} mb_color_job_t;
+
+
+
+/* FUNCTIONS */
+
+/* mb_color_open_dump
+ *
+ * open a raw dump to read, checking its header
+ *
+ * path: the dump
+ *
+ * return: the dump, or NULL on failure
+ */
+mb_color_dump_t * mb_color_open_dump ( const char * path );
+
+/* mb_color_close_dump
+ *
+ * close a raw dump
+ *
+ * dump: the dump to close
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_color_close_dump ( mb_color_dump_t * dump );
+
+/* mb_color_create
+ *
+ * create a colouring for a dump
+ *
+ * dump: the dump to colour
+ * palette: the palette to colour with (MB_COLOR_PALETTE_X)
+ * smooth: 1 to colour by smooth iteration counts, 0 to colour by whole iterations
+ * threads: the maximum number of threads to colour with, or 0 to use one per online processor
+ *
+ * return: the colouring, or NULL on failure
+ */
+mb_color_t * mb_color_create ( const mb_color_dump_t * dump, const int palette, const int smooth, const int threads );
+
+/* mb_color_destroy
+ *
+ * destroy a colouring
+ *
+ * color: the colouring to destroy
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_color_destroy ( mb_color_t * color );
+
+/* mb_color_equalise
+ *
+ * count the iterations of every pixel of a dump, so that the palette is spread evenly over the pixels rather than the iterations
+ * streams through the whole dump once, in parallel
+ *
+ * color: the colouring to equalise
+ * dump: the dump
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_color_equalise ( mb_color_t * color, const mb_color_dump_t * dump );
+
+/* mb_color_rows
+ *
+ * colour rows of a dump, in parallel, and any rows of the legend of the heat view below it
+ *
+ * color: the colouring
+ * dump: the dump
+ * top: the first row, from the top of the image
+ * count: the number of rows, which may run on into the legend, up to the height of the colouring
+ * rows: the 8 bit RGB rows to colour into, top row first
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_color_rows ( const mb_color_t * color, const mb_color_dump_t * dump, const int top, const int count, unsigned char * rows );
+
+/* __mb_color_run
+ *
+ * map the rows of tiles holding some rows of a dump, split the rows between threads, run a function on each, and unmap the rows of tiles
+ *
+ * color: the colouring
+ * dump: the dump
+ * top: the first row, from the top of the image
+ * count: the number of rows
+ * rows: the 8 bit RGB rows to colour into, or NULL if counting
+ * histograms: a histogram of max_it entries for each thread to count into, or NULL if colouring
+ * function: the function to run on each thread
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_color_run ( const mb_color_t * color, const mb_color_dump_t * dump, const int top, const int count, unsigned char * rows, uint64_t * histograms, void * ( * function ) ( void * ) );
+
+/* __mb_color_color_job
+ *
+ * colour the rows of a job
+ * each row is coloured in two passes over contiguous arrays, finding the position of each pixel in the palette then looking it up,
+ * which keeps the loops simple enough for the compiler to vectorise
+ *
+ * arg: the job
+ *
+ * return: NULL
+ */
+void * __mb_color_color_job ( void * arg );
+
+/* __mb_color_heat_row
+ *
+ * colour the row of a tile of a dump by the heat view
+ *
+ * color: the colouring
+ * header: the header of the dump
+ * pixels: the pixels of the row of the tile
+ * left: the first column of the tile
+ * y: the row, from the top of the image
+ * width: the number of pixels of the row of the tile in the image
+ * dst: the 8 bit RGB pixels to colour into
+ */
+void __mb_color_heat_row ( const mb_color_t * color, const mb_export_raw_header_t * header, const float * pixels, const int left, const int y, const int width, unsigned char * dst );
+
+/* __mb_color_legend_row
+ *
+ * colour a row of the legend of the heat view
+ *
+ * color: the colouring
+ * image_width: the width of the image
+ * y: the row of the legend, from its top
+ * row: the 8 bit RGB row to colour into
+ */
+void __mb_color_legend_row ( const mb_color_t * color, const int image_width, const int y, unsigned char * row );
+
+/* __mb_color_count_job
+ *
+ * count the whole iterations of the pixels outside of the set in the rows of a job into its histogram
+ *
+ * arg: the job
+ *
+ * return: NULL
+ */
+void * __mb_color_count_job ( void * arg );
+
+/* __mb_color_build_palette
+ *
+ * sample a palette into a colouring
+ *
+ * color: the colouring
+ * palette: the palette (MB_COLOR_PALETTE_X)
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_color_build_palette ( mb_color_t * color, const int palette );
+
+
+
+/* #ifndef MB_COLOR_H_INCLUDED */
+#endif
@@ -0,0 +1,240 @@
+/*
+ * mb_export.c
+ *
+ * implementation of mb_export.h
+ */
+
+
+
+/* include mb_export.h */
+#include "mb_export.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* mb_export
+ *
+ * render the most recently published view of a set at any size, and write it to a file, in the format given by mb_export_format
+ * uses the context current on the calling thread, such as a headless context
+ * completed rows of tiles of PPM files are journaled to <path>.checkpoint, which is deleted once the export is complete
+ * if the export dies, running it again skips the rows of tiles already completed
+ * PNG files cannot be resumed, as their rows are compressed into a single stream, and nor can TIFF files, as their directory is written last
+ * raw dumps hold the raw values of each pixel rather than colours, so the set is rendered with MANDELBROT_OUTPUT_RAW, and can be resumed
+ *
+ * mb_set: the mandelbrot set to export
+ * width/height: the size of the image in pixels
+ * path: the file to write the image to
+ * stats: will be set to statistics about the export, or NULL
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export ( mb_set_t mb_set, const int width, const int height, const char * path, mb_export_stats_t * stats )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before exporting a mandelbrot set" );
+
+    /* start timing */
+    const double start_time = __mb_export_time ();
+
+    /* find the number of tiles across the image, and the number of rows of tiles */
+    const int tiles_x = ( width + MB_EXPORT_TILE_SIZE - 1 ) / MB_EXPORT_TILE_SIZE;
+    const int bands = ( height + MB_EXPORT_TILE_SIZE - 1 ) / MB_EXPORT_TILE_SIZE;
+
+    /* describe the export, so that only the same export is resumed */
+    mb_export_checkpoint_header_t header;
+    memset ( &header, 0, sizeof ( header ) );
+    memcpy ( header.magic, MB_EXPORT_CHECKPOINT_MAGIC, sizeof ( header.magic ) );
+    header.width = width;
+    header.height = height;
+    header.tile_size = MB_EXPORT_TILE_SIZE;
+    __mb_read_view ( mb_set, &header.view );
+
+    /* open the checkpoint if the file can be resumed, then the file, keeping its contents if resuming
+     * then allocate a row of tiles, or only a tile if a tiff or raw dump, as tiles are written to them as soon as they are read back
+     */
+    const int format = mb_export_format ( path );
+    const int resumable = ( format == MB_EXPORT_FORMAT_PPM || format == MB_EXPORT_FORMAT_RAW );
+    const int tiled = ( format == MB_EXPORT_FORMAT_TIFF || format == MB_EXPORT_FORMAT_RAW );
+    char * checkpoint_path = malloc ( strlen ( path ) + sizeof ( ".checkpoint" ) );
+    if ( checkpoint_path ) strcat ( strcpy ( checkpoint_path, path ), ".checkpoint" );
+    mb_export_checkpoint_t * checkpoint = ( checkpoint_path && resumable ? mb_export_open_checkpoint ( checkpoint_path, &header, bands ) : NULL );
+    mb_export_writer_t * writer = ( checkpoint_path && ( checkpoint || !resumable ) ? mb_export_open_writer ( path, width, height, &header.view, checkpoint && checkpoint->bands_done > 0 ) : NULL );
+    unsigned char * band = malloc ( ( size_t ) ( tiled ? MB_EXPORT_TILE_SIZE : width ) * MB_EXPORT_TILE_SIZE * ( format == MB_EXPORT_FORMAT_RAW ? 16 : 3 ) );
+    if ( ( resumable && !checkpoint ) || !writer || !band || mb_set_output ( mb_set, ( format == MB_EXPORT_FORMAT_RAW ? MANDELBROT_OUTPUT_RAW : MANDELBROT_OUTPUT_COLOUR ) ) == -1 )
+    {
+        /* failed to start export */
+        fprintf ( stderr, "MB ERROR: failed to start export to %s\n", path );
+        if ( writer ) mb_export_close_writer ( writer );
+        if ( checkpoint ) mb_export_close_checkpoint ( checkpoint, checkpoint_path, -1 );
+        free ( checkpoint_path );
+        free ( band );
+        return -1;
+    }
+
+    /* forget any completed rows of tiles missing from the file */
+    if ( checkpoint ) mb_export_checkpoint_truncate ( checkpoint, writer->existing_size );
+
+    /* render each row of tiles not yet completed from the top down, writing it to the file and journaling it once complete */
+    int status = 0;
+    double pixels_resumed = 0.0;
+    for ( int band_index = 0; band_index < bands && status == 0; ++band_index )
+    {
+        /* find the top and height of the row, which is less than a tile at the bottom of the image */
+        const int band_top = band_index * MB_EXPORT_TILE_SIZE;
+        const int band_height = ( height - band_top < MB_EXPORT_TILE_SIZE ? height - band_top : MB_EXPORT_TILE_SIZE );
+
+        /* skip the row if already completed */
+        if ( checkpoint && mb_export_checkpoint_done ( checkpoint, band_index ) )
+        {
+            pixels_resumed += ( double ) width * band_height;
+            continue;
+        }
+
+        /* render each tile and queue it to be read back, tagged with its column
+         * the tiles are read back asynchronously, so the next tile is rendered while the previous ones are read
+         * tiles are always rendered whole, so the frame is never resized, and any part beyond the image is not copied
+         */
+        int tiles_queued = 0, tiles_copied = 0;
+        while ( tiles_copied < tiles_x && status == 0 )
+        {
+            /* if there is space in the readback ring, render and queue the next tile */
+            if ( tiles_queued < tiles_x && mb_set->readback_pending < MANDELBROT_READBACK_COUNT )
+            {
+                MB_TRACE_BEGIN ( "render tile" );
+                if ( mb_render_region ( mb_set, width, height, tiles_queued * MB_EXPORT_TILE_SIZE, height - band_top - MB_EXPORT_TILE_SIZE, MB_EXPORT_TILE_SIZE, MB_EXPORT_TILE_SIZE ) == -1 ||
+                     mb_queue_readback ( mb_set, tiles_queued ) != 0 ) status = -1;
+                MB_TRACE_END ( "render tile" );
+                ++tiles_queued;
+                continue;
+            }
+
+            /* otherwise copy the oldest tile into the row, waiting for it to be read back
+             * if a tiff or raw dump, the whole tile is copied on its own and written straight away
+             */
+            const unsigned char * tile;
+            int tile_width, tile_height;
+            unsigned long tag;
+            if ( mb_map_readback ( mb_set, 1, &tile, &tile_width, &tile_height, &tag ) == 0 )
+            {
+                const int x = tag * MB_EXPORT_TILE_SIZE;
+                MB_TRACE_BEGIN ( "copy tile" );
+                if ( format == MB_EXPORT_FORMAT_RAW ) __mb_export_copy_raw_tile ( ( const float * ) tile, tile_width, tile_height, ( float * ) band, writer->raw->header.channels );
+                else if ( format == MB_EXPORT_FORMAT_TIFF ) __mb_export_copy_tile ( tile, tile_width, tile_height, band, MB_EXPORT_TILE_SIZE, 0, MB_EXPORT_TILE_SIZE, MB_EXPORT_TILE_SIZE );
+                else __mb_export_copy_tile ( tile, tile_width, tile_height, band, width, x, ( width - x < MB_EXPORT_TILE_SIZE ? width - x : MB_EXPORT_TILE_SIZE ), band_height );
+                if ( mb_unmap_readback ( mb_set ) == -1 ) status = -1;
+                MB_TRACE_END ( "copy tile" );
+                MB_TRACE_BEGIN ( "write tile" );
+                if ( status == 0 && tiled ) status = mb_export_write_tile ( writer, band, tag, band_index );
+                MB_TRACE_END ( "write tile" );
+                ++tiles_copied;
+            } else status = -1;
+        }
+
+        /* write the row, unless its tiles were written already, and journal it
+         * the rows of a PPM are its pixel rows, and the rows of tiles of a raw dump are runs of whole tiles
+         */
+        MB_TRACE_BEGIN ( "write rows" );
+        if ( status == 0 && !tiled ) status = mb_export_write_rows ( writer, band, band_top, band_height );
+        MB_TRACE_END ( "write rows" );
+        if ( status == 0 && checkpoint )
+        {
+            MB_TRACE_BEGIN ( "checkpoint" );
+            const off_t band_length = ( format == MB_EXPORT_FORMAT_RAW ? ( off_t ) ( tiles_x * mb_export_raw_tile_size ( &writer->raw->header ) ) : ( off_t ) band_height * width * 3 );
+            const off_t band_offset = writer->data_offset + ( format == MB_EXPORT_FORMAT_RAW ? band_index * band_length : ( off_t ) band_top * width * 3 );
+            status = mb_export_checkpoint_band ( checkpoint, band_index, band_offset, band_length, writer->fd );
+            MB_TRACE_END ( "checkpoint" );
+        }
+    }
+
+    /* consume any tiles left in the readback ring after a failure */
+    const unsigned char * tile;
+    int tile_width, tile_height;
+    unsigned long tag;
+    while ( mb_set->readback_pending > 0 && mb_map_readback ( mb_set, 1, &tile, &tile_width, &tile_height, &tag ) == 0 ) mb_unmap_readback ( mb_set );
+
+    /* go back to rendering colour, free the row, then close the checkpoint, which syncs the file, and the file */
+    if ( mb_set_output ( mb_set, MANDELBROT_OUTPUT_COLOUR ) == -1 ) status = -1;
+    free ( band );
+    if ( checkpoint && mb_export_close_checkpoint ( checkpoint, checkpoint_path, writer->fd ) == -1 ) status = -1;
+    if ( mb_export_close_writer ( writer ) == -1 ) status = -1;
+    free ( checkpoint_path );
+    if ( status == -1 ) fprintf ( stderr, "MB ERROR: failed to export to %s\n", path );
+
+    /* set the statistics */
+    if ( stats )
+    {
+        struct rusage usage;
+        getrusage ( RUSAGE_SELF, &usage );
+        stats->pixels = ( double ) width * height;
+        stats->pixels_resumed = pixels_resumed;
+        stats->seconds = __mb_export_time () - start_time;
+        stats->mpixels_per_second = ( stats->seconds > 0.0 ? ( stats->pixels - stats->pixels_resumed ) * 1.0e-6 / stats->seconds : 0.0 );
+        stats->peak_rss_kb = usage.ru_maxrss;
+    }
+
+    /* return the status */
+    return status;
+}
+
+/* __mb_export_copy_tile
+ *
+ * copy a tile read back from the frame into a row of tiles
+ * the tile is 8 bit RGBA with the bottom row first, and the row of tiles 8 bit RGB with the top row first
+ *
+ * tile: the pixels of the tile
+ * tile_width/height: the size of the tile read back, which may be more than is copied
+ * band: the row of tiles
+ * band_width: the width of the row of tiles, which is the width of the image
+ * x: the column of the row of tiles to copy the tile to
+ * width/height: the size of the part of the tile to copy, from its top left
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_copy_tile ( const unsigned char * tile, const int tile_width, const int tile_height, unsigned char * band, const int band_width, const int x, const int width, const int height )
+{
+    /* copy each row, flipping the tile and dropping the alpha channel */
+    for ( int row = 0; row < height; ++row )
+    {
+        const unsigned char * src = tile + ( size_t ) ( tile_height - 1 - row ) * tile_width * 4;
+        unsigned char * dst = band + ( ( size_t ) row * band_width + x ) * 3;
+        for ( int i = 0; i < width; ++i, src += 4, dst += 3 )
+        {
+            dst [ 0 ] = src [ 0 ];
+            dst [ 1 ] = src [ 1 ];
+            dst [ 2 ] = src [ 2 ];
+        }
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_export_copy_raw_tile
+ *
+ * copy a tile read back from the frame with raw output into a tile of a raw dump
+ * the tile read back is 32 bit float RGBA with the bottom row first, whose channels are the iterations, magnitude, distance and glitch flag,
+ * and the tile of the raw dump is top row first, with only the channels it holds
+ *
+ * tile: the pixels of the tile
+ * tile_width/height: the size of the tile, which is the size of the tile of the raw dump
+ * raw_tile: the tile of the raw dump
+ * channels: the mask of channels the raw dump holds (MB_EXPORT_RAW_X)
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_copy_raw_tile ( const float * tile, const int tile_width, const int tile_height, float * raw_tile, const int channels )
+{
+    /* copy each row, flipping the tile and keeping only the channels held */
+    for ( int row = 0; row < tile_height; ++row )
+    {
+        const float * src = tile + ( size_t ) ( tile_height - 1 - row ) * tile_width * 4;
+        for ( int i = 0; i < tile_width; ++i, src += 4 )
+        {
+            for ( int channel = 0; channel < 4; ++channel ) if ( channels & ( 1 << channel ) ) *raw_tile++ = src [ channel ];
+        }
+    }
+
+    /* return 0 for success */
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * mb_export.h
+ *
+ * exports images of a mandelbrot set of arbitrary size, such as posters of 100000x100000 pixels
+ * the image is rendered tile by tile through the set's frame, and completed rows of tiles are streamed to the file,
+ * so memory usage is bounded by a single row of tiles regardless of the size of the image
+ * completed rows of tiles are journaled to a checkpoint, so that an export which dies can be resumed by running it again
+ * TIFF files and raw dumps are written a tile at a time rather than a row of tiles, so memory usage is bounded by a single tile
+ */
+
+
+
+/* pragma one */
+#ifndef MB_EXPORT_H_INCLUDED
+#define MB_EXPORT_H_INCLUDED
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <sys/types.h>
+
+/* include mb_handler.h */
+#include <mb_handler/mb_handler.h>
+
+/* include mb_export_checkpoint.h */
+#include "mb_export_checkpoint.h"
+
+/* include mb_export_writer.h */
+#include "mb_export_writer.h"
+
+/* include mb_export_video.h */
+#include "mb_export_video.h"
+
+/* include mb_export_expmap.h */
+#include "mb_export_expmap.h"
+
+
+
+/* STRUCTURES */
+
+/* struct mb_export_stats_t
+ *
+ * statistics about an export, for tracking production jobs
+ */
+typedef struct
+{
+    /* the number of pixels exported, the number of those which were already exported before resuming, and the time taken in seconds */
+    double pixels;
+    double pixels_resumed;
+    double seconds;
+
+    /* millions of pixels exported per second, not counting those already exported */
+    double mpixels_per_second;
+
+    /* peak resident set size of the process in kilobytes */
+    long peak_rss_kb;
+
+} mb_export_stats_t;
+
+
+
+/* FUNCTIONS */
+
+/* mb_export
+ *
+ * render the most recently published view of a set at any size, and write it to a file, in the format given by mb_export_format
+ * uses the context current on the calling thread, such as a headless context
+ * completed rows of tiles of PPM files are journaled to <path>.checkpoint, which is deleted once the export is complete
+ * if the export dies, running it again skips the rows of tiles already completed
+ * PNG files cannot be resumed, as their rows are compressed into a single stream, and nor can TIFF files, as their directory is written last
+ * raw dumps hold the raw values of each pixel rather than colours, so the set is rendered with MANDELBROT_OUTPUT_RAW, and can be resumed
+ *
+ * mb_set: the mandelbrot set to export
+ * width/height: the size of the image in pixels
+ * path: the file to write the image to
+ * stats: will be set to statistics about the export, or NULL
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export ( mb_set_t mb_set, const int width, const int height, const char * path, mb_export_stats_t * stats );
+
+/* __mb_export_copy_tile
+ *
+ * copy a tile read back from the frame into a row of tiles
+ * the tile is 8 bit RGBA with the bottom row first, and the row of tiles 8 bit RGB with the top row first
+ *
+ * tile: the pixels of the tile
+ * tile_width/height: the size of the tile read back, which may be more than is copied
+ * band: the row of tiles
+ * band_width: the width of the row of tiles, which is the width of the image
+ * x: the column of the row of tiles to copy the tile to
+ * width/height: the size of the part of the tile to copy, from its top left
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_copy_tile ( const unsigned char * tile, const int tile_width, const int tile_height, unsigned char * band, const int band_width, const int x, const int width, const int height );
+
+/* __mb_export_copy_raw_tile
+ *
+ * copy a tile read back from the frame with raw output into a tile of a raw dump
+ * the tile read back is 32 bit float RGBA with the bottom row first, whose channels are the iterations, magnitude, distance and glitch flag,
+ * and the tile of the raw dump is top row first, with only the channels it holds
+ *
+ * tile: the pixels of the tile
+ * tile_width/height: the size of the tile, which is the size of the tile of the raw dump
+ * raw_tile: the tile of the raw dump
+ * channels: the mask of channels the raw dump holds (MB_EXPORT_RAW_X)
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_copy_raw_tile ( const float * tile, const int tile_width, const int tile_height, float * raw_tile, const int channels );
+
+
+
+
+/* #ifndef MB_EXPORT_H_INCLUDED */
+#endif
@@ -0,0 +1,230 @@
+/*
+ * mb_export_checkpoint.c
+ *
+ * implementation of mb_export_checkpoint.h
+ */
+
+
+
+/* include mb_export.h, which includes mb_export_checkpoint.h */
+#include "mb_export.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* mb_export_open_checkpoint
+ *
+ * open the journal of an export, loading the rows of tiles already completed if it belongs to the same export
+ * otherwise the journal is started afresh
+ *
+ * path: the journal file
+ * header: the header describing the export
+ * bands: the number of rows of tiles in the export
+ *
+ * return: the journal, or NULL on failure
+ */
+mb_export_checkpoint_t * mb_export_open_checkpoint ( const char * path, const mb_export_checkpoint_header_t * header, const int bands )
+{
+    /* allocate the journal, with no rows of tiles completed */
+    mb_export_checkpoint_t * checkpoint = malloc ( sizeof ( mb_export_checkpoint_t ) );
+    unsigned char * done = calloc ( ( bands + 7 ) / 8, 1 );
+    mb_export_checkpoint_record_t * records = calloc ( bands, sizeof ( mb_export_checkpoint_record_t ) );
+    if ( !checkpoint || !done || !records )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for export checkpoint\n" );
+        free ( checkpoint );
+        free ( done );
+        free ( records );
+        return NULL;
+    }
+    checkpoint->done = done;
+    checkpoint->records = records;
+    checkpoint->bands = bands;
+    checkpoint->bands_done = 0;
+    checkpoint->pending_count = 0;
+    checkpoint->sync_time = __mb_export_time ();
+
+    /* if there is a journal with a matching header, load its records */
+    mb_export_checkpoint_header_t existing;
+    if ( ( checkpoint->fd = open ( path, O_RDWR ) ) != -1 )
+    {
+        if ( read ( checkpoint->fd, &existing, sizeof ( existing ) ) == sizeof ( existing ) && memcmp ( &existing, header, sizeof ( existing ) ) == 0 )
+        {
+            /* read whole records until the end of the journal, ignoring any partial record left by a crash */
+            mb_export_checkpoint_record_t record;
+            off_t end = sizeof ( existing );
+            while ( read ( checkpoint->fd, &record, sizeof ( record ) ) == sizeof ( record ) )
+            {
+                if ( record.band >= 0 && record.band < bands && !mb_export_checkpoint_done ( checkpoint, record.band ) )
+                {
+                    checkpoint->done [ record.band / 8 ] |= 1 << ( record.band % 8 );
+                    checkpoint->records [ record.band ] = record;
+                    ++checkpoint->bands_done;
+                }
+                end += sizeof ( record );
+            }
+
+            /* append after the last whole record, overwriting any partial record */
+            if ( lseek ( checkpoint->fd, end, SEEK_SET ) == end ) return checkpoint;
+        }
+
+        /* the journal belongs to a different export, so start afresh */
+        close ( checkpoint->fd );
+        memset ( checkpoint->done, 0, ( bands + 7 ) / 8 );
+        checkpoint->bands_done = 0;
+    }
+
+    /* create a new journal, and make its header durable */
+    if ( ( checkpoint->fd = open ( path, O_RDWR | O_CREAT | O_TRUNC, 0644 ) ) == -1 ||
+         __mb_export_write_fully ( checkpoint->fd, header, sizeof ( mb_export_checkpoint_header_t ) ) == -1 ||
+         fsync ( checkpoint->fd ) == -1 )
+    {
+        /* failed to create */
+        fprintf ( stderr, "MB ERROR: failed to create export checkpoint %s\n", path );
+        if ( checkpoint->fd != -1 ) close ( checkpoint->fd );
+        free ( checkpoint->done );
+        free ( checkpoint->records );
+        free ( checkpoint );
+        return NULL;
+    }
+
+    /* return the journal */
+    return checkpoint;
+}
+
+/* mb_export_close_checkpoint
+ *
+ * sync and close a journal, deleting it if every row of tiles is complete
+ *
+ * checkpoint: the journal to close
+ * path: the journal file
+ * output_fd: the output file, which is synced before the journal
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_close_checkpoint ( mb_export_checkpoint_t * checkpoint, const char * path, const int output_fd )
+{
+    /* sync any rows of tiles held, and close the journal */
+    int status = mb_export_sync_checkpoint ( checkpoint, output_fd );
+    if ( close ( checkpoint->fd ) == -1 ) status = -1;
+
+    /* if the export is complete, the journal is no longer needed */
+    if ( status == 0 && checkpoint->bands_done == checkpoint->bands ) unlink ( path );
+
+    /* free the journal */
+    free ( checkpoint->done );
+    free ( checkpoint->records );
+    free ( checkpoint );
+
+    /* return the status */
+    return status;
+}
+
+/* mb_export_checkpoint_done
+ *
+ * find whether a row of tiles has been completed
+ *
+ * checkpoint: the journal
+ * band: the index of the row of tiles
+ *
+ * return: 1 if completed, 0 if not
+ */
+int mb_export_checkpoint_done ( const mb_export_checkpoint_t * checkpoint, const int band )
+{
+    /* return the bit of the row of tiles */
+    return ( checkpoint->done [ band / 8 ] >> ( band % 8 ) ) & 1;
+}
+
+/* mb_export_checkpoint_truncate
+ *
+ * forget any completed rows of tiles which lie beyond the end of the output file, such as if the output was truncated
+ *
+ * checkpoint: the journal
+ * output_size: the size of the output file in bytes
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_checkpoint_truncate ( mb_export_checkpoint_t * checkpoint, const off_t output_size )
+{
+    /* clear the bit of each completed row of tiles which is not wholly in the output */
+    for ( int band = 0; band < checkpoint->bands; ++band )
+    {
+        if ( mb_export_checkpoint_done ( checkpoint, band ) && checkpoint->records [ band ].offset + checkpoint->records [ band ].length > output_size )
+        {
+            checkpoint->done [ band / 8 ] &= ~( 1 << ( band % 8 ) );
+            --checkpoint->bands_done;
+        }
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_export_checkpoint_band
+ *
+ * record a row of tiles as completed, syncing once enough rows of tiles are held or enough time has passed
+ *
+ * checkpoint: the journal
+ * band: the index of the row of tiles
+ * offset/length: the offset and length of the rows in the output file
+ * output_fd: the output file, which is synced before the journal
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_checkpoint_band ( mb_export_checkpoint_t * checkpoint, const int band, const off_t offset, const off_t length, const int output_fd )
+{
+    /* hold the record until the next sync */
+    mb_export_checkpoint_record_t * record = &checkpoint->pending [ checkpoint->pending_count++ ];
+    record->band = band;
+    record->offset = offset;
+    record->length = length;
+
+    /* sync if enough records are held, or enough time has passed since the last sync */
+    if ( checkpoint->pending_count == MB_EXPORT_CHECKPOINT_BATCH || __mb_export_time () - checkpoint->sync_time >= MB_EXPORT_CHECKPOINT_INTERVAL ) return mb_export_sync_checkpoint ( checkpoint, output_fd );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_export_sync_checkpoint
+ *
+ * sync the output file, then append the records of the rows of tiles held and sync the journal
+ *
+ * checkpoint: the journal
+ * output_fd: the output file
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_sync_checkpoint ( mb_export_checkpoint_t * checkpoint, const int output_fd )
+{
+    /* if there are no records held, there is nothing to sync */
+    if ( checkpoint->pending_count == 0 ) return 0;
+
+    /* make the rows durable before the records claiming them */
+    if ( fsync ( output_fd ) == -1 ||
+         __mb_export_write_fully ( checkpoint->fd, checkpoint->pending, checkpoint->pending_count * sizeof ( mb_export_checkpoint_record_t ) ) == -1 ||
+         fsync ( checkpoint->fd ) == -1 )
+    {
+        /* failed to sync */
+        fprintf ( stderr, "MB ERROR: failed to sync export checkpoint\n" );
+        return -1;
+    }
+
+    /* mark the rows of tiles as completed */
+    for ( int i = 0; i < checkpoint->pending_count; ++i )
+    {
+        const int band = checkpoint->pending [ i ].band;
+        checkpoint->done [ band / 8 ] |= 1 << ( band % 8 );
+        checkpoint->records [ band ] = checkpoint->pending [ i ];
+        ++checkpoint->bands_done;
+    }
+
+    /* no records are now held */
+    checkpoint->pending_count = 0;
+    checkpoint->sync_time = __mb_export_time ();
+
+    /* return 0 for success */
+    return 0;
+}
@@ -0,0 +1,199 @@
+/*
+ * mb_export_checkpoint.h
+ *
+ * journals the rows of tiles of an export which have been written, so that an export which dies can be resumed
+ * the journal is a header describing the export, followed by a record for each completed row of tiles
+ * records are only appended once the rows they describe have been synced to disk, so the journal never claims rows which were lost,
+ * and syncs are batched so that journaling does not throttle the export
+ */
+
+
+
+/* pragma one */
+#ifndef MB_EXPORT_CHECKPOINT_H_INCLUDED
+#define MB_EXPORT_CHECKPOINT_H_INCLUDED
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/types.h>
+
+/* include mb_view.h */
+#include <mb_handler/mb_view.h>
+
+
+
+/* MACROS */
+
+/* MB_EXPORT_CHECKPOINT_MAGIC
+ *
+ * the first 8 bytes of a journal, which change whenever its layout does
+ */
+#define MB_EXPORT_CHECKPOINT_MAGIC "MBCKPT02"
+
+/* MB_EXPORT_CHECKPOINT_BATCH
+ *
+ * defines the maximum number of completed rows of tiles to hold before syncing the output and journal
+ * can be set during compilation using -DMB_EXPORT_CHECKPOINT_BATCH=rows
+ */
+#ifndef MB_EXPORT_CHECKPOINT_BATCH
+#define MB_EXPORT_CHECKPOINT_BATCH 16
+#endif
+
+/* MB_EXPORT_CHECKPOINT_INTERVAL
+ *
+ * defines the maximum time in seconds to hold completed rows of tiles before syncing the output and journal
+ * can be set during compilation using -DMB_EXPORT_CHECKPOINT_INTERVAL=seconds
+ */
+#ifndef MB_EXPORT_CHECKPOINT_INTERVAL
+#define MB_EXPORT_CHECKPOINT_INTERVAL 5.0
+#endif
+
+
+
+/* STRUCTURES */
+
+/* struct mb_export_checkpoint_header_t
+ *
+ * the header of a journal, describing the export it belongs to
+ * an export is only resumed if every byte matches, so should be zeroed before being filled in
+ */
+typedef struct
+{
+    /* MB_EXPORT_CHECKPOINT_MAGIC */
+    char magic [ 8 ];
+
+    /* size of the image, and of the tiles it is rendered in */
+    int width;
+    int height;
+    int tile_size;
+
+    /* the view being exported, including any reference point its centre is an offset from */
+    mb_view_t view;
+
+} mb_export_checkpoint_header_t;
+
+/* struct mb_export_checkpoint_record_t
+ *
+ * a record of a completed row of tiles
+ */
+typedef struct
+{
+    /* index of the row of tiles, from the top */
+    int64_t band;
+
+    /* offset and length of the rows in the output file */
+    int64_t offset;
+    int64_t length;
+
+} mb_export_checkpoint_record_t;
+
+/* struct mb_export_checkpoint_t
+ *
+ * an open journal
+ */
+typedef struct
+{
+    /* the journal file */
+    int fd;
+
+    /* bitmap of the rows of tiles completed, the number of rows of tiles, and the number completed */
+    unsigned char * done;
+    int bands;
+    int bands_done;
+
+    /* records of completed rows of tiles, and their offsets and lengths, for each row of tiles */
+    mb_export_checkpoint_record_t * records;
+
+    /* records of completed rows of tiles not yet synced, and the time of the last sync */
+    mb_export_checkpoint_record_t pending [ MB_EXPORT_CHECKPOINT_BATCH ];
+    int pending_count;
+    double sync_time;
+
+} mb_export_checkpoint_t;
+
+
+
+/* FUNCTIONS */
+
+/* mb_export_open_checkpoint
+ *
+ * open the journal of an export, loading the rows of tiles already completed if it belongs to the same export
+ * otherwise the journal is started afresh
+ *
+ * path: the journal file
+ * header: the header describing the export
+ * bands: the number of rows of tiles in the export
+ *
+ * return: the journal, or NULL on failure
+ */
+mb_export_checkpoint_t * mb_export_open_checkpoint ( const char * path, const mb_export_checkpoint_header_t * header, const int bands );
+
+/* mb_export_close_checkpoint
+ *
+ * sync and close a journal, deleting it if every row of tiles is complete
+ *
+ * checkpoint: the journal to close
+ * path: the journal file
+ * output_fd: the output file, which is synced before the journal
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_close_checkpoint ( mb_export_checkpoint_t * checkpoint, const char * path, const int output_fd );
+
+/* mb_export_checkpoint_done
+ *
+ * find whether a row of tiles has been completed
+ *
+ * checkpoint: the journal
+ * band: the index of the row of tiles
+ *
+ * return: 1 if completed, 0 if not
+ */
+int mb_export_checkpoint_done ( const mb_export_checkpoint_t * checkpoint, const int band );
+
+/* mb_export_checkpoint_truncate
+ *
+ * forget any completed rows of tiles which lie beyond the end of the output file, such as if the output was truncated
+ *
+ * checkpoint: the journal
+ * output_size: the size of the output file in bytes
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_checkpoint_truncate ( mb_export_checkpoint_t * checkpoint, const off_t output_size );
+
+/* mb_export_checkpoint_band
+ *
+ * record a row of tiles as completed, syncing once enough rows of tiles are held or enough time has passed
+ *
+ * checkpoint: the journal
+ * band: the index of the row of tiles
+ * offset/length: the offset and length of the rows in the output file
+ * output_fd: the output file, which is synced before the journal
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_checkpoint_band ( mb_export_checkpoint_t * checkpoint, const int band, const off_t offset, const off_t length, const int output_fd );
+
+/* mb_export_sync_checkpoint
+ *
+ * sync the output file, then append the records of the rows of tiles held and sync the journal
+ *
+ * checkpoint: the journal
+ * output_fd: the output file
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_sync_checkpoint ( mb_export_checkpoint_t * checkpoint, const int output_fd );
+
+
+
+/* #ifndef MB_EXPORT_CHECKPOINT_H_INCLUDED */
+#endif
@@ -0,0 +1,193 @@
+/*
+ * mb_export_expmap.c
+ *
+ * implementation of mb_export_expmap.h
+ */
+
+
+
+/* include mb_export.h, which includes mb_export_expmap.h */
+#include "mb_export.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* mb_export_render_expmap
+ *
+ * render the log-polar strip for a zoom into the centre of the most recently published view of the set, using the context current
+ * on the calling thread
+ * the strip is rendered with the maximum iterations of the published view, and covers every frame with a stretch between the two given
+ *
+ * mb_set: the mandelbrot set to render
+ * frame_width/height: the size of the frames in pixels
+ * patch_size: the width and height of the patch at the centre of each frame which is rendered rather than resampled, at least 4
+ * outer_stretch: the largest stretch of a frame, which is that of the first frame of a zoom in
+ * inner_stretch: the smallest stretch of a frame, which is that of the last frame of a zoom in
+ *
+ * return: the strip, or NULL on failure
+ */
+mb_export_expmap_t * mb_export_render_expmap ( mb_set_t mb_set, const int frame_width, const int frame_height, const int patch_size, const double outer_stretch, const double inner_stretch )
+{
+    /* check the patch fits in the frames, and the stretches zoom in */
+    if ( patch_size < 4 || patch_size > frame_width || patch_size > frame_height || inner_stretch <= 0.0 || outer_stretch < inner_stretch )
+    {
+        /* invalid zoom */
+        fprintf ( stderr, "MB ERROR: invalid zoom for log-polar strip\n" );
+        return NULL;
+    }
+
+    /* find the rows of the strip, one for each pixel around the corners of a frame, so the strip is never coarser than a frame,
+     * and the columns, from just beyond the corners of the first frame to just inside the patch of the last
+     */
+    const double pi = acos ( -1.0 );
+    const double corner = sqrt ( ( double ) frame_width * frame_width + ( double ) frame_height * frame_height ) / 2.0;
+    const int height = ( int ) ceil ( 2.0 * pi * corner );
+    const double log_step = 2.0 * pi / height;
+    const double log_radius = log ( ( corner + 1.0 ) * outer_stretch );
+    const double log_inner = log ( ( patch_size / 2.0 - 1.0 ) * inner_stretch );
+    const int width = ( int ) ceil ( ( log_radius - log_inner ) / log_step ) + 2;
+
+    /* allocate the strip, its sampling tables and a tile to read back into */
+    mb_export_expmap_t * expmap = malloc ( sizeof ( mb_export_expmap_t ) );
+    unsigned char * strip = malloc ( ( size_t ) width * height * 3 );
+    float * columns = malloc ( ( size_t ) frame_width * frame_height * sizeof ( float ) );
+    float * rows = malloc ( ( size_t ) frame_width * frame_height * sizeof ( float ) );
+    unsigned char * tile = malloc ( ( size_t ) MB_EXPORT_TILE_SIZE * MB_EXPORT_TILE_SIZE * 4 );
+    if ( !expmap || !strip || !columns || !rows || !tile )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for log-polar strip\n" );
+        free ( expmap );
+        free ( strip );
+        free ( columns );
+        free ( rows );
+        free ( tile );
+        return NULL;
+    }
+    expmap->width = width;
+    expmap->height = height;
+    expmap->log_radius = log_radius;
+    expmap->log_step = log_step;
+    expmap->strip = strip;
+    expmap->frame_width = frame_width;
+    expmap->frame_height = frame_height;
+    expmap->patch_x = ( frame_width - patch_size ) / 2;
+    expmap->patch_y = ( frame_height - patch_size ) / 2;
+    expmap->patch_size = patch_size;
+    expmap->columns = columns;
+    expmap->rows = rows;
+
+    /* find the column at a stretch of 1 and the row each pixel of a frame samples, from its distance and direction from the centre */
+    for ( int y = 0; y < frame_height; ++y ) for ( int x = 0; x < frame_width; ++x )
+    {
+        const double dx = x + 0.5 - frame_width / 2.0;
+        const double dy = y + 0.5 - frame_height / 2.0;
+        const double angle = atan2 ( dy, dx );
+        columns [ ( size_t ) y * frame_width + x ] = - log ( sqrt ( dx * dx + dy * dy ) ) / log_step - 0.5;
+        rows [ ( size_t ) y * frame_width + x ] = ( angle < 0.0 ? angle + 2.0 * pi : angle ) / log_step - 0.5;
+    }
+
+    /* render the strip tile by tile, copying each tile into the strip without its alpha channel */
+    int status = 0;
+    for ( int tile_y = 0; tile_y < height && status == 0; tile_y += MB_EXPORT_TILE_SIZE ) for ( int tile_x = 0; tile_x < width && status == 0; tile_x += MB_EXPORT_TILE_SIZE )
+    {
+        const int tile_width = ( width - tile_x < MB_EXPORT_TILE_SIZE ? width - tile_x : MB_EXPORT_TILE_SIZE );
+        const int tile_height = ( height - tile_y < MB_EXPORT_TILE_SIZE ? height - tile_y : MB_EXPORT_TILE_SIZE );
+        if ( mb_render_log_polar ( mb_set, log_radius, log_step, tile_x, tile_y, tile_width, tile_height ) != 0 || mb_read_frame ( mb_set, tile ) != 0 ) { status = -1; break; }
+        for ( int y = 0; y < tile_height; ++y ) for ( int x = 0; x < tile_width; ++x ) for ( int c = 0; c < 3; ++c )
+            strip [ ( ( size_t ) ( tile_y + y ) * width + tile_x + x ) * 3 + c ] = tile [ ( ( size_t ) y * tile_width + x ) * 4 + c ];
+    }
+
+    /* free the tile, and return the strip, or NULL on failure */
+    free ( tile );
+    if ( status != 0 )
+    {
+        fprintf ( stderr, "MB ERROR: failed to render log-polar strip\n" );
+        mb_export_destroy_expmap ( expmap );
+        return NULL;
+    }
+    return expmap;
+}
+
+/* mb_export_destroy_expmap
+ *
+ * destroy a log-polar strip
+ *
+ * expmap: the strip to destroy
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_destroy_expmap ( mb_export_expmap_t * expmap )
+{
+    /* free the strip and its sampling tables */
+    free ( expmap->strip );
+    free ( expmap->columns );
+    free ( expmap->rows );
+    free ( expmap );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_export_expmap_frame
+ *
+ * reconstruct a frame of a zoom by resampling its log-polar strip, bilinearly, and copying in the patch rendered at its centre
+ *
+ * expmap: the strip
+ * stretch: the stretch of the frame, between those the strip was rendered for
+ * patch: the patch, 8 bit RGBA with the bottom row first, rendered as the region of the frame at patch_x/y of size patch_size
+ * pixels: memory to reconstruct the frame into, 8 bit RGBA with the bottom row first
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_expmap_frame ( const mb_export_expmap_t * expmap, const double stretch, const unsigned char * patch, unsigned char * pixels )
+{
+    /* find how far into the strip the frame is, which is all that changes between frames */
+    const float column_offset = ( expmap->log_radius - log ( stretch ) ) / expmap->log_step;
+    const int width = expmap->width;
+    const int height = expmap->height;
+
+    /* reconstruct each pixel */
+    for ( int y = 0; y < expmap->frame_height; ++y ) for ( int x = 0; x < expmap->frame_width; ++x )
+    {
+        /* find the pixel, and if it is in the patch, copy it from the patch */
+        const size_t index = ( size_t ) y * expmap->frame_width + x;
+        unsigned char * pixel = pixels + index * 4;
+        const int patch_x = x - expmap->patch_x;
+        const int patch_y = y - expmap->patch_y;
+        if ( patch_x >= 0 && patch_x < expmap->patch_size && patch_y >= 0 && patch_y < expmap->patch_size )
+        {
+            memcpy ( pixel, patch + ( ( size_t ) patch_y * expmap->patch_size + patch_x ) * 4, 4 );
+            continue;
+        }
+
+        /* otherwise find the columns and rows of the strip either side of it, clamping the columns and wrapping the rows round */
+        const float column = expmap->columns [ index ] + column_offset;
+        const float row = expmap->rows [ index ];
+        int column_0 = ( int ) floorf ( column );
+        int row_0 = ( int ) floorf ( row );
+        if ( column_0 < 0 ) column_0 = 0;
+        if ( column_0 > width - 2 ) column_0 = width - 2;
+        const float column_fraction = fminf ( fmaxf ( column - column_0, 0.0f ), 1.0f );
+        const float row_fraction = row - row_0;
+        if ( row_0 < 0 ) row_0 += height;
+        const int row_1 = ( row_0 + 1 == height ? 0 : row_0 + 1 );
+
+        /* interpolate between the four samples */
+        const unsigned char * sample_00 = expmap->strip + ( ( size_t ) row_0 * width + column_0 ) * 3;
+        const unsigned char * sample_10 = sample_00 + 3;
+        const unsigned char * sample_01 = expmap->strip + ( ( size_t ) row_1 * width + column_0 ) * 3;
+        const unsigned char * sample_11 = sample_01 + 3;
+        for ( int c = 0; c < 3; ++c )
+        {
+            const float bottom = sample_00 [ c ] + ( sample_10 [ c ] - sample_00 [ c ] ) * column_fraction;
+            const float top = sample_01 [ c ] + ( sample_11 [ c ] - sample_01 [ c ] ) * column_fraction;
+            pixel [ c ] = ( unsigned char ) ( bottom + ( top - bottom ) * row_fraction + 0.5f );
+        }
+        pixel [ 3 ] = 255;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * mb_export_expmap.h
+ *
+ * renders zoom videos from an exponential map, a log-polar strip around the centre being zoomed into, rather than every frame from scratch
+ * each column of the strip is a step in the log of the distance from the centre, and each row an angle, so the whole zoom is held in a
+ * single image which is rendered once, and each frame is then reconstructed by resampling the strip, apart from a small patch at its
+ * centre, which the strip cannot hold, and which is rendered at full resolution for every frame
+ * the steps in distance and angle are equal, so the strip is conformal, and its rows are spaced so that it is never coarser than a frame
+ */
+
+
+
+/* pragma one */
+#ifndef MB_EXPORT_EXPMAP_H_INCLUDED
+#define MB_EXPORT_EXPMAP_H_INCLUDED
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <math.h>
+
+/* include mb_handler.h */
+#include <mb_handler/mb_handler.h>
+
+
+
+/* MACROS */
+
+/* MB_EXPORT_EXPMAP_PATCH
+ *
+ * defines the width and height in pixels of the patch at the centre of each frame which is rendered rather than resampled
+ * can be set during compilation using -DMB_EXPORT_EXPMAP_PATCH=size
+ */
+#ifndef MB_EXPORT_EXPMAP_PATCH
+#define MB_EXPORT_EXPMAP_PATCH 64
+#endif
+
+
+
+/* STRUCTURES */
+
+/* struct mb_export_expmap_t
+ *
+ * a log-polar strip of a zoom, and how to reconstruct its frames
+ */
+typedef struct
+{
+    /* size of the strip, which has a column for each step in the log of the distance from the centre, and a row for each angle */
+    int width;
+    int height;
+
+    /* the log of the distance from the centre at the left edge of the strip, and the step in it and in the angle across each pixel */
+    double log_radius;
+    double log_step;
+
+    /* the strip as 8 bit RGB, bottom row first */
+    unsigned char * strip;
+
+    /* size of the frames, and the bottom left pixel and size of the patch at their centre which is rendered rather than resampled */
+    int frame_width;
+    int frame_height;
+    int patch_x;
+    int patch_y;
+    int patch_size;
+
+    /* for each pixel of a frame, bottom row first, the column of the strip it samples at a stretch of 1, and the row of the strip it samples,
+     * which depend only on the direction and distance of the pixel from the centre, so are found once for every frame
+     */
+    float * columns;
+    float * rows;
+
+} mb_export_expmap_t;
+
+
+
+/* FUNCTIONS */
+
+/* mb_export_render_expmap
+ *
+ * render the log-polar strip for a zoom into the centre of the most recently published view of the set, using the context current
+ * on the calling thread
+ * the strip is rendered with the maximum iterations of the published view, and covers every frame with a stretch between the two given
+ *
+ * mb_set: the mandelbrot set to render
+ * frame_width/height: the size of the frames in pixels
+ * patch_size: the width and height of the patch at the centre of each frame which is rendered rather than resampled, at least 4
+ * outer_stretch: the largest stretch of a frame, which is that of the first frame of a zoom in
+ * inner_stretch: the smallest stretch of a frame, which is that of the last frame of a zoom in
+ *
+ * return: the strip, or NULL on failure
+ */
+mb_export_expmap_t * mb_export_render_expmap ( mb_set_t mb_set, const int frame_width, const int frame_height, const int patch_size, const double outer_stretch, const double inner_stretch );
+
+/* mb_export_destroy_expmap
+ *
+ * destroy a log-polar strip
+ *
+ * expmap: the strip to destroy
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_destroy_expmap ( mb_export_expmap_t * expmap );
+
+/* mb_export_expmap_frame
+ *
+ * reconstruct a frame of a zoom by resampling its log-polar strip, bilinearly, and copying in the patch rendered at its centre
+ *
+ * expmap: the strip
+ * stretch: the stretch of the frame, between those the strip was rendered for
+ * patch: the patch, 8 bit RGBA with the bottom row first, rendered as the region of the frame at patch_x/y of size patch_size
+ * pixels: memory to reconstruct the frame into, 8 bit RGBA with the bottom row first
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_expmap_frame ( const mb_export_expmap_t * expmap, const double stretch, const unsigned char * patch, unsigned char * pixels );
+
+
+
+/* #ifndef MB_EXPORT_EXPMAP_H_INCLUDED */
+#endif
@@ -0,0 +1,455 @@
+/*
+ * mb_export_png.c
+ *
+ * implementation of mb_export_png.h
+ */
+
+
+
+/* include mb_export_writer.h, which includes mb_export_png.h */
+#include "mb_export_writer.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* mb_export_open_png
+ *
+ * open a PNG file to write an image to, and write everything before the image data
+ *
+ * path: the file to write to
+ * width/height: the size of the image in pixels
+ * level: the zlib compression level
+ * threads: the maximum number of threads to compress with, or 0 to use one per online processor
+ *
+ * return: the png, or NULL on failure
+ */
+mb_export_png_t * mb_export_open_png ( const char * path, const int width, const int height, const int level, const int threads )
+{
+    /* allocate the png, and its last row and window */
+    mb_export_png_t * png = malloc ( sizeof ( mb_export_png_t ) );
+    unsigned char * prev_row = malloc ( ( size_t ) width * 3 );
+    unsigned char * window = malloc ( MB_EXPORT_PNG_WINDOW );
+    if ( !png || !prev_row || !window )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for png\n" );
+        free ( png );
+        free ( prev_row );
+        free ( window );
+        return NULL;
+    }
+    png->width = width;
+    png->height = height;
+    png->level = level;
+    png->threads = ( threads > 0 ? threads : ( int ) sysconf ( _SC_NPROCESSORS_ONLN ) );
+    if ( png->threads < 1 ) png->threads = 1;
+    png->rows_written = 0;
+    png->adler = adler32 ( 0, NULL, 0 );
+    png->prev_row = prev_row;
+    png->window = window;
+    png->window_length = 0;
+
+    /* create the signature and header of the file, for 8 bit RGB with no interlacing */
+    const unsigned char signature [ 8 ] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    unsigned char ihdr [ 13 ] = { 0 };
+    __mb_export_png_put_uint32 ( ihdr, width );
+    __mb_export_png_put_uint32 ( ihdr + 4, height );
+    ihdr [ 8 ] = 8;
+    ihdr [ 9 ] = 2;
+
+    /* create the zlib header, whose check bits make it a multiple of 31, in an IDAT chunk of its own */
+    unsigned char zlib_header [ 2 ] = { 0x78, ( level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3 ) << 6 };
+    zlib_header [ 1 ] += 31 - ( ( zlib_header [ 0 ] * 256 + zlib_header [ 1 ] ) % 31 );
+
+    /* open the file and write everything before the image data */
+    if ( ( png->fd = open ( path, O_WRONLY | O_CREAT | O_TRUNC, 0644 ) ) == -1 ||
+         __mb_export_write_fully ( png->fd, signature, sizeof ( signature ) ) == -1 ||
+         __mb_export_png_write_chunk ( png, "IHDR", ihdr, sizeof ( ihdr ) ) == -1 ||
+         __mb_export_png_write_chunk ( png, "IDAT", zlib_header, sizeof ( zlib_header ) ) == -1 )
+    {
+        /* failed to open */
+        fprintf ( stderr, "MB ERROR: failed to open %s for writing\n", path );
+        if ( png->fd != -1 ) close ( png->fd );
+        free ( png->prev_row );
+        free ( png->window );
+        free ( png );
+        return NULL;
+    }
+
+    /* return the png */
+    return png;
+}
+
+/* mb_export_write_png_rows
+ *
+ * write the next rows of the image, filtering and deflating them in parallel bands
+ * the rows must be written in order from the top of the image down
+ *
+ * png: the png to write to
+ * rows: the rows of 8 bit RGB pixels, top row first
+ * count: the number of rows
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_write_png_rows ( mb_export_png_t * png, const unsigned char * rows, const int count )
+{
+    /* check the rows fit in the image */
+    if ( count <= 0 || png->rows_written + count > png->height )
+    {
+        /* rows outside of the image */
+        fprintf ( stderr, "MB ERROR: attempted to write rows outside of the png\n" );
+        return -1;
+    }
+
+    /* split the rows into a band per thread, unless that would make the bands too small */
+    const size_t row_length = ( size_t ) png->width * 3;
+    int band_count = count / MB_EXPORT_PNG_MIN_BAND_ROWS;
+    if ( band_count > png->threads ) band_count = png->threads;
+    if ( band_count < 1 ) band_count = 1;
+
+    /* allocate the bands and the filtered rows, each of which has its filter type byte first */
+    mb_export_png_band_t * bands = calloc ( band_count, sizeof ( mb_export_png_band_t ) );
+    unsigned char * filtered = malloc ( ( size_t ) count * ( row_length + 1 ) );
+    if ( !bands || !filtered )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for png rows\n" );
+        free ( bands );
+        free ( filtered );
+        return -1;
+    }
+
+    /* set up the bands, each of which is filtered against the row before it and primed with the filtered data before it */
+    for ( int i = 0, first_row = 0; i < band_count; ++i )
+    {
+        const int band_rows = count / band_count + ( i < count % band_count ? 1 : 0 );
+        const size_t offset = ( size_t ) first_row * ( row_length + 1 );
+        bands [ i ].png = png;
+        bands [ i ].rows = rows + first_row * row_length;
+        bands [ i ].prev_row = ( first_row > 0 ? rows + ( first_row - 1 ) * row_length : png->rows_written > 0 ? png->prev_row : NULL );
+        bands [ i ].count = band_rows;
+        bands [ i ].filtered = filtered + offset;
+        bands [ i ].filtered_length = ( size_t ) band_rows * ( row_length + 1 );
+        bands [ i ].dictionary = ( i > 0 ? filtered + offset - ( offset < MB_EXPORT_PNG_WINDOW ? offset : MB_EXPORT_PNG_WINDOW ) : png->window );
+        bands [ i ].dictionary_length = ( i > 0 ? ( offset < MB_EXPORT_PNG_WINDOW ? offset : MB_EXPORT_PNG_WINDOW ) : png->window_length );
+        bands [ i ].last = ( i == band_count - 1 && png->rows_written + count == png->height );
+        first_row += band_rows;
+    }
+
+    /* filter all of the bands, then deflate them, as each band is primed with the filtered data of the band before */
+    int status = __mb_export_png_run_bands ( bands, band_count, __mb_export_png_filter_band );
+    if ( status == 0 ) status = __mb_export_png_run_bands ( bands, band_count, __mb_export_png_deflate_band );
+
+    /* write each band as an IDAT chunk, combining its checksum into the checksum of the stream */
+    MB_TRACE_BEGIN ( "png write chunks" );
+    for ( int i = 0; i < band_count && status == 0; ++i )
+    {
+        status = __mb_export_png_write_chunk ( png, "IDAT", bands [ i ].deflated, bands [ i ].deflated_length );
+        png->adler = adler32_combine ( png->adler, bands [ i ].adler, bands [ i ].filtered_length );
+    }
+    MB_TRACE_END ( "png write chunks" );
+
+    /* keep the last row, and the end of the filtered data to prime the next band with */
+    if ( status == 0 )
+    {
+        const size_t filtered_length = ( size_t ) count * ( row_length + 1 );
+        memcpy ( png->prev_row, rows + ( size_t ) ( count - 1 ) * row_length, row_length );
+        if ( filtered_length >= MB_EXPORT_PNG_WINDOW )
+        {
+            memcpy ( png->window, filtered + filtered_length - MB_EXPORT_PNG_WINDOW, MB_EXPORT_PNG_WINDOW );
+            png->window_length = MB_EXPORT_PNG_WINDOW;
+        } else
+        {
+            const size_t keep = ( png->window_length < MB_EXPORT_PNG_WINDOW - filtered_length ? png->window_length : MB_EXPORT_PNG_WINDOW - filtered_length );
+            memmove ( png->window, png->window + png->window_length - keep, keep );
+            memcpy ( png->window + keep, filtered, filtered_length );
+            png->window_length = keep + filtered_length;
+        }
+        png->rows_written += count;
+    }
+
+    /* if the image is complete, end the zlib stream with its checksum, in an IDAT chunk of its own */
+    if ( status == 0 && png->rows_written == png->height )
+    {
+        unsigned char trailer [ 4 ];
+        __mb_export_png_put_uint32 ( trailer, png->adler );
+        status = __mb_export_png_write_chunk ( png, "IDAT", trailer, sizeof ( trailer ) );
+    }
+
+    /* free the bands and filtered rows */
+    for ( int i = 0; i < band_count; ++i ) free ( bands [ i ].deflated );
+    free ( bands );
+    free ( filtered );
+
+    /* return the status */
+    return status;
+}
+
+/* mb_export_close_png
+ *
+ * close a png, ending the file, which fails if not every row of the image has been written
+ *
+ * png: the png to close
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_close_png ( mb_export_png_t * png )
+{
+    /* end the file if every row has been written, and close it */
+    int status = ( png->rows_written == png->height ? __mb_export_png_write_chunk ( png, "IEND", NULL, 0 ) : -1 );
+    if ( close ( png->fd ) == -1 ) status = -1;
+
+    /* free the png */
+    free ( png->prev_row );
+    free ( png->window );
+    free ( png );
+
+    /* return the status */
+    return status;
+}
+
+/* __mb_export_png_filter_band
+ *
+ * filter the rows of a band, choosing the filter of each row which gives the smallest sum of absolute differences
+ * run by a thread for each band
+ *
+ * arg: the band
+ *
+ * return: NULL
+ */
+void * __mb_export_png_filter_band ( void * arg )
+{
+    /* get the band */
+    mb_export_png_band_t * band = arg;
+    const int length = band->png->width * 3;
+
+    /* allocate a row to try filters in, and a row of zeros to filter the first row of the image against */
+    unsigned char * candidate = malloc ( length + 1 );
+    unsigned char * zero_row = ( band->prev_row ? NULL : calloc ( length, 1 ) );
+    if ( !candidate || ( !band->prev_row && !zero_row ) )
+    {
+        /* failed to allocate */
+        free ( candidate );
+        free ( zero_row );
+        band->status = -1;
+        return NULL;
+    }
+
+    /* filter each row with every filter type, keeping the one with the smallest sum */
+    MB_TRACE_BEGIN ( "png filter band" );
+    const unsigned char * prev_row = ( band->prev_row ? band->prev_row : zero_row );
+    for ( int i = 0; i < band->count; ++i )
+    {
+        const unsigned char * row = band->rows + ( size_t ) i * length;
+        unsigned char * filtered = band->filtered + ( size_t ) i * ( length + 1 );
+        unsigned long best = __mb_export_png_filter_row ( row, prev_row, length, 0, filtered );
+        for ( int type = 1; type <= 4; ++type )
+        {
+            const unsigned long sum = __mb_export_png_filter_row ( row, prev_row, length, type, candidate );
+            if ( sum < best )
+            {
+                best = sum;
+                memcpy ( filtered, candidate, length + 1 );
+            }
+        }
+        prev_row = row;
+    }
+    MB_TRACE_END ( "png filter band" );
+
+    /* free the rows and return */
+    free ( candidate );
+    free ( zero_row );
+    band->status = 0;
+    return NULL;
+}
+
+/* __mb_export_png_filter_row
+ *
+ * filter a row with a filter type
+ *
+ * row: the row to filter
+ * prev_row: the row before it, which is all zero for the first row of the image
+ * length: the length of the row in bytes
+ * type: the filter type, from 0 (none) to 4 (paeth)
+ * filtered: where to write the filter type byte followed by the filtered row
+ *
+ * return: the sum of the absolute values of the filtered bytes, taken as signed
+ */
+unsigned long __mb_export_png_filter_row ( const unsigned char * row, const unsigned char * prev_row, const int length, const int type, unsigned char * filtered )
+{
+    /* write the filter type */
+    filtered [ 0 ] = type;
+    unsigned char * out = filtered + 1;
+
+    /* filter each byte against the byte of the pixel to its left (a), above (b) and above and to the left (c) */
+    switch ( type )
+    {
+        case 0: memcpy ( out, row, length ); break;
+        case 1: for ( int i = 0; i < length; ++i ) out [ i ] = row [ i ] - ( i >= 3 ? row [ i - 3 ] : 0 ); break;
+        case 2: for ( int i = 0; i < length; ++i ) out [ i ] = row [ i ] - prev_row [ i ]; break;
+        case 3: for ( int i = 0; i < length; ++i ) out [ i ] = row [ i ] - ( ( ( i >= 3 ? row [ i - 3 ] : 0 ) + prev_row [ i ] ) >> 1 ); break;
+        case 4: for ( int i = 0; i < length; ++i )
+        {
+            const int a = ( i >= 3 ? row [ i - 3 ] : 0 ), b = prev_row [ i ], c = ( i >= 3 ? prev_row [ i - 3 ] : 0 );
+            const int pa = abs ( b - c ), pb = abs ( a - c ), pc = abs ( a + b - 2 * c );
+            out [ i ] = row [ i ] - ( pa <= pb && pa <= pc ? a : pb <= pc ? b : c );
+        } break;
+    }
+
+    /* sum the absolute values of the bytes, taken as signed */
+    unsigned long sum = 0;
+    for ( int i = 0; i < length; ++i ) sum += ( out [ i ] < 128 ? out [ i ] : 256 - out [ i ] );
+
+    /* return the sum */
+    return sum;
+}
+
+/* __mb_export_png_deflate_band
+ *
+ * deflate the filtered rows of a band as a raw deflate stream, primed with its dictionary
+ * run by a thread for each band
+ *
+ * arg: the band
+ *
+ * return: NULL
+ */
+void * __mb_export_png_deflate_band ( void * arg )
+{
+    /* get the band */
+    mb_export_png_band_t * band = arg;
+    band->status = -1;
+
+    /* initialise a raw deflate stream, primed with the dictionary */
+    z_stream stream;
+    memset ( &stream, 0, sizeof ( z_stream ) );
+    if ( deflateInit2 ( &stream, band->png->level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY ) != Z_OK ) return NULL;
+    if ( band->dictionary_length > 0 && deflateSetDictionary ( &stream, band->dictionary, band->dictionary_length ) != Z_OK )
+    {
+        deflateEnd ( &stream );
+        return NULL;
+    }
+
+    /* allocate enough for the deflated rows, along with the bytes of a sync flush */
+    size_t capacity = deflateBound ( &stream, band->filtered_length ) + 16;
+    if ( !( band->deflated = malloc ( capacity ) ) )
+    {
+        deflateEnd ( &stream );
+        return NULL;
+    }
+
+    /* deflate the rows, finishing the stream if this is the last band, or otherwise sync flushing it so that the next band can follow on
+     * deflate is called again, with more space, until it has written everything
+     */
+    MB_TRACE_BEGIN ( "png deflate band" );
+    stream.next_in = band->filtered;
+    stream.avail_in = band->filtered_length;
+    stream.next_out = band->deflated;
+    stream.avail_out = capacity;
+    int result;
+    while ( ( result = deflate ( &stream, ( band->last ? Z_FINISH : Z_SYNC_FLUSH ) ) ) != Z_STREAM_ERROR && ( band->last ? result != Z_STREAM_END : stream.avail_out == 0 ) )
+    {
+        unsigned char * deflated = realloc ( band->deflated, capacity * 2 );
+        if ( !deflated ) break;
+        band->deflated = deflated;
+        stream.next_out = band->deflated + capacity;
+        stream.avail_out = capacity;
+        capacity *= 2;
+    }
+    band->deflated_length = capacity - stream.avail_out;
+    deflateEnd ( &stream );
+    MB_TRACE_END ( "png deflate band" );
+
+    /* find the checksum of the rows */
+    band->adler = adler32 ( adler32 ( 0, NULL, 0 ), band->filtered, band->filtered_length );
+
+    /* set the status and return */
+    if ( result != Z_STREAM_ERROR && ( band->last ? result == Z_STREAM_END : stream.avail_out > 0 ) ) band->status = 0;
+    return NULL;
+}
+
+/* __mb_export_png_run_bands
+ *
+ * run a function for each band, on a thread per band, and wait for them all
+ *
+ * bands: the bands
+ * count: the number of bands
+ * function: the function to run
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_png_run_bands ( mb_export_png_band_t * bands, const int count, void * ( * function ) ( void * ) )
+{
+    /* start a thread for every band but the first, which is run on this thread, running any band whose thread fails to start here too */
+    pthread_t threads [ count ];
+    int started [ count ];
+    for ( int i = 1; i < count; ++i ) started [ i ] = ( pthread_create ( &threads [ i ], NULL, function, &bands [ i ] ) == 0 );
+    function ( &bands [ 0 ] );
+    for ( int i = 1; i < count; ++i )
+    {
+        if ( started [ i ] ) pthread_join ( threads [ i ], NULL );
+        else function ( &bands [ i ] );
+    }
+
+    /* return -1 if any band failed */
+    for ( int i = 0; i < count; ++i ) if ( bands [ i ].status != 0 ) return -1;
+    return 0;
+}
+
+/* __mb_export_png_write_chunk
+ *
+ * write a chunk to a png, along with its length and crc
+ *
+ * png: the png to write to
+ * type: the 4 character type of the chunk
+ * data: the data of the chunk
+ * length: the length of the data in bytes
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_png_write_chunk ( mb_export_png_t * png, const char * type, const unsigned char * data, const size_t length )
+{
+    /* create the length and type, and the crc of the type and data
+     * zlib treats a NULL buffer as a request for the initial crc, so the data is only included if there is some
+     */
+    unsigned char head [ 8 ], crc [ 4 ];
+    __mb_export_png_put_uint32 ( head, length );
+    memcpy ( head + 4, type, 4 );
+    uLong chunk_crc = crc32 ( crc32 ( 0, NULL, 0 ), head + 4, 4 );
+    if ( length > 0 ) chunk_crc = crc32 ( chunk_crc, data, length );
+    __mb_export_png_put_uint32 ( crc, chunk_crc );
+
+    /* write the chunk */
+    if ( __mb_export_write_fully ( png->fd, head, sizeof ( head ) ) == -1 ||
+         ( length > 0 && __mb_export_write_fully ( png->fd, data, length ) == -1 ) ||
+         __mb_export_write_fully ( png->fd, crc, sizeof ( crc ) ) == -1 )
+    {
+        /* failed to write */
+        fprintf ( stderr, "MB ERROR: failed to write png chunk\n" );
+        return -1;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_export_png_put_uint32
+ *
+ * store a 32 bit unsigned integer in big endian order, as all integers in png files are
+ *
+ * bytes: where to store the integer
+ * value: the integer
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_png_put_uint32 ( unsigned char * bytes, const uint32_t value )
+{
+    /* store each byte, most significant first */
+    bytes [ 0 ] = value >> 24;
+    bytes [ 1 ] = value >> 16;
+    bytes [ 2 ] = value >> 8;
+    bytes [ 3 ] = value;
+
+    /* return 0 for success */
+    return 0;
+}
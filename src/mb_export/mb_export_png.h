@@ -0,0 +1,254 @@
+/*
+ * mb_export_png.h
+ *
+ * writes 8 bit RGB PNG files a number of rows at a time, using zlib for deflate but without libpng
+ * the rows given in each call are split into bands, which are filtered and then deflated in parallel as separate raw deflate streams
+ * every band but the last ends with a sync flush, so the streams join into a single zlib stream, and each band becomes one IDAT chunk
+ * each band is primed with the last 32KiB of the band before it, so splitting costs little compression
+ */
+
+
+
+/* pragma one */
+#ifndef MB_EXPORT_PNG_H_INCLUDED
+#define MB_EXPORT_PNG_H_INCLUDED
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/types.h>
+
+/* include zlib */
+#include <zlib.h>
+
+/* include mb_trace.h */
+#include <mb_trace/mb_trace.h>
+
+
+
+/* MACROS */
+
+/* MB_EXPORT_PNG_LEVEL
+ *
+ * defines the zlib compression level of PNG files
+ * can be set during compilation using -DMB_EXPORT_PNG_LEVEL=level
+ */
+#ifndef MB_EXPORT_PNG_LEVEL
+#define MB_EXPORT_PNG_LEVEL 6
+#endif
+
+/* MB_EXPORT_PNG_THREADS
+ *
+ * defines the maximum number of threads used to compress PNG files, or 0 to use one per online processor
+ * can be set during compilation using -DMB_EXPORT_PNG_THREADS=threads
+ */
+#ifndef MB_EXPORT_PNG_THREADS
+#define MB_EXPORT_PNG_THREADS 0
+#endif
+
+/* MB_EXPORT_PNG_MIN_BAND_ROWS
+ *
+ * defines the minimum number of rows in a band, so that small writes are not split into bands too small to compress well
+ */
+#define MB_EXPORT_PNG_MIN_BAND_ROWS 32
+
+/* MB_EXPORT_PNG_WINDOW
+ *
+ * the size of the deflate window, which is how much of the previous band each band is primed with
+ */
+#define MB_EXPORT_PNG_WINDOW 32768
+
+
+
+/* STRUCTURES */
+
+/* struct mb_export_png_t
+ *
+ * a PNG file being written
+ */
+typedef struct
+{
+    /* the file being written */
+    int fd;
+
+    /* size of the image */
+    int width;
+    int height;
+
+    /* compression level, and the maximum number of threads to compress with */
+    int level;
+    int threads;
+
+    /* the number of rows written so far */
+    int rows_written;
+
+    /* adler-32 checksum of the filtered rows deflated so far */
+    uLong adler;
+
+    /* the last row written, which the next row is filtered against */
+    unsigned char * prev_row;
+
+    /* the last filtered data deflated, up to MB_EXPORT_PNG_WINDOW bytes, which primes the next band */
+    unsigned char * window;
+    size_t window_length;
+
+} mb_export_png_t;
+
+/* struct mb_export_png_band_t
+ *
+ * a band of rows being filtered and deflated by a thread
+ */
+typedef struct
+{
+    /* the png being written */
+    const mb_export_png_t * png;
+
+    /* the rows of the band, the row before them, or NULL if they start the image, and the number of rows */
+    const unsigned char * rows;
+    const unsigned char * prev_row;
+    int count;
+
+    /* the filtered rows, each with its filter type byte first */
+    unsigned char * filtered;
+    size_t filtered_length;
+
+    /* the data to prime the deflate stream with */
+    const unsigned char * dictionary;
+    size_t dictionary_length;
+
+    /* whether the band ends the image, so should finish the stream rather than sync flush */
+    int last;
+
+    /* the deflated band, its length, and the adler-32 checksum of the filtered rows */
+    unsigned char * deflated;
+    size_t deflated_length;
+    uLong adler;
+
+    /* 0 if the band was filtered and deflated successfully, -1 otherwise */
+    int status;
+
+} mb_export_png_band_t;
+
+
+
+/* FUNCTIONS */
+
+/* mb_export_open_png
+ *
+ * open a PNG file to write an image to, and write everything before the image data
+ *
+ * path: the file to write to
+ * width/height: the size of the image in pixels
+ * level: the zlib compression level
+ * threads: the maximum number of threads to compress with, or 0 to use one per online processor
+ *
+ * return: the png, or NULL on failure
+ */
+mb_export_png_t * mb_export_open_png ( const char * path, const int width, const int height, const int level, const int threads );
+
+/* mb_export_write_png_rows
+ *
+ * write the next rows of the image, filtering and deflating them in parallel bands
+ * the rows must be written in order from the top of the image down
+ *
+ * png: the png to write to
+ * rows: the rows of 8 bit RGB pixels, top row first
+ * count: the number of rows
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_write_png_rows ( mb_export_png_t * png, const unsigned char * rows, const int count );
+
+/* mb_export_close_png
+ *
+ * close a png, ending the file, which fails if not every row of the image has been written
+ *
+ * png: the png to close
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_close_png ( mb_export_png_t * png );
+
+/* __mb_export_png_filter_band
+ *
+ * filter the rows of a band, choosing the filter of each row which gives the smallest sum of absolute differences
+ * run by a thread for each band
+ *
+ * arg: the band
+ *
+ * return: NULL
+ */
+void * __mb_export_png_filter_band ( void * arg );
+
+/* __mb_export_png_filter_row
+ *
+ * filter a row with a filter type
+ *
+ * row: the row to filter
+ * prev_row: the row before it, which is all zero for the first row of the image
+ * length: the length of the row in bytes
+ * type: the filter type, from 0 (none) to 4 (paeth)
+ * filtered: where to write the filter type byte followed by the filtered row
+ *
+ * return: the sum of the absolute values of the filtered bytes, taken as signed
+ */
+unsigned long __mb_export_png_filter_row ( const unsigned char * row, const unsigned char * prev_row, const int length, const int type, unsigned char * filtered );
+
+/* __mb_export_png_deflate_band
+ *
+ * deflate the filtered rows of a band as a raw deflate stream, primed with its dictionary
+ * run by a thread for each band
+ *
+ * arg: the band
+ *
+ * return: NULL
+ */
+void * __mb_export_png_deflate_band ( void * arg );
+
+/* __mb_export_png_run_bands
+ *
+ * run a function for each band, on a thread per band, and wait for them all
+ *
+ * bands: the bands
+ * count: the number of bands
+ * function: the function to run
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_png_run_bands ( mb_export_png_band_t * bands, const int count, void * ( * function ) ( void * ) );
+
+/* __mb_export_png_write_chunk
+ *
+ * write a chunk to a png, along with its length and crc
+ *
+ * png: the png to write to
+ * type: the 4 character type of the chunk
+ * data: the data of the chunk
+ * length: the length of the data in bytes
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_png_write_chunk ( mb_export_png_t * png, const char * type, const unsigned char * data, const size_t length );
+
+/* __mb_export_png_put_uint32
+ *
+ * store a 32 bit unsigned integer in big endian order, as all integers in png files are
+ *
+ * bytes: where to store the integer
+ * value: the integer
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_png_put_uint32 ( unsigned char * bytes, const uint32_t value );
+
+
+
+/* #ifndef MB_EXPORT_PNG_H_INCLUDED */
+#endif
@@ -0,0 +1,160 @@
+/*
+ * mb_export_raw.c
+ *
+ * implementation of mb_export_raw.h
+ */
+
+
+
+/* include mb_export_writer.h, which includes mb_export_raw.h */
+#include "mb_export_writer.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* mb_export_open_raw
+ *
+ * open a raw dump to write an image to, and write its header
+ *
+ * path: the file to write to
+ * width/height: the size of the image in pixels
+ * tile_size: the width and height of each tile in pixels
+ * channels: the mask of channels to hold (MB_EXPORT_RAW_X), to which the iterations and magnitude are added
+ * view: the view being rendered, or NULL to leave it zeroed
+ * resume: 1 to keep the existing tiles of the file, 0 to truncate it
+ *
+ * return: the raw dump, or NULL on failure
+ */
+mb_export_raw_t * mb_export_open_raw ( const char * path, const int width, const int height, const int tile_size, const int channels, const mb_view_t * view, const int resume )
+{
+    /* allocate the raw dump */
+    mb_export_raw_t * raw = malloc ( sizeof ( mb_export_raw_t ) );
+    if ( !raw )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for raw dump\n" );
+        return NULL;
+    }
+
+    /* fill in the header, zeroed first so that its padding is deterministic */
+    mb_export_raw_header_t * header = &raw->header;
+    memset ( header, 0, sizeof ( mb_export_raw_header_t ) );
+    memcpy ( header->magic, MB_EXPORT_RAW_MAGIC, sizeof ( header->magic ) );
+    header->data_offset = MB_EXPORT_RAW_ALIGNMENT;
+    header->width = width;
+    header->height = height;
+    header->tile_size = tile_size;
+    header->tiles_x = ( width + tile_size - 1 ) / tile_size;
+    header->tiles_y = ( height + tile_size - 1 ) / tile_size;
+    header->channels = ( channels | MB_EXPORT_RAW_ITERATIONS | MB_EXPORT_RAW_MAGNITUDE ) & ( MB_EXPORT_RAW_ITERATIONS | MB_EXPORT_RAW_MAGNITUDE | MB_EXPORT_RAW_DISTANCE | MB_EXPORT_RAW_GLITCH );
+    for ( int i = 0; i < 4; ++i ) header->channel_count += ( header->channels >> i ) & 1;
+    if ( view ) header->view = *view;
+
+    /* pad the header to the start of the tiles */
+    unsigned char padded [ MB_EXPORT_RAW_ALIGNMENT ];
+    memset ( padded, 0, sizeof ( padded ) );
+    memcpy ( padded, header, sizeof ( mb_export_raw_header_t ) );
+
+    /* open the file, find its existing size, and write the header */
+    if ( ( raw->fd = open ( path, O_RDWR | O_CREAT | ( resume ? 0 : O_TRUNC ), 0644 ) ) == -1 ||
+         ( raw->existing_size = lseek ( raw->fd, 0, SEEK_END ) ) == -1 ||
+         lseek ( raw->fd, 0, SEEK_SET ) != 0 ||
+         __mb_export_write_fully ( raw->fd, padded, sizeof ( padded ) ) == -1 )
+    {
+        /* failed to open */
+        fprintf ( stderr, "MB ERROR: failed to open %s for writing\n", path );
+        if ( raw->fd != -1 ) close ( raw->fd );
+        free ( raw );
+        return NULL;
+    }
+
+    /* return the raw dump */
+    return raw;
+}
+
+/* mb_export_write_raw_tile
+ *
+ * write a tile of the image, which may be written in any order
+ *
+ * raw: the raw dump to write to
+ * tile_x/y: the column and row of the tile, from the top left
+ * pixels: the pixels of the tile, top row first, each the floats of the channels of the dump
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_write_raw_tile ( mb_export_raw_t * raw, const int tile_x, const int tile_y, const float * pixels )
+{
+    /* check the tile is in the image */
+    if ( tile_x < 0 || tile_x >= ( int ) raw->header.tiles_x || tile_y < 0 || tile_y >= ( int ) raw->header.tiles_y )
+    {
+        /* tile outside of the image */
+        fprintf ( stderr, "MB ERROR: attempted to write tile outside of the raw dump\n" );
+        return -1;
+    }
+
+    /* seek to the tile, which starts with its top left pixel, and write it */
+    const off_t offset = mb_export_raw_offset ( &raw->header, tile_x * raw->header.tile_size, tile_y * raw->header.tile_size );
+    if ( lseek ( raw->fd, offset, SEEK_SET ) != offset || __mb_export_write_fully ( raw->fd, pixels, mb_export_raw_tile_size ( &raw->header ) ) == -1 )
+    {
+        /* failed to write */
+        fprintf ( stderr, "MB ERROR: failed to write raw dump tile\n" );
+        return -1;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_export_close_raw
+ *
+ * close a raw dump
+ *
+ * raw: the raw dump to close
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_close_raw ( mb_export_raw_t * raw )
+{
+    /* close the file */
+    const int status = close ( raw->fd );
+
+    /* free the raw dump */
+    free ( raw );
+
+    /* return the status */
+    return status;
+}
+
+/* mb_export_raw_offset
+ *
+ * find the offset in a raw dump of the first float of a pixel
+ *
+ * header: the header of the dump
+ * x/y: the pixel, from the top left
+ *
+ * return: the offset in bytes
+ */
+uint64_t mb_export_raw_offset ( const mb_export_raw_header_t * header, const int x, const int y )
+{
+    /* find the tile the pixel is in, then the pixel within the tile */
+    const uint64_t tile = ( uint64_t ) ( y / header->tile_size ) * header->tiles_x + ( x / header->tile_size );
+    const uint64_t pixel = ( uint64_t ) ( y % header->tile_size ) * header->tile_size + ( x % header->tile_size );
+
+    /* return the offset of the pixel after the header */
+    return header->data_offset + tile * mb_export_raw_tile_size ( header ) + pixel * header->channel_count * sizeof ( float );
+}
+
+/* mb_export_raw_tile_size
+ *
+ * find the size of a tile of a raw dump
+ *
+ * header: the header of the dump
+ *
+ * return: the size in bytes
+ */
+uint64_t mb_export_raw_tile_size ( const mb_export_raw_header_t * header )
+{
+    /* return the size of the pixels of a whole tile */
+    return ( uint64_t ) header->tile_size * header->tile_size * header->channel_count * sizeof ( float );
+}
@@ -0,0 +1,187 @@
+/*
+ * mb_export_raw.h
+ *
+ * writes raw dumps, which hold the raw values each pixel was iterated to rather than its colour, so that a render can be
+ * recoloured, analysed or downsampled later without iterating again
+ * a raw dump is a header padded to a page, followed by the tiles of the image across then down, each tile's pixels top row first,
+ * and each pixel the 32 bit floats of the channels in the dump, in the byte order of the machine which wrote it
+ * every pixel has a fixed offset, given by mb_export_raw_offset, so a dump can be mapped into memory and only the tiles used are read
+ */
+
+
+
+/* pragma one */
+#ifndef MB_EXPORT_RAW_H_INCLUDED
+#define MB_EXPORT_RAW_H_INCLUDED
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/types.h>
+
+/* include mb_view.h */
+#include <mb_handler/mb_view.h>
+
+
+
+/* MACROS */
+
+/* MB_EXPORT_RAW_MAGIC
+ *
+ * the first 8 bytes of a raw dump, which change whenever its layout does
+ */
+#define MB_EXPORT_RAW_MAGIC "MBRAW002"
+
+/* MB_EXPORT_RAW_ALIGNMENT
+ *
+ * the size the header is padded to, so that the tiles start on a page boundary
+ */
+#define MB_EXPORT_RAW_ALIGNMENT 4096
+
+/* MB_EXPORT_RAW_X
+ *
+ * the channels a raw dump may hold, as bits of its channel mask, which are stored in each pixel in this order
+ * ITERATIONS is the number of iterations completed, which is the maximum iterations inside the set
+ * MAGNITUDE is the final |z|^2, which with the iterations gives a smooth iteration count
+ * DISTANCE is the exterior distance estimate on the complex plane, or 0 inside the set
+ * GLITCH is 1 where neighbouring pixels were too close to tell apart with floats, otherwise 0
+ */
+#define MB_EXPORT_RAW_ITERATIONS 1
+#define MB_EXPORT_RAW_MAGNITUDE 2
+#define MB_EXPORT_RAW_DISTANCE 4
+#define MB_EXPORT_RAW_GLITCH 8
+
+/* MB_EXPORT_RAW_CHANNELS
+ *
+ * defines the channel mask of raw dumps, to which the iterations and magnitude are always added
+ * can be set during compilation using -DMB_EXPORT_RAW_CHANNELS=mask
+ */
+#ifndef MB_EXPORT_RAW_CHANNELS
+#define MB_EXPORT_RAW_CHANNELS ( MB_EXPORT_RAW_ITERATIONS | MB_EXPORT_RAW_MAGNITUDE | MB_EXPORT_RAW_DISTANCE | MB_EXPORT_RAW_GLITCH )
+#endif
+
+
+
+/* STRUCTURES */
+
+/* struct mb_export_raw_header_t
+ *
+ * the header at the start of a raw dump
+ */
+typedef struct
+{
+    /* MB_EXPORT_RAW_MAGIC */
+    char magic [ 8 ];
+
+    /* the offset of the first tile, which is the size of the padded header */
+    uint32_t data_offset;
+
+    /* size of the image, and of its tiles */
+    uint32_t width;
+    uint32_t height;
+    uint32_t tile_size;
+
+    /* the number of tiles across and down the image */
+    uint32_t tiles_x;
+    uint32_t tiles_y;
+
+    /* the mask of channels held (MB_EXPORT_RAW_X), and the number of them, which is the number of floats in each pixel */
+    uint32_t channels;
+    uint32_t channel_count;
+
+    /* the view rendered, which gives the maximum iterations, breakout and power the pixels were iterated with, and the reference point
+     * its centre is an offset from if it was perturbed
+     */
+    mb_view_t view;
+
+} mb_export_raw_header_t;
+
+/* struct mb_export_raw_t
+ *
+ * a raw dump being written
+ */
+typedef struct
+{
+    /* the file being written */
+    int fd;
+
+    /* the header of the dump */
+    mb_export_raw_header_t header;
+
+    /* size of the file when it was opened */
+    off_t existing_size;
+
+} mb_export_raw_t;
+
+
+
+/* FUNCTIONS */
+
+/* mb_export_open_raw
+ *
+ * open a raw dump to write an image to, and write its header
+ *
+ * path: the file to write to
+ * width/height: the size of the image in pixels
+ * tile_size: the width and height of each tile in pixels
+ * channels: the mask of channels to hold (MB_EXPORT_RAW_X), to which the iterations and magnitude are added
+ * view: the view being rendered, or NULL to leave it zeroed
+ * resume: 1 to keep the existing tiles of the file, 0 to truncate it
+ *
+ * return: the raw dump, or NULL on failure
+ */
+mb_export_raw_t * mb_export_open_raw ( const char * path, const int width, const int height, const int tile_size, const int channels, const mb_view_t * view, const int resume );
+
+/* mb_export_write_raw_tile
+ *
+ * write a tile of the image, which may be written in any order
+ *
+ * raw: the raw dump to write to
+ * tile_x/y: the column and row of the tile, from the top left
+ * pixels: the pixels of the tile, top row first, each the floats of the channels of the dump
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_write_raw_tile ( mb_export_raw_t * raw, const int tile_x, const int tile_y, const float * pixels );
+
+/* mb_export_close_raw
+ *
+ * close a raw dump
+ *
+ * raw: the raw dump to close
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_close_raw ( mb_export_raw_t * raw );
+
+/* mb_export_raw_offset
+ *
+ * find the offset in a raw dump of the first float of a pixel
+ *
+ * header: the header of the dump
+ * x/y: the pixel, from the top left
+ *
+ * return: the offset in bytes
+ */
+uint64_t mb_export_raw_offset ( const mb_export_raw_header_t * header, const int x, const int y );
+
+/* mb_export_raw_tile_size
+ *
+ * find the size of a tile of a raw dump
+ *
+ * header: the header of the dump
+ *
+ * return: the size in bytes
+ */
+uint64_t mb_export_raw_tile_size ( const mb_export_raw_header_t * header );
+
+
+
+/* #ifndef MB_EXPORT_RAW_H_INCLUDED */
+#endif
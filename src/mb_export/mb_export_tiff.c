@@ -0,0 +1,319 @@
+/*
+ * mb_export_tiff.c
+ *
+ * implementation of mb_export_tiff.h
+ */
+
+
+
+/* include mb_export_writer.h, which includes mb_export_tiff.h */
+#include "mb_export_writer.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* mb_export_open_tiff
+ *
+ * open a tiled BigTIFF file to write an image to, and write its header
+ *
+ * path: the file to write to
+ * width/height: the size of the image in pixels
+ * tile_size: the width and height of each tile in pixels, which must be a multiple of 16
+ * level: the zlib compression level of each tile, or 0 to write tiles uncompressed
+ *
+ * return: the tiff, or NULL on failure
+ */
+mb_export_tiff_t * mb_export_open_tiff ( const char * path, const int width, const int height, const int tile_size, const int level )
+{
+    /* check the tile size is one tiff readers accept */
+    if ( tile_size <= 0 || tile_size % 16 != 0 )
+    {
+        /* invalid tile size */
+        fprintf ( stderr, "MB ERROR: tiff tile size must be a multiple of 16\n" );
+        return NULL;
+    }
+
+    /* allocate the tiff, with no tiles written */
+    const int tiles_x = ( width + tile_size - 1 ) / tile_size;
+    const int tiles_y = ( height + tile_size - 1 ) / tile_size;
+    mb_export_tiff_t * tiff = malloc ( sizeof ( mb_export_tiff_t ) );
+    uint64_t * tile_offsets = calloc ( ( size_t ) tiles_x * tiles_y, sizeof ( uint64_t ) );
+    uint64_t * tile_lengths = calloc ( ( size_t ) tiles_x * tiles_y, sizeof ( uint64_t ) );
+    if ( !tiff || !tile_offsets || !tile_lengths )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for tiff\n" );
+        free ( tiff );
+        free ( tile_offsets );
+        free ( tile_lengths );
+        return NULL;
+    }
+    tiff->width = width;
+    tiff->height = height;
+    tiff->tile_size = tile_size;
+    tiff->tiles_x = tiles_x;
+    tiff->tiles_y = tiles_y;
+    tiff->level = level;
+    tiff->tile_offsets = tile_offsets;
+    tiff->tile_lengths = tile_lengths;
+    tiff->tiles_written = 0;
+
+    /* uncompressed tiles have a fixed place after the header, in order, so the tiles end after the last of them
+     * deflated tiles are appended in the order they are written, so the tiles end straight after the header
+     */
+    const uint64_t tile_bytes = ( uint64_t ) tile_size * tile_size * 3;
+    tiff->end = MB_EXPORT_TIFF_HEADER_SIZE + ( level > 0 ? 0 : tile_bytes * tiles_x * tiles_y );
+
+    /* create the header, which is the byte order, version 43 for BigTIFF, the size of offsets, and the offset of the directory, not yet known */
+    unsigned char header [ MB_EXPORT_TIFF_HEADER_SIZE ] = { 'I', 'I' };
+    __mb_export_tiff_put ( header + 2, 43, 2 );
+    __mb_export_tiff_put ( header + 4, 8, 2 );
+    __mb_export_tiff_put ( header + 6, 0, 2 );
+    __mb_export_tiff_put ( header + 8, 0, 8 );
+
+    /* open the file and write the header */
+    if ( ( tiff->fd = open ( path, O_RDWR | O_CREAT | O_TRUNC, 0644 ) ) == -1 ||
+         __mb_export_write_fully ( tiff->fd, header, sizeof ( header ) ) == -1 )
+    {
+        /* failed to open */
+        fprintf ( stderr, "MB ERROR: failed to open %s for writing\n", path );
+        if ( tiff->fd != -1 ) close ( tiff->fd );
+        free ( tiff->tile_offsets );
+        free ( tiff->tile_lengths );
+        free ( tiff );
+        return NULL;
+    }
+
+    /* create the mutex */
+    pthread_mutex_init ( &tiff->mutex, NULL );
+
+    /* return the tiff */
+    return tiff;
+}
+
+/* mb_export_write_tiff_tile
+ *
+ * write a tile of the image, which may be written in any order and from any thread
+ * deflating the tile happens before taking the tiff's mutex, so tiles are compressed in parallel
+ * tiles on the right and bottom edges of the image are still whole, and the pixels beyond the image are ignored by readers
+ *
+ * tiff: the tiff to write to
+ * tile_x/y: the column and row of the tile, from the top left
+ * pixels: the 8 bit RGB pixels of the tile, top row first
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_write_tiff_tile ( mb_export_tiff_t * tiff, const int tile_x, const int tile_y, const unsigned char * pixels )
+{
+    /* check the tile is in the image */
+    if ( tile_x < 0 || tile_x >= tiff->tiles_x || tile_y < 0 || tile_y >= tiff->tiles_y )
+    {
+        /* tile outside of the image */
+        fprintf ( stderr, "MB ERROR: attempted to write tile outside of the tiff\n" );
+        return -1;
+    }
+
+    /* find the index of the tile, which tiff orders across then down, and its size */
+    const int index = tile_y * tiff->tiles_x + tile_x;
+    const size_t row_bytes = ( size_t ) tiff->tile_size * 3;
+    const size_t tile_bytes = row_bytes * tiff->tile_size;
+
+    /* if deflating, apply the horizontal predictor, which replaces each sample with its difference from the pixel to its left, then deflate the tile */
+    const unsigned char * data = pixels;
+    unsigned char * deflated = NULL;
+    uLongf length = tile_bytes;
+    if ( tiff->level > 0 )
+    {
+        unsigned char * predicted = malloc ( tile_bytes );
+        length = compressBound ( tile_bytes );
+        deflated = malloc ( length );
+        if ( !predicted || !deflated )
+        {
+            /* failed to allocate */
+            fprintf ( stderr, "MB ERROR: failed to allocate memory for tiff tile\n" );
+            free ( predicted );
+            free ( deflated );
+            return -1;
+        }
+        for ( size_t row = 0; row < tile_bytes; row += row_bytes )
+        {
+            memcpy ( predicted + row, pixels + row, 3 );
+            for ( size_t i = 3; i < row_bytes; ++i ) predicted [ row + i ] = pixels [ row + i ] - pixels [ row + i - 3 ];
+        }
+        const int deflate_status = compress2 ( deflated, &length, predicted, tile_bytes, tiff->level );
+        free ( predicted );
+        if ( deflate_status != Z_OK )
+        {
+            /* failed to deflate */
+            fprintf ( stderr, "MB ERROR: failed to deflate tiff tile\n" );
+            free ( deflated );
+            return -1;
+        }
+        data = deflated;
+    }
+
+    /* holding the mutex, find where the tile goes, which is appended if deflated, and write it there */
+    pthread_mutex_lock ( &tiff->mutex );
+    const uint64_t offset = ( tiff->level > 0 ? tiff->end : MB_EXPORT_TIFF_HEADER_SIZE + ( uint64_t ) index * tile_bytes );
+    int status = 0;
+    if ( lseek ( tiff->fd, offset, SEEK_SET ) != ( off_t ) offset || __mb_export_write_fully ( tiff->fd, data, length ) == -1 )
+    {
+        /* failed to write */
+        fprintf ( stderr, "MB ERROR: failed to write tiff tile\n" );
+        status = -1;
+    } else
+    {
+        /* record the tile, counting it unless it is being rewritten */
+        if ( tiff->level > 0 ) tiff->end += length;
+        if ( tiff->tile_lengths [ index ] == 0 ) ++tiff->tiles_written;
+        tiff->tile_offsets [ index ] = offset;
+        tiff->tile_lengths [ index ] = length;
+    }
+    pthread_mutex_unlock ( &tiff->mutex );
+
+    /* free the deflated tile */
+    free ( deflated );
+
+    /* return the status */
+    return status;
+}
+
+/* mb_export_close_tiff
+ *
+ * close a tiff, writing its directory, which fails if not every tile of the image has been written
+ *
+ * tiff: the tiff to close
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_close_tiff ( mb_export_tiff_t * tiff )
+{
+    /* check every tile has been written */
+    const uint64_t tiles = ( uint64_t ) tiff->tiles_x * tiff->tiles_y;
+    int status = 0;
+    if ( ( uint64_t ) tiff->tiles_written != tiles )
+    {
+        /* tiles missing */
+        fprintf ( stderr, "MB ERROR: attempted to close tiff with tiles missing\n" );
+        status = -1;
+    }
+
+    /* the directory goes after the tiles on a word boundary, followed by the offsets then lengths of the tiles
+     * the directory is a count of entries, the entries, and the offset of the next directory, which is 0 as there is none
+     */
+    const int entries = 12;
+    const uint64_t directory_offset = ( tiff->end + 7 ) & ~( uint64_t ) 7;
+    const uint64_t directory_size = 8 + entries * 20 + 8;
+    const uint64_t offsets_offset = directory_offset + directory_size;
+    const uint64_t lengths_offset = offsets_offset + tiles * 8;
+
+    /* allocate the directory and arrays, along with the padding before them */
+    const size_t padding = directory_offset - tiff->end;
+    const size_t size = padding + directory_size + tiles * 16;
+    unsigned char * directory = ( status == 0 ? calloc ( size, 1 ) : NULL );
+    if ( status == 0 && !directory )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for tiff directory\n" );
+        status = -1;
+    }
+
+    /* create and write the directory, then point the header at it */
+    if ( status == 0 )
+    {
+        /* fill in the entries, in ascending order of tag
+         * values of 8 bytes or fewer are held in the entry, so the arrays of the tiles are only elsewhere if there are several tiles
+         */
+        unsigned char * entry = directory + padding;
+        __mb_export_tiff_put ( entry, entries, 8 );
+        entry += 8;
+        __mb_export_tiff_entry ( entry, 256, MB_EXPORT_TIFF_TYPE_LONG, 1, tiff->width ); entry += 20;
+        __mb_export_tiff_entry ( entry, 257, MB_EXPORT_TIFF_TYPE_LONG, 1, tiff->height ); entry += 20;
+        __mb_export_tiff_entry ( entry, 258, MB_EXPORT_TIFF_TYPE_SHORT, 3, 8 | ( 8 << 16 ) | ( ( uint64_t ) 8 << 32 ) ); entry += 20;
+        __mb_export_tiff_entry ( entry, 259, MB_EXPORT_TIFF_TYPE_SHORT, 1, ( tiff->level > 0 ? 8 : 1 ) ); entry += 20;
+        __mb_export_tiff_entry ( entry, 262, MB_EXPORT_TIFF_TYPE_SHORT, 1, 2 ); entry += 20;
+        __mb_export_tiff_entry ( entry, 277, MB_EXPORT_TIFF_TYPE_SHORT, 1, 3 ); entry += 20;
+        __mb_export_tiff_entry ( entry, 284, MB_EXPORT_TIFF_TYPE_SHORT, 1, 1 ); entry += 20;
+        __mb_export_tiff_entry ( entry, 317, MB_EXPORT_TIFF_TYPE_SHORT, 1, ( tiff->level > 0 ? 2 : 1 ) ); entry += 20;
+        __mb_export_tiff_entry ( entry, 322, MB_EXPORT_TIFF_TYPE_LONG, 1, tiff->tile_size ); entry += 20;
+        __mb_export_tiff_entry ( entry, 323, MB_EXPORT_TIFF_TYPE_LONG, 1, tiff->tile_size ); entry += 20;
+        __mb_export_tiff_entry ( entry, 324, MB_EXPORT_TIFF_TYPE_LONG8, tiles, ( tiles == 1 ? tiff->tile_offsets [ 0 ] : offsets_offset ) ); entry += 20;
+        __mb_export_tiff_entry ( entry, 325, MB_EXPORT_TIFF_TYPE_LONG8, tiles, ( tiles == 1 ? tiff->tile_lengths [ 0 ] : lengths_offset ) ); entry += 20;
+        __mb_export_tiff_put ( entry, 0, 8 );
+
+        /* fill in the offsets and lengths of the tiles */
+        for ( uint64_t i = 0; i < tiles; ++i )
+        {
+            __mb_export_tiff_put ( directory + padding + directory_size + i * 8, tiff->tile_offsets [ i ], 8 );
+            __mb_export_tiff_put ( directory + padding + directory_size + ( tiles + i ) * 8, tiff->tile_lengths [ i ], 8 );
+        }
+
+        /* write the directory after the tiles, then its offset into the header */
+        unsigned char header_offset [ 8 ];
+        __mb_export_tiff_put ( header_offset, directory_offset, 8 );
+        if ( lseek ( tiff->fd, tiff->end, SEEK_SET ) != ( off_t ) tiff->end ||
+             __mb_export_write_fully ( tiff->fd, directory, size ) == -1 ||
+             lseek ( tiff->fd, 8, SEEK_SET ) != 8 ||
+             __mb_export_write_fully ( tiff->fd, header_offset, sizeof ( header_offset ) ) == -1 )
+        {
+            /* failed to write */
+            fprintf ( stderr, "MB ERROR: failed to write tiff directory\n" );
+            status = -1;
+        }
+    }
+
+    /* close the file and free the tiff */
+    if ( close ( tiff->fd ) == -1 ) status = -1;
+    pthread_mutex_destroy ( &tiff->mutex );
+    free ( directory );
+    free ( tiff->tile_offsets );
+    free ( tiff->tile_lengths );
+    free ( tiff );
+
+    /* return the status */
+    return status;
+}
+
+/* __mb_export_tiff_entry
+ *
+ * fill in a BigTIFF directory entry
+ *
+ * entry: the 20 bytes of the entry
+ * tag: the tag of the field
+ * type: the type of the field (MB_EXPORT_TIFF_TYPE_X)
+ * count: the number of values of the field
+ * value: the value of the field if it fits in 8 bytes, or otherwise the offset of its values
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_tiff_entry ( unsigned char * entry, const uint16_t tag, const uint16_t type, const uint64_t count, const uint64_t value )
+{
+    /* store the tag, type and count, then the value, whose bytes in little endian order are its values from the first */
+    __mb_export_tiff_put ( entry, tag, 2 );
+    __mb_export_tiff_put ( entry + 2, type, 2 );
+    __mb_export_tiff_put ( entry + 4, count, 8 );
+    __mb_export_tiff_put ( entry + 12, value, 8 );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_export_tiff_put
+ *
+ * store an unsigned integer of some number of bytes in little endian order, as all integers in the file are
+ *
+ * bytes: where to store the integer
+ * value: the integer
+ * size: the number of bytes to store
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_tiff_put ( unsigned char * bytes, const uint64_t value, const int size )
+{
+    /* store each byte, lowest first */
+    for ( int i = 0; i < size; ++i ) bytes [ i ] = ( value >> ( 8 * i ) ) & 0xff;
+
+    /* return 0 for success */
+    return 0;
+}
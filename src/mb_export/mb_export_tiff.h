@@ -0,0 +1,167 @@
+/*
+ * mb_export_tiff.h
+ *
+ * writes 8 bit RGB tiled BigTIFF files, which have 64 bit offsets so can be far larger than 4GiB
+ * tiles may be written in any order, and from any number of threads, and are written straight to their place in the file
+ * uncompressed tiles have fixed offsets, and deflated tiles are appended as they arrive, so no tiles are held in memory
+ * the directory, which records the offset of every tile, is written when the file is closed
+ */
+
+
+
+/* pragma one */
+#ifndef MB_EXPORT_TIFF_H_INCLUDED
+#define MB_EXPORT_TIFF_H_INCLUDED
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/types.h>
+
+/* include zlib */
+#include <zlib.h>
+
+
+
+/* MACROS */
+
+/* MB_EXPORT_TIFF_LEVEL
+ *
+ * defines the zlib compression level of deflated tiles, or 0 to write tiles uncompressed
+ * deflated tiles use the horizontal predictor, which deflates far better on smooth images
+ * can be set during compilation using -DMB_EXPORT_TIFF_LEVEL=level
+ */
+#ifndef MB_EXPORT_TIFF_LEVEL
+#define MB_EXPORT_TIFF_LEVEL 6
+#endif
+
+/* MB_EXPORT_TIFF_HEADER_SIZE
+ *
+ * the size of a BigTIFF header, after which the tiles start
+ */
+#define MB_EXPORT_TIFF_HEADER_SIZE 16
+
+/* MB_EXPORT_TIFF_TYPE_X
+ *
+ * the tiff field types used in the directory
+ */
+#define MB_EXPORT_TIFF_TYPE_SHORT 3
+#define MB_EXPORT_TIFF_TYPE_LONG 4
+#define MB_EXPORT_TIFF_TYPE_LONG8 16
+
+
+
+/* STRUCTURES */
+
+/* struct mb_export_tiff_t
+ *
+ * a tiled BigTIFF file being written
+ */
+typedef struct
+{
+    /* the file being written */
+    int fd;
+
+    /* size of the image, and of its tiles, which must be a multiple of 16 */
+    int width;
+    int height;
+    int tile_size;
+
+    /* the number of tiles across and down the image */
+    int tiles_x;
+    int tiles_y;
+
+    /* compression level, or 0 if tiles are uncompressed */
+    int level;
+
+    /* offset and length in the file of each tile, and the number of tiles written */
+    uint64_t * tile_offsets;
+    uint64_t * tile_lengths;
+    int tiles_written;
+
+    /* the end of the tiles written so far */
+    uint64_t end;
+
+    /* mutex held while seeking and writing, so that tiles can be written from any thread */
+    pthread_mutex_t mutex;
+
+} mb_export_tiff_t;
+
+
+
+/* FUNCTIONS */
+
+/* mb_export_open_tiff
+ *
+ * open a tiled BigTIFF file to write an image to, and write its header
+ *
+ * path: the file to write to
+ * width/height: the size of the image in pixels
+ * tile_size: the width and height of each tile in pixels, which must be a multiple of 16
+ * level: the zlib compression level of each tile, or 0 to write tiles uncompressed
+ *
+ * return: the tiff, or NULL on failure
+ */
+mb_export_tiff_t * mb_export_open_tiff ( const char * path, const int width, const int height, const int tile_size, const int level );
+
+/* mb_export_write_tiff_tile
+ *
+ * write a tile of the image, which may be written in any order and from any thread
+ * deflating the tile happens before taking the tiff's mutex, so tiles are compressed in parallel
+ * tiles on the right and bottom edges of the image are still whole, and the pixels beyond the image are ignored by readers
+ *
+ * tiff: the tiff to write to
+ * tile_x/y: the column and row of the tile, from the top left
+ * pixels: the 8 bit RGB pixels of the tile, top row first
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_write_tiff_tile ( mb_export_tiff_t * tiff, const int tile_x, const int tile_y, const unsigned char * pixels );
+
+/* mb_export_close_tiff
+ *
+ * close a tiff, writing its directory, which fails if not every tile of the image has been written
+ *
+ * tiff: the tiff to close
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_close_tiff ( mb_export_tiff_t * tiff );
+
+/* __mb_export_tiff_entry
+ *
+ * fill in a BigTIFF directory entry
+ *
+ * entry: the 20 bytes of the entry
+ * tag: the tag of the field
+ * type: the type of the field (MB_EXPORT_TIFF_TYPE_X)
+ * count: the number of values of the field
+ * value: the value of the field if it fits in 8 bytes, or otherwise the offset of its values
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_tiff_entry ( unsigned char * entry, const uint16_t tag, const uint16_t type, const uint64_t count, const uint64_t value );
+
+/* __mb_export_tiff_put
+ *
+ * store an unsigned integer of some number of bytes in little endian order, as all integers in the file are
+ *
+ * bytes: where to store the integer
+ * value: the integer
+ * size: the number of bytes to store
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_tiff_put ( unsigned char * bytes, const uint64_t value, const int size );
+
+
+
+/* #ifndef MB_EXPORT_TIFF_H_INCLUDED */
+#endif
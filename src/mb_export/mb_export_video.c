@@ -0,0 +1,282 @@
+/*
+ * mb_export_video.c
+ *
+ * implementation of mb_export_video.h
+ */
+
+
+
+/* include mb_export.h, which includes mb_export_video.h */
+#include "mb_export.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* mb_export_open_video
+ *
+ * start streaming a video to a file descriptor, writing its header and starting the writing thread
+ *
+ * fd: the file to write to, which is not closed with the video
+ * width/height: the size of the frames in pixels
+ * format: the format to write the frames in (MB_EXPORT_VIDEO_X)
+ *
+ * return: the video, or NULL on failure
+ */
+mb_export_video_t * mb_export_open_video ( const int fd, const int width, const int height, const int format )
+{
+    /* check the format */
+    if ( format != MB_EXPORT_VIDEO_Y4M && format != MB_EXPORT_VIDEO_RGB )
+    {
+        /* invalid format */
+        fprintf ( stderr, "MB ERROR: invalid video format\n" );
+        return NULL;
+    }
+
+    /* find the size of a converted frame, which for Y4M starts with its frame header */
+    const size_t pixels = ( size_t ) width * height;
+    const size_t chroma = ( size_t ) ( ( width + 1 ) / 2 ) * ( ( height + 1 ) / 2 );
+    const size_t converted_size = ( format == MB_EXPORT_VIDEO_Y4M ? strlen ( "FRAME\n" ) + pixels + chroma * 2 : pixels * 3 );
+
+    /* allocate the video, its ring of frames and its converted frame */
+    mb_export_video_t * video = calloc ( 1, sizeof ( mb_export_video_t ) );
+    int allocated = ( video != NULL );
+    if ( video )
+    {
+        for ( int i = 0; i < MB_EXPORT_VIDEO_QUEUE; ++i ) if ( !( video->frames [ i ] = malloc ( pixels * 4 ) ) ) allocated = 0;
+        if ( !( video->converted = malloc ( converted_size ) ) ) allocated = 0;
+    }
+    if ( !allocated )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for video\n" );
+        if ( video ) for ( int i = 0; i < MB_EXPORT_VIDEO_QUEUE; ++i ) free ( video->frames [ i ] );
+        if ( video ) free ( video->converted );
+        free ( video );
+        return NULL;
+    }
+    video->fd = fd;
+    video->width = width;
+    video->height = height;
+    video->format = format;
+    video->converted_size = converted_size;
+
+    /* write the header of a Y4M video, which gives the size, frame rate, progressive scan, square pixels, the chroma layout and the full colour range,
+     * without which readers take the frames to be limited range and crush their colours
+     */
+    char header [ 128 ];
+    const int header_length = snprintf ( header, sizeof ( header ), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XYSCSS=420JPEG XCOLORRANGE=FULL\n", width, height, MB_EXPORT_VIDEO_FPS );
+    if ( format == MB_EXPORT_VIDEO_Y4M && __mb_export_write_fully ( fd, header, header_length ) == -1 )
+    {
+        /* failed to write */
+        fprintf ( stderr, "MB ERROR: failed to write video header\n" );
+        for ( int i = 0; i < MB_EXPORT_VIDEO_QUEUE; ++i ) free ( video->frames [ i ] );
+        free ( video->converted );
+        free ( video );
+        return NULL;
+    }
+
+    /* create the mutex and condition, and start the writing thread */
+    pthread_mutex_init ( &video->mutex, NULL );
+    pthread_cond_init ( &video->cond, NULL );
+    if ( pthread_create ( &video->thread, NULL, __mb_export_video_thread, video ) != 0 )
+    {
+        /* failed to start the thread */
+        fprintf ( stderr, "MB ERROR: failed to start video writing thread\n" );
+        pthread_cond_destroy ( &video->cond );
+        pthread_mutex_destroy ( &video->mutex );
+        for ( int i = 0; i < MB_EXPORT_VIDEO_QUEUE; ++i ) free ( video->frames [ i ] );
+        free ( video->converted );
+        free ( video );
+        return NULL;
+    }
+
+    /* return the video */
+    return video;
+}
+
+/* mb_export_write_video_frame
+ *
+ * queue a frame to be written, waiting only if the queue is full
+ * the frame is copied, so may be reused or unmapped as soon as this returns
+ *
+ * video: the video to write to
+ * pixels: the frame, 8 bit RGBA with the bottom row first, of the size of the video
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_write_video_frame ( mb_export_video_t * video, const unsigned char * pixels )
+{
+    /* wait for a free place in the ring, failing if the writing thread has */
+    pthread_mutex_lock ( &video->mutex );
+    while ( video->queued == MB_EXPORT_VIDEO_QUEUE && video->status == 0 ) pthread_cond_wait ( &video->cond, &video->mutex );
+    const int status = video->status;
+    const int slot = ( video->head + video->queued ) % MB_EXPORT_VIDEO_QUEUE;
+    pthread_mutex_unlock ( &video->mutex );
+    if ( status != 0 ) return -1;
+
+    /* copy the frame outside of the mutex, as the writing thread never touches a place until it is queued */
+    memcpy ( video->frames [ slot ], pixels, ( size_t ) video->width * video->height * 4 );
+
+    /* queue the frame, and wake the writing thread */
+    pthread_mutex_lock ( &video->mutex );
+    ++video->queued;
+    pthread_cond_broadcast ( &video->cond );
+    pthread_mutex_unlock ( &video->mutex );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_export_close_video
+ *
+ * wait for the queued frames to be written, then stop the writing thread and free the video
+ *
+ * video: the video to close
+ * write_seconds: will be set to the seconds the writing thread spent converting and writing frames, or NULL
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_close_video ( mb_export_video_t * video, double * write_seconds )
+{
+    /* tell the writing thread no more frames will be queued, and wait for it to write the rest */
+    pthread_mutex_lock ( &video->mutex );
+    video->closing = 1;
+    pthread_cond_broadcast ( &video->cond );
+    pthread_mutex_unlock ( &video->mutex );
+    pthread_join ( video->thread, NULL );
+    const int status = video->status;
+    if ( write_seconds ) *write_seconds = video->write_seconds;
+
+    /* destroy the mutex and condition, and free the video */
+    pthread_cond_destroy ( &video->cond );
+    pthread_mutex_destroy ( &video->mutex );
+    for ( int i = 0; i < MB_EXPORT_VIDEO_QUEUE; ++i ) free ( video->frames [ i ] );
+    free ( video->converted );
+    free ( video );
+
+    /* return the status of the writing thread */
+    return status;
+}
+
+/* __mb_export_video_thread
+ *
+ * the writing thread, which converts and writes queued frames in order until the video is closing and the queue is empty
+ *
+ * arg: the video
+ *
+ * return: NULL
+ */
+void * __mb_export_video_thread ( void * arg )
+{
+    /* get the video, and name the thread in any trace */
+    mb_export_video_t * video = arg;
+    mb_trace_name_thread ( "video writer" );
+
+    /* write frames until closing with none left */
+    while ( 1 )
+    {
+        /* wait for a frame, or to close */
+        pthread_mutex_lock ( &video->mutex );
+        while ( video->queued == 0 && !video->closing ) pthread_cond_wait ( &video->cond, &video->mutex );
+        const int slot = video->head;
+        const int queued = video->queued;
+        pthread_mutex_unlock ( &video->mutex );
+        if ( queued == 0 ) break;
+
+        /* convert and write the oldest frame outside of the mutex, timing it */
+        const double start_time = __mb_export_time ();
+        MB_TRACE_BEGIN ( "convert frame" );
+        int status = __mb_export_video_convert ( video, video->frames [ slot ] );
+        MB_TRACE_END ( "convert frame" );
+        MB_TRACE_BEGIN ( "write frame" );
+        if ( status == 0 && __mb_export_write_fully ( video->fd, video->converted, video->converted_size ) == -1 )
+        {
+            /* failed to write, such as the encoder exiting */
+            fprintf ( stderr, "MB ERROR: failed to write video frame\n" );
+            status = -1;
+        }
+        MB_TRACE_END ( "write frame" );
+        video->write_seconds += __mb_export_time () - start_time;
+
+        /* free its place in the ring, recording any failure so that no more frames are queued, and wake anything waiting for a place */
+        pthread_mutex_lock ( &video->mutex );
+        video->head = ( video->head + 1 ) % MB_EXPORT_VIDEO_QUEUE;
+        --video->queued;
+        if ( status != 0 ) video->status = -1;
+        pthread_cond_broadcast ( &video->cond );
+        pthread_mutex_unlock ( &video->mutex );
+        if ( status != 0 ) break;
+    }
+
+    /* return NULL */
+    return NULL;
+}
+
+/* __mb_export_video_convert
+ *
+ * convert a queued frame to the format of a video, top row first
+ * Y4M frames are the full resolution luma plane, then the two chroma planes averaged over each 2x2 block, rounding the size up
+ *
+ * video: the video
+ * pixels: the frame, 8 bit RGBA with the bottom row first
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_video_convert ( mb_export_video_t * video, const unsigned char * pixels )
+{
+    /* get the size of the frame, and of a row of it */
+    const int width = video->width;
+    const int height = video->height;
+    const size_t stride = ( size_t ) width * 4;
+
+    /* if raw, drop the alpha channel of each pixel */
+    if ( video->format == MB_EXPORT_VIDEO_RGB )
+    {
+        for ( int y = 0; y < height; ++y )
+        {
+            const unsigned char * row = pixels + ( height - 1 - y ) * stride;
+            unsigned char * out = video->converted + ( size_t ) y * width * 3;
+            for ( int x = 0; x < width; ++x ) for ( int c = 0; c < 3; ++c ) out [ x * 3 + c ] = row [ x * 4 + c ];
+        }
+        return 0;
+    }
+
+    /* otherwise write the frame header, then the luma plane, in 16 bit fixed point */
+    memcpy ( video->converted, "FRAME\n", strlen ( "FRAME\n" ) );
+    unsigned char * luma = video->converted + strlen ( "FRAME\n" );
+    for ( int y = 0; y < height; ++y )
+    {
+        const unsigned char * row = pixels + ( height - 1 - y ) * stride;
+        unsigned char * out = luma + ( size_t ) y * width;
+        for ( int x = 0; x < width; ++x ) out [ x ] = ( 19595 * row [ x * 4 ] + 38470 * row [ x * 4 + 1 ] + 7471 * row [ x * 4 + 2 ] + 32768 ) >> 16;
+    }
+
+    /* then the chroma planes, from the average colour of each 2x2 block, clipped to the frame */
+    const int chroma_width = ( width + 1 ) / 2;
+    const int chroma_height = ( height + 1 ) / 2;
+    unsigned char * cb = luma + ( size_t ) width * height;
+    unsigned char * cr = cb + ( size_t ) chroma_width * chroma_height;
+    for ( int cy = 0; cy < chroma_height; ++cy )
+    {
+        const unsigned char * rows [ 2 ] = { pixels + ( height - 1 - cy * 2 ) * stride, pixels + ( height - 1 - ( cy * 2 + 1 < height ? cy * 2 + 1 : cy * 2 ) ) * stride };
+        for ( int cx = 0; cx < chroma_width; ++cx )
+        {
+            /* sum the block, repeating the last column or row if the frame is odd in size */
+            const int x0 = cx * 2 * 4;
+            const int x1 = ( cx * 2 + 1 < width ? cx * 2 + 1 : cx * 2 ) * 4;
+            const int r = rows [ 0 ] [ x0 ] + rows [ 0 ] [ x1 ] + rows [ 1 ] [ x0 ] + rows [ 1 ] [ x1 ];
+            const int g = rows [ 0 ] [ x0 + 1 ] + rows [ 0 ] [ x1 + 1 ] + rows [ 1 ] [ x0 + 1 ] + rows [ 1 ] [ x1 + 1 ];
+            const int b = rows [ 0 ] [ x0 + 2 ] + rows [ 0 ] [ x1 + 2 ] + rows [ 1 ] [ x0 + 2 ] + rows [ 1 ] [ x1 + 2 ];
+
+            /* convert the sum, dividing by 4 in the shift, centring on 128, and clamping as pure blue or red rounds up to 256 */
+            const int u = ( -11059 * r - 21709 * g + 32768 * b + ( 128 << 18 ) + ( 1 << 17 ) ) >> 18;
+            const int v = ( 32768 * r - 27439 * g - 5329 * b + ( 128 << 18 ) + ( 1 << 17 ) ) >> 18;
+            cb [ ( size_t ) cy * chroma_width + cx ] = ( u > 255 ? 255 : u );
+            cr [ ( size_t ) cy * chroma_width + cx ] = ( v > 255 ? 255 : v );
+        }
+    }
+
+    /* return 0 for success */
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * mb_export_video.h
+ *
+ * streams frames of a video to a file descriptor, such as stdout piped into an external encoder
+ * frames are written as YUV4MPEG2 (Y4M), which encoders read with the size and frame rate from its header, or as raw packed RGB
+ * frames are queued and then converted and written by a thread of their own, so that rendering the next frames overlaps writing
+ * the last, and the throughput of a video is bounded by the slower of the two rather than their sum
+ */
+
+
+
+/* pragma one */
+#ifndef MB_EXPORT_VIDEO_H_INCLUDED
+#define MB_EXPORT_VIDEO_H_INCLUDED
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <pthread.h>
+
+
+
+/* MACROS */
+
+/* MB_EXPORT_VIDEO_FPS
+ *
+ * defines the frame rate written to the header of Y4M videos
+ * can be set during compilation using -DMB_EXPORT_VIDEO_FPS=fps
+ */
+#ifndef MB_EXPORT_VIDEO_FPS
+#define MB_EXPORT_VIDEO_FPS 30
+#endif
+
+/* MB_EXPORT_VIDEO_QUEUE
+ *
+ * defines the number of frames which may be queued for the writing thread at once
+ * can be set during compilation using -DMB_EXPORT_VIDEO_QUEUE=frames
+ */
+#ifndef MB_EXPORT_VIDEO_QUEUE
+#define MB_EXPORT_VIDEO_QUEUE 3
+#endif
+
+/* MB_EXPORT_VIDEO_X
+ *
+ * the formats videos can be streamed in
+ * Y4M is YUV4MPEG2 with full range BT.601 4:2:0 frames, marked as full range by XCOLORRANGE=FULL, as ffmpeg reads as yuvj420p
+ * RGB is packed 8 bit RGB frames with no header, as ffmpeg reads with -f rawvideo -pix_fmt rgb24
+ */
+#define MB_EXPORT_VIDEO_Y4M 0
+#define MB_EXPORT_VIDEO_RGB 1
+
+
+
+/* STRUCTURES */
+
+/* struct mb_export_video_t
+ *
+ * a video being streamed
+ */
+typedef struct
+{
+    /* the file being written to */
+    int fd;
+
+    /* size of the frames, and the format to write them in (MB_EXPORT_VIDEO_X) */
+    int width;
+    int height;
+    int format;
+
+    /* the ring of queued frames, each 8 bit RGBA with the bottom row first, the oldest of them, and how many are queued */
+    unsigned char * frames [ MB_EXPORT_VIDEO_QUEUE ];
+    int head;
+    int queued;
+
+    /* a frame converted to the format of the video, and its size */
+    unsigned char * converted;
+    size_t converted_size;
+
+    /* the seconds the writing thread has spent converting and writing frames */
+    double write_seconds;
+
+    /* 1 once no more frames will be queued, and 0 until the writing thread fails, then -1 */
+    int closing;
+    int status;
+
+    /* the writing thread, and the mutex and condition guarding the ring */
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+} mb_export_video_t;
+
+
+
+/* FUNCTIONS */
+
+/* mb_export_open_video
+ *
+ * start streaming a video to a file descriptor, writing its header and starting the writing thread
+ *
+ * fd: the file to write to, which is not closed with the video
+ * width/height: the size of the frames in pixels
+ * format: the format to write the frames in (MB_EXPORT_VIDEO_X)
+ *
+ * return: the video, or NULL on failure
+ */
+mb_export_video_t * mb_export_open_video ( const int fd, const int width, const int height, const int format );
+
+/* mb_export_write_video_frame
+ *
+ * queue a frame to be written, waiting only if the queue is full
+ * the frame is copied, so may be reused or unmapped as soon as this returns
+ *
+ * video: the video to write to
+ * pixels: the frame, 8 bit RGBA with the bottom row first, of the size of the video
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_write_video_frame ( mb_export_video_t * video, const unsigned char * pixels );
+
+/* mb_export_close_video
+ *
+ * wait for the queued frames to be written, then stop the writing thread and free the video
+ *
+ * video: the video to close
+ * write_seconds: will be set to the seconds the writing thread spent converting and writing frames, or NULL
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_close_video ( mb_export_video_t * video, double * write_seconds );
+
+/* __mb_export_video_thread
+ *
+ * the writing thread, which converts and writes queued frames in order until the video is closing and the queue is empty
+ *
+ * arg: the video
+ *
+ * return: NULL
+ */
+void * __mb_export_video_thread ( void * arg );
+
+/* __mb_export_video_convert
+ *
+ * convert a queued frame to the format of a video, top row first
+ * Y4M frames are the full resolution luma plane, then the two chroma planes averaged over each 2x2 block, rounding the size up
+ *
+ * video: the video
+ * pixels: the frame, 8 bit RGBA with the bottom row first
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_video_convert ( mb_export_video_t * video, const unsigned char * pixels );
+
+
+
+/* #ifndef MB_EXPORT_VIDEO_H_INCLUDED */
+#endif
@@ -0,0 +1,281 @@
+/*
+ * mb_export_writer.c
+ *
+ * implementation of mb_export_writer.h
+ */
+
+
+
+/* include mb_export_writer.h */
+#include "mb_export_writer.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* mb_export_format
+ *
+ * find the format to export to a file in from its extension
+ *
+ * path: the file
+ *
+ * return: MB_EXPORT_FORMAT_PNG for .png files, MB_EXPORT_FORMAT_TIFF for .tif and .tiff files, MB_EXPORT_FORMAT_RAW for .mbraw files,
+ *         otherwise MB_EXPORT_FORMAT_PPM
+ */
+int mb_export_format ( const char * path )
+{
+    /* find the extension */
+    const char * extension = strrchr ( path, '.' );
+    if ( extension && ( strcmp ( extension, ".png" ) == 0 || strcmp ( extension, ".PNG" ) == 0 ) ) return MB_EXPORT_FORMAT_PNG;
+    if ( extension && ( strcmp ( extension, ".tif" ) == 0 || strcmp ( extension, ".tiff" ) == 0 || strcmp ( extension, ".TIF" ) == 0 || strcmp ( extension, ".TIFF" ) == 0 ) ) return MB_EXPORT_FORMAT_TIFF;
+    if ( extension && strcmp ( extension, ".mbraw" ) == 0 ) return MB_EXPORT_FORMAT_RAW;
+
+    /* otherwise default to PPM */
+    return MB_EXPORT_FORMAT_PPM;
+}
+
+/* mb_export_open_writer
+ *
+ * open a file to write an image to, in the format given by mb_export_format, and write its header
+ *
+ * path: the file to write to
+ * width/height: the size of the image in pixels
+ * view: the view being written, which is recorded in raw dumps, or NULL
+ * resume: 1 to keep the existing contents of a PPM file or raw dump, 0 to truncate it
+ *
+ * return: the writer, or NULL on failure
+ */
+mb_export_writer_t * mb_export_open_writer ( const char * path, const int width, const int height, const mb_view_t * view, const int resume )
+{
+    /* allocate the writer */
+    mb_export_writer_t * writer = malloc ( sizeof ( mb_export_writer_t ) );
+    if ( !writer )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for export writer\n" );
+        return NULL;
+    }
+    writer->format = mb_export_format ( path );
+    writer->fd = -1;
+    writer->png = NULL;
+    writer->tiff = NULL;
+    writer->raw = NULL;
+    writer->width = width;
+    writer->height = height;
+    writer->data_offset = 0;
+    writer->existing_size = 0;
+
+    /* if a png, open the png, which writes its own header */
+    if ( writer->format == MB_EXPORT_FORMAT_PNG )
+    {
+        if ( !( writer->png = mb_export_open_png ( path, width, height, MB_EXPORT_PNG_LEVEL, MB_EXPORT_PNG_THREADS ) ) )
+        {
+            free ( writer );
+            return NULL;
+        }
+        return writer;
+    }
+
+    /* if a tiff, open the tiff, which writes its own header */
+    if ( writer->format == MB_EXPORT_FORMAT_TIFF )
+    {
+        if ( !( writer->tiff = mb_export_open_tiff ( path, width, height, MB_EXPORT_TILE_SIZE, MB_EXPORT_TIFF_LEVEL ) ) )
+        {
+            free ( writer );
+            return NULL;
+        }
+        return writer;
+    }
+
+    /* if a raw dump, open the raw dump, which writes its own header */
+    if ( writer->format == MB_EXPORT_FORMAT_RAW )
+    {
+        if ( !( writer->raw = mb_export_open_raw ( path, width, height, MB_EXPORT_TILE_SIZE, MB_EXPORT_RAW_CHANNELS, view, resume ) ) )
+        {
+            free ( writer );
+            return NULL;
+        }
+        writer->fd = writer->raw->fd;
+        writer->data_offset = writer->raw->header.data_offset;
+        writer->existing_size = writer->raw->existing_size;
+        return writer;
+    }
+
+    /* otherwise create the header */
+    char header [ 64 ];
+    const int header_length = snprintf ( header, sizeof ( header ), "P6\n%d %d\n255\n", width, height );
+
+    /* open the file, find its existing size, and write the header */
+    if ( ( writer->fd = open ( path, O_RDWR | O_CREAT | ( resume ? 0 : O_TRUNC ), 0644 ) ) == -1 ||
+         ( writer->existing_size = lseek ( writer->fd, 0, SEEK_END ) ) == -1 ||
+         lseek ( writer->fd, 0, SEEK_SET ) != 0 ||
+         __mb_export_write_fully ( writer->fd, header, header_length ) == -1 )
+    {
+        /* failed to open */
+        fprintf ( stderr, "MB ERROR: failed to open %s for writing\n", path );
+        if ( writer->fd != -1 ) close ( writer->fd );
+        free ( writer );
+        return NULL;
+    }
+
+    /* set where the rows start */
+    writer->data_offset = header_length;
+
+    /* return the writer */
+    return writer;
+}
+
+/* mb_export_write_rows
+ *
+ * write rows of the image, which may be written in any order to PPM files, but must be written in order to PNG files
+ * rows written to TIFF files must be whole rows of tiles, other than at the bottom of the image, and rows cannot be written to raw dumps
+ *
+ * writer: the writer to write to
+ * rows: the rows of 8 bit RGB pixels, top row first
+ * y: the index of the first row, from the top of the image
+ * count: the number of rows
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_write_rows ( mb_export_writer_t * writer, const unsigned char * rows, const int y, const int count )
+{
+    /* check the file holds colours, as raw dumps are only written by mb_export */
+    if ( writer->raw )
+    {
+        /* not a colour image */
+        fprintf ( stderr, "MB ERROR: attempted to write rows of colours to a raw dump\n" );
+        return -1;
+    }
+
+    /* check the rows fit in the image, follow on from the last rows if a png, and are whole rows of tiles if a tiff */
+    if ( y < 0 || y + count > writer->height || ( writer->png && y != writer->png->rows_written ) ||
+         ( writer->tiff && ( y % MB_EXPORT_TILE_SIZE != 0 || ( count % MB_EXPORT_TILE_SIZE != 0 && y + count != writer->height ) ) ) )
+    {
+        /* rows outside of the image, out of order, or not whole rows of tiles */
+        fprintf ( stderr, "MB ERROR: attempted to write rows outside of the image, out of order, or not in whole rows of tiles\n" );
+        return -1;
+    }
+
+    /* if a png, compress the rows into it */
+    if ( writer->png ) return mb_export_write_png_rows ( writer->png, rows, count );
+
+    /* if a tiff, cut the rows into tiles, with any part beyond the image left black, and write each */
+    if ( writer->tiff )
+    {
+        unsigned char * tile = malloc ( ( size_t ) MB_EXPORT_TILE_SIZE * MB_EXPORT_TILE_SIZE * 3 );
+        if ( !tile )
+        {
+            /* failed to allocate */
+            fprintf ( stderr, "MB ERROR: failed to allocate memory for tiff tile\n" );
+            return -1;
+        }
+        int status = 0;
+        for ( int top = y; top < y + count && status == 0; top += MB_EXPORT_TILE_SIZE )
+        {
+            const int tile_rows = ( y + count - top < MB_EXPORT_TILE_SIZE ? y + count - top : MB_EXPORT_TILE_SIZE );
+            for ( int left = 0; left < writer->width && status == 0; left += MB_EXPORT_TILE_SIZE )
+            {
+                const int tile_columns = ( writer->width - left < MB_EXPORT_TILE_SIZE ? writer->width - left : MB_EXPORT_TILE_SIZE );
+                memset ( tile, 0, ( size_t ) MB_EXPORT_TILE_SIZE * MB_EXPORT_TILE_SIZE * 3 );
+                for ( int row = 0; row < tile_rows; ++row ) memcpy ( tile + ( size_t ) row * MB_EXPORT_TILE_SIZE * 3, rows + ( ( size_t ) ( top - y + row ) * writer->width + left ) * 3, ( size_t ) tile_columns * 3 );
+                status = mb_export_write_tile ( writer, tile, left / MB_EXPORT_TILE_SIZE, top / MB_EXPORT_TILE_SIZE );
+            }
+        }
+        free ( tile );
+        return status;
+    }
+
+    /* otherwise seek to the first row and write the rows */
+    const off_t offset = writer->data_offset + ( off_t ) y * writer->width * 3;
+    if ( lseek ( writer->fd, offset, SEEK_SET ) != offset || __mb_export_write_fully ( writer->fd, rows, ( size_t ) count * writer->width * 3 ) == -1 )
+    {
+        /* failed to write */
+        fprintf ( stderr, "MB ERROR: failed to write rows of image\n" );
+        return -1;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_export_write_tile
+ *
+ * write a tile of the image to a TIFF file or raw dump, in any order
+ *
+ * writer: the writer to write to
+ * tile: the pixels of the tile, top row first, which is MB_EXPORT_TILE_SIZE pixels square
+ *       each pixel is 8 bit RGB for TIFF files, or the floats of the channels of a raw dump
+ * tile_x/y: the column and row of the tile, from the top left
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_write_tile ( mb_export_writer_t * writer, const void * tile, const int tile_x, const int tile_y )
+{
+    /* write the tile to the raw dump or tiff */
+    if ( writer->raw ) return mb_export_write_raw_tile ( writer->raw, tile_x, tile_y, tile );
+    if ( writer->tiff ) return mb_export_write_tiff_tile ( writer->tiff, tile_x, tile_y, tile );
+
+    /* otherwise the file cannot be written a tile at a time */
+    fprintf ( stderr, "MB ERROR: attempted to write a tile to a file which is not tiled\n" );
+    return -1;
+}
+
+/* mb_export_close_writer
+ *
+ * close a writer
+ *
+ * writer: the writer to close
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_close_writer ( mb_export_writer_t * writer )
+{
+    /* close the png, tiff, raw dump or file */
+    const int status = ( writer->png ? mb_export_close_png ( writer->png ) : writer->tiff ? mb_export_close_tiff ( writer->tiff ) : writer->raw ? mb_export_close_raw ( writer->raw ) : close ( writer->fd ) );
+
+    /* free the writer */
+    free ( writer );
+
+    /* return the status */
+    return status;
+}
+
+/* __mb_export_write_fully
+ *
+ * write a buffer to a file descriptor, retrying after partial writes
+ *
+ * fd: the file to write to
+ * data: the data to write
+ * length: the length of the data in bytes
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_write_fully ( const int fd, const void * data, size_t length )
+{
+    /* write until every byte is written */
+    const unsigned char * bytes = data;
+    while ( length > 0 )
+    {
+        const ssize_t written = write ( fd, bytes, length );
+        if ( written <= 0 ) return -1;
+        bytes += written;
+        length -= written;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_export_time
+ *
+ * return: the wall clock time in seconds
+ */
+double __mb_export_time ()
+{
+    /* get the time of day */
+    struct timeval time;
+    gettimeofday ( &time, NULL );
+
+    /* return it in seconds */
+    return time.tv_sec + time.tv_usec * 1.0e-6;
+}
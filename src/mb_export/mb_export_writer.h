@@ -0,0 +1,178 @@
+/*
+ * mb_export_writer.h
+ *
+ * writes images to PPM, PNG or tiled TIFF files, or raw dumps, a row of tiles or a tile at a time
+ * needs no opengl, so tools which only write images, such as mbcolor, need not link the renderer
+ */
+
+
+
+/* pragma one */
+#ifndef MB_EXPORT_WRITER_H_INCLUDED
+#define MB_EXPORT_WRITER_H_INCLUDED
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <sys/types.h>
+
+/* include mb_view.h */
+#include <mb_handler/mb_view.h>
+
+/* include mb_export_png.h */
+#include "mb_export_png.h"
+
+/* include mb_export_tiff.h */
+#include "mb_export_tiff.h"
+
+/* include mb_export_raw.h */
+#include "mb_export_raw.h"
+
+
+
+/* MACROS */
+
+/* MB_EXPORT_TILE_SIZE
+ *
+ * defines the width and height in pixels of the tiles an image is exported in
+ * a row of tiles, of width * MB_EXPORT_TILE_SIZE * 3 bytes, is held in memory at once
+ * can be set during compilation using -DMB_EXPORT_TILE_SIZE=size
+ */
+#ifndef MB_EXPORT_TILE_SIZE
+#define MB_EXPORT_TILE_SIZE 512
+#endif
+
+/* MB_EXPORT_FORMAT_X
+ *
+ * the formats images can be exported in, chosen by the extension of the file
+ */
+#define MB_EXPORT_FORMAT_PPM 0
+#define MB_EXPORT_FORMAT_PNG 1
+#define MB_EXPORT_FORMAT_TIFF 2
+#define MB_EXPORT_FORMAT_RAW 3
+
+
+
+
+/* STRUCTURES */
+
+/* struct mb_export_writer_t
+ *
+ * a file being written to a row of tiles at a time
+ */
+typedef struct
+{
+    /* the format of the file */
+    int format;
+
+    /* the file being written if a PPM or raw dump, and the png, tiff or raw dump being written */
+    int fd;
+    mb_export_png_t * png;
+    mb_export_tiff_t * tiff;
+    mb_export_raw_t * raw;
+
+    /* size of the image */
+    int width;
+    int height;
+
+    /* offset of the first row in the file */
+    off_t data_offset;
+
+    /* size of the file when it was opened */
+    off_t existing_size;
+
+} mb_export_writer_t;
+
+
+
+/* FUNCTIONS */
+
+/* mb_export_format
+ *
+ * find the format to export to a file in from its extension
+ *
+ * path: the file
+ *
+ * return: MB_EXPORT_FORMAT_PNG for .png files, MB_EXPORT_FORMAT_TIFF for .tif and .tiff files, MB_EXPORT_FORMAT_RAW for .mbraw files,
+ *         otherwise MB_EXPORT_FORMAT_PPM
+ */
+int mb_export_format ( const char * path );
+
+/* mb_export_open_writer
+ *
+ * open a file to write an image to, in the format given by mb_export_format, and write its header
+ *
+ * path: the file to write to
+ * width/height: the size of the image in pixels
+ * view: the view being written, which is recorded in raw dumps, or NULL
+ * resume: 1 to keep the existing contents of a PPM file or raw dump, 0 to truncate it
+ *
+ * return: the writer, or NULL on failure
+ */
+mb_export_writer_t * mb_export_open_writer ( const char * path, const int width, const int height, const mb_view_t * view, const int resume );
+
+/* mb_export_write_rows
+ *
+ * write rows of the image, which may be written in any order to PPM files, but must be written in order to PNG files
+ * rows written to TIFF files must be whole rows of tiles, other than at the bottom of the image, and rows cannot be written to raw dumps
+ *
+ * writer: the writer to write to
+ * rows: the rows of 8 bit RGB pixels, top row first
+ * y: the index of the first row, from the top of the image
+ * count: the number of rows
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_write_rows ( mb_export_writer_t * writer, const unsigned char * rows, const int y, const int count );
+
+/* mb_export_write_tile
+ *
+ * write a tile of the image to a TIFF file or raw dump, in any order
+ *
+ * writer: the writer to write to
+ * tile: the pixels of the tile, top row first, which is MB_EXPORT_TILE_SIZE pixels square
+ *       each pixel is 8 bit RGB for TIFF files, or the floats of the channels of a raw dump
+ * tile_x/y: the column and row of the tile, from the top left
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_write_tile ( mb_export_writer_t * writer, const void * tile, const int tile_x, const int tile_y );
+
+/* mb_export_close_writer
+ *
+ * close a writer
+ *
+ * writer: the writer to close
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_export_close_writer ( mb_export_writer_t * writer );
+
+/* __mb_export_write_fully
+ *
+ * write a buffer to a file descriptor, retrying after partial writes
+ *
+ * fd: the file to write to
+ * data: the data to write
+ * length: the length of the data in bytes
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_export_write_fully ( const int fd, const void * data, size_t length );
+
+/* __mb_export_time
+ *
+ * return: the wall clock time in seconds
+ */
+double __mb_export_time ();
+
+
+
+/* #ifndef MB_EXPORT_WRITER_H_INCLUDED */
+#endif
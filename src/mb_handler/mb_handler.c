@@ -58,16 +58,21 @@ mb_set_t mb_create_set ( const float re_min_range, const float im_min_range, con
         return NULL;
     }
 
-    /* get uniform locations (second, as is more likely to fail than creating buffers) */
-    if ( ( mb_set->uni_stretch = glh_get_uniform_location ( mb_set->sprogram, "mandelbrot_stretch" ) ) == -1 ||
-         ( mb_set->uni_translation = glh_get_uniform_location ( mb_set->sprogram, "mandelbrot_translation" ) ) == -1 ||
-         ( mb_set->uni_breakout = glh_get_uniform_location ( mb_set->sprogram, "mandelbrot_breakout" ) ) == -1 ||
-         ( mb_set->uni_max_it = glh_get_uniform_location ( mb_set->sprogram, "mandelbrot_max_it" ) ) == -1 ||
-         ( mb_set->uni_power = glh_get_uniform_location ( mb_set->sprogram, "mandelbrot_power" ) ) == -1 ||
-         ( mb_set->uni_rotation = glh_get_uniform_location ( mb_set->sprogram, "mandelbrot_rotation" ) ) == -1 )
-    {
-        /* failed to get uniform location */
-        fprintf ( stderr, "MB ERROR: failed to get uniform locations\n" );
+    /* set up uniform buffer object (second, as is more likely to fail than creating vertex buffers) */
+    if ( ( mb_set->ubo = glh_create_uniform_buffer_object ( &mb_set->ubo_uniforms, sizeof ( mb_uniforms_t ), GLH_BUFF_DYNAMIC_DRAW ) ) == -1 ||
+         ( glh_set_uniform_block_binding ( mb_set->sprogram, "mandelbrot_parameters", MANDELBROT_UNIFORM_BINDING ) ) == -1 )
+    {
+        /* failed to set up uniform buffer object */
+        fprintf ( stderr, "MB ERROR: failed to set up uniform buffer object\n" );
+        mb_destroy_set ( mb_set );
+        return NULL;
+    }
+
+    /* point the sampler for the reference orbit at its texture unit */
+    if ( glh_set_uniform_int ( glh_get_uniform_location ( mb_set->sprogram, "mandelbrot_orbit" ), MANDELBROT_ORBIT_UNIT ) == -1 )
+    {
+        /* failed to set the sampler */
+        fprintf ( stderr, "MB ERROR: failed to set up reference orbit sampler\n" );
         mb_destroy_set ( mb_set );
         return NULL;
     }
@@ -86,6 +91,16 @@ mb_set_t mb_create_set ( const float re_min_range, const float im_min_range, con
         return NULL;        
     }
 
+    /* create the pools of timer queries, enough to time every phase of MANDELBROT_TIMER_COUNT draws */
+    if ( !( mb_set->elapsed_pool = glh_create_timer_pool ( MANDELBROT_TIMER_COUNT * MANDELBROT_PHASE_COUNT, GLH_QUERY_TIME_ELAPSED ) ) ||
+         !( mb_set->timestamp_pool = glh_create_timer_pool ( MANDELBROT_TIMER_COUNT * 2, GLH_QUERY_TIMESTAMP ) ) )
+    {
+        /* error creating queries */
+        fprintf ( stderr, "MB ERROR: failed to create timer queries\n" );
+        mb_destroy_set ( mb_set );
+        return NULL;
+    }
+
     /* set mandelbrot parameters */
     mb_set->re_min_range = re_min_range;
     mb_set->im_min_range = im_min_range;
@@ -96,8 +111,10 @@ mb_set_t mb_create_set ( const float re_min_range, const float im_min_range, con
     mb_set->power = MBDEF_POWER;
     mb_set->rotation = MBDEF_ROTATION;
 
-    /* set up the mutex */
-    pthread_mutex_init ( &mb_set->draw_mutex, NULL );
+    /* set up the mutex and condition for the render thread */
+    pthread_mutex_init ( &mb_set->render_mutex, NULL );
+    pthread_cond_init ( &mb_set->render_cond, NULL );
+    pthread_cond_init ( &mb_set->frame_cond, NULL );
 
     /* return mb_set */
     return mb_set;
@@ -123,10 +140,8 @@ mb_set_t __mb_create_empty_set ()
     mb_set->fshader = -1;
     mb_set->sprogram = -1;
 
-    mb_set->uni_stretch = -1;
-    mb_set->uni_translation = -1;
-    mb_set->uni_breakout = -1;
-    mb_set->uni_max_it = -1;
+    mb_set->ubo = -1;
+    memset ( &mb_set->ubo_uniforms, 0, sizeof ( mb_uniforms_t ) );
 
     mb_set->re_min_range = 0;
     mb_set->im_min_range = 0;
@@ -141,7 +156,85 @@ mb_set_t __mb_create_empty_set ()
 
     mb_set->rotation = 0;
 
-    memset ( &mb_set->draw_mutex, 0, sizeof ( pthread_mutex_t ) );
+    mb_set->width = 0;
+    mb_set->height = 0;
+
+    mb_set->orbit_texture = -1;
+    mb_set->orbit_rows = 0;
+    mb_set->re_reference = 0;
+    mb_set->im_reference = 0;
+    mb_set->orbit_length = 0;
+
+    mb_set->generation = 0;
+    memset ( &mb_set->published_view, 0, sizeof ( mb_view_t ) );
+
+    mb_set->frame_texture = -1;
+    mb_set->frame_fbo = -1;
+    mb_set->frame_width = 0;
+    mb_set->frame_height = 0;
+    mb_set->output = MANDELBROT_OUTPUT_COLOUR;
+    mb_set->frame_generation = 0;
+    mb_set->frame_tiles_done = 0;
+
+    mb_set->pixel_time = 0.0;
+
+    mb_set->elapsed_pool = NULL;
+    mb_set->timestamp_pool = NULL;
+    memset ( mb_set->timers, 0, sizeof ( mb_set->timers ) );
+    mb_set->timer_head = 0;
+    mb_set->timer_pending = 0;
+    mb_set->timer = NULL;
+    mb_set->timer_cpu = 0;
+    mb_set->phase_start = 0.0;
+    memset ( &mb_set->stats, 0, sizeof ( mb_stats_t ) );
+
+    mb_set->hud = NULL;
+    mb_set->hud_enabled = 0;
+    mb_set->hud_update_time = 0.0;
+
+    mb_set->frame_stats_enabled = 0;
+    mb_set->iterations_texture = -1;
+    mb_set->reduce_vshader = -1;
+    mb_set->reduce_fshader = -1;
+    mb_set->reduce_sprogram = -1;
+    mb_set->reduce_vao = -1;
+    mb_set->histogram_texture = -1;
+    mb_set->histogram_fbo = -1;
+    mb_set->histogram_pbo = -1;
+    mb_set->histogram_fence = NULL;
+    mb_set->histogram_rows = 0;
+    mb_set->histogram_width = 0;
+    mb_set->histogram_height = 0;
+    mb_set->histogram_max_it = 0;
+    memset ( &mb_set->frame_stats, 0, sizeof ( mb_frame_stats_t ) );
+
+    for ( int i = 0; i < MANDELBROT_READBACK_COUNT; ++i )
+    {
+        mb_set->readback_pbos [ i ] = -1;
+        mb_set->readback_sizes [ i ] = 0;
+        mb_set->readback_fences [ i ] = NULL;
+        mb_set->readback_widths [ i ] = 0;
+        mb_set->readback_heights [ i ] = 0;
+        mb_set->readback_pixel_sizes [ i ] = 0;
+        mb_set->readback_tags [ i ] = 0;
+    }
+    mb_set->readback_head = 0;
+    mb_set->readback_pending = 0;
+    mb_set->readback_mapped = 0;
+
+    mb_set->render_thread_running = 0;
+    mb_set->render_window = NULL;
+    memset ( &mb_set->render_mutex, 0, sizeof ( pthread_mutex_t ) );
+    memset ( &mb_set->render_cond, 0, sizeof ( pthread_cond_t ) );
+    mb_set->render_stop = 0;
+    mb_set->damaged = 0;
+    mb_set->complete_generation = 0;
+    mb_set->failed_generation = 0;
+    memset ( &mb_set->frame_cond, 0, sizeof ( pthread_cond_t ) );
+
+    mb_set->frame_times = NULL;
+    mb_set->frame_time_capacity = 0;
+    mb_set->frame_time_count = 0;
 
     /* return the set */
     return mb_set;
@@ -160,6 +253,9 @@ int mb_destroy_set ( mb_set_t mb_set )
     /* check glad is initialised */
     __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before destroying a mandelbrot set" );
 
+    /* stop the render thread, if running */
+    mb_stop_render_thread ( mb_set );
+
     /* if changed from empty, destroy attributes */
     if ( mb_set->vao != -1 ) glh_delete_vertex_array_object ( mb_set->vao );
     if ( mb_set->vbo != -1 ) glh_delete_vertex_buffer_object ( mb_set->vbo );
@@ -169,9 +265,45 @@ int mb_destroy_set ( mb_set_t mb_set )
     if ( mb_set->fshader != -1 ) glh_delete_shader ( mb_set->fshader );
     if ( mb_set->sprogram != -1 ) glh_delete_shader_program ( mb_set->sprogram );
 
+    if ( mb_set->ubo != -1 ) glh_delete_uniform_buffer_object ( mb_set->ubo );
+
+    if ( mb_set->frame_fbo != -1 ) glh_delete_framebuffer_object ( mb_set->frame_fbo );
+    if ( mb_set->frame_texture != -1 ) glh_delete_texture ( mb_set->frame_texture );
+    if ( mb_set->iterations_texture != -1 ) glh_delete_texture ( mb_set->iterations_texture );
+
+    if ( mb_set->orbit_texture != -1 ) glh_delete_texture ( mb_set->orbit_texture );
+
+    if ( mb_set->elapsed_pool ) glh_destroy_timer_pool ( mb_set->elapsed_pool );
+    if ( mb_set->timestamp_pool ) glh_destroy_timer_pool ( mb_set->timestamp_pool );
+
+    if ( mb_set->hud ) mb_hud_destroy ( mb_set->hud );
+
+    if ( mb_set->reduce_vao != -1 ) glh_delete_vertex_array_object ( mb_set->reduce_vao );
+    if ( mb_set->reduce_vshader != -1 ) glh_delete_shader ( mb_set->reduce_vshader );
+    if ( mb_set->reduce_fshader != -1 ) glh_delete_shader ( mb_set->reduce_fshader );
+    if ( mb_set->reduce_sprogram != -1 ) glh_delete_shader_program ( mb_set->reduce_sprogram );
+    if ( mb_set->histogram_fbo != -1 ) glh_delete_framebuffer_object ( mb_set->histogram_fbo );
+    if ( mb_set->histogram_texture != -1 ) glh_delete_texture ( mb_set->histogram_texture );
+    if ( mb_set->histogram_fence ) glh_delete_fence ( mb_set->histogram_fence );
+    if ( mb_set->histogram_pbo != -1 ) glh_delete_pixel_pack_buffer_object ( mb_set->histogram_pbo );
+
+    if ( mb_set->readback_mapped ) glh_unmap_pixel_pack_buffer_object ( mb_set->readback_pbos [ mb_set->readback_head ] );
+    for ( int i = 0; i < MANDELBROT_READBACK_COUNT; ++i )
+    {
+        if ( mb_set->readback_fences [ i ] ) glh_delete_fence ( mb_set->readback_fences [ i ] );
+        if ( mb_set->readback_pbos [ i ] != -1 ) glh_delete_pixel_pack_buffer_object ( mb_set->readback_pbos [ i ] );
+    }
+
     pthread_mutex_t zero_mutex;
     memset ( &zero_mutex, 0, sizeof ( pthread_mutex_t ) );
-    if ( memcmp ( &mb_set->draw_mutex, &zero_mutex, sizeof ( pthread_mutex_t ) ) != 0 ) pthread_mutex_destroy ( &mb_set->draw_mutex ); 
+    if ( memcmp ( &mb_set->render_mutex, &zero_mutex, sizeof ( pthread_mutex_t ) ) != 0 )
+    {
+        pthread_mutex_destroy ( &mb_set->render_mutex );
+        pthread_cond_destroy ( &mb_set->render_cond );
+        pthread_cond_destroy ( &mb_set->frame_cond );
+    }
+
+    free ( mb_set->frame_times );
 
     /* free the set */
     free ( mb_set );
@@ -183,11 +315,14 @@ int mb_destroy_set ( mb_set_t mb_set )
 /* mb_draw
  *
  * draws the mandelbrot set onto a window
+ * the set is rendered offscreen in tiles, and only as many tiles as fit in MANDELBROT_TILE_BUDGET are rendered per call
+ * rendering restarts if the generation of the set or the viewport size has changed since the frame was started
+ * the frame is presented while it is being rendered, and once it is complete only when the window is damaged
  * 
  * mb_set: the mandelbrot set to draw
  * window: the window to draw onto
  * 
- * return: 0 for success, -1 for failure
+ * return: 1 if tiles remain to be rendered, 0 if the frame is complete, -1 for failure
  */
 int mb_draw ( mb_set_t mb_set, glh_window_t window )
 {
@@ -195,60 +330,1629 @@ int mb_draw ( mb_set_t mb_set, glh_window_t window )
     __GLH_GLFW_INIT_CHECK__ ( 1, -1, "MB ERROR: glfw must be initialised before drawing a mandelbrot set" );
     __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before drawing a mandelbrot set" );
 
-    /* lock the mutex */
-    pthread_mutex_lock ( &mb_set->draw_mutex );
+    /* read the most recently published view */
+    mb_view_t view;
+    const unsigned long generation = __mb_read_view ( mb_set, &view );
 
-    /* get viewport size */
-    int viewport_size [ 4 ];
-    glh_get_viewport_size ( window, viewport_size );
+    /* if the viewport is empty, such as when the window is minimised or no view has been published, there is nothing to draw */
+    if ( view.width <= 0 || view.height <= 0 )
+    {
+        /* record the generation as drawn, so that the render thread does not retry until a new view is published */
+        mb_set->frame_generation = generation;
+        return 0;
+    }
 
-    /* create the stretch coeficients */
-    const float re_stretch = mb_set->re_min_range / ( float ) viewport_size [ 2 ];
-    const float im_stretch = mb_set->im_min_range / ( float ) viewport_size [ 3 ];
+    /* find the number of tiles across and up the frame */
+    const int tiles_x = ( view.width + MANDELBROT_TILE_SIZE - 1 ) / MANDELBROT_TILE_SIZE;
+    const int tiles_y = ( view.height + MANDELBROT_TILE_SIZE - 1 ) / MANDELBROT_TILE_SIZE;
 
-    /* set the overall stretch to the largest coeficient */
-    const float stretch = fmaxf ( re_stretch, im_stretch );
+    /* find whether the frame must be restarted */
+    const int restart = ( view.width != mb_set->frame_width || view.height != mb_set->frame_height || generation != mb_set->frame_generation );
 
-    /* get the new ranges */
-    const float re_range = ( float ) viewport_size [ 2 ] * stretch;
-    const float im_range = ( float ) viewport_size [ 3 ] * stretch;
+    /* if the frame is complete and does not need restarting, present it only if the window has been damaged */
+    if ( !restart && mb_set->frame_tiles_done >= tiles_x * tiles_y )
+    {
+        if ( __atomic_exchange_n ( &mb_set->damaged, 0, __ATOMIC_ACQ_REL ) )
+        {
+            MB_TRACE_BEGIN ( "repair" );
+            glh_make_window_current ( window );
+
+            /* if the overlay is shown, collect the statistics of the frame, which were still being read back when it completed,
+             * and update the overlay with them straight away
+             */
+            if ( __atomic_load_n ( &mb_set->hud_enabled, __ATOMIC_ACQUIRE ) && __mb_read_frame_stats ( mb_set, 1 ) == 1 ) mb_set->hud_update_time = 0.0;
+            glh_blit_framebuffer_object ( mb_set->frame_fbo, 0, mb_set->frame_width, mb_set->frame_height );
+            ++mb_set->stats.presents;
+            ++mb_set->stats.repairs;
+            __mb_draw_hud ( mb_set );
+            glh_swap_buffers ( window );
+            MB_TRACE_END ( "repair" );
+        }
 
-    /* set the new ranges */
-    mb_set->re_range = re_range;
-    mb_set->im_range = im_range;
+        /* return 0, as the frame is complete */
+        return 0;
+    }
 
-    /* set translation */
-    const float re_translation = 0 + mb_set->re_centre - ( mb_set->re_range / 2 );
-    const float im_translation = 0 + mb_set->im_centre - ( mb_set->im_range / 2 );
+    /* if the overlay is shown, time the whole draw for its sparkline */
+    const int hud_shown = __atomic_load_n ( &mb_set->hud_enabled, __ATOMIC_ACQUIRE );
+    const double draw_start = ( hud_shown ? glh_get_time () : 0.0 );
 
-    /* make window current and use shader program */
+    /* make window current, update the statistics and estimated time per pixel from any finished timer queries, and begin timing the draw */
     glh_make_window_current ( window );
-    glh_use_shader_program ( mb_set->sprogram );
+    __mb_update_stats ( mb_set );
+    __mb_begin_timing ( mb_set, 1 );
 
-    /* create rotation matrix */
-    float rotation_matirx [ 4 ] =
+    /* prepare the frame for the view */
+    MB_TRACE_BEGIN ( "prepare" );
+    __mb_begin_phase ( mb_set, MANDELBROT_PHASE_PREPARE );
+    const int prepared = __mb_prepare_frame ( mb_set, &view, generation );
+    __mb_end_phase ( mb_set, MANDELBROT_PHASE_PREPARE );
+    MB_TRACE_END ( "prepare" );
+    if ( prepared < 0 )
     {
-        cos ( mb_set->rotation ), -sin ( mb_set->rotation ),
-        sin ( mb_set->rotation ),  cos ( mb_set->rotation )    
-    };
+        __mb_end_timing ( mb_set );
+        return -1;
+    }
 
-    /* set uniforms */
-    glh_set_uniform_vec4 ( mb_set->uni_stretch, stretch, stretch, 1.0f, 1.0f );
-    glh_set_uniform_vec4 ( mb_set->uni_translation, re_translation, im_translation, 0.0f, 0.0f );
-    glh_set_uniform_float ( mb_set->uni_breakout, mb_set->breakout );
-    glh_set_uniform_int ( mb_set->uni_max_it, ( int ) mb_set->max_it );
-    glh_set_uniform_int ( mb_set->uni_power, mb_set->power );
-    glh_set_uniform_mat2 ( mb_set->uni_rotation, 0, rotation_matirx );
+    /* render as many tiles as fit in the budget, rendering a single tile if the time per pixel is not yet known */
+    const int tiles_remain = __mb_render_tiles ( mb_set, ( mb_set->pixel_time > 0.0 ? MANDELBROT_TILE_BUDGET / mb_set->pixel_time : 1.0 ) );
 
-    /* clear, render and swap buffers */
-    glh_set_clear_color ( 1.0f, 1.0f, 1.0f, 1.0f );
-    glh_clear_screen ();
-    glh_draw_elements ( mb_set->vao, GLH_DRAWMODE_TRIANGLES, 6, GLH_TYPE_UNSIGNED_INT );
+    /* present the frame with any overlay over it and swap buffers, which also repairs any damage */
+    __mb_begin_phase ( mb_set, MANDELBROT_PHASE_PRESENT );
+    __atomic_store_n ( &mb_set->damaged, 0, __ATOMIC_RELEASE );
+    MB_TRACE_BEGIN ( "blit" );
+    glh_blit_framebuffer_object ( mb_set->frame_fbo, 0, mb_set->frame_width, mb_set->frame_height );
+    ++mb_set->stats.presents;
+    MB_TRACE_END ( "blit" );
+    if ( hud_shown ) __mb_draw_hud ( mb_set );
+    MB_TRACE_BEGIN ( "swap" );
     glh_swap_buffers ( window );
+    MB_TRACE_END ( "swap" );
+    __mb_end_phase ( mb_set, MANDELBROT_PHASE_PRESENT );
+    __mb_end_timing ( mb_set );
+
+    /* record the time of the draw for the sparkline of the overlay, and if the frame is complete but its statistics are still being read back,
+     * mark the window as damaged so that it is presented once more with them
+     */
+    if ( hud_shown && mb_set->hud ) mb_hud_add_sample ( mb_set->hud, glh_get_time () - draw_start );
+    if ( hud_shown && !tiles_remain && mb_set->histogram_fence ) __atomic_store_n ( &mb_set->damaged, 1, __ATOMIC_RELEASE );
+
+    /* return whether tiles remain */
+    return tiles_remain;
+}
+
+/* mb_render_frame
+ *
+ * renders the most recently published view of the set completely into the frame, using the context current on the calling thread
+ * needs no window, so can be used with headless contexts, and the frame may be any size the context supports
+ * the tiles are still rendered in batches of MANDELBROT_TILE_BUDGET, so that no single batch of commands runs for too long
+ *
+ * mb_set: the mandelbrot set to render
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_render_frame ( mb_set_t mb_set )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before rendering a mandelbrot set" );
+
+    /* read the most recently published view */
+    mb_view_t view;
+    const unsigned long generation = __mb_read_view ( mb_set, &view );
+
+    /* if the view is empty there is nothing to render */
+    if ( view.width <= 0 || view.height <= 0 ) return 0;
+
+    /* prepare the frame for the view */
+    if ( __mb_prepare_frame ( mb_set, &view, generation ) < 0 ) return -1;
+
+    /* render every tile of the frame */
+    return __mb_render_all_tiles ( mb_set );
+}
+
+/* mb_render_region
+ *
+ * renders a region of the most recently published view of the set, as if the view were a different size, completely into the frame
+ * uses the context current on the calling thread, and allows images far larger than the context supports to be rendered piece by piece
+ * the frame must then be restarted, so the next call to mb_draw or mb_render_frame renders the view again from scratch
+ *
+ * mb_set: the mandelbrot set to render
+ * image_width/height: the size to render the view at
+ * x/y: the bottom left pixel of the region, from the bottom left of the image
+ * width/height: the size of the region, which becomes the size of the frame
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_render_region ( mb_set_t mb_set, const int image_width, const int image_height, const int x, const int y, const int width, const int height )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before rendering a mandelbrot set" );
+
+    /* read the most recently published view, and set it to the size of the image */
+    mb_view_t view;
+    __mb_read_view ( mb_set, &view );
+    view.width = image_width;
+    view.height = image_height;
+
+    /* if the image or region is empty there is nothing to render */
+    if ( image_width <= 0 || image_height <= 0 || width <= 0 || height <= 0 ) return 0;
+
+    /* use shader program and bind the uniform buffer object */
+    glh_use_shader_program ( mb_set->sprogram );
+    glh_bind_uniform_buffer_object ( mb_set->ubo, MANDELBROT_UNIFORM_BINDING );
+
+    /* resize the frame to the region if necessary, and give it a buffer for iterations if statistics have been enabled since it was created */
+    if ( width != mb_set->frame_width || height != mb_set->frame_height )
+    {
+        if ( __mb_resize_frame ( mb_set, width, height ) < 0 ) return -1;
+    }
+    if ( __mb_attach_iterations ( mb_set ) < 0 ) return -1;
+
+    /* update the uniforms for the region, and restart the frame with a generation which is odd, so never matches a published view */
+    __mb_update_uniforms ( mb_set, &view, x, y );
+    mb_set->frame_generation = 1;
+    mb_set->frame_tiles_done = 0;
+
+    /* render every tile of the region */
+    return __mb_render_all_tiles ( mb_set );
+}
+
+/* mb_render_log_polar
+ *
+ * renders a region of a log-polar strip around the centre of the most recently published view of the set, completely into the frame
+ * column x of the strip is log_step further in, in the log of the distance from the centre, than column x - 1, and row y is log_step
+ * further round, in radians, than row y - 1, so a strip 2pi / log_step high covers every angle
+ * uses the context current on the calling thread, and the frame must then be restarted, as with mb_render_region
+ *
+ * mb_set: the mandelbrot set to render
+ * log_radius: the log of the distance from the centre at the left edge of the strip
+ * log_step: the step in the log of the distance and in the angle across each pixel
+ * x/y: the bottom left pixel of the region, from the bottom left of the strip
+ * width/height: the size of the region, which becomes the size of the frame
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_render_log_polar ( mb_set_t mb_set, const double log_radius, const double log_step, const int x, const int y, const int width, const int height )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before rendering a mandelbrot set" );
+
+    /* read the most recently published view */
+    mb_view_t view;
+    __mb_read_view ( mb_set, &view );
+
+    /* if the region is empty there is nothing to render */
+    if ( width <= 0 || height <= 0 ) return 0;
+
+    /* use shader program and bind the uniform buffer object */
+    glh_use_shader_program ( mb_set->sprogram );
+    glh_bind_uniform_buffer_object ( mb_set->ubo, MANDELBROT_UNIFORM_BINDING );
+
+    /* resize the frame to the region if necessary, and give it a buffer for iterations if statistics have been enabled since it was created */
+    if ( width != mb_set->frame_width || height != mb_set->frame_height )
+    {
+        if ( __mb_resize_frame ( mb_set, width, height ) < 0 ) return -1;
+    }
+    if ( __mb_attach_iterations ( mb_set ) < 0 ) return -1;
+
+    /* create the uniforms for the region, centred on the view, and offset to the region, with the rotation of the view turning the angles */
+    mb_uniforms_t uniforms;
+    memset ( &uniforms, 0, sizeof ( mb_uniforms_t ) );
+    uniforms.stretch [ 0 ] = log_step;
+    uniforms.stretch [ 1 ] = log_step;
+    uniforms.stretch [ 2 ] = 1.0f;
+    uniforms.stretch [ 3 ] = 1.0f;
+    uniforms.rotation_matrix [ 0 ] = 1.0f;
+    uniforms.rotation_matrix [ 5 ] = 1.0f;
+    uniforms.breakout = view.breakout;
+    uniforms.max_it = ( int ) view.max_it;
+    uniforms.power = view.power;
+    uniforms.output = mb_set->output;
+    uniforms.mapping = MANDELBROT_MAPPING_LOG_POLAR;
+    uniforms.log_radius = log_radius - ( x * log_step );
+    uniforms.log_step = log_step;
+    uniforms.angle = ( y * log_step ) + view.rotation;
+    uniforms.reference [ 0 ] = mb_set->re_reference;
+    uniforms.reference [ 1 ] = mb_set->im_reference;
+    uniforms.centre [ 0 ] = view.re_centre;
+    uniforms.centre [ 1 ] = view.im_centre;
+    uniforms.orbit_length = mb_set->orbit_length;
+
+    /* write the uniforms, and restart the frame with a generation which is odd, so never matches a published view */
+    __mb_write_uniforms ( mb_set, &uniforms );
+    mb_set->frame_generation = 1;
+    mb_set->frame_tiles_done = 0;
+
+    /* render every tile of the region */
+    return __mb_render_all_tiles ( mb_set );
+}
+
+/* mb_read_frame
+ *
+ * read the frame back into memory, waiting for it to finish rendering
+ * the frame is read as 8 bit RGBA, or 32 bit float RGBA if the output is raw, with the bottom row first
+ *
+ * mb_set: the mandelbrot set to read the frame of
+ * pixels: memory to read into, of at least frame_width * frame_height * 4 bytes, or 16 bytes per pixel if the output is raw
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_read_frame ( mb_set_t mb_set, unsigned char * pixels )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before reading a mandelbrot set" );
+
+    /* if there is no frame, there is nothing to read */
+    if ( mb_set->frame_fbo == -1 ) return -1;
+
+    /* read the frame */
+    MB_TRACE_BEGIN ( "read frame" );
+    const int status = glh_read_framebuffer_object ( mb_set->frame_fbo, 0, 0, mb_set->frame_width, mb_set->frame_height, GLH_TEX_FORMAT_RGBA, ( mb_set->output == MANDELBROT_OUTPUT_RAW ? GLH_TYPE_FLOAT : GLH_TYPE_UNSIGNED_BYTE ), pixels );
+    MB_TRACE_END ( "read frame" );
+
+    /* return the status */
+    return status;
+}
+
+/* mb_queue_readback
+ *
+ * begin reading the frame back into the next pixel pack buffer of the readback ring, without waiting for rendering to finish
+ * the frame should be complete, such as after mb_render_frame
+ * the frame can then be rendered again while it is read back
+ *
+ * mb_set: the mandelbrot set to read the frame of
+ * tag: a value to identify the frame by, such as its index, returned by mb_map_readback
+ *
+ * return: 0 for success, 1 if the ring is full and the oldest frame must be consumed first, -1 for failure
+ */
+int mb_queue_readback ( mb_set_t mb_set, const unsigned long tag )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before reading a mandelbrot set" );
+
+    /* if there is no frame, there is nothing to read */
+    if ( mb_set->frame_fbo == -1 ) return -1;
+
+    /* if the ring is full, the oldest frame must be consumed first */
+    if ( mb_set->readback_pending == MANDELBROT_READBACK_COUNT ) return 1;
+
+    /* find the next slot in the ring, and the size of the frame, which has 16 byte pixels if raw */
+    const int slot = ( mb_set->readback_head + mb_set->readback_pending ) % MANDELBROT_READBACK_COUNT;
+    const int pixel_size = ( mb_set->output == MANDELBROT_OUTPUT_RAW ? 16 : 4 );
+    const size_t size = ( size_t ) mb_set->frame_width * mb_set->frame_height * pixel_size;
+
+    /* create the pbo if not yet created, or grow it if too small for the frame */
+    if ( mb_set->readback_pbos [ slot ] == -1 )
+    {
+        if ( ( mb_set->readback_pbos [ slot ] = glh_create_pixel_pack_buffer_object ( size ) ) == -1 ) return -1;
+        mb_set->readback_sizes [ slot ] = size;
+    } else
+    if ( mb_set->readback_sizes [ slot ] < size )
+    {
+        if ( glh_resize_pixel_pack_buffer_object ( mb_set->readback_pbos [ slot ], size ) == -1 ) return -1;
+        mb_set->readback_sizes [ slot ] = size;
+    }
+
+    /* begin reading the frame into the pbo, then fence the read */
+    if ( glh_read_framebuffer_object_to_buffer ( mb_set->frame_fbo, 0, 0, mb_set->frame_width, mb_set->frame_height, GLH_TEX_FORMAT_RGBA, ( pixel_size == 16 ? GLH_TYPE_FLOAT : GLH_TYPE_UNSIGNED_BYTE ), mb_set->readback_pbos [ slot ] ) == -1 ) return -1;
+    if ( !( mb_set->readback_fences [ slot ] = glh_create_fence () ) ) return -1;
 
-    /* unlock mutex */
-    pthread_mutex_unlock ( &mb_set->draw_mutex );
+    /* record the frame and add it to the ring */
+    mb_set->readback_widths [ slot ] = mb_set->frame_width;
+    mb_set->readback_heights [ slot ] = mb_set->frame_height;
+    mb_set->readback_pixel_sizes [ slot ] = pixel_size;
+    mb_set->readback_tags [ slot ] = tag;
+    ++mb_set->readback_pending;
 
     /* return 0 for success */
     return 0;
-}
\ No newline at end of file
+}
+
+/* mb_map_readback
+ *
+ * map the oldest frame in the readback ring for reading
+ * the frame is 8 bit RGBA, or 32 bit float RGBA if the output was raw when it was queued, with the bottom row first,
+ * and must be unmapped with mb_unmap_readback once consumed
+ *
+ * mb_set: the mandelbrot set to map the frame of
+ * wait: 1 to wait for the read to complete, 0 to return immediately if it has not
+ * pixels: will be set to the pixels of the frame
+ * width/height: will be set to the size of the frame
+ * tag: will be set to the tag the frame was queued with
+ *
+ * return: 0 for success, 1 if no frame is ready, -1 for failure
+ */
+int mb_map_readback ( mb_set_t mb_set, const int wait, const unsigned char ** pixels, int * width, int * height, unsigned long * tag )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before reading a mandelbrot set" );
+
+    /* if the oldest frame is already mapped, or there are no frames, fail */
+    if ( mb_set->readback_mapped || mb_set->readback_pending == 0 ) return ( mb_set->readback_mapped ? -1 : 1 );
+
+    /* check or wait for the read of the oldest frame to complete */
+    const int slot = mb_set->readback_head;
+    MB_TRACE_BEGIN ( "wait readback" );
+    const int signalled = glh_wait_fence ( mb_set->readback_fences [ slot ], ( wait ? UINT64_MAX : 0 ) );
+    MB_TRACE_END ( "wait readback" );
+    if ( signalled != 1 ) return ( signalled == 0 ? 1 : -1 );
+
+    /* map the pbo */
+    const size_t size = ( size_t ) mb_set->readback_widths [ slot ] * mb_set->readback_heights [ slot ] * mb_set->readback_pixel_sizes [ slot ];
+    if ( !( *pixels = glh_map_pixel_pack_buffer_object ( mb_set->readback_pbos [ slot ], size ) ) ) return -1;
+    mb_set->readback_mapped = 1;
+
+    /* set the size and tag of the frame */
+    *width = mb_set->readback_widths [ slot ];
+    *height = mb_set->readback_heights [ slot ];
+    *tag = mb_set->readback_tags [ slot ];
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_unmap_readback
+ *
+ * unmap the frame mapped by mb_map_readback, freeing its place in the readback ring
+ *
+ * mb_set: the mandelbrot set to unmap the frame of
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_unmap_readback ( mb_set_t mb_set )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before reading a mandelbrot set" );
+
+    /* if no frame is mapped, fail */
+    if ( !mb_set->readback_mapped ) return -1;
+
+    /* delete the fence and unmap the pbo */
+    const int slot = mb_set->readback_head;
+    glh_delete_fence ( mb_set->readback_fences [ slot ] );
+    mb_set->readback_fences [ slot ] = NULL;
+    const int unmapped = glh_unmap_pixel_pack_buffer_object ( mb_set->readback_pbos [ slot ] );
+
+    /* remove the frame from the ring */
+    mb_set->readback_mapped = 0;
+    mb_set->readback_head = ( slot + 1 ) % MANDELBROT_READBACK_COUNT;
+    --mb_set->readback_pending;
+
+    /* return whether the contents survived being mapped */
+    return unmapped;
+}
+
+/* mb_set_output
+ *
+ * set what the frame holds, recreating the frame in the format for it and restarting it if the output changes
+ * uses the context current on the calling thread, so must not be called while the render thread is running
+ *
+ * mb_set: the mandelbrot set to set the output of
+ * output: what the frame should hold (MANDELBROT_OUTPUT_X)
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_set_output ( mb_set_t mb_set, const int output )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before setting the output of a mandelbrot set" );
+
+    /* if the output is unchanged, there is nothing to do */
+    if ( output == mb_set->output ) return 0;
+
+    /* set the output, and recreate the frame in its format if there is one */
+    mb_set->output = output;
+    if ( mb_set->frame_fbo != -1 && __mb_resize_frame ( mb_set, mb_set->frame_width, mb_set->frame_height ) < 0 ) return -1;
+
+    /* restart the frame with a generation which is odd, so never matches a published view */
+    mb_set->frame_generation = 1;
+    mb_set->frame_tiles_done = 0;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_set_reference
+ *
+ * iterate a reference point at high precision, once, and upload its orbit for every following frame to perturb around
+ * while there is a reference, the centre of the set is an offset from the reference point, so views far deeper than a float
+ * can place are rendered by iterating only the small offset of each pixel, and views needing fewer iterations reuse the start of the orbit
+ * colour and raw output are both perturbed, for a power of 2, and the view still rotates about its centre, as it does without a reference
+ * uses the context current on the calling thread, so must not be called while the render thread is running
+ *
+ * mb_set: the mandelbrot set to set the reference of
+ * re/im_reference: the reference point, such as the target of a zoom
+ * max_it: the maximum iterations of the deepest view to be rendered
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_set_reference ( mb_set_t mb_set, const long double re_reference, const long double im_reference, const int max_it )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before setting the reference of a mandelbrot set" );
+
+    /* allocate the orbit, with a point for the start and every iteration, rounded up to whole rows of the texture */
+    const int rows = ( max_it + MANDELBROT_ORBIT_WIDTH ) / MANDELBROT_ORBIT_WIDTH;
+    float * orbit = calloc ( ( size_t ) rows * MANDELBROT_ORBIT_WIDTH * 4, sizeof ( float ) );
+    if ( !orbit )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate memory for reference orbit\n" );
+        return -1;
+    }
+
+    /* iterate the reference point from 0 until it breaks out or reaches the maximum iterations, storing each point as a float */
+    MB_TRACE_BEGIN ( "reference orbit" );
+    const long double breakout = mb_set->breakout;
+    long double re_z = 0.0L, im_z = 0.0L;
+    int length = 1;
+    while ( length <= max_it && ( re_z * re_z ) + ( im_z * im_z ) < breakout * breakout )
+    {
+        const long double re_next = ( re_z * re_z ) - ( im_z * im_z ) + re_reference;
+        im_z = ( 2.0L * re_z * im_z ) + im_reference;
+        re_z = re_next;
+        orbit [ ( size_t ) length * 4 ] = ( float ) re_z;
+        orbit [ ( size_t ) length * 4 + 1 ] = ( float ) im_z;
+        ++length;
+    }
+    MB_TRACE_END ( "reference orbit" );
+
+    /* recreate the texture if it has too few rows, then upload the orbit and bind it to its unit */
+    if ( mb_set->orbit_texture == -1 || mb_set->orbit_rows < rows )
+    {
+        if ( mb_set->orbit_texture != -1 ) glh_delete_texture ( mb_set->orbit_texture );
+        mb_set->orbit_rows = 0;
+        if ( ( mb_set->orbit_texture = glh_create_texture_2d ( MANDELBROT_ORBIT_WIDTH, rows, GLH_TEX_RGBA32F, GLH_TEX_FORMAT_RGBA, GLH_TYPE_FLOAT, GLH_TEX_FILTER_NEAREST ) ) == -1 )
+        {
+            /* failed to create the texture */
+            fprintf ( stderr, "MB ERROR: failed to create reference orbit texture\n" );
+            free ( orbit );
+            return -1;
+        }
+        mb_set->orbit_rows = rows;
+    }
+    MB_TRACE_BEGIN ( "upload orbit" );
+    glh_update_texture_2d ( mb_set->orbit_texture, 0, 0, MANDELBROT_ORBIT_WIDTH, rows, GLH_TEX_FORMAT_RGBA, GLH_TYPE_FLOAT, orbit );
+    MB_TRACE_END ( "upload orbit" );
+    glh_bind_texture_2d_to_unit ( mb_set->orbit_texture, MANDELBROT_ORBIT_UNIT );
+    free ( orbit );
+
+    /* set the reference */
+    mb_set->re_reference = re_reference;
+    mb_set->im_reference = im_reference;
+    mb_set->orbit_length = length;
+
+    /* restart the frame with a generation which is odd, so never matches a published view */
+    mb_set->frame_generation = 1;
+    mb_set->frame_tiles_done = 0;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_clear_reference
+ *
+ * stop perturbing around the reference orbit, so the centre of the set is once again a point on the plane
+ *
+ * mb_set: the mandelbrot set to clear the reference of
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_clear_reference ( mb_set_t mb_set )
+{
+    /* clear the reference, keeping the texture to be reused */
+    mb_set->re_reference = 0;
+    mb_set->im_reference = 0;
+    mb_set->orbit_length = 0;
+
+    /* restart the frame with a generation which is odd, so never matches a published view */
+    mb_set->frame_generation = 1;
+    mb_set->frame_tiles_done = 0;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_publish_view
+ *
+ * publish the current parameters of the set as the view to render
+ * should be called whenever the parameters are changed
+ * does not block on rendering, and wakes the render thread if there is one
+ * also updates re/im_range to the ranges which will be visible with the current parameters
+ *
+ * mb_set: the mandelbrot set to publish the view of
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_publish_view ( mb_set_t mb_set )
+{
+    /* create the view from the current parameters */
+    mb_view_t view;
+    view.re_min_range = mb_set->re_min_range;
+    view.im_min_range = mb_set->im_min_range;
+    view.re_centre = mb_set->re_centre;
+    view.im_centre = mb_set->im_centre;
+    view.breakout = mb_set->breakout;
+    view.max_it = mb_set->max_it;
+    view.power = mb_set->power;
+    view.rotation = mb_set->rotation;
+    view.width = mb_set->width;
+    view.height = mb_set->height;
+    view.re_reference [ 0 ] = mb_set->re_reference;
+    view.re_reference [ 1 ] = mb_set->re_reference - view.re_reference [ 0 ];
+    view.im_reference [ 0 ] = mb_set->im_reference;
+    view.im_reference [ 1 ] = mb_set->im_reference - view.im_reference [ 0 ];
+
+    /* set the new ranges, if the viewport is not empty */
+    if ( view.width > 0 && view.height > 0 )
+    {
+        const float stretch = __mb_view_stretch ( &view );
+        mb_set->re_range = ( float ) view.width * stretch;
+        mb_set->im_range = ( float ) view.height * stretch;
+    }
+
+    /* write the view, with the generation odd while it is being written so that readers retry */
+    const unsigned long generation = __atomic_load_n ( &mb_set->generation, __ATOMIC_RELAXED );
+    __atomic_store_n ( &mb_set->generation, generation + 1, __ATOMIC_RELAXED );
+    __atomic_thread_fence ( __ATOMIC_RELEASE );
+    mb_set->published_view = view;
+    __atomic_store_n ( &mb_set->generation, generation + 2, __ATOMIC_RELEASE );
+
+    /* wake the render thread
+     * the mutex is never held while rendering, so this cannot block on a render
+     */
+    pthread_mutex_lock ( &mb_set->render_mutex );
+    pthread_cond_signal ( &mb_set->render_cond );
+    pthread_mutex_unlock ( &mb_set->render_mutex );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_mark_damaged
+ *
+ * mark the window the set is drawn onto as damaged, so that the frame is presented again
+ * does not block on rendering, and wakes the render thread if there is one
+ *
+ * mb_set: the mandelbrot set to mark as damaged
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_mark_damaged ( mb_set_t mb_set )
+{
+    /* set the damaged flag and wake the render thread */
+    pthread_mutex_lock ( &mb_set->render_mutex );
+    __atomic_store_n ( &mb_set->damaged, 1, __ATOMIC_RELEASE );
+    pthread_cond_signal ( &mb_set->render_cond );
+    pthread_mutex_unlock ( &mb_set->render_mutex );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_start_render_thread
+ *
+ * start a thread which owns the window's context and draws the set whenever a new view is published or the window is damaged
+ * the window's context is released from the calling thread, which must not use OpenGL until mb_stop_render_thread is called
+ *
+ * mb_set: the mandelbrot set to draw
+ * window: the window to draw onto, whose context must be current on the calling thread
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_start_render_thread ( mb_set_t mb_set, glh_window_t window )
+{
+    /* if already running, produce error */
+    if ( mb_set->render_thread_running )
+    {
+        fprintf ( stderr, "MB ERROR: render thread is already running\n" );
+        return -1;
+    }
+
+    /* set the window and clear the stop flag */
+    mb_set->render_window = window;
+    mb_set->render_stop = 0;
+
+    /* release the context so that the render thread can make it current */
+    glh_release_window_current ();
+
+    /* start the thread */
+    if ( pthread_create ( &mb_set->render_thread, NULL, __mb_render_thread, mb_set ) != 0 )
+    {
+        /* failed, so take the context back and produce error */
+        glh_make_window_current ( window );
+        fprintf ( stderr, "MB ERROR: failed to start render thread\n" );
+        return -1;
+    }
+
+    /* set the running flag */
+    mb_set->render_thread_running = 1;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_stop_render_thread
+ *
+ * stop the render thread, if running, and make the window's context current on the calling thread again
+ *
+ * mb_set: the mandelbrot set being drawn
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_stop_render_thread ( mb_set_t mb_set )
+{
+    /* if not running, there is nothing to do */
+    if ( !mb_set->render_thread_running ) return 0;
+
+    /* set the stop flag and wake the render thread */
+    pthread_mutex_lock ( &mb_set->render_mutex );
+    mb_set->render_stop = 1;
+    pthread_cond_signal ( &mb_set->render_cond );
+    pthread_mutex_unlock ( &mb_set->render_mutex );
+
+    /* wait for the render thread to finish, which releases the context */
+    pthread_join ( mb_set->render_thread, NULL );
+    mb_set->render_thread_running = 0;
+
+    /* take the context back */
+    return glh_make_window_current ( mb_set->render_window );
+}
+
+/* mb_record_frame_times
+ *
+ * start recording the duration of each draw made by the render thread, discarding any durations already recorded
+ * the durations are in frame_times, and frame_time_count of them have been recorded, which may be read once the render thread is stopped
+ * must not be called while the render thread is running
+ *
+ * mb_set: the mandelbrot set to record the frame times of
+ * capacity: the most durations to record, after which no more are recorded, or 0 to stop recording
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_record_frame_times ( mb_set_t mb_set, const int capacity )
+{
+    /* discard any durations already recorded */
+    free ( mb_set->frame_times );
+    mb_set->frame_times = NULL;
+    mb_set->frame_time_capacity = 0;
+    mb_set->frame_time_count = 0;
+
+    /* if recording, allocate room for the durations */
+    if ( capacity > 0 )
+    {
+        if ( !( mb_set->frame_times = malloc ( ( size_t ) capacity * sizeof ( double ) ) ) )
+        {
+            /* failed to allocate */
+            fprintf ( stderr, "MB ERROR: failed to allocate memory for frame times\n" );
+            return -1;
+        }
+        mb_set->frame_time_capacity = capacity;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_wait_frame
+ *
+ * wait until the render thread has completed the frame of the most recently published view, or failed to draw it
+ *
+ * mb_set: the mandelbrot set to wait for
+ *
+ * return: 0 for success, -1 for failure, including if the render thread is not running or failed to draw the view
+ */
+int mb_wait_frame ( mb_set_t mb_set )
+{
+    /* if the render thread is not running, no frame will be completed */
+    if ( !mb_set->render_thread_running ) return -1;
+
+    /* wait until the generation of the last completed or failed frame is that of the published view */
+    pthread_mutex_lock ( &mb_set->render_mutex );
+    unsigned long generation;
+    while ( mb_set->complete_generation != ( generation = __atomic_load_n ( &mb_set->generation, __ATOMIC_ACQUIRE ) ) && mb_set->failed_generation != generation )
+        pthread_cond_wait ( &mb_set->frame_cond, &mb_set->render_mutex );
+    const int failed = ( mb_set->complete_generation != generation );
+    pthread_mutex_unlock ( &mb_set->render_mutex );
+
+    /* return -1 if the frame failed, otherwise 0 for success */
+    return ( failed ? -1 : 0 );
+}
+
+/* mb_get_stats
+ *
+ * read back the timings of any draws the gpu has finished, without stalling, and get the timings of all draws read back so far
+ * must be called on the thread rendering the set, with its context current, or once the render thread has stopped
+ *
+ * mb_set: the mandelbrot set to get the timings of
+ * stats: will be set to the timings
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_get_stats ( mb_set_t mb_set, mb_stats_t * stats )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before getting the timings of a mandelbrot set" );
+
+    /* read back any finished timings, and copy the statistics */
+    const int status = __mb_update_stats ( mb_set );
+    * stats = mb_set->stats;
+
+    /* return the status */
+    return status;
+}
+
+/* mb_set_hud
+ *
+ * show or hide the overlay of performance statistics drawn over the window by mb_draw
+ * if the overlay cannot be created when it is first drawn, it is hidden again and frame statistics are disabled, as they are counted for it
+ * does not block on rendering, and wakes the render thread if there is one, so that the window is presented again
+ *
+ * mb_set: the mandelbrot set whose overlay to show or hide
+ * enabled: 1 to show the overlay, 0 to hide it
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_set_hud ( mb_set_t mb_set, const int enabled )
+{
+    /* show or hide the overlay, then mark the window as damaged, so that it is presented again with or without it */
+    __atomic_store_n ( &mb_set->hud_enabled, ( enabled ? 1 : 0 ), __ATOMIC_RELEASE );
+    return mb_mark_damaged ( mb_set );
+}
+
+/* mb_set_frame_stats
+ *
+ * enable or disable reducing the iterations of each complete frame to statistics on the gpu
+ * while enabled, a colour frame also renders the iterations of each pixel into a second colour buffer, which is only created as a frame
+ * is started, so the frame in progress is never restarted, and statistics are of the frames started after they are enabled
+ * does not block on rendering, and wakes the render thread if there is one
+ *
+ * mb_set: the mandelbrot set to enable or disable statistics of
+ * enabled: 1 to enable statistics, 0 to disable them
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_set_frame_stats ( mb_set_t mb_set, const int enabled )
+{
+    /* enable or disable statistics, then mark the window as damaged, so that the render thread wakes to present the frame again */
+    __atomic_store_n ( &mb_set->frame_stats_enabled, ( enabled ? 1 : 0 ), __ATOMIC_RELEASE );
+    return mb_mark_damaged ( mb_set );
+}
+
+/* mb_get_frame_stats
+ *
+ * read back the statistics of the last frame reduced, if finished, and get the statistics of the last frame read back
+ * must be called on the thread rendering the set, with its context current, or once the render thread has stopped
+ *
+ * mb_set: the mandelbrot set to get the statistics of
+ * stats: will be set to the statistics, whose frames is 0 if no frame has been read back
+ * wait: 1 to wait for the last frame reduced to be read back, 0 to return immediately if it has not
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_get_frame_stats ( mb_set_t mb_set, mb_frame_stats_t * stats, const int wait )
+{
+    /* check glad is initialised */
+    __GLH_GLAD_INIT_CHECK__ ( 1, -1, "MB ERROR: glad must be initialised before getting the statistics of a mandelbrot set" );
+
+    /* read back any finished statistics, and copy them */
+    const int status = __mb_read_frame_stats ( mb_set, wait );
+    * stats = mb_set->frame_stats;
+
+    /* return the status */
+    return ( status < 0 ? -1 : 0 );
+}
+
+/* __mb_render_thread
+ *
+ * the function run by the render thread
+ *
+ * arg: the mandelbrot set to draw
+ *
+ * return: NULL
+ */
+void * __mb_render_thread ( void * arg )
+{
+    /* get the mandelbrot set */
+    mb_set_t mb_set = ( mb_set_t ) arg;
+
+    /* take ownership of the context, and name the thread in any trace */
+    glh_make_window_current ( mb_set->render_window );
+    mb_trace_name_thread ( "render" );
+
+    /* draw until stopped */
+    int partial = 1;
+    pthread_mutex_lock ( &mb_set->render_mutex );
+    while ( !mb_set->render_stop )
+    {
+        /* if the frame is complete or failed, no new view has been published and the window is not damaged, sleep until woken */
+        const unsigned long generation = __atomic_load_n ( &mb_set->generation, __ATOMIC_ACQUIRE );
+        if ( !partial && ( generation == mb_set->frame_generation || generation == mb_set->failed_generation ) && !__atomic_load_n ( &mb_set->damaged, __ATOMIC_ACQUIRE ) )
+        {
+            pthread_cond_wait ( &mb_set->render_cond, &mb_set->render_mutex );
+            continue;
+        }
+
+        /* draw, without holding the mutex, recording how long the draw took if recording frame times */
+        pthread_mutex_unlock ( &mb_set->render_mutex );
+        const double start_time = ( mb_set->frame_times ? glh_get_time () : 0.0 );
+        MB_TRACE_BEGIN ( "draw" );
+        const int drawn = mb_draw ( mb_set, mb_set->render_window );
+        partial = ( drawn > 0 );
+        MB_TRACE_END ( "draw" );
+        if ( mb_set->frame_time_count < mb_set->frame_time_capacity ) mb_set->frame_times [ mb_set->frame_time_count++ ] = glh_get_time () - start_time;
+        pthread_mutex_lock ( &mb_set->render_mutex );
+
+        /* if the draw failed, record the generation it was of and clear any damage, so that the view is not drawn again
+         * until a new view is published or the window is damaged again, and wake anything waiting for it
+         */
+        if ( drawn < 0 )
+        {
+            mb_set->failed_generation = generation;
+            __atomic_store_n ( &mb_set->damaged, 0, __ATOMIC_RELEASE );
+            pthread_cond_broadcast ( &mb_set->frame_cond );
+            continue;
+        }
+
+        /* if the frame is complete, record its generation and wake anything waiting for it */
+        if ( !partial )
+        {
+            mb_set->complete_generation = mb_set->frame_generation;
+            pthread_cond_broadcast ( &mb_set->frame_cond );
+        }
+    }
+    pthread_mutex_unlock ( &mb_set->render_mutex );
+
+    /* release the context */
+    glh_release_window_current ();
+
+    /* return NULL */
+    return NULL;
+}
+
+/* __mb_read_view
+ *
+ * read the most recently published view
+ * lock-free, retrying if the view is published while being read
+ *
+ * mb_set: the mandelbrot set to read the view of
+ * view: will be set to the view
+ *
+ * return: the generation of the view read
+ */
+unsigned long __mb_read_view ( mb_set_t mb_set, mb_view_t * view )
+{
+    /* read until a view is read which was not published while reading */
+    while ( 1 )
+    {
+        /* get the generation, retrying if a view is being published */
+        const unsigned long generation = __atomic_load_n ( &mb_set->generation, __ATOMIC_ACQUIRE );
+        if ( generation & 1 ) continue;
+
+        /* copy the view */
+        * view = mb_set->published_view;
+
+        /* if the generation is unchanged, the copy is consistent */
+        __atomic_thread_fence ( __ATOMIC_ACQUIRE );
+        if ( __atomic_load_n ( &mb_set->generation, __ATOMIC_RELAXED ) == generation ) return generation;
+    }
+}
+
+/* __mb_view_stretch
+ *
+ * find the stretch from pixels to the complex plane for a view
+ * the stretch is such that at least the minimum ranges are visible
+ *
+ * view: the view to find the stretch of
+ *
+ * return: the stretch
+ */
+float __mb_view_stretch ( const mb_view_t * view )
+{
+    /* create the stretch coeficients */
+    const float re_stretch = view->re_min_range / ( float ) view->width;
+    const float im_stretch = view->im_min_range / ( float ) view->height;
+
+    /* return the overall stretch, which is the largest coeficient */
+    return fmaxf ( re_stretch, im_stretch );
+}
+
+/* __mb_prepare_frame
+ *
+ * prepare to render tiles of the frame for a view, using the context current on the calling thread
+ * the shader program and uniform buffer object are bound, the frame is resized if necessary,
+ * and if the view differs from the one the frame was started with the frame is restarted
+ *
+ * mb_set: the mandelbrot set to prepare
+ * view: the view to render
+ * generation: the generation of the view
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_prepare_frame ( mb_set_t mb_set, const mb_view_t * view, const unsigned long generation )
+{
+    /* use shader program and bind the uniform buffer object */
+    glh_use_shader_program ( mb_set->sprogram );
+    glh_bind_uniform_buffer_object ( mb_set->ubo, MANDELBROT_UNIFORM_BINDING );
+
+    /* find whether the frame must be recreated, because the view has changed size, and whether it must be restarted */
+    const int resize = ( view->width != mb_set->frame_width || view->height != mb_set->frame_height );
+    const int restart = ( resize || generation != mb_set->frame_generation );
+
+    /* recreate the frame if necessary */
+    if ( resize )
+    {
+        if ( __mb_resize_frame ( mb_set, view->width, view->height ) < 0 ) return -1;
+    }
+
+    /* if restarting, update the uniforms for the view
+     * otherwise the uniform buffer object still holds the uniforms the frame was started with
+     */
+    if ( restart )
+    {
+        /* give the frame a buffer for iterations if statistics have been enabled since it was created */
+        if ( __mb_attach_iterations ( mb_set ) < 0 ) return -1;
+
+        /* update the uniforms for the whole view */
+        __mb_update_uniforms ( mb_set, view, 0, 0 );
+
+        /* restart the frame */
+        mb_set->frame_generation = generation;
+        mb_set->frame_tiles_done = 0;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_update_uniforms
+ *
+ * write the uniforms to render a view with to the uniform buffer object, if they have changed
+ * the uniforms can be offset so that fragment coordinate (0,0) is a pixel other than the bottom left of the view
+ *
+ * mb_set: the mandelbrot set to update the uniforms of
+ * view: the view to render
+ * x/y: the pixel of the view which fragment coordinate (0,0) should be, from the bottom left
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_update_uniforms ( mb_set_t mb_set, const mb_view_t * view, const int x, const int y )
+{
+    /* find the stretch */
+    const float stretch = __mb_view_stretch ( view );
+
+    /* create the uniforms for this view */
+    mb_uniforms_t uniforms;
+    memset ( &uniforms, 0, sizeof ( mb_uniforms_t ) );
+    uniforms.stretch [ 0 ] = stretch;
+    uniforms.stretch [ 1 ] = stretch;
+    uniforms.stretch [ 2 ] = 1.0f;
+    uniforms.stretch [ 3 ] = 1.0f;
+    uniforms.translation [ 0 ] = ( x * stretch ) - ( view->width * stretch / 2 );
+    uniforms.translation [ 1 ] = ( y * stretch ) - ( view->height * stretch / 2 );
+    uniforms.rotation_matrix [ 0 ] = cos ( view->rotation );
+    uniforms.rotation_matrix [ 1 ] = -sin ( view->rotation );
+    uniforms.rotation_matrix [ 4 ] = sin ( view->rotation );
+    uniforms.rotation_matrix [ 5 ] = cos ( view->rotation );
+    uniforms.breakout = view->breakout;
+    uniforms.max_it = ( int ) view->max_it;
+    uniforms.power = view->power;
+    uniforms.output = mb_set->output;
+    uniforms.mapping = MANDELBROT_MAPPING_LINEAR;
+    uniforms.reference [ 0 ] = mb_set->re_reference;
+    uniforms.reference [ 1 ] = mb_set->im_reference;
+    uniforms.centre [ 0 ] = view->re_centre;
+    uniforms.centre [ 1 ] = view->im_centre;
+    uniforms.orbit_length = mb_set->orbit_length;
+
+    /* write the uniforms */
+    return __mb_write_uniforms ( mb_set, &uniforms );
+}
+
+/* __mb_write_uniforms
+ *
+ * write uniforms to the uniform buffer object, if they have changed
+ *
+ * mb_set: the mandelbrot set to write the uniforms of
+ * uniforms: the uniforms to write
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_write_uniforms ( mb_set_t mb_set, const mb_uniforms_t * uniforms )
+{
+    /* if the uniforms have changed, write them to the uniform buffer object in a single update */
+    ++mb_set->stats.uniform_writes;
+    if ( memcmp ( uniforms, &mb_set->ubo_uniforms, sizeof ( mb_uniforms_t ) ) != 0 )
+    {
+        MB_TRACE_BEGIN ( "upload uniforms" );
+        glh_update_uniform_buffer_object ( mb_set->ubo, 0, uniforms, sizeof ( mb_uniforms_t ) );
+        mb_set->ubo_uniforms = *uniforms;
+        ++mb_set->stats.uniform_uploads;
+        MB_TRACE_END ( "upload uniforms" );
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_render_tiles
+ *
+ * render the next tiles of a prepared frame, until a budget of pixels is used up
+ * always renders at least one tile, unless the frame is complete
+ *
+ * mb_set: the mandelbrot set to render the tiles of
+ * pixel_budget: the number of pixels to render
+ *
+ * return: 1 if tiles remain to be rendered, 0 if the frame is complete
+ */
+int __mb_render_tiles ( mb_set_t mb_set, const double pixel_budget )
+{
+    /* begin timing the tiles */
+    MB_TRACE_BEGIN ( "tiles" );
+    __mb_begin_phase ( mb_set, MANDELBROT_PHASE_ITERATE );
+
+    /* find the number of tiles across and up the frame */
+    const int tiles_x = ( mb_set->frame_width + MANDELBROT_TILE_SIZE - 1 ) / MANDELBROT_TILE_SIZE;
+    const int tiles_y = ( mb_set->frame_height + MANDELBROT_TILE_SIZE - 1 ) / MANDELBROT_TILE_SIZE;
+
+    /* render tiles into the frame until the budget is used up, always rendering at least one tile */
+    glh_bind_framebuffer_object ( mb_set->frame_fbo );
+    int pixels_rendered = 0;
+    while ( mb_set->frame_tiles_done < tiles_x * tiles_y && ( pixels_rendered == 0 || pixels_rendered < pixel_budget ) )
+    {
+        /* find the position and size of the tile */
+        const int tile_x = ( mb_set->frame_tiles_done % tiles_x ) * MANDELBROT_TILE_SIZE;
+        const int tile_y = ( mb_set->frame_tiles_done / tiles_x ) * MANDELBROT_TILE_SIZE;
+        const int tile_width = ( mb_set->frame_width - tile_x < MANDELBROT_TILE_SIZE ? mb_set->frame_width - tile_x : MANDELBROT_TILE_SIZE );
+        const int tile_height = ( mb_set->frame_height - tile_y < MANDELBROT_TILE_SIZE ? mb_set->frame_height - tile_y : MANDELBROT_TILE_SIZE );
+
+        /* render the tile */
+        glh_enable_scissor ( tile_x, tile_y, tile_width, tile_height );
+        glh_draw_elements ( mb_set->vao, GLH_DRAWMODE_TRIANGLES, 6, GLH_TYPE_UNSIGNED_INT );
+
+        /* count the tile */
+        pixels_rendered += tile_width * tile_height;
+        ++mb_set->frame_tiles_done;
+    }
+    glh_disable_scissor ();
+
+    /* end timing the tiles, recording the pixels they covered */
+    __mb_end_phase ( mb_set, MANDELBROT_PHASE_ITERATE );
+    MB_TRACE_END ( "tiles" );
+    if ( mb_set->timer ) mb_set->timer->pixels += pixels_rendered;
+
+    /* if these tiles completed the frame, reduce it to statistics, outside of the timed phase so that it does not skew the time per pixel */
+    const int tiles_remain = ( mb_set->frame_tiles_done < tiles_x * tiles_y );
+    if ( !tiles_remain && pixels_rendered > 0 && __atomic_load_n ( &mb_set->frame_stats_enabled, __ATOMIC_ACQUIRE ) ) __mb_reduce_frame ( mb_set );
+
+    /* return whether tiles remain */
+    return tiles_remain;
+}
+
+/* __mb_resize_frame
+ *
+ * recreate the texture and framebuffer the set is rendered into at a new size, in the format for its output
+ * the new frame is cleared to white and has no tiles rendered, and the viewport is set to cover it
+ * the new frame has no buffer for iterations until __mb_attach_iterations gives it one, as every caller does when the frame restarts
+ *
+ * mb_set: the mandelbrot set to resize the frame of
+ * width/height: the new size of the frame
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_resize_frame ( mb_set_t mb_set, const int width, const int height )
+{
+    /* delete the old frame */
+    if ( mb_set->frame_fbo != -1 ) glh_delete_framebuffer_object ( mb_set->frame_fbo );
+    if ( mb_set->frame_texture != -1 ) glh_delete_texture ( mb_set->frame_texture );
+    if ( mb_set->iterations_texture != -1 ) glh_delete_texture ( mb_set->iterations_texture );
+    mb_set->iterations_texture = -1;
+    mb_set->frame_fbo = -1;
+    mb_set->frame_width = 0;
+    mb_set->frame_height = 0;
+
+    /* create the new frame */
+    if ( ( mb_set->frame_texture = ( mb_set->output == MANDELBROT_OUTPUT_RAW ?
+           glh_create_texture_2d ( width, height, GLH_TEX_RGBA32F, GLH_TEX_FORMAT_RGBA, GLH_TYPE_FLOAT, GLH_TEX_FILTER_NEAREST ) :
+           glh_create_texture_2d ( width, height, GLH_TEX_RGBA8, GLH_TEX_FORMAT_RGBA, GLH_TYPE_UNSIGNED_BYTE, GLH_TEX_FILTER_NEAREST ) ) ) == -1 ||
+         ( mb_set->frame_fbo = glh_create_framebuffer_object ( mb_set->frame_texture ) ) == -1 )
+    {
+        /* error creating frame */
+        fprintf ( stderr, "MB ERROR: failed to create frame\n" );
+        return -1;
+    }
+
+    /* clear the new frame, and set the viewport to cover it */
+    glh_bind_framebuffer_object ( mb_set->frame_fbo );
+    glh_set_clear_color ( 1.0f, 1.0f, 1.0f, 1.0f );
+    glh_clear_screen ();
+    glh_set_viewport ( 0, 0, width, height );
+
+    /* set the new size and restart the frame */
+    mb_set->frame_width = width;
+    mb_set->frame_height = height;
+    mb_set->frame_tiles_done = 0;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_attach_iterations
+ *
+ * give a colour frame a second colour buffer to render the iterations of each pixel into, if statistics are enabled and it has none
+ * must only be called as the frame is restarted, so that every pixel of a frame with the buffer has its iterations in it,
+ * and the buffer is kept until the frame is recreated, so that neither enabling nor disabling statistics restarts the frame
+ *
+ * mb_set: the mandelbrot set to attach the buffer to the frame of
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_attach_iterations ( mb_set_t mb_set )
+{
+    /* a raw frame holds the iterations already, and a frame which has the buffer keeps it */
+    if ( !__atomic_load_n ( &mb_set->frame_stats_enabled, __ATOMIC_ACQUIRE ) || mb_set->output == MANDELBROT_OUTPUT_RAW || mb_set->iterations_texture != -1 ) return 0;
+
+    /* create the buffer at the size of the frame and attach it */
+    if ( ( mb_set->iterations_texture = glh_create_texture_2d ( mb_set->frame_width, mb_set->frame_height, GLH_TEX_R32F, GLH_TEX_FORMAT_RED, GLH_TYPE_FLOAT, GLH_TEX_FILTER_NEAREST ) ) == -1 ||
+         glh_attach_texture_to_framebuffer_object ( mb_set->frame_fbo, mb_set->iterations_texture, 1 ) == -1 )
+    {
+        /* error creating the colour buffer */
+        fprintf ( stderr, "MB ERROR: failed to create iterations buffer\n" );
+        return -1;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_render_all_tiles
+ *
+ * render every remaining tile of a prepared frame, in batches of MANDELBROT_TILE_BUDGET, each timed on the gpu
+ *
+ * mb_set: the mandelbrot set to render the tiles of
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_render_all_tiles ( mb_set_t mb_set )
+{
+    /* render batches of tiles until the frame is complete, updating the estimated time per pixel before each */
+    int tiles_remain = 1;
+    while ( tiles_remain )
+    {
+        __mb_update_stats ( mb_set );
+        __mb_begin_timing ( mb_set, 0 );
+        tiles_remain = __mb_render_tiles ( mb_set, ( mb_set->pixel_time > 0.0 ? MANDELBROT_TILE_BUDGET / mb_set->pixel_time : 1.0 ) );
+        __mb_end_timing ( mb_set );
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_begin_timing
+ *
+ * begin timing a draw, if there are enough free timer queries, otherwise the draw goes untimed
+ *
+ * mb_set: the mandelbrot set being drawn
+ * time_cpu: 1 to also time the cpu with glh_get_time, which requires glfw, or 0 to not
+ *
+ * return: 1 if the draw is being timed, 0 if not
+ */
+int __mb_begin_timing ( mb_set_t mb_set, const int time_cpu )
+{
+    /* if there is no room for another draw in the ring, or not enough queries for it, leave it untimed */
+    mb_set->timer = NULL;
+    if ( mb_set->timer_pending >= MANDELBROT_TIMER_COUNT || glh_timer_pool_free ( mb_set->elapsed_pool ) < MANDELBROT_PHASE_COUNT || glh_timer_pool_free ( mb_set->timestamp_pool ) < 2 ) return 0;
+
+    /* add the draw to the ring, with no phases timed yet */
+    mb_timer_t * timer = &mb_set->timers [ ( mb_set->timer_head + mb_set->timer_pending ) % MANDELBROT_TIMER_COUNT ];
+    ++mb_set->timer_pending;
+    memset ( timer, 0, sizeof ( mb_timer_t ) );
+    for ( int phase = 0; phase < MANDELBROT_PHASE_COUNT; ++phase ) timer->phase_slots [ phase ] = -1;
+    timer->end_slot = -1;
+
+    /* record the timestamp at its start */
+    timer->start_slot = glh_timer_pool_timestamp ( mb_set->timestamp_pool );
+    timer->timestamp_queries = 1;
+
+    /* it is now the draw being timed */
+    mb_set->timer = timer;
+    mb_set->timer_cpu = time_cpu;
+
+    /* return 1, as the draw is being timed */
+    return 1;
+}
+
+/* __mb_begin_phase
+ *
+ * begin timing a phase of the draw being timed, if any
+ *
+ * mb_set: the mandelbrot set being drawn
+ * phase: the phase (MANDELBROT_PHASE_X)
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_begin_phase ( mb_set_t mb_set, const int phase )
+{
+    /* if no draw is being timed, there is nothing to do */
+    mb_timer_t * timer = mb_set->timer;
+    if ( !timer ) return 0;
+
+    /* begin a timer query for the phase, and note when the cpu began it */
+    timer->phase_slots [ phase ] = glh_timer_pool_begin ( mb_set->elapsed_pool );
+    ++timer->elapsed_queries;
+    if ( mb_set->timer_cpu ) mb_set->phase_start = glh_get_time ();
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_end_phase
+ *
+ * end timing a phase of the draw being timed, if any
+ *
+ * mb_set: the mandelbrot set being drawn
+ * phase: the phase (MANDELBROT_PHASE_X), which must be the phase last begun
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_end_phase ( mb_set_t mb_set, const int phase )
+{
+    /* if no draw is being timed, there is nothing to do */
+    mb_timer_t * timer = mb_set->timer;
+    if ( !timer ) return 0;
+
+    /* end the timer query, if one was free to begin, and record the cpu time the phase took */
+    if ( timer->phase_slots [ phase ] != -1 ) glh_timer_pool_end ( mb_set->elapsed_pool );
+    if ( mb_set->timer_cpu ) timer->cpu_times [ phase ] = glh_get_time () - mb_set->phase_start;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_end_timing
+ *
+ * end timing the draw being timed, if any
+ *
+ * mb_set: the mandelbrot set being drawn
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_end_timing ( mb_set_t mb_set )
+{
+    /* if no draw is being timed, there is nothing to do */
+    mb_timer_t * timer = mb_set->timer;
+    if ( !timer ) return 0;
+
+    /* record the timestamp at its end, and stop timing it */
+    timer->end_slot = glh_timer_pool_timestamp ( mb_set->timestamp_pool );
+    ++timer->timestamp_queries;
+    mb_set->timer = NULL;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_update_stats
+ *
+ * read back the timings of any draws the gpu has finished, without stalling, adding them to the statistics
+ * and updating the estimated time per pixel, and read back the statistics of the last frame reduced, if finished
+ *
+ * mb_set: the mandelbrot set to update
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_update_stats ( mb_set_t mb_set )
+{
+    /* read draws, oldest first, until one has not finished */
+    while ( mb_set->timer_pending > 0 )
+    {
+        /* read the timestamps and the time elapsed in each phase timed, stopping if any are not yet available */
+        const mb_timer_t * timer = &mb_set->timers [ mb_set->timer_head ];
+        uint64_t start = 0, end = 0, elapsed [ MANDELBROT_PHASE_COUNT ] = { 0 };
+        int available = ( glh_timer_pool_read ( mb_set->timestamp_pool, timer->start_slot, &start ) == 1 && glh_timer_pool_read ( mb_set->timestamp_pool, timer->end_slot, &end ) == 1 );
+        for ( int phase = 0; phase < MANDELBROT_PHASE_COUNT && available; ++phase )
+            if ( timer->phase_slots [ phase ] != -1 ) available = ( glh_timer_pool_read ( mb_set->elapsed_pool, timer->phase_slots [ phase ], &elapsed [ phase ] ) == 1 );
+        if ( !available ) break;
+
+        /* update the estimated time per pixel, averaging with the previous one to smooth out differences between tiles */
+        if ( timer->pixels > 0 )
+        {
+            const double pixel_time = ( elapsed [ MANDELBROT_PHASE_ITERATE ] * 1.0e-9 ) / timer->pixels;
+            mb_set->pixel_time = ( mb_set->pixel_time > 0.0 ? 0.5 * ( mb_set->pixel_time + pixel_time ) : pixel_time );
+        }
+
+        /* add the draw to the statistics */
+        mb_stats_t * stats = &mb_set->stats;
+        ++stats->draws;
+        stats->pixels = timer->pixels;
+        stats->total_pixels += timer->pixels;
+        stats->gpu_span = ( end > start ? ( end - start ) * 1.0e-9 : 0.0 );
+        stats->total_gpu_span += stats->gpu_span;
+        for ( int phase = 0; phase < MANDELBROT_PHASE_COUNT; ++phase )
+        {
+            stats->gpu_times [ phase ] = elapsed [ phase ] * 1.0e-9;
+            stats->cpu_times [ phase ] = timer->cpu_times [ phase ];
+            stats->total_gpu_times [ phase ] += stats->gpu_times [ phase ];
+            stats->total_cpu_times [ phase ] += stats->cpu_times [ phase ];
+        }
+
+        /* release its queries and move onto the next draw */
+        glh_timer_pool_release ( mb_set->elapsed_pool, timer->elapsed_queries );
+        glh_timer_pool_release ( mb_set->timestamp_pool, timer->timestamp_queries );
+        mb_set->timer_head = ( mb_set->timer_head + 1 ) % MANDELBROT_TIMER_COUNT;
+        --mb_set->timer_pending;
+    }
+
+    /* read back the statistics of the last frame reduced, if finished */
+    return ( __mb_read_frame_stats ( mb_set, 0 ) < 0 ? -1 : 0 );
+}
+
+/* __mb_reduce_frame
+ *
+ * reduce the iterations of the complete frame to a histogram on the gpu, and begin reading it back without waiting
+ * each pixel is drawn as a point onto the cell of the histogram its iterations fall into, and additive blending sums the points,
+ * so the whole reduction is a single draw which needs neither atomics nor compute shaders
+ * the frame is skipped if the histogram of an earlier frame is still being read back
+ *
+ * mb_set: the mandelbrot set whose frame to reduce
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_reduce_frame ( mb_set_t mb_set )
+{
+    /* the iterations are the iterations buffer of a colour frame, or the red channel of a raw frame, and a colour frame without one cannot be reduced */
+    const glh_object_t iterations = ( mb_set->output == MANDELBROT_OUTPUT_RAW ? mb_set->frame_texture : mb_set->iterations_texture );
+    if ( iterations == -1 ) return 0;
+
+    /* if the histogram of an earlier frame is still being read back, skip this frame */
+    if ( __mb_read_frame_stats ( mb_set, 0 ) < 0 ) return -1;
+    if ( mb_set->histogram_fence ) return 0;
+    MB_TRACE_BEGIN ( "reduce" );
+
+    /* create the reduction the first time a frame is reduced, disabling statistics if it cannot be created */
+    if ( mb_set->reduce_sprogram == -1 )
+    {
+        if ( ( mb_set->reduce_vshader = glh_create_shader_from_path ( MANDELBROT_REDUCE_VERTEX_SHADER_PATH, GLH_GLSL_VERTEX_SHADER ) ) == -1 ||
+             ( mb_set->reduce_fshader = glh_create_shader_from_path ( MANDELBROT_REDUCE_FRAGMENT_SHADER_PATH, GLH_GLSL_FRAGMENT_SHADER ) ) == -1 ||
+             ( mb_set->reduce_sprogram = glh_create_shader_program ( mb_set->reduce_vshader, -1, mb_set->reduce_fshader ) ) == -1 ||
+             glh_use_shader_program ( mb_set->reduce_sprogram ) == -1 ||
+             glh_set_uniform_int ( glh_get_uniform_location ( mb_set->reduce_sprogram, "reduce_iterations" ), MANDELBROT_ITERATIONS_UNIT ) == -1 ||
+             ( mb_set->reduce_vao = glh_create_vertex_array_object () ) == -1 ||
+             ( mb_set->histogram_texture = glh_create_texture_2d ( MANDELBROT_HISTOGRAM_BINS, MANDELBROT_HISTOGRAM_ROWS, GLH_TEX_RGBA32F, GLH_TEX_FORMAT_RGBA, GLH_TYPE_FLOAT, GLH_TEX_FILTER_NEAREST ) ) == -1 ||
+             ( mb_set->histogram_fbo = glh_create_framebuffer_object ( mb_set->histogram_texture ) ) == -1 ||
+             ( mb_set->histogram_pbo = glh_create_pixel_pack_buffer_object ( ( size_t ) MANDELBROT_HISTOGRAM_BINS * MANDELBROT_HISTOGRAM_ROWS * 4 * sizeof ( float ) ) ) == -1 )
+        {
+            /* error creating the reduction, so leave the frame without statistics rather than failing the draw */
+            fprintf ( stderr, "MB ERROR: failed to set up frame statistics\n" );
+            if ( mb_set->reduce_vshader != -1 ) glh_delete_shader ( mb_set->reduce_vshader );
+            if ( mb_set->reduce_fshader != -1 ) glh_delete_shader ( mb_set->reduce_fshader );
+            if ( mb_set->reduce_sprogram != -1 ) glh_delete_shader_program ( mb_set->reduce_sprogram );
+            if ( mb_set->reduce_vao != -1 ) glh_delete_vertex_array_object ( mb_set->reduce_vao );
+            if ( mb_set->histogram_fbo != -1 ) glh_delete_framebuffer_object ( mb_set->histogram_fbo );
+            if ( mb_set->histogram_texture != -1 ) glh_delete_texture ( mb_set->histogram_texture );
+            if ( mb_set->histogram_pbo != -1 ) glh_delete_pixel_pack_buffer_object ( mb_set->histogram_pbo );
+            mb_set->reduce_vshader = mb_set->reduce_fshader = mb_set->reduce_sprogram = mb_set->reduce_vao = -1;
+            mb_set->histogram_fbo = mb_set->histogram_texture = mb_set->histogram_pbo = -1;
+            __atomic_store_n ( &mb_set->frame_stats_enabled, 0, __ATOMIC_RELEASE );
+            MB_TRACE_END ( "reduce" );
+            return -1;
+        }
+    }
+
+    /* find the rows to spread the frame over, disabling statistics if the frame is too large for its sums to be exact */
+    const int rows = __mb_histogram_rows ( mb_set->frame_width, mb_set->frame_height, mb_set->ubo_uniforms.max_it );
+    if ( rows == 0 )
+    {
+        fprintf ( stderr, "MB ERROR: frame is too large to reduce to statistics\n" );
+        __atomic_store_n ( &mb_set->frame_stats_enabled, 0, __ATOMIC_RELEASE );
+        MB_TRACE_END ( "reduce" );
+        return -1;
+    }
+
+    /* clear the rows of the histogram, and sum a point for every pixel of the frame into them */
+    glh_bind_framebuffer_object ( mb_set->histogram_fbo );
+    glh_set_viewport ( 0, 0, MANDELBROT_HISTOGRAM_BINS, rows );
+    glh_set_clear_color ( 0.0f, 0.0f, 0.0f, 0.0f );
+    glh_clear_screen ();
+    glh_use_shader_program ( mb_set->reduce_sprogram );
+    glh_set_uniform_int ( glh_get_uniform_location ( mb_set->reduce_sprogram, "reduce_max_it" ), mb_set->ubo_uniforms.max_it );
+    glh_set_uniform_int ( glh_get_uniform_location ( mb_set->reduce_sprogram, "reduce_rows" ), rows );
+    glh_bind_texture_2d_to_unit ( iterations, MANDELBROT_ITERATIONS_UNIT );
+    glh_enable_additive_blend ();
+    glh_draw_arrays ( mb_set->reduce_vao, GLH_DRAWMODE_POINTS, 0, ( size_t ) mb_set->frame_width * mb_set->frame_height );
+    glh_disable_blend ();
+
+    /* begin reading the histogram back, then fence the read */
+    const int status = ( glh_read_framebuffer_object_to_buffer ( mb_set->histogram_fbo, 0, 0, MANDELBROT_HISTOGRAM_BINS, rows, GLH_TEX_FORMAT_RGBA, GLH_TYPE_FLOAT, mb_set->histogram_pbo ) == 0 &&
+                         ( mb_set->histogram_fence = glh_create_fence () ) ? 0 : -1 );
+    mb_set->histogram_rows = rows;
+    mb_set->histogram_width = mb_set->frame_width;
+    mb_set->histogram_height = mb_set->frame_height;
+    mb_set->histogram_max_it = mb_set->ubo_uniforms.max_it;
+
+    /* restore the frame's program and viewport, so that rendering can continue */
+    glh_use_shader_program ( mb_set->sprogram );
+    glh_set_viewport ( 0, 0, mb_set->frame_width, mb_set->frame_height );
+    MB_TRACE_END ( "reduce" );
+
+    /* return the status */
+    return status;
+}
+
+/* __mb_histogram_rows
+ *
+ * find the number of rows of the histogram to spread a frame over, so that every sum a cell holds is of whole numbers below 2^24,
+ * and so is exact in a float, given that each pixel adds 1, the remainder modulo 256 of its offset into its bin, and the whole 256s of it
+ *
+ * width/height: the size of the frame
+ * max_it: the maximum iterations the frame was rendered with
+ *
+ * return: the number of rows, or 0 if even MANDELBROT_HISTOGRAM_ROWS is not enough
+ */
+int __mb_histogram_rows ( const int width, const int height, const int max_it )
+{
+    /* bound the whole 256s of iterations a pixel can be into its bin, as it is less than max_it / ( MANDELBROT_HISTOGRAM_BINS - 1 ) + 1 in,
+     * rounding up so that the bound is never 0
+     */
+    const long whole = ( max_it / ( MANDELBROT_HISTOGRAM_BINS - 1 ) + 1 ) / 256 + 1;
+
+    /* find the most pixels a cell can count, so that both the sum of the remainders, each at most 255, and the sum of the whole 256s stay below 2^24 */
+    const long cell_pixels = ( 65536 < 16777216 / whole ? 65536 : 16777216 / whole );
+
+    /* find the rows needed, as pixels are spread over the rows in turn, so no cell counts more than the pixels divided by the rows, rounded up */
+    const long rows = ( ( long ) width * height + cell_pixels - 1 ) / cell_pixels;
+
+    /* return the rows, or 0 if there are too many */
+    return ( rows > MANDELBROT_HISTOGRAM_ROWS ? 0 : ( rows < 1 ? 1 : ( int ) rows ) );
+}
+
+/* __mb_read_frame_stats
+ *
+ * read back the histogram of the last frame reduced, if finished, and sum it into the statistics of the frame
+ *
+ * mb_set: the mandelbrot set whose statistics to read
+ * wait: 1 to wait for the read to finish, 0 to return immediately if it has not
+ *
+ * return: 1 if statistics were read, 0 if none were ready, -1 for failure
+ */
+int __mb_read_frame_stats ( mb_set_t mb_set, const int wait )
+{
+    /* if no histogram is being read back, there is nothing to read */
+    if ( !mb_set->histogram_fence ) return 0;
+
+    /* check or wait for the read to complete */
+    const int signalled = glh_wait_fence ( mb_set->histogram_fence, ( wait ? UINT64_MAX : 0 ) );
+    if ( signalled != 1 ) return ( signalled == 0 ? 0 : -1 );
+    glh_delete_fence ( mb_set->histogram_fence );
+    mb_set->histogram_fence = NULL;
+
+    /* map the histogram */
+    const float * cells = glh_map_pixel_pack_buffer_object ( mb_set->histogram_pbo, ( size_t ) MANDELBROT_HISTOGRAM_BINS * mb_set->histogram_rows * 4 * sizeof ( float ) );
+    if ( !cells ) return -1;
+
+    /* sum the rows of each bin, adding the whole number of iterations the bin starts at back onto the iterations of each pixel counted,
+     * found without overflow as the reduce vertex shader finds it, and joining the two halves of the offsets
+     */
+    mb_frame_stats_t * stats = &mb_set->frame_stats;
+    memset ( stats->histogram, 0, sizeof ( stats->histogram ) );
+    stats->iterations = 0.0;
+    const int max_it = mb_set->histogram_max_it;
+    for ( int bin = 0; bin < MANDELBROT_HISTOGRAM_BINS; ++bin )
+    {
+        const double bin_start = ( bin == MANDELBROT_HISTOGRAM_BINS - 1 ? max_it :
+                                   bin * ( max_it / ( MANDELBROT_HISTOGRAM_BINS - 1 ) ) + bin * ( max_it % ( MANDELBROT_HISTOGRAM_BINS - 1 ) ) / ( MANDELBROT_HISTOGRAM_BINS - 1 ) );
+        for ( int row = 0; row < mb_set->histogram_rows; ++row )
+        {
+            const float * cell = &cells [ ( ( size_t ) row * MANDELBROT_HISTOGRAM_BINS + bin ) * 4 ];
+            stats->histogram [ bin ] += cell [ 0 ];
+            stats->iterations += cell [ 0 ] * bin_start + cell [ 1 ] + cell [ 2 ] * 256.0;
+        }
+    }
+    const int unmapped = glh_unmap_pixel_pack_buffer_object ( mb_set->histogram_pbo );
+
+    /* record the frame, and find how many of its pixels escaped and how many reached the maximum iterations */
+    ++stats->frames;
+    stats->width = mb_set->histogram_width;
+    stats->height = mb_set->histogram_height;
+    stats->max_it = mb_set->histogram_max_it;
+    stats->pixels = ( double ) stats->width * stats->height;
+    stats->bound = stats->histogram [ MANDELBROT_HISTOGRAM_BINS - 1 ];
+    stats->escaped = stats->pixels - stats->bound;
+
+    /* return 1, as statistics were read, unless their contents did not survive being mapped */
+    return ( unmapped == 0 ? 1 : -1 );
+}
+
+/* __mb_draw_hud
+ *
+ * draw the overlay over the window, if it is shown, creating it the first time and updating it at most every MANDELBROT_HUD_INTERVAL
+ * the window's framebuffer must be bound, and the frame presented into it
+ *
+ * mb_set: the mandelbrot set whose overlay to draw
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_draw_hud ( mb_set_t mb_set )
+{
+    /* if the overlay is hidden, there is nothing to draw */
+    if ( !__atomic_load_n ( &mb_set->hud_enabled, __ATOMIC_ACQUIRE ) ) return 0;
+    MB_TRACE_BEGIN ( "hud" );
+
+    /* create the overlay the first time it is shown, hiding it again, and disabling the statistics counted for it, if it cannot be created */
+    if ( !mb_set->hud && !( mb_set->hud = mb_hud_create ( MANDELBROT_HUD_VERTEX_SHADER_PATH, MANDELBROT_HUD_FRAGMENT_SHADER_PATH ) ) )
+    {
+        __atomic_store_n ( &mb_set->hud_enabled, 0, __ATOMIC_RELEASE );
+        __atomic_store_n ( &mb_set->frame_stats_enabled, 0, __ATOMIC_RELEASE );
+        MB_TRACE_END ( "hud" );
+        return -1;
+    }
+
+    /* update the overlay if it has not been updated recently */
+    const double time = glh_get_time ();
+    if ( time - mb_set->hud_update_time >= MANDELBROT_HUD_INTERVAL )
+    {
+        __mb_update_hud ( mb_set );
+        mb_set->hud_update_time = time;
+    }
+
+    /* draw the overlay over the whole window */
+    glh_set_viewport ( 0, 0, mb_set->frame_width, mb_set->frame_height );
+    mb_hud_draw ( mb_set->hud, mb_set->frame_width, mb_set->frame_height );
+    MB_TRACE_END ( "hud" );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_update_hud
+ *
+ * write the latest statistics of the set to the text of its overlay, and rebuild it
+ *
+ * mb_set: the mandelbrot set whose overlay to update
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_update_hud ( mb_set_t mb_set )
+{
+    /* get the statistics and the view being drawn */
+    const mb_stats_t * stats = &mb_set->stats;
+    mb_view_t view;
+    __mb_read_view ( mb_set, &view );
+
+    /* find the cpu and gpu time of the last draw read back, and the rate it iterated pixels at */
+    double cpu_time = 0.0, gpu_time = 0.0;
+    for ( int phase = 0; phase < MANDELBROT_PHASE_COUNT; ++phase )
+    {
+        cpu_time += stats->cpu_times [ phase ];
+        gpu_time += stats->gpu_times [ phase ];
+    }
+    const double iterate_time = stats->gpu_times [ MANDELBROT_PHASE_ITERATE ];
+    const double pixel_rate = ( iterate_time > 0.0 ? stats->pixels / iterate_time : 0.0 );
+
+    /* if the last frame reduced had the maximum iterations of the view, find the mean iterations of its pixels
+     * otherwise there are no statistics of the view yet, so the iterations per second assume every pixel ran to the maximum, and are an upper bound
+     */
+    const mb_frame_stats_t * frame_stats = &mb_set->frame_stats;
+    const int counted = ( frame_stats->frames > 0 && frame_stats->pixels > 0.0 && frame_stats->max_it == ( int ) view.max_it );
+    const double mean_it = ( counted ? frame_stats->iterations / frame_stats->pixels : view.max_it );
+
+    /* write each line */
+    char text [ 7 ] [ MB_HUD_COLUMNS + 1 ];
+    snprintf ( text [ 0 ], sizeof ( text [ 0 ] ), "frame     cpu %6.2f ms  gpu %6.2f ms", cpu_time * 1.0e3, gpu_time * 1.0e3 );
+    snprintf ( text [ 1 ], sizeof ( text [ 1 ] ), "iterate   %8.2f Mpix/s  %s %7.2f Git/s", pixel_rate * 1.0e-6, ( counted ? "  " : "<=" ), pixel_rate * mean_it * 1.0e-9 );
+    if ( mb_set->orbit_length > 0 ) snprintf ( text [ 2 ], sizeof ( text [ 2 ] ), "precision float, perturbed (orbit %d)", mb_set->orbit_length );
+    else snprintf ( text [ 2 ], sizeof ( text [ 2 ] ), "precision float" );
+    snprintf ( text [ 3 ], sizeof ( text [ 3 ] ), "max_it    %d", ( int ) view.max_it );
+    snprintf ( text [ 4 ], sizeof ( text [ 4 ] ), "zoom      %.3ex", ( view.re_min_range > 0.0f ? MBDEF_RE_MIN_RANGE / view.re_min_range : 0.0 ) );
+    snprintf ( text [ 5 ], sizeof ( text [ 5 ] ), "reuse     frames %3.0f%%  uniforms %3.0f%%",
+               ( stats->presents > 0 ? 100.0 * stats->repairs / stats->presents : 0.0 ),
+               ( stats->uniform_writes > 0 ? 100.0 * ( stats->uniform_writes - stats->uniform_uploads ) / stats->uniform_writes : 0.0 ) );
+    if ( counted ) snprintf ( text [ 6 ], sizeof ( text [ 6 ] ), "pixels    escaped %5.1f%%  bound %5.1f%%  %.0f it",
+                              100.0 * frame_stats->escaped / frame_stats->pixels, 100.0 * frame_stats->bound / frame_stats->pixels, mean_it );
+    else snprintf ( text [ 6 ], sizeof ( text [ 6 ] ), "pixels    not yet counted" );
+
+    /* rebuild the overlay */
+    const char * lines [ 7 ] = { text [ 0 ], text [ 1 ], text [ 2 ], text [ 3 ], text [ 4 ], text [ 5 ], text [ 6 ] };
+    return mb_hud_update ( mb_set->hud, lines, 7, MANDELBROT_HUD_TARGET );
+}
@@ -23,6 +23,15 @@
 /* include glhelper.h */
 #include <glhelper/glhelper.h>
 
+/* include mb_trace.h */
+#include <mb_trace/mb_trace.h>
+
+/* include mb_hud.h */
+#include <mb_hud/mb_hud.h>
+
+/* include mb_view.h */
+#include "mb_view.h"
+
 
 
 /* MACROS */
@@ -57,6 +66,163 @@
 #define MANDELBROT_FRAGMENT_SHADER_PATH MANDELBROT_SHADER_PATH "/mandelbrot_fragment.glsl"
 #endif
 
+/* MANDELBROT_HUD_VERTEX/FRAGMENT_SHADER_PATH
+ *
+ * defines the location of the vertex/fragment shaders of the overlay
+ * can be set during compilation using -DMANDELBROT_HUD_VERTEX/FRAGMENT_SHADER_PATH='"/path/file"'
+ */
+#ifndef MANDELBROT_HUD_VERTEX_SHADER_PATH
+#define MANDELBROT_HUD_VERTEX_SHADER_PATH MANDELBROT_SHADER_PATH "/hud_vertex.glsl"
+#endif
+#ifndef MANDELBROT_HUD_FRAGMENT_SHADER_PATH
+#define MANDELBROT_HUD_FRAGMENT_SHADER_PATH MANDELBROT_SHADER_PATH "/hud_fragment.glsl"
+#endif
+
+/* MANDELBROT_REDUCE_VERTEX/FRAGMENT_SHADER_PATH
+ *
+ * defines the location of the vertex/fragment shaders which reduce the iterations of a frame to statistics
+ * can be set during compilation using -DMANDELBROT_REDUCE_VERTEX/FRAGMENT_SHADER_PATH='"/path/file"'
+ */
+#ifndef MANDELBROT_REDUCE_VERTEX_SHADER_PATH
+#define MANDELBROT_REDUCE_VERTEX_SHADER_PATH MANDELBROT_SHADER_PATH "/reduce_vertex.glsl"
+#endif
+#ifndef MANDELBROT_REDUCE_FRAGMENT_SHADER_PATH
+#define MANDELBROT_REDUCE_FRAGMENT_SHADER_PATH MANDELBROT_SHADER_PATH "/reduce_fragment.glsl"
+#endif
+
+/* MANDELBROT_HUD_INTERVAL
+ *
+ * defines the least time in seconds between updates of the text and sparkline of the overlay
+ * can be set during compilation using -DMANDELBROT_HUD_INTERVAL=seconds
+ */
+#ifndef MANDELBROT_HUD_INTERVAL
+#define MANDELBROT_HUD_INTERVAL 0.25
+#endif
+
+/* MANDELBROT_HUD_TARGET
+ *
+ * defines the frame time in seconds the sparkline of the overlay marks
+ * can be set during compilation using -DMANDELBROT_HUD_TARGET=seconds
+ */
+#ifndef MANDELBROT_HUD_TARGET
+#define MANDELBROT_HUD_TARGET ( 1.0 / 60.0 )
+#endif
+
+/* MANDELBROT_TILE_SIZE
+ *
+ * defines the width and height in pixels of the tiles the set is rendered in
+ * can be set during compilation using -DMANDELBROT_TILE_SIZE=size
+ */
+#ifndef MANDELBROT_TILE_SIZE
+#define MANDELBROT_TILE_SIZE 128
+#endif
+
+/* MANDELBROT_TILE_BUDGET
+ *
+ * defines the gpu time in seconds that a single call to mb_draw should spend rendering tiles
+ * can be set during compilation using -DMANDELBROT_TILE_BUDGET=seconds
+ */
+#ifndef MANDELBROT_TILE_BUDGET
+#define MANDELBROT_TILE_BUDGET 0.008
+#endif
+
+/* MANDELBROT_PHASE_X
+ *
+ * the phases of a draw which are timed
+ * PREPARE is updating the uniforms and resizing the frame for the view
+ * ITERATE is rendering tiles, which both iterates and colours each pixel in a single pass
+ * PRESENT is blitting the frame to the window and swapping buffers
+ * COUNT is the number of phases
+ */
+#define MANDELBROT_PHASE_PREPARE 0
+#define MANDELBROT_PHASE_ITERATE 1
+#define MANDELBROT_PHASE_PRESENT 2
+#define MANDELBROT_PHASE_COUNT 3
+
+/* MANDELBROT_TIMER_COUNT
+ *
+ * defines the number of draws which may be being timed on the gpu at once
+ * each uses a timestamp at its start and end, and a timer query for each phase
+ */
+#define MANDELBROT_TIMER_COUNT 4
+
+/* MANDELBROT_READBACK_COUNT
+ *
+ * defines the number of frames which may be being read back from the gpu at once
+ * with 3, the cpu can consume frame N-2 while frames N-1 and N are still rendering and being read back
+ * can be set during compilation using -DMANDELBROT_READBACK_COUNT=count
+ */
+#ifndef MANDELBROT_READBACK_COUNT
+#define MANDELBROT_READBACK_COUNT 3
+#endif
+
+/* MANDELBROT_OUTPUT_X
+ *
+ * what the frame holds
+ * COLOUR is 8 bit RGBA colour, to be displayed or exported as an image
+ * RAW is 32 bit float RGBA holding the iterations completed, the final |z|^2, the distance estimate and a glitch flag of each pixel,
+ * to be recoloured or analysed later without iterating again
+ */
+#define MANDELBROT_OUTPUT_COLOUR 0
+#define MANDELBROT_OUTPUT_RAW 1
+
+/* MANDELBROT_MAPPING_X
+ *
+ * how fragments are mapped onto the plane
+ * LINEAR maps them onto the view, stretched and translated
+ * LOG_POLAR maps them onto a strip around the centre of the view, each column a step in the log of the distance from the centre
+ * and each row an angle, so that a whole zoom into the centre is held in a single image
+ */
+#define MANDELBROT_MAPPING_LINEAR 0
+#define MANDELBROT_MAPPING_LOG_POLAR 1
+
+/* MANDELBROT_ORBIT_WIDTH
+ *
+ * defines the width in texels of the texture holding the reference orbit, which has as many rows as the orbit needs
+ * can be set during compilation using -DMANDELBROT_ORBIT_WIDTH=width
+ */
+#ifndef MANDELBROT_ORBIT_WIDTH
+#define MANDELBROT_ORBIT_WIDTH 1024
+#endif
+
+/* MANDELBROT_ORBIT_UNIT
+ *
+ * defines the texture unit the reference orbit is bound to, which must not be the first
+ */
+#define MANDELBROT_ORBIT_UNIT 1
+
+/* MANDELBROT_ITERATIONS_UNIT
+ *
+ * defines the texture unit the iterations of a frame are bound to while they are reduced, which must not be the first,
+ * nor the unit of the reference orbit or the font of the overlay
+ */
+#define MANDELBROT_ITERATIONS_UNIT 3
+
+/* MANDELBROT_HISTOGRAM_BINS
+ *
+ * the number of bins in the histogram of the iterations of each frame
+ * the last bin counts the pixels which reached the maximum iterations, and the rest split the iterations below it evenly
+ * must match REDUCE_BINS in the reduce vertex shader
+ */
+#define MANDELBROT_HISTOGRAM_BINS 64
+
+/* MANDELBROT_HISTOGRAM_ROWS
+ *
+ * the most rows the histogram is spread over on the gpu, which are summed once read back
+ * each cell of the histogram is a float, so each frame is spread over enough rows that every sum a cell holds stays below 2^24,
+ * which __mb_histogram_rows finds, and statistics are disabled for a frame too large for that
+ * can be set during compilation using -DMANDELBROT_HISTOGRAM_ROWS=rows
+ */
+#ifndef MANDELBROT_HISTOGRAM_ROWS
+#define MANDELBROT_HISTOGRAM_ROWS 1024
+#endif
+
+/* MANDELBROT_UNIFORM_BINDING
+ *
+ * defines the uniform block binding point the mandelbrot parameters are bound to
+ */
+#define MANDELBROT_UNIFORM_BINDING 0
+
 /* MBDEF_...
  * 
  * default mandelbrot parameters
@@ -75,6 +241,138 @@
 
 /* STRUCTURES */
 
+/* struct mb_uniforms_t
+ *
+ * the values of the uniforms a frame is rendered with
+ * laid out to match the std140 uniform block mandelbrot_parameters in the fragment shader
+ */
+typedef struct
+{
+    /* stretch and translation from fragment coordinates to their offset from the centre of the view (vec4s) */
+    float stretch [ 4 ];
+    float translation [ 4 ];
+
+    /* rotation matrix turning the offsets about the centre of the view (mat2, with each column padded to a vec4) */
+    float rotation_matrix [ 8 ];
+
+    /* breakout point and maximum iterations */
+    float breakout;
+    int max_it;
+
+    /* power */
+    int power;
+
+    /* what the shader outputs (MANDELBROT_OUTPUT_X) */
+    int output;
+
+    /* how fragments are mapped onto the plane (MANDELBROT_MAPPING_X) */
+    int mapping;
+
+    /* if log-polar, the log of the distance from the centre at the left edge of the frame, the step in it and in the angle across each pixel,
+     * and the angle at the bottom edge of the frame, which pads to a multiple of the size of a vec4
+     */
+    float log_radius;
+    float log_step;
+    float angle;
+
+    /* the reference point when there is a reference orbit, otherwise 0, the centre of the view, which is an offset from the reference point,
+     * the number of points in the orbit, or 0 if there is none, and padding to a multiple of the size of a vec4
+     */
+    float reference [ 2 ];
+    float centre [ 2 ];
+    int orbit_length;
+    int padding [ 3 ];
+
+} mb_uniforms_t;
+
+/* struct mb_timer_t
+ *
+ * the timer queries timing a single draw, or batch of tiles when rendering headless
+ */
+typedef struct
+{
+    /* slots in the timestamp pool of the timestamps at the start and end of the draw, and slots in the elapsed pool of the time elapsed
+     * in each phase, or -1 for phases which were not timed
+     */
+    int start_slot;
+    int end_slot;
+    int phase_slots [ MANDELBROT_PHASE_COUNT ];
+
+    /* the number of queries handed out from the elapsed pool and the timestamp pool for the draw */
+    int elapsed_queries;
+    int timestamp_queries;
+
+    /* the pixels rendered by the draw */
+    int pixels;
+
+    /* the cpu time in seconds spent submitting each phase, or 0 if the cpu was not timed */
+    double cpu_times [ MANDELBROT_PHASE_COUNT ];
+
+} mb_timer_t;
+
+/* struct mb_stats_t
+ *
+ * timings of the draws of a set, read back from the gpu without stalling, so a few draws behind, and how often work was reused
+ */
+typedef struct
+{
+    /* the number of draws whose timings have been read back */
+    unsigned long draws;
+
+    /* the pixels rendered by the last draw read back */
+    int pixels;
+
+    /* the gpu time of each phase (MANDELBROT_PHASE_X) of the last draw read back, the gpu time from its start to its end, which
+     * includes any time the gpu sat idle waiting for commands, and the cpu time spent submitting each phase, all in seconds
+     */
+    double gpu_times [ MANDELBROT_PHASE_COUNT ];
+    double gpu_span;
+    double cpu_times [ MANDELBROT_PHASE_COUNT ];
+
+    /* the totals of the same over every draw read back */
+    double total_pixels;
+    double total_gpu_times [ MANDELBROT_PHASE_COUNT ];
+    double total_gpu_span;
+    double total_cpu_times [ MANDELBROT_PHASE_COUNT ];
+
+    /* the frames presented to the window, and how many of them repaired damage by presenting a complete frame again without rendering */
+    unsigned long presents;
+    unsigned long repairs;
+
+    /* the times the uniforms were written, and how many of them were uploaded, rather than skipped as unchanged */
+    unsigned long uniform_writes;
+    unsigned long uniform_uploads;
+
+} mb_stats_t;
+
+/* struct mb_frame_stats_t
+ *
+ * statistics of the iterations of every pixel of a complete frame, reduced on the gpu and read back without stalling
+ */
+typedef struct
+{
+    /* the number of frames reduced and read back so far, the last of which these are the statistics of, or 0 if none have been */
+    unsigned long frames;
+
+    /* the size of the frame, and the maximum iterations it was rendered with */
+    int width;
+    int height;
+    int max_it;
+
+    /* the pixels of the frame, how many of them escaped and how many reached the maximum iterations, and the iterations of every pixel summed */
+    double pixels;
+    double escaped;
+    double bound;
+    double iterations;
+
+    /* the number of pixels in each bin of the histogram
+     * bin b counts the pixels which escaped after at least b and fewer than b + 1 steps of max_it / ( MANDELBROT_HISTOGRAM_BINS - 1 ) iterations,
+     * except for the last, which counts the pixels which reached max_it
+     */
+    double histogram [ MANDELBROT_HISTOGRAM_BINS ];
+
+} mb_frame_stats_t;
+
 /* struct __mb_set_t
  *
  * structure to hold all the data needed to render a mandelbrot set
@@ -93,13 +391,9 @@ typedef struct
     glh_object_t fshader;
     glh_object_t sprogram;
 
-    /* uniforms */
-    glh_object_t uni_stretch;
-    glh_object_t uni_translation;
-    glh_object_t uni_breakout;
-    glh_object_t uni_max_it;
-    glh_object_t uni_power;
-    glh_object_t uni_rotation;
+    /* uniform buffer object holding the parameters, and the uniforms last written to it */
+    glh_object_t ubo;
+    mb_uniforms_t ubo_uniforms;
 
     /* MANDELBROT PARAMETERS */
 
@@ -122,13 +416,160 @@ typedef struct
     /* power */
     int power;
 
-    /* rotation (in degrees) */
+    /* rotation about the centre of the view (in radians) */
     float rotation;
 
-    /* OTHER ATTRIBUTES */
+    /* size of the viewport in pixels */
+    int width;
+    int height;
+
+    /* REFERENCE ORBIT */
+
+    /* texture holding the reference orbit, one point per texel, and the number of rows it has */
+    glh_object_t orbit_texture;
+    int orbit_rows;
+
+    /* the reference point, which the centre is an offset from while there is an orbit, and the number of points in the orbit, or 0 if none */
+    long double re_reference;
+    long double im_reference;
+    int orbit_length;
+
+    /* PUBLISHED VIEW */
+
+    /* generation of the published view
+     * incremented by mb_publish_view, and odd while a view is being published
+     */
+    unsigned long generation;
+
+    /* the most recently published view, which is what is rendered */
+    mb_view_t published_view;
+
+    /* TILED RENDERING */
+
+    /* texture and framebuffer the set is rendered into tile by tile */
+    glh_object_t frame_texture;
+    glh_object_t frame_fbo;
+
+    /* size of the frame, and what it holds (MANDELBROT_OUTPUT_X), which decides its format */
+    int frame_width;
+    int frame_height;
+    int output;
+
+    /* generation of the parameters the frame is being rendered with, and the number of its tiles rendered so far */
+    unsigned long frame_generation;
+    int frame_tiles_done;
+
+    /* estimated gpu time in seconds to render a single pixel, or 0 if not yet measured */
+    double pixel_time;
+
+    /* TIMING */
+
+    /* pools of timer queries timing elapsed time and recording timestamps, and a ring of the draws being timed with them, oldest first */
+    glh_timer_pool_t * elapsed_pool;
+    glh_timer_pool_t * timestamp_pool;
+    mb_timer_t timers [ MANDELBROT_TIMER_COUNT ];
+    int timer_head;
+    int timer_pending;
+
+    /* the draw currently being timed, or NULL if none is, whether the cpu is being timed too, and the cpu time its current phase began */
+    mb_timer_t * timer;
+    int timer_cpu;
+    double phase_start;
+
+    /* timings of the draws read back so far, only accessed by the thread rendering the set */
+    mb_stats_t stats;
+
+    /* OVERLAY */
+
+    /* the overlay drawn over the window, or NULL until it is first shown, 1 while it is shown, and the time it was last updated */
+    mb_hud_t * hud;
+    int hud_enabled;
+    double hud_update_time;
+
+    /* FRAME STATISTICS */
+
+    /* 1 while the iterations of each complete frame are reduced to statistics, and the texture the iterations of each pixel are rendered into
+     * alongside its colour, or -1 if the frame has none, as when statistics were disabled as it started or the output is raw, which holds the iterations already
+     */
+    int frame_stats_enabled;
+    glh_object_t iterations_texture;
+
+    /* shaders and shader program of the reduction, and an empty vao to draw its points from, or -1 until a frame is first reduced */
+    glh_object_t reduce_vshader;
+    glh_object_t reduce_fshader;
+    glh_object_t reduce_sprogram;
+    glh_object_t reduce_vao;
+
+    /* texture and framebuffer the histogram is summed into, and the pixel pack buffer it is read back into */
+    glh_object_t histogram_texture;
+    glh_object_t histogram_fbo;
+    glh_object_t histogram_pbo;
+
+    /* fence signalled once the histogram has been read back, or NULL if no read is pending, the rows it was spread over,
+     * and the size and maximum iterations of its frame
+     */
+    glh_sync_t histogram_fence;
+    int histogram_rows;
+    int histogram_width;
+    int histogram_height;
+    int histogram_max_it;
+
+    /* statistics of the last frame read back, only accessed by the thread rendering the set */
+    mb_frame_stats_t frame_stats;
+
+    /* ASYNCHRONOUS READBACK */
+
+    /* ring of pixel pack buffers which frames are read back into, and their allocated sizes */
+    glh_object_t readback_pbos [ MANDELBROT_READBACK_COUNT ];
+    size_t readback_sizes [ MANDELBROT_READBACK_COUNT ];
+
+    /* fences signalled once each read has completed */
+    glh_sync_t readback_fences [ MANDELBROT_READBACK_COUNT ];
+
+    /* size of each frame read back, the size of its pixels in bytes, and the tag it was queued with */
+    int readback_widths [ MANDELBROT_READBACK_COUNT ];
+    int readback_heights [ MANDELBROT_READBACK_COUNT ];
+    int readback_pixel_sizes [ MANDELBROT_READBACK_COUNT ];
+    unsigned long readback_tags [ MANDELBROT_READBACK_COUNT ];
+
+    /* oldest read in the ring, the number of reads in the ring, and whether the oldest is mapped */
+    int readback_head;
+    int readback_pending;
+    int readback_mapped;
+
+    /* RENDER THREAD */
+
+    /* the render thread, whether it is running, and the window it renders onto */
+    pthread_t render_thread;
+    int render_thread_running;
+    glh_window_t render_window;
+
+    /* mutex and condition used to wake the render thread when there is something to draw
+     * never held while rendering
+     */
+    pthread_mutex_t render_mutex;
+    pthread_cond_t render_cond;
 
-    /* locking to ensure not rendering conflict */
-    pthread_mutex_t draw_mutex;
+    /* set to 1 to stop the render thread */
+    int render_stop;
+
+    /* set to 1 when the window's contents have been damaged and the frame must be presented again */
+    int damaged;
+
+    /* generation of the last view whose frame the render thread completed, generation of the last view it failed to draw,
+     * and a condition signalled whenever a frame is completed or fails, all guarded by the render mutex
+     * a view which failed is not drawn again until a new view is published or the window is damaged
+     */
+    unsigned long complete_generation;
+    unsigned long failed_generation;
+    pthread_cond_t frame_cond;
+
+    /* FRAME TIMES */
+
+    /* if recording, the duration of each draw made by the render thread in seconds, the most which may be recorded, and the number recorded */
+    double * frame_times;
+    int frame_time_capacity;
+    int frame_time_count;
 
 } __mb_set_t;
 
@@ -177,14 +618,500 @@ int mb_destroy_set ( mb_set_t mb_set );
 /* mb_draw
  *
  * draws the mandelbrot set onto a window
+ * the set is rendered offscreen in tiles, and only as many tiles as fit in MANDELBROT_TILE_BUDGET are rendered per call
+ * the most recently published view is drawn, and rendering restarts if a new view has been published since the frame was started
+ * the frame is presented while it is being rendered, and once it is complete only when the window is damaged
  * 
  * mb_set: the mandelbrot set to draw
  * window: the window to draw onto
  * 
- * return: 0 for success, -1 for failure
+ * return: 1 if tiles remain to be rendered, 0 if the frame is complete, -1 for failure
  */
 int mb_draw ( mb_set_t mb_set, glh_window_t window );
 
+/* mb_render_frame
+ *
+ * renders the most recently published view of the set completely into the frame, using the context current on the calling thread
+ * needs no window, so can be used with headless contexts, and the frame may be any size the context supports
+ * the tiles are still rendered in batches of MANDELBROT_TILE_BUDGET, so that no single batch of commands runs for too long
+ *
+ * mb_set: the mandelbrot set to render
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_render_frame ( mb_set_t mb_set );
+
+/* mb_render_region
+ *
+ * renders a region of the most recently published view of the set, as if the view were a different size, completely into the frame
+ * uses the context current on the calling thread, and allows images far larger than the context supports to be rendered piece by piece
+ * the frame must then be restarted, so the next call to mb_draw or mb_render_frame renders the view again from scratch
+ *
+ * mb_set: the mandelbrot set to render
+ * image_width/height: the size to render the view at
+ * x/y: the bottom left pixel of the region, from the bottom left of the image
+ * width/height: the size of the region, which becomes the size of the frame
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_render_region ( mb_set_t mb_set, const int image_width, const int image_height, const int x, const int y, const int width, const int height );
+
+/* mb_render_log_polar
+ *
+ * renders a region of a log-polar strip around the centre of the most recently published view of the set, completely into the frame
+ * column x of the strip is log_step further in, in the log of the distance from the centre, than column x - 1, and row y is log_step
+ * further round, in radians, than row y - 1, so a strip 2pi / log_step high covers every angle
+ * uses the context current on the calling thread, and the frame must then be restarted, as with mb_render_region
+ *
+ * mb_set: the mandelbrot set to render
+ * log_radius: the log of the distance from the centre at the left edge of the strip
+ * log_step: the step in the log of the distance and in the angle across each pixel
+ * x/y: the bottom left pixel of the region, from the bottom left of the strip
+ * width/height: the size of the region, which becomes the size of the frame
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_render_log_polar ( mb_set_t mb_set, const double log_radius, const double log_step, const int x, const int y, const int width, const int height );
+
+/* mb_read_frame
+ *
+ * read the frame back into memory, waiting for it to finish rendering
+ * the frame is read as 8 bit RGBA, or 32 bit float RGBA if the output is raw, with the bottom row first
+ *
+ * mb_set: the mandelbrot set to read the frame of
+ * pixels: memory to read into, of at least frame_width * frame_height * 4 bytes, or 16 bytes per pixel if the output is raw
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_read_frame ( mb_set_t mb_set, unsigned char * pixels );
+
+/* mb_queue_readback
+ *
+ * begin reading the frame back into the next pixel pack buffer of the readback ring, without waiting for rendering to finish
+ * the frame should be complete, such as after mb_render_frame
+ * the frame can then be rendered again while it is read back
+ *
+ * mb_set: the mandelbrot set to read the frame of
+ * tag: a value to identify the frame by, such as its index, returned by mb_map_readback
+ *
+ * return: 0 for success, 1 if the ring is full and the oldest frame must be consumed first, -1 for failure
+ */
+int mb_queue_readback ( mb_set_t mb_set, const unsigned long tag );
+
+/* mb_map_readback
+ *
+ * map the oldest frame in the readback ring for reading
+ * the frame is 8 bit RGBA, or 32 bit float RGBA if the output was raw when it was queued, with the bottom row first,
+ * and must be unmapped with mb_unmap_readback once consumed
+ *
+ * mb_set: the mandelbrot set to map the frame of
+ * wait: 1 to wait for the read to complete, 0 to return immediately if it has not
+ * pixels: will be set to the pixels of the frame
+ * width/height: will be set to the size of the frame
+ * tag: will be set to the tag the frame was queued with
+ *
+ * return: 0 for success, 1 if no frame is ready, -1 for failure
+ */
+int mb_map_readback ( mb_set_t mb_set, const int wait, const unsigned char ** pixels, int * width, int * height, unsigned long * tag );
+
+/* mb_unmap_readback
+ *
+ * unmap the frame mapped by mb_map_readback, freeing its place in the readback ring
+ *
+ * mb_set: the mandelbrot set to unmap the frame of
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_unmap_readback ( mb_set_t mb_set );
+
+/* mb_set_output
+ *
+ * set what the frame holds, recreating the frame in the format for it and restarting it if the output changes
+ * uses the context current on the calling thread, so must not be called while the render thread is running
+ *
+ * mb_set: the mandelbrot set to set the output of
+ * output: what the frame should hold (MANDELBROT_OUTPUT_X)
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_set_output ( mb_set_t mb_set, const int output );
+
+/* mb_set_reference
+ *
+ * iterate a reference point at high precision, once, and upload its orbit for every following frame to perturb around
+ * while there is a reference, the centre of the set is an offset from the reference point, so views far deeper than a float
+ * can place are rendered by iterating only the small offset of each pixel, and views needing fewer iterations reuse the start of the orbit
+ * colour and raw output are both perturbed, for a power of 2, and the view still rotates about its centre, as it does without a reference
+ * uses the context current on the calling thread, so must not be called while the render thread is running
+ *
+ * mb_set: the mandelbrot set to set the reference of
+ * re/im_reference: the reference point, such as the target of a zoom
+ * max_it: the maximum iterations of the deepest view to be rendered
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_set_reference ( mb_set_t mb_set, const long double re_reference, const long double im_reference, const int max_it );
+
+/* mb_clear_reference
+ *
+ * stop perturbing around the reference orbit, so the centre of the set is once again a point on the plane
+ *
+ * mb_set: the mandelbrot set to clear the reference of
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_clear_reference ( mb_set_t mb_set );
+
+/* mb_publish_view
+ *
+ * publish the current parameters of the set as the view to render
+ * should be called whenever the parameters are changed
+ * does not block on rendering, and wakes the render thread if there is one
+ * also updates re/im_range to the ranges which will be visible with the current parameters
+ *
+ * mb_set: the mandelbrot set to publish the view of
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_publish_view ( mb_set_t mb_set );
+
+/* mb_mark_damaged
+ *
+ * mark the window the set is drawn onto as damaged, so that the frame is presented again
+ * does not block on rendering, and wakes the render thread if there is one
+ *
+ * mb_set: the mandelbrot set to mark as damaged
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_mark_damaged ( mb_set_t mb_set );
+
+/* mb_start_render_thread
+ *
+ * start a thread which owns the window's context and draws the set whenever a new view is published or the window is damaged
+ * the window's context is released from the calling thread, which must not use OpenGL until mb_stop_render_thread is called
+ *
+ * mb_set: the mandelbrot set to draw
+ * window: the window to draw onto, whose context must be current on the calling thread
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_start_render_thread ( mb_set_t mb_set, glh_window_t window );
+
+/* mb_stop_render_thread
+ *
+ * stop the render thread, if running, and make the window's context current on the calling thread again
+ *
+ * mb_set: the mandelbrot set being drawn
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_stop_render_thread ( mb_set_t mb_set );
+
+/* mb_record_frame_times
+ *
+ * start recording the duration of each draw made by the render thread, discarding any durations already recorded
+ * the durations are in frame_times, and frame_time_count of them have been recorded, which may be read once the render thread is stopped
+ * must not be called while the render thread is running
+ *
+ * mb_set: the mandelbrot set to record the frame times of
+ * capacity: the most durations to record, after which no more are recorded, or 0 to stop recording
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_record_frame_times ( mb_set_t mb_set, const int capacity );
+
+/* mb_wait_frame
+ *
+ * wait until the render thread has completed the frame of the most recently published view, or failed to draw it
+ *
+ * mb_set: the mandelbrot set to wait for
+ *
+ * return: 0 for success, -1 for failure, including if the render thread is not running or failed to draw the view
+ */
+int mb_wait_frame ( mb_set_t mb_set );
+
+/* mb_get_stats
+ *
+ * read back the timings of any draws the gpu has finished, without stalling, and get the timings of all draws read back so far
+ * must be called on the thread rendering the set, with its context current, or once the render thread has stopped
+ *
+ * mb_set: the mandelbrot set to get the timings of
+ * stats: will be set to the timings
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_get_stats ( mb_set_t mb_set, mb_stats_t * stats );
+
+/* mb_set_hud
+ *
+ * show or hide the overlay of performance statistics drawn over the window by mb_draw
+ * if the overlay cannot be created when it is first drawn, it is hidden again and frame statistics are disabled, as they are counted for it
+ * does not block on rendering, and wakes the render thread if there is one, so that the window is presented again
+ *
+ * mb_set: the mandelbrot set whose overlay to show or hide
+ * enabled: 1 to show the overlay, 0 to hide it
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_set_hud ( mb_set_t mb_set, const int enabled );
+
+/* mb_set_frame_stats
+ *
+ * enable or disable reducing the iterations of each complete frame to statistics on the gpu
+ * while enabled, a colour frame also renders the iterations of each pixel into a second colour buffer, which is only created as a frame
+ * is started, so the frame in progress is never restarted, and statistics are of the frames started after they are enabled
+ * does not block on rendering, and wakes the render thread if there is one
+ *
+ * mb_set: the mandelbrot set to enable or disable statistics of
+ * enabled: 1 to enable statistics, 0 to disable them
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_set_frame_stats ( mb_set_t mb_set, const int enabled );
+
+/* mb_get_frame_stats
+ *
+ * read back the statistics of the last frame reduced, if finished, and get the statistics of the last frame read back
+ * must be called on the thread rendering the set, with its context current, or once the render thread has stopped
+ *
+ * mb_set: the mandelbrot set to get the statistics of
+ * stats: will be set to the statistics, whose frames is 0 if no frame has been read back
+ * wait: 1 to wait for the last frame reduced to be read back, 0 to return immediately if it has not
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_get_frame_stats ( mb_set_t mb_set, mb_frame_stats_t * stats, const int wait );
+
+/* __mb_render_thread
+ *
+ * the function run by the render thread
+ *
+ * arg: the mandelbrot set to draw
+ *
+ * return: NULL
+ */
+void * __mb_render_thread ( void * arg );
+
+/* __mb_read_view
+ *
+ * read the most recently published view
+ * lock-free, retrying if the view is published while being read
+ *
+ * mb_set: the mandelbrot set to read the view of
+ * view: will be set to the view
+ *
+ * return: the generation of the view read
+ */
+unsigned long __mb_read_view ( mb_set_t mb_set, mb_view_t * view );
+
+/* __mb_view_stretch
+ *
+ * find the stretch from pixels to the complex plane for a view
+ * the stretch is such that at least the minimum ranges are visible
+ *
+ * view: the view to find the stretch of
+ *
+ * return: the stretch
+ */
+float __mb_view_stretch ( const mb_view_t * view );
+
+/* __mb_prepare_frame
+ *
+ * prepare to render tiles of the frame for a view, using the context current on the calling thread
+ * the shader program and uniform buffer object are bound, the frame is resized if necessary,
+ * and if the view differs from the one the frame was started with the frame is restarted
+ *
+ * mb_set: the mandelbrot set to prepare
+ * view: the view to render
+ * generation: the generation of the view
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_prepare_frame ( mb_set_t mb_set, const mb_view_t * view, const unsigned long generation );
+
+/* __mb_update_uniforms
+ *
+ * write the uniforms to render a view with to the uniform buffer object, if they have changed
+ * the uniforms can be offset so that fragment coordinate (0,0) is a pixel other than the bottom left of the view
+ *
+ * mb_set: the mandelbrot set to update the uniforms of
+ * view: the view to render
+ * x/y: the pixel of the view which fragment coordinate (0,0) should be, from the bottom left
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_update_uniforms ( mb_set_t mb_set, const mb_view_t * view, const int x, const int y );
+
+/* __mb_write_uniforms
+ *
+ * write uniforms to the uniform buffer object, if they have changed
+ *
+ * mb_set: the mandelbrot set to write the uniforms of
+ * uniforms: the uniforms to write
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_write_uniforms ( mb_set_t mb_set, const mb_uniforms_t * uniforms );
+
+/* __mb_render_tiles
+ *
+ * render the next tiles of a prepared frame, until a budget of pixels is used up
+ * always renders at least one tile, unless the frame is complete
+ *
+ * mb_set: the mandelbrot set to render the tiles of
+ * pixel_budget: the number of pixels to render
+ *
+ * return: 1 if tiles remain to be rendered, 0 if the frame is complete
+ */
+int __mb_render_tiles ( mb_set_t mb_set, const double pixel_budget );
+
+/* __mb_resize_frame
+ *
+ * recreate the texture and framebuffer the set is rendered into at a new size, in the format for its output
+ * the new frame is cleared to white and has no tiles rendered, and the viewport is set to cover it
+ * the new frame has no buffer for iterations until __mb_attach_iterations gives it one, as every caller does when the frame restarts
+ *
+ * mb_set: the mandelbrot set to resize the frame of
+ * width/height: the new size of the frame
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_resize_frame ( mb_set_t mb_set, const int width, const int height );
+
+/* __mb_attach_iterations
+ *
+ * give a colour frame a second colour buffer to render the iterations of each pixel into, if statistics are enabled and it has none
+ * must only be called as the frame is restarted, so that every pixel of a frame with the buffer has its iterations in it,
+ * and the buffer is kept until the frame is recreated, so that neither enabling nor disabling statistics restarts the frame
+ *
+ * mb_set: the mandelbrot set to attach the buffer to the frame of
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_attach_iterations ( mb_set_t mb_set );
+
+/* __mb_render_all_tiles
+ *
+ * render every remaining tile of a prepared frame, in batches of MANDELBROT_TILE_BUDGET, each timed on the gpu
+ *
+ * mb_set: the mandelbrot set to render the tiles of
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_render_all_tiles ( mb_set_t mb_set );
+
+/* __mb_begin_timing
+ *
+ * begin timing a draw, if there are enough free timer queries, otherwise the draw goes untimed
+ *
+ * mb_set: the mandelbrot set being drawn
+ * time_cpu: 1 to also time the cpu with glh_get_time, which requires glfw, or 0 to not
+ *
+ * return: 1 if the draw is being timed, 0 if not
+ */
+int __mb_begin_timing ( mb_set_t mb_set, const int time_cpu );
+
+/* __mb_begin_phase
+ *
+ * begin timing a phase of the draw being timed, if any
+ *
+ * mb_set: the mandelbrot set being drawn
+ * phase: the phase (MANDELBROT_PHASE_X)
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_begin_phase ( mb_set_t mb_set, const int phase );
+
+/* __mb_end_phase
+ *
+ * end timing a phase of the draw being timed, if any
+ *
+ * mb_set: the mandelbrot set being drawn
+ * phase: the phase (MANDELBROT_PHASE_X), which must be the phase last begun
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_end_phase ( mb_set_t mb_set, const int phase );
+
+/* __mb_end_timing
+ *
+ * end timing the draw being timed, if any
+ *
+ * mb_set: the mandelbrot set being drawn
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_end_timing ( mb_set_t mb_set );
+
+/* __mb_update_stats
+ *
+ * read back the timings of any draws the gpu has finished, without stalling, adding them to the statistics
+ * and updating the estimated time per pixel
+ *
+ * mb_set: the mandelbrot set to update
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_update_stats ( mb_set_t mb_set );
+
+/* __mb_reduce_frame
+ *
+ * reduce the iterations of the complete frame to a histogram on the gpu, and begin reading it back without waiting
+ * each pixel is drawn as a point onto the cell of the histogram its iterations fall into, and additive blending sums the points,
+ * so the whole reduction is a single draw which needs neither atomics nor compute shaders
+ * the frame is skipped if the histogram of an earlier frame is still being read back
+ *
+ * mb_set: the mandelbrot set whose frame to reduce
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_reduce_frame ( mb_set_t mb_set );
+
+/* __mb_histogram_rows
+ *
+ * find the number of rows of the histogram to spread a frame over, so that every sum a cell holds is of whole numbers below 2^24,
+ * and so is exact in a float, given that each pixel adds 1, the remainder modulo 256 of its offset into its bin, and the whole 256s of it
+ *
+ * width/height: the size of the frame
+ * max_it: the maximum iterations the frame was rendered with
+ *
+ * return: the number of rows, or 0 if even MANDELBROT_HISTOGRAM_ROWS is not enough
+ */
+int __mb_histogram_rows ( const int width, const int height, const int max_it );
+
+/* __mb_read_frame_stats
+ *
+ * read back the histogram of the last frame reduced, if finished, and sum it into the statistics of the frame
+ *
+ * mb_set: the mandelbrot set whose statistics to read
+ * wait: 1 to wait for the read to finish, 0 to return immediately if it has not
+ *
+ * return: 1 if statistics were read, 0 if none were ready, -1 for failure
+ */
+int __mb_read_frame_stats ( mb_set_t mb_set, const int wait );
+
+/* __mb_draw_hud
+ *
+ * draw the overlay over the window, if it is shown, creating it the first time and updating it at most every MANDELBROT_HUD_INTERVAL
+ * the window's framebuffer must be bound, and the frame presented into it
+ *
+ * mb_set: the mandelbrot set whose overlay to draw
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_draw_hud ( mb_set_t mb_set );
+
+/* __mb_update_hud
+ *
+ * write the latest statistics of the set to the text of its overlay, and rebuild it
+ *
+ * mb_set: the mandelbrot set whose overlay to update
+ *
+ * return: 0 for success, -1 for failure
+ */
+int __mb_update_hud ( mb_set_t mb_set );
+
 
 
 /* #ifndef MB_HANDLER_H_INCLUDED */
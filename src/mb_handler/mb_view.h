@@ -0,0 +1,57 @@
+/*
+ * mb_view.h
+ *
+ * defines a view of the set, on its own so that tools which read or write views without rendering them need no opengl
+ */
+
+
+
+/* pragma one */
+#ifndef MB_VIEW_H_INCLUDED
+#define MB_VIEW_H_INCLUDED
+
+
+
+/* STRUCTURES */
+
+/* struct mb_view_t
+ *
+ * a snapshot of the parameters which define a view of the set
+ * published by mb_publish_view for rendering
+ */
+typedef struct
+{
+    /* minimum ranges that should be visible on the real and imaginary axis */
+    float re_min_range;
+    float im_min_range;
+
+    /* centre of the screen, which is an offset from the reference point while there is one */
+    float re_centre;
+    float im_centre;
+
+    /* breakout point and maximum iterations */
+    float breakout;
+    float max_it;
+
+    /* power */
+    int power;
+
+    /* rotation about the centre of the view (in radians) */
+    float rotation;
+
+    /* size of the viewport in pixels */
+    int width;
+    int height;
+
+    /* the reference point while there is one, otherwise 0, each coordinate as the nearest double and the remainder of the long double
+     * it was set from, so that files recording the view place it exactly without depending on the layout of a long double
+     */
+    double re_reference [ 2 ];
+    double im_reference [ 2 ];
+
+} mb_view_t;
+
+
+
+/* #ifndef MB_VIEW_H_INCLUDED */
+#endif
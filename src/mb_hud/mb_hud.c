@@ -0,0 +1,372 @@
+/*
+ * mb_hud.c
+ *
+ * implementation of mb_hud.h
+ */
+
+
+
+/* include mb_hud.h */
+#include "mb_hud.h"
+
+
+
+/* FONT */
+
+/* the columns of each printable ascii character of a 5x7 font, from ' ' to '~', the lowest bit of each column being its top row */
+static const unsigned char __mb_hud_font [ MB_HUD_GLYPH_COUNT - 1 ] [ 5 ] =
+{
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, /* space */
+    { 0x00, 0x00, 0x5F, 0x00, 0x00 }, /* ! */
+    { 0x00, 0x07, 0x00, 0x07, 0x00 }, /* " */
+    { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, /* # */
+    { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, /* $ */
+    { 0x23, 0x13, 0x08, 0x64, 0x62 }, /* % */
+    { 0x36, 0x49, 0x56, 0x20, 0x50 }, /* & */
+    { 0x00, 0x08, 0x07, 0x03, 0x00 }, /* ' */
+    { 0x00, 0x1C, 0x22, 0x41, 0x00 }, /* ( */
+    { 0x00, 0x41, 0x22, 0x1C, 0x00 }, /* ) */
+    { 0x2A, 0x1C, 0x7F, 0x1C, 0x2A }, /* * */
+    { 0x08, 0x08, 0x3E, 0x08, 0x08 }, /* + */
+    { 0x00, 0x80, 0x70, 0x30, 0x00 }, /* , */
+    { 0x08, 0x08, 0x08, 0x08, 0x08 }, /* - */
+    { 0x00, 0x00, 0x60, 0x60, 0x00 }, /* . */
+    { 0x20, 0x10, 0x08, 0x04, 0x02 }, /* / */
+    { 0x3E, 0x51, 0x49, 0x45, 0x3E }, /* 0 */
+    { 0x00, 0x42, 0x7F, 0x40, 0x00 }, /* 1 */
+    { 0x72, 0x49, 0x49, 0x49, 0x46 }, /* 2 */
+    { 0x21, 0x41, 0x49, 0x4D, 0x33 }, /* 3 */
+    { 0x18, 0x14, 0x12, 0x7F, 0x10 }, /* 4 */
+    { 0x27, 0x45, 0x45, 0x45, 0x39 }, /* 5 */
+    { 0x3C, 0x4A, 0x49, 0x49, 0x31 }, /* 6 */
+    { 0x41, 0x21, 0x11, 0x09, 0x07 }, /* 7 */
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, /* 8 */
+    { 0x46, 0x49, 0x49, 0x29, 0x1E }, /* 9 */
+    { 0x00, 0x00, 0x14, 0x00, 0x00 }, /* : */
+    { 0x00, 0x40, 0x34, 0x00, 0x00 }, /* ; */
+    { 0x00, 0x08, 0x14, 0x22, 0x41 }, /* < */
+    { 0x14, 0x14, 0x14, 0x14, 0x14 }, /* = */
+    { 0x00, 0x41, 0x22, 0x14, 0x08 }, /* > */
+    { 0x02, 0x01, 0x59, 0x09, 0x06 }, /* ? */
+    { 0x3E, 0x41, 0x5D, 0x59, 0x4E }, /* @ */
+    { 0x7C, 0x12, 0x11, 0x12, 0x7C }, /* A */
+    { 0x7F, 0x49, 0x49, 0x49, 0x36 }, /* B */
+    { 0x3E, 0x41, 0x41, 0x41, 0x22 }, /* C */
+    { 0x7F, 0x41, 0x41, 0x41, 0x3E }, /* D */
+    { 0x7F, 0x49, 0x49, 0x49, 0x41 }, /* E */
+    { 0x7F, 0x09, 0x09, 0x09, 0x01 }, /* F */
+    { 0x3E, 0x41, 0x41, 0x51, 0x73 }, /* G */
+    { 0x7F, 0x08, 0x08, 0x08, 0x7F }, /* H */
+    { 0x00, 0x41, 0x7F, 0x41, 0x00 }, /* I */
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 }, /* J */
+    { 0x7F, 0x08, 0x14, 0x22, 0x41 }, /* K */
+    { 0x7F, 0x40, 0x40, 0x40, 0x40 }, /* L */
+    { 0x7F, 0x02, 0x1C, 0x02, 0x7F }, /* M */
+    { 0x7F, 0x04, 0x08, 0x10, 0x7F }, /* N */
+    { 0x3E, 0x41, 0x41, 0x41, 0x3E }, /* O */
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, /* P */
+    { 0x3E, 0x41, 0x51, 0x21, 0x5E }, /* Q */
+    { 0x7F, 0x09, 0x19, 0x29, 0x46 }, /* R */
+    { 0x26, 0x49, 0x49, 0x49, 0x32 }, /* S */
+    { 0x03, 0x01, 0x7F, 0x01, 0x03 }, /* T */
+    { 0x3F, 0x40, 0x40, 0x40, 0x3F }, /* U */
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F }, /* V */
+    { 0x3F, 0x40, 0x38, 0x40, 0x3F }, /* W */
+    { 0x63, 0x14, 0x08, 0x14, 0x63 }, /* X */
+    { 0x03, 0x04, 0x78, 0x04, 0x03 }, /* Y */
+    { 0x61, 0x59, 0x49, 0x4D, 0x43 }, /* Z */
+    { 0x00, 0x7F, 0x41, 0x41, 0x41 }, /* [ */
+    { 0x02, 0x04, 0x08, 0x10, 0x20 }, /* backslash */
+    { 0x00, 0x41, 0x41, 0x41, 0x7F }, /* ] */
+    { 0x04, 0x02, 0x01, 0x02, 0x04 }, /* ^ */
+    { 0x40, 0x40, 0x40, 0x40, 0x40 }, /* _ */
+    { 0x00, 0x03, 0x07, 0x08, 0x00 }, /* ` */
+    { 0x20, 0x54, 0x54, 0x78, 0x40 }, /* a */
+    { 0x7F, 0x28, 0x44, 0x44, 0x38 }, /* b */
+    { 0x38, 0x44, 0x44, 0x44, 0x28 }, /* c */
+    { 0x38, 0x44, 0x44, 0x28, 0x7F }, /* d */
+    { 0x38, 0x54, 0x54, 0x54, 0x18 }, /* e */
+    { 0x00, 0x08, 0x7E, 0x09, 0x02 }, /* f */
+    { 0x18, 0xA4, 0xA4, 0x9C, 0x78 }, /* g */
+    { 0x7F, 0x08, 0x04, 0x04, 0x78 }, /* h */
+    { 0x00, 0x44, 0x7D, 0x40, 0x00 }, /* i */
+    { 0x20, 0x40, 0x40, 0x3D, 0x00 }, /* j */
+    { 0x7F, 0x10, 0x28, 0x44, 0x00 }, /* k */
+    { 0x00, 0x41, 0x7F, 0x40, 0x00 }, /* l */
+    { 0x7C, 0x04, 0x78, 0x04, 0x78 }, /* m */
+    { 0x7C, 0x08, 0x04, 0x04, 0x78 }, /* n */
+    { 0x38, 0x44, 0x44, 0x44, 0x38 }, /* o */
+    { 0xFC, 0x18, 0x24, 0x24, 0x18 }, /* p */
+    { 0x18, 0x24, 0x24, 0x18, 0xFC }, /* q */
+    { 0x7C, 0x08, 0x04, 0x04, 0x08 }, /* r */
+    { 0x48, 0x54, 0x54, 0x54, 0x24 }, /* s */
+    { 0x04, 0x04, 0x3F, 0x44, 0x24 }, /* t */
+    { 0x3C, 0x40, 0x40, 0x20, 0x7C }, /* u */
+    { 0x1C, 0x20, 0x40, 0x20, 0x1C }, /* v */
+    { 0x3C, 0x40, 0x30, 0x40, 0x3C }, /* w */
+    { 0x44, 0x28, 0x10, 0x28, 0x44 }, /* x */
+    { 0x4C, 0x90, 0x90, 0x90, 0x7C }, /* y */
+    { 0x44, 0x64, 0x54, 0x4C, 0x44 }, /* z */
+    { 0x00, 0x08, 0x36, 0x41, 0x00 }, /* { */
+    { 0x00, 0x00, 0x77, 0x00, 0x00 }, /* | */
+    { 0x00, 0x41, 0x36, 0x08, 0x00 }, /* } */
+    { 0x02, 0x01, 0x02, 0x04, 0x02 }, /* ~ */
+};
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* mb_hud_create
+ *
+ * create an overlay, using the context current on the calling thread, which the overlay must always be drawn with
+ *
+ * vertex_path/fragment_path: the paths of the vertex and fragment shaders of the overlay
+ *
+ * return: the overlay, or NULL on failure
+ */
+mb_hud_t * mb_hud_create ( const char * vertex_path, const char * fragment_path )
+{
+    /* allocate the overlay, and set it to its empty state */
+    mb_hud_t * hud = malloc ( sizeof ( mb_hud_t ) );
+    if ( !hud )
+    {
+        /* failed to allocate */
+        fprintf ( stderr, "MB ERROR: failed to allocate overlay\n" );
+        return NULL;
+    }
+    memset ( hud, 0, sizeof ( mb_hud_t ) );
+    hud->vshader = -1;
+    hud->fshader = -1;
+    hud->sprogram = -1;
+    hud->vao = -1;
+    hud->vbo = -1;
+    hud->font_texture = -1;
+
+    /* set up shader program (first, as is most likely to fail), pointing the font sampler at its texture unit */
+    if ( ( hud->vshader = glh_create_shader_from_path ( vertex_path, GLH_GLSL_VERTEX_SHADER ) ) == -1 ||
+         ( hud->fshader = glh_create_shader_from_path ( fragment_path, GLH_GLSL_FRAGMENT_SHADER ) ) == -1 ||
+         ( hud->sprogram = glh_create_shader_program ( hud->vshader, -1, hud->fshader ) ) == -1 ||
+         ( glh_use_shader_program ( hud->sprogram ) ) == -1 ||
+         ( glh_set_uniform_int ( glh_get_uniform_location ( hud->sprogram, "hud_font" ), MB_HUD_FONT_UNIT ) ) == -1 ||
+         ( hud->viewport_uniform = glh_get_uniform_location ( hud->sprogram, "hud_viewport" ) ) == -1 )
+    {
+        /* error creating shader program */
+        fprintf ( stderr, "MB ERROR: failed to create overlay shader program\n" );
+        mb_hud_destroy ( hud );
+        return NULL;
+    }
+
+    /* set up the vertex array object, whose only attributes are the fields of each instance, advancing once per instance */
+    if ( ( hud->vao = glh_create_vertex_array_object () ) == -1 ||
+         ( hud->vbo = glh_create_vertex_buffer_object ( NULL, sizeof ( hud->instances ), GLH_BUFF_DYNAMIC_DRAW ) ) == -1 ||
+         ( glh_bind_vertex_buffer_object ( hud->vao, hud->vbo, 0, 4, GLH_TYPE_FLOAT, sizeof ( mb_hud_instance_t ), ( void * ) offsetof ( mb_hud_instance_t, rect ) ) ) == -1 ||
+         ( glh_bind_vertex_buffer_object ( hud->vao, hud->vbo, 1, 4, GLH_TYPE_FLOAT, sizeof ( mb_hud_instance_t ), ( void * ) offsetof ( mb_hud_instance_t, colour ) ) ) == -1 ||
+         ( glh_bind_vertex_buffer_object ( hud->vao, hud->vbo, 2, 1, GLH_TYPE_FLOAT, sizeof ( mb_hud_instance_t ), ( void * ) offsetof ( mb_hud_instance_t, glyph ) ) ) == -1 )
+    {
+        /* error creating vertex array object */
+        fprintf ( stderr, "MB ERROR: failed to set up overlay vertex array object\n" );
+        mb_hud_destroy ( hud );
+        return NULL;
+    }
+    for ( int i = 0; i < 3; ++i )
+    {
+        glh_enable_vertex_attribute ( hud->vao, i );
+        glh_set_vertex_attribute_divisor ( hud->vao, i, 1 );
+    }
+
+    /* bake the font into a single row of glyphs, top row first, and upload it */
+    const int font_width = MB_HUD_GLYPH_COUNT * MB_HUD_GLYPH_WIDTH;
+    unsigned char texels [ MB_HUD_GLYPH_COUNT * MB_HUD_GLYPH_WIDTH * MB_HUD_GLYPH_HEIGHT ] = { 0 };
+    for ( int glyph = 0; glyph < MB_HUD_GLYPH_COUNT; ++glyph )
+        for ( int row = 0; row < MB_HUD_GLYPH_HEIGHT; ++row )
+            for ( int column = 0; column < MB_HUD_GLYPH_WIDTH; ++column )
+            {
+                const int set = ( glyph == MB_HUD_GLYPH_SOLID ? 1 : ( column < 5 && ( __mb_hud_font [ glyph ] [ column ] >> row ) & 1 ) );
+                texels [ row * font_width + glyph * MB_HUD_GLYPH_WIDTH + column ] = ( set ? 255 : 0 );
+            }
+    if ( ( hud->font_texture = glh_create_texture_2d ( font_width, MB_HUD_GLYPH_HEIGHT, GLH_TEX_R8, GLH_TEX_FORMAT_RED, GLH_TYPE_UNSIGNED_BYTE, GLH_TEX_FILTER_NEAREST ) ) == -1 ||
+         ( glh_update_texture_2d ( hud->font_texture, 0, 0, font_width, MB_HUD_GLYPH_HEIGHT, GLH_TEX_FORMAT_RED, GLH_TYPE_UNSIGNED_BYTE, texels ) ) == -1 )
+    {
+        /* error creating font */
+        fprintf ( stderr, "MB ERROR: failed to create overlay font\n" );
+        mb_hud_destroy ( hud );
+        return NULL;
+    }
+
+    /* return the overlay */
+    return hud;
+}
+
+/* mb_hud_destroy
+ *
+ * destroy an overlay
+ *
+ * hud: the overlay to destroy
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_hud_destroy ( mb_hud_t * hud )
+{
+    /* if changed from empty, destroy attributes */
+    if ( hud->vao != -1 ) glh_delete_vertex_array_object ( hud->vao );
+    if ( hud->vbo != -1 ) glh_delete_vertex_buffer_object ( hud->vbo );
+
+    if ( hud->vshader != -1 ) glh_delete_shader ( hud->vshader );
+    if ( hud->fshader != -1 ) glh_delete_shader ( hud->fshader );
+    if ( hud->sprogram != -1 ) glh_delete_shader_program ( hud->sprogram );
+
+    if ( hud->font_texture != -1 ) glh_delete_texture ( hud->font_texture );
+
+    /* free the overlay */
+    free ( hud );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_hud_add_sample
+ *
+ * record a frame time, which is shown by the sparkline once the overlay is next updated
+ * does not touch opengl, so is cheap enough to call every frame
+ *
+ * hud: the overlay to record to
+ * seconds: the frame time
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_hud_add_sample ( mb_hud_t * hud, const double seconds )
+{
+    /* record the sample, overwriting the oldest once the ring is full */
+    hud->samples [ hud->sample_head ] = seconds;
+    hud->sample_head = ( hud->sample_head + 1 ) % MB_HUD_SAMPLES;
+    if ( hud->sample_count < MB_HUD_SAMPLES ) ++hud->sample_count;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_hud_update
+ *
+ * rebuild the instances of an overlay from lines of text and the frame times recorded, and upload them
+ * lines are clipped to MB_HUD_COLUMNS characters, and characters the font lacks are shown as '?'
+ *
+ * hud: the overlay to update
+ * lines: the lines of text
+ * line_count: the number of lines, at most MB_HUD_LINES
+ * target: the frame time in seconds the sparkline marks, and colours bars by
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_hud_update ( mb_hud_t * hud, const char * const * lines, const int line_count, const double target )
+{
+    /* find the size of a texel, the margin around the panel and the padding inside it */
+    const float texel = MB_HUD_SCALE;
+    const float margin = 4 * texel;
+    const float padding = 3 * texel;
+
+    /* find the size of the text and the sparkline, each bar of which is two texels wide */
+    const int lines_shown = ( line_count < MB_HUD_LINES ? line_count : MB_HUD_LINES );
+    int columns = 0;
+    for ( int i = 0; i < lines_shown; ++i ) if ( ( int ) strlen ( lines [ i ] ) > columns ) columns = strlen ( lines [ i ] );
+    if ( columns > MB_HUD_COLUMNS ) columns = MB_HUD_COLUMNS;
+    const float text_width = columns * MB_HUD_GLYPH_WIDTH * texel;
+    const float text_height = lines_shown * MB_HUD_LINE_HEIGHT * texel;
+    const float bar_width = 2 * texel;
+    const float sparkline_width = MB_HUD_SAMPLES * bar_width;
+    const float sparkline_height = MB_HUD_SPARKLINE_HEIGHT * texel;
+
+    /* start with the panel behind everything else */
+    hud->instance_count = 0;
+    __mb_hud_add_quad ( hud, margin, margin, ( text_width > sparkline_width ? text_width : sparkline_width ) + 2 * padding, text_height + sparkline_height + 3 * padding,
+                        MB_HUD_GLYPH_SOLID, 0.0f, 0.0f, 0.0f, 0.6f );
+
+    /* add each character of each line, skipping spaces */
+    for ( int i = 0; i < lines_shown; ++i )
+        for ( int j = 0; j < columns && lines [ i ] [ j ]; ++j )
+        {
+            const int c = ( unsigned char ) lines [ i ] [ j ];
+            if ( c == ' ' ) continue;
+            __mb_hud_add_quad ( hud, margin + padding + j * MB_HUD_GLYPH_WIDTH * texel, margin + padding + i * MB_HUD_LINE_HEIGHT * texel,
+                                MB_HUD_GLYPH_WIDTH * texel, MB_HUD_GLYPH_HEIGHT * texel, ( c > ' ' && c <= '~' ? c - ' ' : '?' - ' ' ), 1.0f, 1.0f, 1.0f, 1.0f );
+        }
+
+    /* add a bar for each frame time, oldest first, scaled so that the target is half the height of the sparkline
+     * bars within the target are green, within twice the target amber, and otherwise red
+     */
+    const float sparkline_x = margin + padding;
+    const float sparkline_bottom = margin + 2 * padding + text_height + sparkline_height;
+    for ( int i = 0; i < hud->sample_count; ++i )
+    {
+        const double sample = hud->samples [ ( hud->sample_head - hud->sample_count + i + MB_HUD_SAMPLES ) % MB_HUD_SAMPLES ];
+        const double fraction = ( target > 0.0 ? sample / ( 2.0 * target ) : 0.0 );
+        const float height = ( fraction < 1.0 ? fraction : 1.0 ) * sparkline_height;
+        if ( sample <= target ) __mb_hud_add_quad ( hud, sparkline_x + i * bar_width, sparkline_bottom - height, bar_width, height, MB_HUD_GLYPH_SOLID, 0.3f, 0.9f, 0.3f, 0.9f );
+        else if ( sample <= 2.0 * target ) __mb_hud_add_quad ( hud, sparkline_x + i * bar_width, sparkline_bottom - height, bar_width, height, MB_HUD_GLYPH_SOLID, 1.0f, 0.7f, 0.2f, 0.9f );
+        else __mb_hud_add_quad ( hud, sparkline_x + i * bar_width, sparkline_bottom - height, bar_width, height, MB_HUD_GLYPH_SOLID, 1.0f, 0.3f, 0.3f, 0.9f );
+    }
+
+    /* mark the target across the sparkline */
+    __mb_hud_add_quad ( hud, sparkline_x, sparkline_bottom - sparkline_height / 2, sparkline_width, texel / 2, MB_HUD_GLYPH_SOLID, 1.0f, 1.0f, 1.0f, 0.5f );
+
+    /* upload the instances in a single update */
+    return glh_update_vertex_buffer_object ( hud->vbo, 0, hud->instances, hud->instance_count * sizeof ( mb_hud_instance_t ) );
+}
+
+/* mb_hud_draw
+ *
+ * draw an overlay over the top left of the bound framebuffer, as last updated, in a single instanced draw
+ * the viewport must cover the framebuffer, and the overlay's shader program is left in use
+ *
+ * hud: the overlay to draw
+ * width/height: the size of the viewport in pixels
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_hud_draw ( mb_hud_t * hud, const int width, const int height )
+{
+    /* if there is nothing to draw, return */
+    if ( hud->instance_count == 0 ) return 0;
+
+    /* use the shader program, set the size of the viewport and bind the font */
+    glh_use_shader_program ( hud->sprogram );
+    glh_set_uniform_vec2 ( hud->viewport_uniform, width, height );
+    glh_bind_texture_2d_to_unit ( hud->font_texture, MB_HUD_FONT_UNIT );
+
+    /* draw every quad as an instance of a strip of two triangles, blended over the framebuffer */
+    glh_enable_blend ();
+    glh_draw_arrays_instanced ( hud->vao, GLH_DRAWMODE_TRIANGLE_STRIP, 0, 4, hud->instance_count );
+    glh_disable_blend ();
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_hud_add_quad
+ *
+ * add a quad to the instances of an overlay, if there is room
+ *
+ * hud: the overlay to add to
+ * x/y: the top left of the quad in pixels
+ * width/height: the size of the quad in pixels
+ * glyph: the glyph the quad shows
+ * r/g/b/a: the colour of the quad
+ */
+void __mb_hud_add_quad ( mb_hud_t * hud, const float x, const float y, const float width, const float height, const int glyph,
+                         const float r, const float g, const float b, const float a )
+{
+    /* if there is no room, drop the quad */
+    if ( hud->instance_count >= MB_HUD_INSTANCES ) return;
+
+    /* add the quad */
+    mb_hud_instance_t * instance = &hud->instances [ hud->instance_count++ ];
+    instance->rect [ 0 ] = x;
+    instance->rect [ 1 ] = y;
+    instance->rect [ 2 ] = width;
+    instance->rect [ 3 ] = height;
+    instance->colour [ 0 ] = r;
+    instance->colour [ 1 ] = g;
+    instance->colour [ 2 ] = b;
+    instance->colour [ 3 ] = a;
+    instance->glyph = glyph;
+}
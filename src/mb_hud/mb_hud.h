@@ -0,0 +1,220 @@
+/*
+ * mb_hud.h
+ *
+ * an overlay of text and a sparkline drawn over a window, to show performance state without attaching any tools
+ * the text is drawn from a 5x7 bitmap font baked into a single texture, and every character, bar and the panel behind them
+ * is an instance of one quad, so the whole overlay is a single instanced draw
+ * the instances are only rebuilt and uploaded when the overlay is updated, so drawing it again costs one draw call
+ */
+
+
+
+/* pragma one */
+#ifndef MB_HUD_H_INCLUDED
+#define MB_HUD_H_INCLUDED
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stddef.h>
+
+/* include glhelper.h */
+#include <glhelper/glhelper.h>
+
+
+
+/* MACROS */
+
+/* MB_HUD_LINES/COLUMNS
+ *
+ * defines the most lines of text the overlay shows, and the most characters on each
+ */
+#define MB_HUD_LINES 8
+#define MB_HUD_COLUMNS 48
+
+/* MB_HUD_SAMPLES
+ *
+ * defines the number of frame times the sparkline shows, one bar each, newest on the right
+ * can be set during compilation using -DMB_HUD_SAMPLES=samples
+ */
+#ifndef MB_HUD_SAMPLES
+#define MB_HUD_SAMPLES 120
+#endif
+
+/* MB_HUD_SCALE
+ *
+ * defines the size in pixels of each texel of the font
+ * can be set during compilation using -DMB_HUD_SCALE=scale
+ */
+#ifndef MB_HUD_SCALE
+#define MB_HUD_SCALE 2
+#endif
+
+/* MB_HUD_FONT_UNIT
+ *
+ * defines the texture unit the font is bound to, which must not be the first, or any other unit in use while the overlay is drawn
+ */
+#define MB_HUD_FONT_UNIT 2
+
+/* MB_HUD_GLYPH_WIDTH/HEIGHT/COUNT
+ *
+ * the size in texels of each glyph of the font, including a column of spacing, and the number of glyphs
+ * glyphs are the printable ascii characters from ' ' to '~', then MB_HUD_GLYPH_SOLID, which is solid
+ */
+#define MB_HUD_GLYPH_WIDTH 6
+#define MB_HUD_GLYPH_HEIGHT 8
+#define MB_HUD_GLYPH_COUNT 96
+#define MB_HUD_GLYPH_SOLID 95
+
+/* MB_HUD_LINE_HEIGHT
+ *
+ * the height in texels of each line of text, including spacing
+ */
+#define MB_HUD_LINE_HEIGHT 10
+
+/* MB_HUD_SPARKLINE_HEIGHT
+ *
+ * the height in texels of the sparkline below the text
+ */
+#define MB_HUD_SPARKLINE_HEIGHT 24
+
+/* MB_HUD_INSTANCES
+ *
+ * the most quads the overlay can hold: a panel, a character for every cell of text, and a bar and target line for the sparkline
+ */
+#define MB_HUD_INSTANCES ( 1 + MB_HUD_LINES * MB_HUD_COLUMNS + MB_HUD_SAMPLES + 1 )
+
+
+
+/* STRUCTURES */
+
+/* struct mb_hud_instance_t
+ *
+ * a single quad of the overlay, as read by the vertex shader
+ */
+typedef struct
+{
+    /* the left, top, width and height of the quad in pixels, from the top left of the window */
+    float rect [ 4 ];
+
+    /* the colour of the quad, whose alpha is multiplied by the glyph */
+    float colour [ 4 ];
+
+    /* the glyph of the font the quad shows */
+    float glyph;
+
+} mb_hud_instance_t;
+
+/* struct mb_hud_t
+ *
+ * an overlay, and the opengl objects to draw it with
+ */
+typedef struct
+{
+    /* shaders and shader program, and the location of the uniform holding the size of the viewport */
+    glh_object_t vshader;
+    glh_object_t fshader;
+    glh_object_t sprogram;
+    glh_object_t viewport_uniform;
+
+    /* vao, and the vbo holding the instances */
+    glh_object_t vao;
+    glh_object_t vbo;
+
+    /* texture holding the font, every glyph side by side */
+    glh_object_t font_texture;
+
+    /* the instances last uploaded, and the number of them */
+    mb_hud_instance_t instances [ MB_HUD_INSTANCES ];
+    int instance_count;
+
+    /* ring of the most recent frame times in seconds, the slot the next is recorded in, and the number recorded */
+    double samples [ MB_HUD_SAMPLES ];
+    int sample_head;
+    int sample_count;
+
+} mb_hud_t;
+
+
+
+/* FUNCTIONS */
+
+/* mb_hud_create
+ *
+ * create an overlay, using the context current on the calling thread, which the overlay must always be drawn with
+ *
+ * vertex_path/fragment_path: the paths of the vertex and fragment shaders of the overlay
+ *
+ * return: the overlay, or NULL on failure
+ */
+mb_hud_t * mb_hud_create ( const char * vertex_path, const char * fragment_path );
+
+/* mb_hud_destroy
+ *
+ * destroy an overlay
+ *
+ * hud: the overlay to destroy
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_hud_destroy ( mb_hud_t * hud );
+
+/* mb_hud_add_sample
+ *
+ * record a frame time, which is shown by the sparkline once the overlay is next updated
+ * does not touch opengl, so is cheap enough to call every frame
+ *
+ * hud: the overlay to record to
+ * seconds: the frame time
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_hud_add_sample ( mb_hud_t * hud, const double seconds );
+
+/* mb_hud_update
+ *
+ * rebuild the instances of an overlay from lines of text and the frame times recorded, and upload them
+ * lines are clipped to MB_HUD_COLUMNS characters, and characters the font lacks are shown as '?'
+ *
+ * hud: the overlay to update
+ * lines: the lines of text
+ * line_count: the number of lines, at most MB_HUD_LINES
+ * target: the frame time in seconds the sparkline marks, and colours bars by
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_hud_update ( mb_hud_t * hud, const char * const * lines, const int line_count, const double target );
+
+/* mb_hud_draw
+ *
+ * draw an overlay over the top left of the bound framebuffer, as last updated, in a single instanced draw
+ * the viewport must cover the framebuffer, and the overlay's shader program is left in use
+ *
+ * hud: the overlay to draw
+ * width/height: the size of the viewport in pixels
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_hud_draw ( mb_hud_t * hud, const int width, const int height );
+
+/* __mb_hud_add_quad
+ *
+ * add a quad to the instances of an overlay, if there is room
+ *
+ * hud: the overlay to add to
+ * x/y: the top left of the quad in pixels
+ * width/height: the size of the quad in pixels
+ * glyph: the glyph the quad shows
+ * r/g/b/a: the colour of the quad
+ */
+void __mb_hud_add_quad ( mb_hud_t * hud, const float x, const float y, const float width, const float height, const int glyph,
+                         const float r, const float g, const float b, const float a );
+
+
+
+/* #ifndef MB_HUD_H_INCLUDED */
+#endif
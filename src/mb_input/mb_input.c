@@ -0,0 +1,172 @@
+/*
+ * mb_input.c
+ *
+ * implementation of mb_input.h
+ */
+
+
+
+/* include mb_input.h */
+#include "mb_input.h"
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* mb_input_open_record
+ *
+ * create an input log to record events to, writing its header
+ * glfw must be initialised, as events are timed with glh_get_time
+ *
+ * path: the file to write the log to
+ * width/height: the size of the framebuffer of the window when recording starts
+ *
+ * return: the log, or NULL on failure
+ */
+mb_input_log_t * mb_input_open_record ( const char * path, const int width, const int height )
+{
+    /* allocate the log and open the file */
+    mb_input_log_t * log = malloc ( sizeof ( mb_input_log_t ) );
+    FILE * file = fopen ( path, "wb" );
+    if ( !log || !file )
+    {
+        /* failed to open */
+        fprintf ( stderr, "MB ERROR: failed to open input log %s for recording\n", path );
+        if ( file ) fclose ( file );
+        free ( log );
+        return NULL;
+    }
+    log->file = file;
+
+    /* write the header */
+    memset ( &log->header, 0, sizeof ( mb_input_header_t ) );
+    memcpy ( log->header.magic, MB_INPUT_MAGIC, sizeof ( log->header.magic ) );
+    log->header.width = width;
+    log->header.height = height;
+    if ( fwrite ( &log->header, sizeof ( mb_input_header_t ), 1, file ) != 1 )
+    {
+        /* failed to write */
+        fprintf ( stderr, "MB ERROR: failed to write input log header\n" );
+        fclose ( file );
+        free ( log );
+        return NULL;
+    }
+
+    /* start the clock, and return the log */
+    log->start_time = glh_get_time ();
+    return log;
+}
+
+/* mb_input_record
+ *
+ * record an event to a log, setting its time to the seconds since recording started
+ *
+ * log: the log to record to
+ * event: the event to record, whose time will be set
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_input_record ( mb_input_log_t * log, mb_input_event_t * event )
+{
+    /* time the event and write it */
+    event->time = glh_get_time () - log->start_time;
+    event->padding = 0;
+    if ( fwrite ( event, sizeof ( mb_input_event_t ), 1, log->file ) != 1 )
+    {
+        /* failed to write */
+        fprintf ( stderr, "MB ERROR: failed to record input event\n" );
+        return -1;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_input_open_replay
+ *
+ * open an input log to replay, reading and checking its header
+ *
+ * path: the file to read the log from
+ *
+ * return: the log, or NULL on failure
+ */
+mb_input_log_t * mb_input_open_replay ( const char * path )
+{
+    /* allocate the log and open the file */
+    mb_input_log_t * log = malloc ( sizeof ( mb_input_log_t ) );
+    FILE * file = fopen ( path, "rb" );
+    if ( !log || !file )
+    {
+        /* failed to open */
+        fprintf ( stderr, "MB ERROR: failed to open input log %s for replaying\n", path );
+        if ( file ) fclose ( file );
+        free ( log );
+        return NULL;
+    }
+    log->file = file;
+    log->start_time = 0.0;
+
+    /* read and check the header */
+    if ( fread ( &log->header, sizeof ( mb_input_header_t ), 1, file ) != 1 || memcmp ( log->header.magic, MB_INPUT_MAGIC, sizeof ( log->header.magic ) ) != 0 ||
+         log->header.width < 0 || log->header.height < 0 )
+    {
+        /* not an input log */
+        fprintf ( stderr, "MB ERROR: %s is not an input log\n", path );
+        fclose ( file );
+        free ( log );
+        return NULL;
+    }
+
+    /* return the log */
+    return log;
+}
+
+/* mb_input_read
+ *
+ * read the next event of a log being replayed
+ *
+ * log: the log to read from
+ * event: will be set to the event
+ *
+ * return: 1 if an event was read, 0 at the end of the log, -1 for failure
+ */
+int mb_input_read ( mb_input_log_t * log, mb_input_event_t * event )
+{
+    /* read the event, returning 0 if the log ended cleanly after the last */
+    if ( fread ( event, sizeof ( mb_input_event_t ), 1, log->file ) != 1 )
+    {
+        if ( feof ( log->file ) ) return 0;
+        fprintf ( stderr, "MB ERROR: failed to read input event\n" );
+        return -1;
+    }
+
+    /* check the type, as the rest of the event is only meaningful for its type */
+    if ( event->type < MB_INPUT_KEY || event->type > MB_INPUT_APPLY )
+    {
+        /* unknown event */
+        fprintf ( stderr, "MB ERROR: unknown input event type %d\n", ( int ) event->type );
+        return -1;
+    }
+
+    /* return 1, as an event was read */
+    return 1;
+}
+
+/* mb_input_close
+ *
+ * close an input log, flushing any recorded events
+ *
+ * log: the log to close
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_input_close ( mb_input_log_t * log )
+{
+    /* close the file and free the log */
+    const int status = ( fclose ( log->file ) == 0 ? 0 : -1 );
+    if ( status != 0 ) fprintf ( stderr, "MB ERROR: failed to close input log\n" );
+    free ( log );
+
+    /* return the status */
+    return status;
+}
@@ -0,0 +1,183 @@
+/*
+ * mb_input.h
+ *
+ * records the input given to a window to a compact binary log, and reads it back to replay it
+ * each event is a fixed size record holding when it occured, relative to the start of the recording, and the arguments it was given with,
+ * so that replaying the log drives the same callbacks with the same arguments, and interactive performance can be reproduced and measured
+ * logs are written in the byte order of the machine recording them, and are only replayed on machines of the same byte order
+ */
+
+
+
+/* pragma one */
+#ifndef MB_INPUT_H_INCLUDED
+#define MB_INPUT_H_INCLUDED
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+
+/* include glhelper.h */
+#include <glhelper/glhelper.h>
+
+
+
+/* MACROS */
+
+/* MB_INPUT_MAGIC
+ *
+ * the bytes every input log starts with
+ */
+#define MB_INPUT_MAGIC "MBINPUT1"
+
+/* MB_INPUT_X
+ *
+ * the types of event which are recorded
+ * KEY is a key callback, with the key, scancode, action and mods it was given
+ * DRAG is a drag callback, with the change in x and y
+ * SCROLL is a scroll callback, with the change in x and y
+ * RESIZE is a viewport size callback, with the width and height as x and y
+ * REFRESH is a window refresh callback
+ * APPLY is the input accumulated since the last APPLY being applied to the set, so that replaying publishes the same views
+ */
+#define MB_INPUT_KEY 0
+#define MB_INPUT_DRAG 1
+#define MB_INPUT_SCROLL 2
+#define MB_INPUT_RESIZE 3
+#define MB_INPUT_REFRESH 4
+#define MB_INPUT_APPLY 5
+
+
+
+/* STRUCTURES */
+
+/* struct mb_input_header_t
+ *
+ * the header at the start of an input log
+ */
+typedef struct
+{
+    /* MB_INPUT_MAGIC, without its terminator */
+    char magic [ 8 ];
+
+    /* the size of the framebuffer of the window when recording started */
+    int32_t width;
+    int32_t height;
+
+} mb_input_header_t;
+
+/* struct mb_input_event_t
+ *
+ * an event in an input log, 56 bytes with no padding between fields
+ */
+typedef struct
+{
+    /* the seconds since recording started */
+    double time;
+
+    /* the changes in x and y of a drag or scroll, or the size of a resize */
+    double x;
+    double y;
+
+    /* the position of the cursor when the event occured, which a scroll is centred on */
+    float cursor_x;
+    float cursor_y;
+
+    /* the type of the event (MB_INPUT_X) */
+    int32_t type;
+
+    /* the key, scancode, action and mods of a key event */
+    int32_t key;
+    int32_t scancode;
+    int32_t action;
+    int32_t mods;
+
+    /* padding, always 0 */
+    int32_t padding;
+
+} mb_input_event_t;
+
+/* struct mb_input_log_t
+ *
+ * an input log open for recording or replaying
+ */
+typedef struct
+{
+    /* the file of the log */
+    FILE * file;
+
+    /* the header of the log */
+    mb_input_header_t header;
+
+    /* if recording, the time recording started, from glh_get_time */
+    double start_time;
+
+} mb_input_log_t;
+
+
+
+/* FUNCTIONS */
+
+/* mb_input_open_record
+ *
+ * create an input log to record events to, writing its header
+ * glfw must be initialised, as events are timed with glh_get_time
+ *
+ * path: the file to write the log to
+ * width/height: the size of the framebuffer of the window when recording starts
+ *
+ * return: the log, or NULL on failure
+ */
+mb_input_log_t * mb_input_open_record ( const char * path, const int width, const int height );
+
+/* mb_input_record
+ *
+ * record an event to a log, setting its time to the seconds since recording started
+ *
+ * log: the log to record to
+ * event: the event to record, whose time will be set
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_input_record ( mb_input_log_t * log, mb_input_event_t * event );
+
+/* mb_input_open_replay
+ *
+ * open an input log to replay, reading and checking its header
+ *
+ * path: the file to read the log from
+ *
+ * return: the log, or NULL on failure
+ */
+mb_input_log_t * mb_input_open_replay ( const char * path );
+
+/* mb_input_read
+ *
+ * read the next event of a log being replayed
+ *
+ * log: the log to read from
+ * event: will be set to the event
+ *
+ * return: 1 if an event was read, 0 at the end of the log, -1 for failure
+ */
+int mb_input_read ( mb_input_log_t * log, mb_input_event_t * event );
+
+/* mb_input_close
+ *
+ * close an input log, flushing any recorded events
+ *
+ * log: the log to close
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_input_close ( mb_input_log_t * log );
+
+
+
+/* #ifndef MB_INPUT_H_INCLUDED */
+#endif
@@ -0,0 +1,290 @@
+/*
+ * mb_trace.c
+ *
+ * implementation of mb_trace.h
+ */
+
+
+
+/* include mb_trace.h */
+#include "mb_trace.h"
+
+
+
+/* GLOBAL VARIABLES */
+
+/* volatile int MB_TRACE_STATE
+ *
+ * will be one while tracing is enabled, and zero otherwise
+ */
+volatile int MB_TRACE_STATE = 0;
+
+/* the file the trace is dumped to, and the time tracing was enabled */
+static const char * __mb_trace_path = NULL;
+static double __mb_trace_start_time = 0.0;
+
+/* the ring buffers, the number of them ever created, the number of threads ever given one, a mutex guarding their ownership,
+ * and the key holding the buffer of each thread
+ */
+static __mb_trace_buffer_t __mb_trace_buffers [ MB_TRACE_THREADS ];
+static int __mb_trace_buffer_count = 0;
+static int __mb_trace_thread_count = 0;
+static pthread_mutex_t __mb_trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t __mb_trace_key;
+
+
+
+/* FUNCTION IMPLEMENTATIONS */
+
+/* mb_trace_enable
+ *
+ * enable tracing, which lasts until the process exits, at which point the trace is dumped
+ *
+ * path: the file the trace is dumped to, which must live until the process exits
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_trace_enable ( const char * path )
+{
+    /* tracing can only be enabled once */
+    if ( MB_TRACE_STATE )
+    {
+        fprintf ( stderr, "MB ERROR: tracing is already enabled\n" );
+        return -1;
+    }
+
+    /* create the key holding the buffer of each thread, which releases it when the thread exits, and dump the trace at exit */
+    if ( pthread_key_create ( &__mb_trace_key, __mb_trace_release_buffer ) != 0 || atexit ( __mb_trace_dump_at_exit ) != 0 )
+    {
+        /* failed to set up */
+        fprintf ( stderr, "MB ERROR: failed to enable tracing\n" );
+        return -1;
+    }
+
+    /* start the clock and enable tracing */
+    __mb_trace_path = path;
+    __mb_trace_start_time = __mb_trace_time ();
+    __atomic_store_n ( &MB_TRACE_STATE, 1, __ATOMIC_RELEASE );
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_trace_name_thread
+ *
+ * name the calling thread in the trace
+ *
+ * name: the name, which must be a string literal, or otherwise live until the trace is dumped
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_trace_name_thread ( const char * name )
+{
+    /* if not tracing, there is nothing to name */
+    if ( !MB_TRACE_STATE ) return 0;
+
+    /* get the thread's buffer, and name it */
+    __mb_trace_buffer_t * buffer = __mb_trace_thread_buffer ();
+    if ( !buffer ) return -1;
+    buffer->thread_name = name;
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* mb_trace_dump
+ *
+ * dump the most recent events of every thread traced to the trace file as trace-event JSON, replacing any earlier dump
+ * other threads may keep recording events while the trace is dumped
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_trace_dump ()
+{
+    /* if not tracing, there is nothing to dump */
+    if ( !MB_TRACE_STATE ) return 0;
+
+    /* open the file, and allocate memory to copy a buffer into */
+    FILE * file = fopen ( __mb_trace_path, "w" );
+    mb_trace_event_t * events = malloc ( MB_TRACE_EVENTS * sizeof ( mb_trace_event_t ) );
+    if ( !file || !events )
+    {
+        /* failed to open */
+        fprintf ( stderr, "MB ERROR: failed to open trace file %s\n", __mb_trace_path );
+        if ( file ) fclose ( file );
+        free ( events );
+        return -1;
+    }
+
+    /* write each buffer created so far, as a thread of a single process */
+    fprintf ( file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"mandelbrot\"}}" );
+    const int buffer_count = __atomic_load_n ( &__mb_trace_buffer_count, __ATOMIC_ACQUIRE );
+    for ( int i = 0; i < buffer_count; ++i )
+    {
+        /* take the threads which have owned the buffer, and the events recorded so far, as they may be handed off to another thread */
+        __mb_trace_buffer_t * buffer = &__mb_trace_buffers [ i ];
+        pthread_mutex_lock ( &__mb_trace_mutex );
+        const int tid = buffer->tid, previous_tid = buffer->previous_tid;
+        const char * thread_name = buffer->thread_name, * previous_name = buffer->previous_name;
+        const unsigned long thread_first = buffer->first, previous_first = buffer->previous_first;
+        const unsigned long count = __atomic_load_n ( &buffer->count, __ATOMIC_ACQUIRE );
+        pthread_mutex_unlock ( &__mb_trace_mutex );
+
+        /* name the threads */
+        if ( previous_tid >= 0 && previous_name ) fprintf ( file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", previous_tid, previous_name );
+        if ( thread_name ) fprintf ( file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", tid, thread_name );
+
+        /* copy the events the buffer holds, no older than those of the thread before, then drop any the thread may have overwritten
+         * while they were being copied, including the one it may be partway through recording
+         */
+        unsigned long first = ( previous_tid >= 0 ? previous_first : thread_first );
+        if ( count > first + MB_TRACE_EVENTS ) first = count - MB_TRACE_EVENTS;
+        for ( unsigned long j = first; j < count; ++j ) events [ j % MB_TRACE_EVENTS ] = buffer->events [ j % MB_TRACE_EVENTS ];
+        const unsigned long recount = __atomic_load_n ( &buffer->count, __ATOMIC_ACQUIRE );
+        if ( recount + 1 > first + MB_TRACE_EVENTS ) first = recount + 1 - MB_TRACE_EVENTS;
+
+        /* write the events under the thread which recorded them, skipping any ends whose beginnings were overwritten,
+         * and starting afresh from the first event of the current thread, as the thread before may have exited within spans
+         */
+        int depth = 0;
+        for ( unsigned long j = first; j < count; ++j )
+        {
+            const mb_trace_event_t * event = &events [ j % MB_TRACE_EVENTS ];
+            if ( j == thread_first ) depth = 0;
+            if ( event->phase == 'E' && depth == 0 ) continue;
+            depth += ( event->phase == 'B' ) - ( event->phase == 'E' );
+            fprintf ( file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d%s}",
+                      event->name, event->phase, event->time * 1.0e6, ( j < thread_first ? previous_tid : tid ), ( event->phase == 'i' ? ",\"s\":\"t\"" : "" ) );
+        }
+    }
+    fprintf ( file, "\n]}\n" );
+
+    /* close the file */
+    free ( events );
+    if ( fclose ( file ) != 0 )
+    {
+        /* failed to write */
+        fprintf ( stderr, "MB ERROR: failed to write trace file %s\n", __mb_trace_path );
+        return -1;
+    }
+
+    /* return 0 for success */
+    return 0;
+}
+
+/* __mb_trace_event
+ *
+ * record an event on the calling thread, giving it a ring buffer if it has none
+ *
+ * name: the name of the event
+ * phase: the phase of the event ('B', 'E' or 'i')
+ */
+void __mb_trace_event ( const char * name, const char phase )
+{
+    /* get the thread's buffer */
+    __mb_trace_buffer_t * buffer = __mb_trace_thread_buffer ();
+    if ( !buffer ) return;
+
+    /* record the event in the next slot, then publish it */
+    const unsigned long count = buffer->count;
+    mb_trace_event_t * event = &buffer->events [ count % MB_TRACE_EVENTS ];
+    event->name = name;
+    event->time = __mb_trace_time () - __mb_trace_start_time;
+    event->phase = phase;
+    __atomic_store_n ( &buffer->count, count + 1, __ATOMIC_RELEASE );
+}
+
+/* __mb_trace_thread_buffer
+ *
+ * get the ring buffer of the calling thread, giving it one if it has none
+ * a buffer released by a thread which has exited is handed off with a new id and no name, keeping the events of the thread before
+ *
+ * return: the buffer, or NULL if there are none left
+ */
+__mb_trace_buffer_t * __mb_trace_thread_buffer ()
+{
+    /* if the thread already has a buffer, return it */
+    __mb_trace_buffer_t * buffer = pthread_getspecific ( __mb_trace_key );
+    if ( buffer ) return buffer;
+
+    /* otherwise take a buffer released by a thread which has exited, keeping its events under its own id and name,
+     * or create a new one, then give the buffer a new id, with no name, from the next event on
+     */
+    pthread_mutex_lock ( &__mb_trace_mutex );
+    for ( int i = 0; i < __mb_trace_buffer_count && !buffer; ++i ) if ( !__mb_trace_buffers [ i ].owned ) buffer = &__mb_trace_buffers [ i ];
+    if ( buffer )
+    {
+        buffer->previous_tid = buffer->tid;
+        buffer->previous_name = buffer->thread_name;
+        buffer->previous_first = buffer->first;
+    }
+    else if ( __mb_trace_buffer_count < MB_TRACE_THREADS )
+    {
+        mb_trace_event_t * events = malloc ( MB_TRACE_EVENTS * sizeof ( mb_trace_event_t ) );
+        if ( events )
+        {
+            buffer = &__mb_trace_buffers [ __mb_trace_buffer_count ];
+            buffer->events = events;
+            buffer->count = 0;
+            buffer->previous_tid = -1;
+            buffer->previous_name = NULL;
+            buffer->previous_first = 0;
+            __atomic_store_n ( &__mb_trace_buffer_count, __mb_trace_buffer_count + 1, __ATOMIC_RELEASE );
+        }
+    }
+    if ( buffer )
+    {
+        buffer->tid = __mb_trace_thread_count++;
+        buffer->thread_name = NULL;
+        buffer->first = buffer->count;
+        buffer->owned = 1;
+    }
+    pthread_mutex_unlock ( &__mb_trace_mutex );
+
+    /* give the buffer to the thread */
+    if ( buffer ) pthread_setspecific ( __mb_trace_key, buffer );
+
+    /* return the buffer */
+    return buffer;
+}
+
+/* __mb_trace_release_buffer
+ *
+ * release the ring buffer of a thread which has exited, so it can be reused, keeping its events
+ *
+ * arg: the buffer
+ */
+void __mb_trace_release_buffer ( void * arg )
+{
+    /* release the buffer */
+    __mb_trace_buffer_t * buffer = ( __mb_trace_buffer_t * ) arg;
+    pthread_mutex_lock ( &__mb_trace_mutex );
+    buffer->owned = 0;
+    pthread_mutex_unlock ( &__mb_trace_mutex );
+}
+
+/* __mb_trace_dump_at_exit
+ *
+ * dump the trace as the process exits
+ */
+void __mb_trace_dump_at_exit ()
+{
+    /* dump the trace, reporting where it went */
+    if ( mb_trace_dump () == 0 ) fprintf ( stderr, "wrote trace to %s\n", __mb_trace_path );
+}
+
+/* __mb_trace_time
+ *
+ * get the seconds since the epoch, with microsecond resolution
+ *
+ * return: the time
+ */
+double __mb_trace_time ()
+{
+    /* get the time of day */
+    struct timeval time;
+    gettimeofday ( &time, NULL );
+
+    /* return it in seconds */
+    return time.tv_sec + time.tv_usec * 1.0e-6;
+}
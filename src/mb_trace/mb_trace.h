@@ -0,0 +1,195 @@
+/*
+ * mb_trace.h
+ *
+ * lightweight tracing of where time goes across the input, render and present pipeline
+ * each thread records begin, end and instant events into its own ring buffer, so tracing never contends between threads,
+ * and the most recent events of every thread are dumped as Chrome trace-event JSON, which about:tracing and Perfetto both open
+ * while tracing is disabled, each event costs a single check of MB_TRACE_STATE
+ */
+
+
+
+/* pragma one */
+#ifndef MB_TRACE_H_INCLUDED
+#define MB_TRACE_H_INCLUDED
+
+
+
+/* include general headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+
+
+/* MACROS */
+
+/* MB_TRACE_EVENTS
+ *
+ * defines the number of events each thread's ring buffer holds, after which its oldest events are overwritten
+ * can be set during compilation using -DMB_TRACE_EVENTS=events
+ */
+#ifndef MB_TRACE_EVENTS
+#define MB_TRACE_EVENTS 65536
+#endif
+
+/* MB_TRACE_THREADS
+ *
+ * defines the most threads which may be traced at once, after which further threads go untraced
+ * the ring buffer of a thread which exits is reused by the next thread to be traced, which is given an id of its own in the trace
+ * can be set during compilation using -DMB_TRACE_THREADS=threads
+ */
+#ifndef MB_TRACE_THREADS
+#define MB_TRACE_THREADS 64
+#endif
+
+/* MB_TRACE_BEGIN/END/INSTANT
+ *
+ * record the beginning or end of a span of time on the calling thread, or an instant, if tracing is enabled
+ * every span begun must be ended on the same thread, and spans must nest
+ *
+ * name: the name of the event, which must be a string literal, or otherwise live until the trace is dumped
+ */
+#define MB_TRACE_BEGIN(name) \
+        do { if ( MB_TRACE_STATE ) __mb_trace_event ( name, 'B' ); } while ( 0 )
+#define MB_TRACE_END(name) \
+        do { if ( MB_TRACE_STATE ) __mb_trace_event ( name, 'E' ); } while ( 0 )
+#define MB_TRACE_INSTANT(name) \
+        do { if ( MB_TRACE_STATE ) __mb_trace_event ( name, 'i' ); } while ( 0 )
+
+
+
+/* STRUCTURES */
+
+/* struct mb_trace_event_t
+ *
+ * an event recorded by a thread
+ */
+typedef struct
+{
+    /* the name of the event */
+    const char * name;
+
+    /* the seconds since tracing was enabled */
+    double time;
+
+    /* the phase of the event, as in trace-event JSON ('B' for begin, 'E' for end or 'i' for instant) */
+    char phase;
+
+} mb_trace_event_t;
+
+/* struct __mb_trace_buffer_t
+ *
+ * the ring buffer of events of a thread
+ */
+typedef struct
+{
+    /* the events, of which the most recent MB_TRACE_EVENTS are held */
+    mb_trace_event_t * events;
+
+    /* the number of events ever recorded, only written by the thread which owns the buffer */
+    unsigned long count;
+
+    /* the id of the thread in the trace, its name, or NULL if unnamed, the first event it recorded, and 1 while a thread owns the buffer */
+    int tid;
+    const char * thread_name;
+    unsigned long first;
+    int owned;
+
+    /* the id, name and first event of the thread which owned the buffer before, whose events are kept until overwritten, or -1 if none */
+    int previous_tid;
+    const char * previous_name;
+    unsigned long previous_first;
+
+} __mb_trace_buffer_t;
+
+
+
+/* GLOBAL VARIABLES */
+
+/* volatile int MB_TRACE_STATE
+ *
+ * will be one while tracing is enabled, and zero otherwise
+ */
+extern volatile int MB_TRACE_STATE;
+
+
+
+/* FUNCTIONS */
+
+/* mb_trace_enable
+ *
+ * enable tracing, which lasts until the process exits, at which point the trace is dumped
+ *
+ * path: the file the trace is dumped to, which must live until the process exits
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_trace_enable ( const char * path );
+
+/* mb_trace_name_thread
+ *
+ * name the calling thread in the trace
+ *
+ * name: the name, which must be a string literal, or otherwise live until the trace is dumped
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_trace_name_thread ( const char * name );
+
+/* mb_trace_dump
+ *
+ * dump the most recent events of every thread traced to the trace file as trace-event JSON, replacing any earlier dump
+ * other threads may keep recording events while the trace is dumped
+ *
+ * return: 0 for success, -1 for failure
+ */
+int mb_trace_dump ();
+
+/* __mb_trace_event
+ *
+ * record an event on the calling thread, giving it a ring buffer if it has none
+ *
+ * name: the name of the event
+ * phase: the phase of the event ('B', 'E' or 'i')
+ */
+void __mb_trace_event ( const char * name, const char phase );
+
+/* __mb_trace_thread_buffer
+ *
+ * get the ring buffer of the calling thread, giving it one if it has none
+ * a buffer released by a thread which has exited is handed off with a new id and no name, keeping the events of the thread before
+ *
+ * return: the buffer, or NULL if there are none left
+ */
+__mb_trace_buffer_t * __mb_trace_thread_buffer ();
+
+/* __mb_trace_release_buffer
+ *
+ * release the ring buffer of a thread which has exited, so it can be reused, keeping its events
+ *
+ * arg: the buffer
+ */
+void __mb_trace_release_buffer ( void * arg );
+
+/* __mb_trace_dump_at_exit
+ *
+ * dump the trace as the process exits
+ */
+void __mb_trace_dump_at_exit ();
+
+/* __mb_trace_time
+ *
+ * get the seconds since the epoch, with microsecond resolution
+ *
+ * return: the time
+ */
+double __mb_trace_time ();
+
+
+
+/* #ifndef MB_TRACE_H_INCLUDED */
+#endif
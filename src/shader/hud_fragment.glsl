@@ -0,0 +1,39 @@
+/*
+ * hud_fragment.glsl
+ * 
+ * fragment shader for the overlay
+ */
+
+#version 330 core
+
+
+
+/* INPUT AND OUTPUT */
+
+/* the coordinate of the fragment in the font, and the colour of its quad */
+in vec2 font_coord;
+in vec4 quad_colour;
+
+/* output colour */
+out vec4 FragColor;
+
+
+
+/* UNIFORMS */
+
+/* hud_font
+ *
+ * the font, a single channel of coverage for each texel
+ */
+uniform sampler2D hud_font;
+
+
+
+/* MAIN */
+
+/* main */
+void main ()
+{
+    /* colour the fragment, with the alpha of its quad multiplied by the coverage of the font */
+    FragColor = vec4 ( quad_colour.rgb, quad_colour.a * texture ( hud_font, font_coord ).r );
+}
\ No newline at end of file
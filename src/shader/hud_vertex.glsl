@@ -0,0 +1,49 @@
+/*
+ * hud_vertex.glsl
+ * 
+ * vertex shader for the overlay, which draws every quad as an instance of a strip of two triangles
+ */
+
+#version 330 core
+
+
+
+/* INPUT AND OUTPUT */
+
+/* per instance attributes: the left, top, width and height of the quad in pixels from the top left, its colour, and its glyph */
+layout ( location = 0 ) in vec4 rect;
+layout ( location = 1 ) in vec4 colour;
+layout ( location = 2 ) in float glyph;
+
+/* the coordinate of the quad in the font, and its colour */
+out vec2 font_coord;
+out vec4 quad_colour;
+
+
+
+/* UNIFORMS */
+
+/* hud_viewport
+ *
+ * the size of the viewport in pixels
+ */
+uniform vec2 hud_viewport;
+
+
+
+/* MAIN */
+
+/* main */
+void main ()
+{
+    /* find the corner of the quad from the vertex, 0 to 3 being top left, top right, bottom left and bottom right */
+    vec2 corner = vec2 ( gl_VertexID & 1, gl_VertexID >> 1 );
+
+    /* find the pixel of the corner, and transform it to clip space, flipping y so that it runs down the viewport */
+    vec2 pixel = rect.xy + corner * rect.zw;
+    gl_Position = vec4 ( pixel.x / hud_viewport.x * 2.0f - 1.0f, 1.0f - pixel.y / hud_viewport.y * 2.0f, 0.0f, 1.0f );
+
+    /* find the corner in the font, where the glyphs sit side by side with their top rows first */
+    font_coord = vec2 ( ( glyph + corner.x ) / 96.0f, corner.y );
+    quad_colour = colour;
+}
\ No newline at end of file
@@ -10,38 +10,56 @@
 
 /* INPUT AND OUTPUT */
 
-/* output colour */
-out vec4 FragColor;
+/* output colour, and the iterations completed, which is only kept if the frame has a second colour buffer for statistics */
+layout ( location = 0 ) out vec4 FragColor;
+layout ( location = 1 ) out float FragIterations;
 
 
 
 /* UNIFORMS */
 
-/* mandelbrot_stretch/translation/rotation
- * 
- * uniforms to be applied to a fragment to transform it to a value of c for the mandelbrot function
- */
-uniform vec4 mandelbrot_stretch;
-uniform vec4 mandelbrot_translation;
-uniform mat2 mandelbrot_rotation;
-
-/* mandelbrot_breakout
+/* mandelbrot_parameters
  *
- * uniform for the breakout point of the mandelbrot iteration
- */
-uniform float mandelbrot_breakout;
-
-/* mandelbrot_max_it
+ * std140 uniform block holding the parameters of the set, shared with mb_handler's uniform buffer object
+ * must match the layout of mb_uniforms_t
  *
- * uniform for the maximum number of iterations of the mandelbrot function
+ * mandelbrot_stretch/translation/rotation: transformations to be applied to a fragment to transform it to its offset from the centre of the view,
+ * so that the view rotates about its centre
+ * mandelbrot_breakout: the breakout point of the mandelbrot iteration
+ * mandelbrot_max_it: the maximum number of iterations of the mandelbrot function
+ * mandelbrot_power: the power of z
+ * mandelbrot_output: 0 to output a colour, or 1 to output the raw values found by iterate_raw, for a float frame
+ * mandelbrot_mapping: 0 to map fragments linearly onto the plane, or 1 to map them onto a log-polar strip around the centre of the view
+ * mandelbrot_log_radius: if log-polar, the log of the distance from the centre at the left edge of the frame
+ * mandelbrot_log_step: if log-polar, the decrease in the log of the distance across each pixel, which is also the angle up each pixel
+ * mandelbrot_angle: if log-polar, the angle at the bottom edge of the frame
+ * mandelbrot_reference: the reference point, which the centre of the view is an offset from when there is a reference orbit, otherwise 0
+ * mandelbrot_centre: the centre of the view, or its offset from the reference point when there is a reference orbit
+ * mandelbrot_orbit_length: the number of points in the reference orbit, or 0 if there is none
  */
-uniform int mandelbrot_max_it;
-
-/* mandelbrot_power
- * 
- * uniform for the power of z
+layout ( std140 ) uniform mandelbrot_parameters
+{
+    vec4 mandelbrot_stretch;
+    vec4 mandelbrot_translation;
+    mat2 mandelbrot_rotation;
+    float mandelbrot_breakout;
+    int mandelbrot_max_it;
+    int mandelbrot_power;
+    int mandelbrot_output;
+    int mandelbrot_mapping;
+    float mandelbrot_log_radius;
+    float mandelbrot_log_step;
+    float mandelbrot_angle;
+    vec2 mandelbrot_reference;
+    vec2 mandelbrot_centre;
+    int mandelbrot_orbit_length;
+};
+
+/* mandelbrot_orbit
+ *
+ * the reference orbit, the point after each iteration of the reference point in the xy of consecutive texels, row by row
  */
-uniform int mandelbrot_power;
+uniform sampler2D mandelbrot_orbit;
 
 
 
@@ -121,7 +139,7 @@ vec2 complex_pow ( const vec2 z, const int p )
 
 /* transform_vector
  *
- * transforms a vector through a stretch followd by a translation
+ * transforms a vector through a stretch followd by a translation, then rotates it about the origin
  *
  * initial_vector: initial vector
  * stretch: stretch to apply to the initial vector
@@ -143,6 +161,28 @@ vec4 transform_vector ( const vec4 initial_vector, const vec4 stretch, const vec
     return transformed_vector;
 }
 
+/* transform_log_polar
+ *
+ * transforms a fragment onto a log-polar strip, where each column is a step in the log of the distance from a centre and each row is an angle
+ * the steps in both are equal, so the strip is conformal and features keep their shape as they shrink towards the centre
+ *
+ * frag_coord: the fragment coordinates
+ * centre: the centre of the strip
+ * log_radius: the log of the distance from the centre at the left edge of the frame
+ * log_step: the decrease in the log of the distance across each pixel, and the angle up each pixel
+ * angle: the angle at the bottom edge of the frame
+ *
+ * return: the value of c at the fragment
+ */
+vec2 transform_log_polar ( const vec4 frag_coord, const vec2 centre, const float log_radius, const float log_step, const float angle )
+{
+    /* find the distance and angle of the fragment */
+    float radius = exp ( log_radius - ( frag_coord.x * log_step ) );
+    float theta = angle + ( frag_coord.y * log_step );
+    /* return the point at that distance and angle from the centre */
+    return centre + radius * vec2 ( cos ( theta ), sin ( theta ) );
+}
+
 /* iterate_on_mandelbrot
  *
  * c: the complex number to test in the form x + yi
@@ -201,14 +241,180 @@ int iterate_on_multibrot ( const vec2 c, const float breakout, const int max_it,
     return it;
 }
 
+/* iterate_perturbed
+ *
+ * iterate on the mandelbrot function by perturbing around the reference orbit, so that only the offsets of c from the reference point
+ * and of z from the orbit are held as floats, and these stay precise however deep the view
+ * the offset is rebased onto the start of the orbit whenever z comes nearer to 0 than the offset, or the orbit runs out,
+ * so a single orbit serves every pixel, including those iterating for longer than the reference point
+ *
+ * dc: the offset of c from the reference point
+ * breakout: the absolute value at which to break out on
+ * max_it: the maximum number of iterations
+ * orbit_length: the number of points in the reference orbit, at least 2
+ *
+ * return: the number of iterations before reaching breakout or max_it
+ */
+int iterate_perturbed ( const vec2 dc, const float breakout, const int max_it, const int orbit_length )
+{
+    /* find the width of the orbit texture */
+    int orbit_width = textureSize ( mandelbrot_orbit, 0 ).x;
+    /* initial offset from the start of the orbit */
+    vec2 dz = vec2 ( 0.0f, 0.0f );
+    vec2 reference_z = vec2 ( 0.0f, 0.0f );
+    int reference_it = 0;
+    float absab = 0;
+    /* initiate iteration loop */
+    int it;
+    for ( it = 0; absab < breakout && it < max_it; ++it )
+    {
+        /* perturb the offset, which is 2 * Z * dz + dz^2 + dc */
+        dz = 2.0f * complex_multiply ( reference_z, dz ) + complex_square ( dz ) + dc;
+        /* step along the orbit and find z */
+        ++reference_it;
+        reference_z = texelFetch ( mandelbrot_orbit, ivec2 ( reference_it % orbit_width, reference_it / orbit_width ), 0 ).xy;
+        vec2 z = reference_z + dz;
+        /* find the absolute */
+        absab = complex_abs ( z );
+        /* rebase onto the start of the orbit, where Z is 0, if z is nearer 0 than the offset or the orbit has run out */
+        if ( dot ( z, z ) < dot ( dz, dz ) || reference_it == orbit_length - 1 )
+        {
+            dz = z;
+            reference_z = vec2 ( 0.0f, 0.0f );
+            reference_it = 0;
+        }
+    }
+    /* return iterations completed */
+    return it;
+}
+
+/* iterate_perturbed_raw
+ *
+ * iterate on the mandelbrot function by perturbing around the reference orbit, as iterate_perturbed does,
+ * tracking the derivative of z with respect to c, as iterate_raw does
+ *
+ * dc: the offset of c from the reference point
+ * breakout: the absolute value at which to break out on
+ * max_it: the maximum number of iterations
+ * orbit_length: the number of points in the reference orbit, at least 2
+ * spacing: the distance between neighbouring pixels on the complex plane
+ *
+ * return: the number of iterations completed, the final |z|^2, the exterior distance estimate 2|z|log|z|/|dz/dc| (0 if inside the set),
+ *         and 1 if the spacing is too small for the offset of c to be held to within a pixel as a float, otherwise 0
+ */
+vec4 iterate_perturbed_raw ( const vec2 dc, const float breakout, const int max_it, const int orbit_length, const float spacing )
+{
+    /* find the width of the orbit texture */
+    int orbit_width = textureSize ( mandelbrot_orbit, 0 ).x;
+    /* initial offset from the start of the orbit, z, and its derivative */
+    vec2 dz = vec2 ( 0.0f, 0.0f );
+    vec2 reference_z = vec2 ( 0.0f, 0.0f );
+    vec2 z = vec2 ( 0.0f, 0.0f );
+    vec2 der = vec2 ( 0.0f, 0.0f );
+    int reference_it = 0;
+    float absab = 0;
+    /* initiate iteration loop */
+    int it;
+    for ( it = 0; absab < breakout && it < max_it; ++it )
+    {
+        /* find the derivative, which is 2 * z * dz/dc + 1 */
+        der = 2.0f * complex_multiply ( z, der ) + vec2 ( 1.0f, 0.0f );
+        /* perturb the offset, which is 2 * Z * dz + dz^2 + dc */
+        dz = 2.0f * complex_multiply ( reference_z, dz ) + complex_square ( dz ) + dc;
+        /* step along the orbit and find z */
+        ++reference_it;
+        reference_z = texelFetch ( mandelbrot_orbit, ivec2 ( reference_it % orbit_width, reference_it / orbit_width ), 0 ).xy;
+        z = reference_z + dz;
+        /* find the absolute */
+        absab = complex_abs ( z );
+        /* rebase onto the start of the orbit, where Z is 0, if z is nearer 0 than the offset or the orbit has run out */
+        if ( dot ( z, z ) < dot ( dz, dz ) || reference_it == orbit_length - 1 )
+        {
+            dz = z;
+            reference_z = vec2 ( 0.0f, 0.0f );
+            reference_it = 0;
+        }
+    }
+    /* find the distance estimate, only meaningful outside of the set */
+    float distance = ( it < max_it && absab > 1.0f ? 2.0f * absab * log ( absab ) / complex_abs ( der ) : 0.0f );
+    /* flag pixels whose spacing is within a few ulps of the offset, where neighbouring pixels iterate on the same value */
+    float glitch = ( spacing < max ( abs ( dc.x ), abs ( dc.y ) ) * 1.0e-6f ? 1.0f : 0.0f );
+    /* return the raw values */
+    return vec4 ( float ( it ), dot ( z, z ), distance, glitch );
+}
+
+/* iterate_raw
+ *
+ * iterate on the mandelbrot or multibrot function, tracking the derivative of z with respect to c
+ *
+ * c: the complex number to test in the form x + yi
+ * breakout: the absolute value at which to break out on
+ * max_it: the maximum number of iterations
+ * power: the power of z
+ * spacing: the distance between neighbouring pixels on the complex plane
+ *
+ * return: the number of iterations completed, the final |z|^2, the exterior distance estimate 2|z|log|z|/|dz/dc| (0 if inside the set),
+ *         and 1 if the spacing is too small for c to be held to within a pixel as a float, otherwise 0
+ */
+vec4 iterate_raw ( const vec2 c, const float breakout, const int max_it, const int power, const float spacing )
+{
+    /* initial input to the mandelbrot function, and its derivative */
+    vec2 z = vec2 ( 0.0f, 0.0f );
+    vec2 dz = vec2 ( 0.0f, 0.0f );
+    float absab = 0;
+    /* initiate iteration loop */
+    int it;
+    for ( it = 0; absab < breakout && it < max_it; ++it )
+    {
+        /* find the derivative, which is power * z^(power-1) * dz + 1 */
+        dz = float ( power ) * complex_multiply ( ( power == 2 ? z : complex_pow ( z, power - 1 ) ), dz ) + vec2 ( 1.0f, 0.0f );
+        /* raise z to power and add c */
+        z = ( power == 2 ? complex_square ( z ) : complex_pow ( z, power ) ) + c;
+        /* find the absolute */
+        absab = complex_abs ( z );
+    }
+    /* find the distance estimate, only meaningful outside of the set */
+    float distance = ( it < max_it && absab > 1.0f ? 2.0f * absab * log ( absab ) / complex_abs ( dz ) : 0.0f );
+    /* flag pixels whose spacing is within a few ulps of c, where neighbouring pixels iterate on the same value */
+    float glitch = ( spacing < max ( abs ( c.x ), abs ( c.y ) ) * 1.0e-6f ? 1.0f : 0.0f );
+    /* return the raw values */
+    return vec4 ( float ( it ), dot ( z, z ), distance, glitch );
+}
+
 void main ()
 {
-    /* transform frag coords */
+    /* transform frag coords to their offset from the centre of the view, linearly or onto a log-polar strip,
+     * where the spacing of pixels grows with the distance from the centre
+     */
     vec4 new_frag_coord = transform_vector ( gl_FragCoord, mandelbrot_stretch, mandelbrot_translation, mandelbrot_rotation );
-    /* if mandelbrot_power == 2, use normal function */
+    float spacing = mandelbrot_stretch.x;
+    if ( mandelbrot_mapping == 1 )
+    {
+        new_frag_coord.xy = transform_log_polar ( gl_FragCoord, vec2 ( 0.0f, 0.0f ), mandelbrot_log_radius, mandelbrot_log_step, mandelbrot_angle );
+        spacing = exp ( mandelbrot_log_radius - ( gl_FragCoord.x * mandelbrot_log_step ) ) * mandelbrot_log_step;
+    }
+    /* add the centre, to find the offset from the reference point, which is 0 if there is none */
+    new_frag_coord.xy += mandelbrot_centre;
+    /* perturb around the reference orbit if there is one, with a power of 2, when the spacing is too fine for c to be held
+     * as a float to within a few hundred ulps, otherwise add the reference point back, as iterating on c directly is cheaper
+     */
+    vec2 c = mandelbrot_reference + new_frag_coord.xy;
+    bool perturbed = ( mandelbrot_orbit_length > 1 && mandelbrot_power == 2 && spacing < max ( abs ( c.x ), abs ( c.y ) ) * 1.0e-5f );
+    if ( !perturbed ) new_frag_coord.xy = c;
+    /* if outputting raw values, output them without colouring */
+    if ( mandelbrot_output == 1 )
+    {
+        if ( perturbed ) FragColor = iterate_perturbed_raw ( new_frag_coord.xy, mandelbrot_breakout, mandelbrot_max_it, mandelbrot_orbit_length, spacing );
+        else FragColor = iterate_raw ( new_frag_coord.xy, mandelbrot_breakout, mandelbrot_max_it, mandelbrot_power, spacing );
+        FragIterations = FragColor.x;
+        return;
+    }
+    /* if perturbed, iterate on the offset, otherwise if mandelbrot_power == 2, use normal function */
     float mandelbrot_constant;
-    if ( mandelbrot_power == 2 ) mandelbrot_constant = iterate_on_mandelbrot ( new_frag_coord.xy, mandelbrot_breakout, mandelbrot_max_it );
+    if ( perturbed ) mandelbrot_constant = iterate_perturbed ( new_frag_coord.xy, mandelbrot_breakout, mandelbrot_max_it, mandelbrot_orbit_length );
+    else if ( mandelbrot_power == 2 ) mandelbrot_constant = iterate_on_mandelbrot ( new_frag_coord.xy, mandelbrot_breakout, mandelbrot_max_it );
     else mandelbrot_constant = iterate_on_multibrot ( new_frag_coord.xy, mandelbrot_breakout, mandelbrot_max_it, mandelbrot_power );
+    FragIterations = mandelbrot_constant;
     /* fully in set colour */
     if ( mandelbrot_constant == mandelbrot_max_it ) FragColor = vec4 ( 0.0, 0.0, 0.0, 1.0 );
     /* if not in set */
@@ -0,0 +1,28 @@
+/*
+ * reduce_fragment.glsl
+ * 
+ * fragment shader for the reduction of a frame's iterations
+ */
+
+#version 330 core
+
+
+
+/* INPUT AND OUTPUT */
+
+/* the iterations of the pixel beyond the start of its bin, split into their remainder modulo 256 and the number of whole 256s */
+flat in vec2 bin_offset;
+
+/* output to be added to the cell, the pixel count in red and the iterations beyond the start of the bin in green and blue */
+out vec4 FragColor;
+
+
+
+/* MAIN */
+
+/* main */
+void main ()
+{
+    /* count the pixel and its iterations */
+    FragColor = vec4 ( 1.0f, bin_offset.x, bin_offset.y, 0.0f );
+}
\ No newline at end of file
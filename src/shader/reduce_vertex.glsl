@@ -0,0 +1,79 @@
+/*
+ * reduce_vertex.glsl
+ * 
+ * vertex shader for the reduction of a frame's iterations, which draws a point for each pixel of the frame onto the cell of the histogram
+ * its iterations fall into, so that additive blending sums the histogram without atomics
+ */
+
+#version 330 core
+
+
+
+/* INPUT AND OUTPUT */
+
+/* the iterations of the pixel beyond the start of its bin, split into their remainder modulo 256 and the number of whole 256s */
+flat out vec2 bin_offset;
+
+
+
+/* UNIFORMS */
+
+/* reduce_iterations
+ *
+ * the iterations of each pixel of the frame, in the red channel
+ */
+uniform sampler2D reduce_iterations;
+
+/* reduce_max_it
+ *
+ * the maximum iterations the frame was rendered with
+ */
+uniform int reduce_max_it;
+
+/* reduce_rows
+ *
+ * the number of rows of the histogram the pixels are spread over, which is enough that the sums of no cell reach 2^24
+ */
+uniform int reduce_rows;
+
+
+
+/* MACROS */
+
+/* REDUCE_BINS
+ *
+ * the number of bins in the histogram, which must match MANDELBROT_HISTOGRAM_BINS
+ */
+#define REDUCE_BINS 64
+
+
+
+/* MAIN */
+
+/* main */
+void main ()
+{
+    /* find the pixel of the vertex and its iterations */
+    int width = textureSize ( reduce_iterations, 0 ).x;
+    float it = texelFetch ( reduce_iterations, ivec2 ( gl_VertexID % width, gl_VertexID / width ), 0 ).r;
+
+    /* find its bin, the last being pixels which reached the maximum iterations and the rest splitting the iterations below it evenly,
+     * and its offset from the whole number of iterations the bin starts at, found without overflow as __mb_read_frame_stats finds it,
+     * which is summed rather than the iterations themselves, split in two so that each sum is of whole numbers below 2^24, and so exact
+     */
+    int bin = REDUCE_BINS - 1;
+    bin_offset = vec2 ( 0.0f, 0.0f );
+    if ( it < float ( reduce_max_it ) )
+    {
+        bin = min ( int ( it * float ( REDUCE_BINS - 1 ) / float ( reduce_max_it ) ), REDUCE_BINS - 2 );
+        int bin_start = bin * ( reduce_max_it / ( REDUCE_BINS - 1 ) ) + bin * ( reduce_max_it % ( REDUCE_BINS - 1 ) ) / ( REDUCE_BINS - 1 );
+        float offset = max ( it - float ( bin_start ), 0.0f );
+        bin_offset = vec2 ( mod ( offset, 256.0f ), floor ( offset / 256.0f ) );
+    }
+
+    /* spread neighbouring pixels over the rows, so that no cell counts so many pixels that its sums lose precision */
+    int row = gl_VertexID % reduce_rows;
+
+    /* place the point at the centre of its cell */
+    gl_Position = vec4 ( ( float ( bin ) + 0.5f ) / REDUCE_BINS * 2.0f - 1.0f, ( float ( row ) + 0.5f ) / float ( reduce_rows ) * 2.0f - 1.0f, 0.0f, 1.0f );
+}
\ No newline at end of file